@@ -75,7 +75,7 @@ int main() {
         synth->generateAudio(output, numFrames);
         
         // Also process tracks (for future use)
-        trackManager.processAllTracks(output, numFrames);
+        trackManager.processAllTracks(output, numFrames, &engine.getScratchArena());
     });
     
     // Start audio engine
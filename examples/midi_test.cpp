@@ -59,7 +59,7 @@ int main() {
         output.clear();
         
         // Process tracks
-        trackManager.processAllTracks(output, numFrames);
+        trackManager.processAllTracks(output, numFrames, &engine.getScratchArena());
         
         // Update timeline position (simplified - real implementation needs proper transport)
         timelinePosition += numFrames;
@@ -0,0 +1,94 @@
+// Offline synthesizer benchmark: how many voices one core can render in real time,
+// with the band-limited wavetable oscillators and with the old naive ones.
+//
+// Usage: synth_benchmark [seconds-of-audio-per-run] [control-rate]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "pan/audio/audio_buffer.h"
+#include "pan/midi/synthesizer.h"
+#include "pan/midi/wavetable.h"
+
+namespace {
+
+constexpr double SAMPLE_RATE = 48000.0;
+constexpr size_t BLOCK_SIZE = 256;
+constexpr int VOICES = 16;  // Synthesizer::DEFAULT_POLYPHONY
+
+struct Patch {
+    const char* name;
+    std::vector<pan::Oscillator> oscillators;
+    int unison;
+    bool pad = false;  // Filter with envelope, amplitude LFO
+};
+
+// Seconds of wall time needed to render one second of audio with VOICES notes held
+double measure(const Patch& patch, bool bandLimited, double audioSeconds, size_t controlRate) {
+    pan::Synthesizer synth(SAMPLE_RATE);
+    synth.setBandLimited(bandLimited);
+    synth.setControlRate(controlRate);
+    synth.setOscillators(patch.oscillators);
+    synth.setADSR(0.001f, 0.1f, 1.0f, 0.3f);
+    if (patch.unison > 1) {
+        synth.getEnvelope().unison.enabled = true;
+        synth.getEnvelope().unison.voices = patch.unison;
+        synth.getEnvelope().unison.detune = 20.0f;
+    }
+    if (patch.pad) {
+        auto& env = synth.getEnvelope();
+        env.filter.enabled = true;
+        env.filter.cutoff = 0.5f;
+        env.filter.resonance = 0.3f;
+        env.filter.envAmount = 0.3f;
+        env.filter.envelope = pan::ADSREnvelope(0.5f, 1.0f, 0.5f, 1.0f);
+        env.lfo1 = pan::LFO(0.3f, 0.2f, pan::LFO::Target::Amplitude);
+    }
+    for (int v = 0; v < VOICES; ++v) {
+        synth.noteOn(static_cast<uint8_t>(36 + v * 3), 100);
+    }
+
+    pan::AudioBuffer buffer(2, BLOCK_SIZE);
+    const size_t blocks = static_cast<size_t>(audioSeconds * SAMPLE_RATE / BLOCK_SIZE);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t b = 0; b < blocks; ++b) {
+        synth.generateAudio(buffer, BLOCK_SIZE);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (static_cast<double>(blocks * BLOCK_SIZE) / SAMPLE_RATE);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double audioSeconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+    int controlRate = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(pan::Synthesizer::DEFAULT_CONTROL_RATE);
+    if (audioSeconds <= 0.0 || controlRate <= 0) {
+        std::fprintf(stderr, "Usage: %s [seconds-of-audio-per-run] [control-rate]\n", argv[0]);
+        return 1;
+    }
+
+    // Build the tables outside the timed region
+    pan::WavetableBank::get();
+
+    const std::vector<Patch> patches = {
+        {"sine", {pan::Oscillator(pan::Waveform::Sine, 1.0f, 1.0f)}, 1},
+        {"saw", {pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 1.0f)}, 1},
+        {"square + triangle", {pan::Oscillator(pan::Waveform::Square, 1.0f, 0.5f),
+                               pan::Oscillator(pan::Waveform::Triangle, 2.0f, 0.5f)}, 1},
+        {"saw x4 unison", {pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 1.0f)}, 4},
+        {"pad", {pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 0.5f),
+                 pan::Oscillator(pan::Waveform::Sawtooth, 2.0f, 0.3f)}, 4, true},
+    };
+
+    std::printf("%d voices, %.0f Hz, %zu-frame blocks, control rate %d, %.1f s of audio per run\n\n",
+                VOICES, SAMPLE_RATE, BLOCK_SIZE, controlRate, audioSeconds);
+    std::printf("%-20s %18s %18s %8s\n", "patch", "naive voices/core", "table voices/core", "speedup");
+    for (const auto& patch : patches) {
+        double naive = measure(patch, false, audioSeconds, static_cast<size_t>(controlRate));
+        double table = measure(patch, true, audioSeconds, static_cast<size_t>(controlRate));
+        std::printf("%-20s %18.0f %18.0f %7.2fx\n", patch.name, VOICES / naive, VOICES / table, naive / table);
+    }
+    return 0;
+}
@@ -1,42 +1,89 @@
 #pragma once
 
-#include <vector>
 #include <cstddef>
 
 namespace pan {
 
 /**
- * Audio buffer for storing multi-channel audio data
+ * Audio buffer for storing multi-channel audio data.
+ *
+ * All channels live in one 64-byte-aligned allocation; each channel starts on
+ * an aligned boundary (the channel stride is padded to whole cache lines).
+ * createView() returns a non-owning buffer over a frame range of this one, so
+ * a block can be split and processed in place without copies. A view must not
+ * outlive the buffer it was created from.
  */
 class AudioBuffer {
 public:
+    static constexpr size_t ALIGNMENT = 64;
+
     AudioBuffer(size_t numChannels, size_t numFrames);
-    ~AudioBuffer() = default;
+    ~AudioBuffer();
+
+    // Copies are deep (and always owning); moves transfer the storage
+    AudioBuffer(const AudioBuffer& other);
+    AudioBuffer& operator=(const AudioBuffer& other);
+    AudioBuffer(AudioBuffer&& other) noexcept;
+    AudioBuffer& operator=(AudioBuffer&& other) noexcept;
 
     // Buffer properties
     size_t getNumChannels() const { return numChannels_; }
     size_t getNumFrames() const { return numFrames_; }
     size_t getSize() const { return numChannels_ * numFrames_; }
+    size_t getCapacity() const { return capacity_; }
+    size_t getChannelStride() const { return stride_; }
+    bool isView() const { return !ownsData_; }
+
+    // Change the logical length without reallocating. Fails if numFrames exceeds
+    // the capacity the buffer was constructed with.
+    bool setNumFrames(size_t numFrames);
+
+    // Non-owning view of frames [offset, offset + length), clipped to this buffer
+    AudioBuffer createView(size_t offset, size_t length);
 
     // Data access
     float* getWritePointer(size_t channel);
     const float* getReadPointer(size_t channel) const;
-    
-    // Channel access
-    std::vector<float>& getChannel(size_t channel);
-    const std::vector<float>& getChannel(size_t channel) const;
 
-    // Buffer operations
+    // Buffer operations (whole buffer)
     void clear();
     void fill(float value);
+    void applyGain(float gain);
+    void applyGainRamp(float startGain, float endGain);
+
+    // Copy/add the overlapping region: min(channels) x min(frames)
     void copyFrom(const AudioBuffer& other);
     void addFrom(const AudioBuffer& other, float gain = 1.0f);
+    void addFromWithRamp(const AudioBuffer& other, float startGain, float endGain);
+
+    // Ranged operations; out-of-range requests are clipped
+    void clear(size_t channel, size_t startFrame, size_t numFrames);
+    void applyGain(size_t channel, size_t startFrame, size_t numFrames, float gain);
+    void applyGainRamp(size_t channel, size_t startFrame, size_t numFrames, float startGain, float endGain);
+    void copyFrom(size_t destChannel, size_t destStartFrame, const AudioBuffer& source,
+                  size_t sourceChannel, size_t sourceStartFrame, size_t numFrames);
+    void addFrom(size_t destChannel, size_t destStartFrame, const AudioBuffer& source,
+                 size_t sourceChannel, size_t sourceStartFrame, size_t numFrames, float gain = 1.0f);
+
+    // Metering
+    float getPeak(size_t channel) const;
+    float getPeak(size_t channel, size_t startFrame, size_t numFrames) const;
+    float getRMS(size_t channel) const;
+    float getRMS(size_t channel, size_t startFrame, size_t numFrames) const;
 
 private:
-    size_t numChannels_;
-    size_t numFrames_;
-    std::vector<std::vector<float>> channels_;
+    AudioBuffer(float* data, size_t numChannels, size_t numFrames, size_t stride);
+
+    void allocate(size_t numChannels, size_t numFrames);
+    void release();
+    size_t clipLength(size_t startFrame, size_t numFrames) const;
+
+    float* data_ = nullptr;
+    size_t numChannels_ = 0;
+    size_t numFrames_ = 0;
+    size_t capacity_ = 0;
+    size_t stride_ = 0;
+    bool ownsData_ = false;
 };
 
 } // namespace pan
-
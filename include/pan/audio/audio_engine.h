@@ -4,11 +4,89 @@
 #include <vector>
 #include <atomic>
 #include <functional>
+#include <string>
+#include "pan/audio/wav_writer.h"
+#include "pan/audio/device_io.h"
+#include "pan/audio/realtime_thread.h"
+#include "pan/audio/callback_stats.h"
+#include "pan/audio/audio_recorder.h"
 
 namespace pan {
 
 class AudioBuffer;
 class AudioDevice;
+class RenderPool;
+class ScratchArena;
+
+/**
+ * Progress report for offline (faster than real-time) renders
+ */
+struct OfflineRenderProgress {
+    size_t framesRendered = 0;
+    size_t totalFrames = 0;
+    double elapsedSeconds = 0.0;   // Wall-clock time spent rendering
+    double realtimeFactor = 0.0;   // Seconds of audio rendered per second of wall time
+    bool cancelled = false;
+
+    float getFraction() const {
+        return totalFrames > 0 ? static_cast<float>(framesRendered) / static_cast<float>(totalFrames) : 1.0f;
+    }
+};
+
+/**
+ * Offline render settings. The process callback is driven in a tight loop
+ * with no device attached; every rendered block is handed to the sink.
+ */
+struct OfflineRenderOptions {
+    size_t totalFrames = 0;
+    size_t blockSize = 512;
+    size_t numChannels = 2;
+
+    // Receives each rendered block. Return false to abort the render.
+    std::function<bool(const AudioBuffer& block, size_t numFrames)> sink;
+
+    // Called roughly every progressIntervalFrames and once at the end. Return false to cancel.
+    std::function<bool(const OfflineRenderProgress& progress)> progress;
+    size_t progressIntervalFrames = 44100;
+};
+
+/**
+ * Device stream settings, applied by start(). sampleRate and bufferSize are the
+ * same values setSampleRate()/setBufferSize() change.
+ */
+struct StreamConfig {
+    enum class HostApi {
+        Default,  // PulseAudio, then ALSA, then whatever PortAudio lists first
+        Jack,
+        Alsa,
+        Pulse
+    };
+
+    HostApi hostApi = HostApi::Default;
+    double sampleRate = 44100.0;
+    size_t bufferSize = 512;        // Frames per callback (0 = let the host choose)
+    double suggestedLatency = 0.0;  // Seconds; 0 = device default (high latency on Pulse, low otherwise)
+    bool duplex = false;            // Open the default input device as well
+    size_t numChannels = 2;
+    SampleFormat format = SampleFormat::Float32;
+    bool dither = false;            // TPDF dither for integer formats
+};
+
+/**
+ * What the host actually gave us for the running stream
+ */
+struct StreamInfo {
+    bool open = false;
+    std::string hostApiName;
+    std::string outputDeviceName;
+    std::string inputDeviceName;    // Empty unless the stream is duplex
+    double sampleRate = 0.0;
+    size_t bufferSize = 0;          // Requested frames per callback; the host may vary it
+    size_t numOutputChannels = 0;
+    size_t numInputChannels = 0;
+    double outputLatency = 0.0;     // Seconds, as reported by Pa_GetStreamInfo
+    double inputLatency = 0.0;
+};
 
 /**
  * Core audio engine responsible for real-time audio processing
@@ -34,22 +112,90 @@ public:
     // Sample rate and buffer size
     void setSampleRate(double sampleRate);
     double getSampleRate() const;
+    
+    // Called whenever getSampleRate() changes: through setSampleRate() or
+    // setStreamConfig(), or when start() gets a different rate from the device
+    // than the one configured. Runs on the thread that made the change, after
+    // the change; never on the audio thread.
+    using SampleRateListener = std::function<void(double sampleRate)>;
+    void setSampleRateListener(SampleRateListener listener);
     void setBufferSize(size_t bufferSize);
     size_t getBufferSize() const;
 
-    // Audio processing callback
+    // Full stream configuration. Cannot be changed while running or rendering offline.
+    bool setStreamConfig(const StreamConfig& config);
+    StreamConfig getStreamConfig() const;
+    StreamInfo getStreamInfo() const;
+    static const char* getHostApiName(StreamConfig::HostApi hostApi);
+
+    // Audio processing callback. Installing one never blocks the audio thread: the
+    // new callback is handed over atomically and the old one is retired until
+    // collectGarbage() can free it.
     using ProcessCallback = std::function<void(AudioBuffer& input, AudioBuffer& output, size_t numFrames)>;
     void setProcessCallback(ProcessCallback callback);
+    bool hasProcessCallback();
+
+    // Free retired callbacks. Call periodically from a non-real-time thread (e.g. the GUI loop).
+    size_t collectGarbage();
 
     // Internal callback handler (for PortAudio) - public for callback access
     void processAudioCallback(AudioBuffer& input, AudioBuffer& output, size_t numFrames);
     
-    // Methods for PortAudio callback to access buffers
+    // Planar staging buffers used by processDeviceBlock (allocated in initialize()/start())
     AudioBuffer* getInputBuffer();
     AudioBuffer* getOutputBuffer();
     
-    // Internal method for callback to resize buffers if needed
-    void resizeBuffersIfNeeded(size_t numChannels, size_t numFrames);
+    // Device callback entry point: converts the device's interleaved buffers to and
+    // from the staging buffers and runs the process callback. Blocks larger than the
+    // staging buffers are processed in chunks; nothing is allocated.
+    // statusFlags are CallbackStats::StatusFlags (PortAudio's values) and feed the stats below.
+    void processDeviceBlock(const void* deviceInput, void* deviceOutput, size_t numFrames,
+                            uint32_t statusFlags = 0, double outputLatencySeconds = 0.0);
+    
+    // Timing and xrun counters for device callbacks, reset by start(). Lock-free;
+    // safe to poll from the GUI.
+    CallbackStatsSnapshot getCallbackStats() const;
+    void resetCallbackStats();
+    
+    // Input recorder. While it is recording, processDeviceBlock() pushes every block
+    // of device input to it; start it with the stream's input channel count.
+    AudioRecorder& getRecorder();
+    
+    // Priority, CPU pinning, memory locking and denormal flushing for the audio thread
+    // and render workers. Applied by start(): memory is locked there, the audio thread
+    // configures itself on its first callback and workers on their next wake-up.
+    bool setRealtimePolicy(const RealtimeThreadPolicy& policy);
+    RealtimeThreadPolicy getRealtimePolicy() const;
+    RealtimeDiagnostics getRealtimeDiagnostics() const;
+    
+    // Sample format of the device stream. Dither applies to integer formats only.
+    bool setDeviceFormat(SampleFormat format, bool dither = false);
+    SampleFormat getDeviceFormat() const;
+    bool isDeviceDitherEnabled() const;
+
+    // Offline rendering - runs the process callback as fast as the CPU allows.
+    // The engine must be stopped; returns false on error or cancellation.
+    bool renderOffline(const OfflineRenderOptions& options, OfflineRenderProgress* result = nullptr);
+    bool renderOfflineToFile(const std::string& path, size_t totalFrames,
+                             WavWriter::Format format = WavWriter::Format::Float32,
+                             std::function<bool(const OfflineRenderProgress&)> progress = nullptr,
+                             OfflineRenderProgress* result = nullptr);
+    bool isRenderingOffline() const;
+
+    // Worker threads used by the process callback for parallel track rendering
+    // (0 = render serially on the audio thread). Cannot be changed while running.
+    bool setRenderThreadCount(size_t numThreads);
+    size_t getRenderThreadCount() const;
+    RenderPool& getRenderPool();
+
+    // Scratch buffers the process callback borrows instead of allocating. The arena is
+    // sized in start() (and before offline renders) for the largest block the engine can
+    // deliver and SCRATCH_BUFFERS_PER_TRACK buffers per track, and is reset every block.
+    bool setMaxTrackCount(size_t maxTracks);
+    size_t getMaxTrackCount() const;
+    size_t getMaxBlockSize() const;
+    ScratchArena& getScratchArena();
+    static constexpr size_t SCRATCH_BUFFERS_PER_TRACK = 2;
 
 private:
     class Impl;
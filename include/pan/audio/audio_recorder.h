@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pan/audio/spsc_ring_buffer.h"
+#include "pan/audio/wav_writer.h"
+
+namespace pan {
+
+class AudioBuffer;
+
+/**
+ * Records audio-thread input to disk without ever blocking the audio thread.
+ *
+ * push() interleaves each block into a lock-free ring; a writer thread drains
+ * the ring in large sequential writes. If the disk stalls long enough for the
+ * ring to fill, push() drops the frames that don't fit and counts them instead
+ * of waiting.
+ */
+class AudioRecorder {
+public:
+    struct Options {
+        std::string path;
+        size_t numChannels = 2;
+        double sampleRate = 44100.0;
+        WavWriter::Format format = WavWriter::Format::PCM24;
+        WavWriter::Container container = WavWriter::Container::Wav;
+        double ringSeconds = 2.0;          // Audio the ring can hold while the disk is busy
+        size_t writeChunkFrames = 16384;   // Frames per disk write
+        double preallocateSeconds = 60.0;  // Disk space reserved up front (0 = none)
+    };
+
+    AudioRecorder();
+    ~AudioRecorder();
+
+    AudioRecorder(const AudioRecorder&) = delete;
+    AudioRecorder& operator=(const AudioRecorder&) = delete;
+
+    // Opens the file and starts the writer thread. Not real-time safe.
+    bool start(const Options& options);
+
+    // Waits for any push() in progress, writes what is left in the ring and closes the file.
+    bool stop();
+
+    bool isRecording() const { return recording_.load(std::memory_order_acquire); }
+
+    // Audio thread: queue the first numFrames of input. Never blocks or allocates.
+    void push(const AudioBuffer& input, size_t numFrames);
+
+    uint64_t getFramesRecorded() const { return framesRecorded_.load(std::memory_order_relaxed); }
+    uint64_t getDroppedFrames() const { return droppedFrames_.load(std::memory_order_relaxed); }
+    bool hasWriteError() const { return writeError_.load(std::memory_order_relaxed); }
+    const Options& getOptions() const { return options_; }
+
+    // Read the last finished take back into memory (after stop())
+    std::shared_ptr<AudioBuffer> readTake() const;
+
+    // Frames interleaved per ring write inside push()
+    static constexpr size_t PUSH_CHUNK_FRAMES = 1024;
+
+private:
+    void writerLoop();
+
+    Options options_;
+    WavWriter writer_;
+    SpscRingBuffer<float> ring_;
+    std::vector<float> pushScratch_;   // Audio thread only
+    std::vector<float> writeScratch_;  // Writer thread only
+    std::thread writerThread_;
+
+    std::atomic<bool> recording_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> activePushes_{0};
+    std::atomic<uint64_t> framesRecorded_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::atomic<bool> writeError_{false};
+    bool hasTake_ = false;
+};
+
+} // namespace pan
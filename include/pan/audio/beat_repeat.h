@@ -2,8 +2,8 @@
 
 #include "pan/audio/effect.h"
 #include "pan/audio/audio_buffer.h"
+#include "pan/dsp/random.h"
 #include <vector>
-#include <random>
 #include <algorithm>
 
 namespace pan {
@@ -14,8 +14,15 @@ public:
     ~BeatRepeat() override = default;
     
     void process(AudioBuffer& buffer, size_t numFrames) override;
+    // Repeats replay up to the whole capture buffer
+    double getTailSeconds() const override { return static_cast<double>(bufSize_) / sampleRate_; }
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(intervalMs_).add(gateMs_).add(chance_).add(decay_).add(filter_).add(mix_);
+    }
     std::string getName() const override { return "Beat Repeat"; }
     void reset() override;
+    void setSeed(uint32_t seed) override { pendingSeed_.post(seed); }
+    uint32_t getSeed() const override { return pendingSeed_.get(); }
     
     void setIntervalMs(float ms) { intervalMs_ = std::clamp(ms, 50.0f, 2000.0f); }
     void setGateMs(float ms) { gateMs_ = std::clamp(ms, 40.0f, 800.0f); }
@@ -42,8 +49,8 @@ private:
     size_t intervalSamples_ = 0;
     size_t intervalCounter_ = 0;
     bool repeating_ = false;
-    std::mt19937 rng_;
-    std::uniform_real_distribution<float> dist_{0.0f, 1.0f};
+    dsp::PendingSeed pendingSeed_;  // Next seed for rng_, taken in process()
+    dsp::Random rng_;  // Decides whether each interval repeats
     
     // Params
     float intervalMs_ = 500.0f;
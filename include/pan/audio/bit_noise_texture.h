@@ -2,7 +2,7 @@
 
 #include "pan/audio/effect.h"
 #include "pan/audio/audio_buffer.h"
-#include <random>
+#include "pan/dsp/random.h"
 #include <algorithm>
 
 namespace pan {
@@ -13,8 +13,17 @@ public:
     ~BitNoiseTexture() override = default;
     
     void process(AudioBuffer& buffer, size_t numFrames) override;
+    // The added noise never stops
+    double getTailSeconds() const override {
+        return noise_ > 0.0f && mix_ > 0.0f ? std::numeric_limits<double>::infinity() : 0.0;
+    }
     std::string getName() const override { return "Bit/Noise Texture"; }
     void reset() override { phase_ = 0; }
+    void setSeed(uint32_t seed) override { pendingSeed_.post(seed); }
+    uint32_t getSeed() const override { return pendingSeed_.get(); }
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(bits_).add(downsampleFactor_).add(noise_).add(tilt_).add(mix_);
+    }
     
     void setBits(int b) { bits_ = std::clamp(b, 4, 16); }
     void setDownsample(int f) { downsampleFactor_ = std::clamp(f, 1, 16); }
@@ -41,8 +50,11 @@ private:
     float heldR_ = 0.0f;
     float tiltStateL_ = 0.0f;
     float tiltStateR_ = 0.0f;
-    std::mt19937 rng_;
-    std::uniform_real_distribution<float> dist_{-1.0f, 1.0f};
+    dsp::PendingSeed pendingSeed_;  // Next seed for rng_, taken in process()
+    dsp::Random rng_;
+    static constexpr size_t NOISE_CHUNK = 64;  // Frames of noise generated at a time
+    float noiseL_[NOISE_CHUNK];
+    float noiseR_[NOISE_CHUNK];
 };
 
 } // namespace pan
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace pan {
+namespace kernels {
+
+/**
+ * Vectorised inner loops behind AudioBuffer and the mixer.
+ *
+ * Each function is dispatched once at start-up to the widest implementation the
+ * CPU supports (AVX2, SSE2, or plain C++). Pointers need no particular alignment,
+ * and source and destination may be the same buffer but must not partially overlap.
+ */
+
+void clear(float* dst, size_t n);
+void fill(float* dst, float value, size_t n);
+void copy(float* dst, const float* src, size_t n);
+
+// dst[i] += src[i] * gain
+void add(float* dst, const float* src, float gain, size_t n);
+
+// dst[i] += src[i] * (startGain + (endGain - startGain) * i / n)
+void addRamp(float* dst, const float* src, float startGain, float endGain, size_t n);
+
+// dst[i] *= gain
+void scale(float* dst, float gain, size_t n);
+
+// dst[i] *= startGain + (endGain - startGain) * i / n
+void scaleRamp(float* dst, float startGain, float endGain, size_t n);
+
+// max |src[i]|
+float peak(const float* src, size_t n);
+
+// sum of src[i]^2 (accumulated in double-width lanes for long blocks)
+double sumSquares(const float* src, size_t n);
+
+// Name of the active implementation ("avx2", "sse2" or "scalar")
+const char* getImplementationName();
+
+} // namespace kernels
+} // namespace pan
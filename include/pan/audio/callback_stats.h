@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pan {
+
+/**
+ * Point-in-time copy of CallbackStats. Load is callback wall time divided by
+ * the block's real-time budget (numFrames / sampleRate); 1.0 means the callback
+ * used its whole deadline.
+ */
+struct CallbackStatsSnapshot {
+    // Histogram bin k counts callbacks that took [2^k, 2^(k+1)) microseconds;
+    // the first bin also takes anything shorter, the last anything longer
+    static constexpr size_t HISTOGRAM_BINS = 20;
+
+    uint64_t callbacks = 0;
+    uint64_t deadlineMisses = 0;        // Callbacks that took longer than their budget
+    uint64_t framesProcessed = 0;
+
+    double lastDurationSeconds = 0.0;
+    double maxDurationSeconds = 0.0;
+    double averageDurationSeconds = 0.0;
+
+    double load = 0.0;                  // Smoothed over roughly the last 100 callbacks
+    double peakLoad = 0.0;
+    double averageLoad = 0.0;
+
+    // From the host's status flags
+    uint64_t inputUnderflows = 0;
+    uint64_t inputOverflows = 0;
+    uint64_t outputUnderflows = 0;
+    uint64_t outputOverflows = 0;
+    uint64_t primingOutput = 0;
+
+    double outputLatencySeconds = 0.0;  // DAC time minus callback time, when the host reports it
+
+    std::array<uint64_t, HISTOGRAM_BINS> durationHistogram{};
+
+    uint64_t getXrunCount() const { return inputUnderflows + inputOverflows + outputUnderflows + outputOverflows; }
+    static double getBinLowerMicros(size_t bin);
+    std::string toJson() const;
+};
+
+/**
+ * Lock-free callback instrumentation. record() is called by the audio thread
+ * once per device callback; snapshot() may be called from any thread. Fields
+ * are individually atomic, so a snapshot taken mid-callback can mix two
+ * adjacent callbacks but never tears a value.
+ */
+class CallbackStats {
+public:
+    // Status bits; the values match PortAudio's PaStreamCallbackFlags
+    enum StatusFlags : uint32_t {
+        InputUnderflow = 0x01,
+        InputOverflow = 0x02,
+        OutputUnderflow = 0x04,
+        OutputOverflow = 0x08,
+        PrimingOutput = 0x10
+    };
+
+    CallbackStats() = default;
+
+    CallbackStats(const CallbackStats&) = delete;
+    CallbackStats& operator=(const CallbackStats&) = delete;
+
+    void record(double durationSeconds, size_t numFrames, double sampleRate, uint32_t statusFlags,
+                double outputLatencySeconds = 0.0);
+
+    CallbackStatsSnapshot snapshot() const;
+
+    // Takes effect at the next record() so only the audio thread ever writes
+    void reset() { resetRequested_.store(true, std::memory_order_release); }
+
+private:
+    void clear();
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> resetRequested_{false};
+
+    std::atomic<uint64_t> callbacks_{0};
+    std::atomic<uint64_t> deadlineMisses_{0};
+    std::atomic<uint64_t> framesProcessed_{0};
+    std::atomic<uint64_t> totalNanos_{0};
+
+    std::atomic<double> lastDuration_{0.0};
+    std::atomic<double> maxDuration_{0.0};
+    std::atomic<double> load_{0.0};
+    std::atomic<double> peakLoad_{0.0};
+    std::atomic<double> loadSum_{0.0};
+    std::atomic<double> outputLatency_{0.0};
+
+    std::atomic<uint64_t> inputUnderflows_{0};
+    std::atomic<uint64_t> inputOverflows_{0};
+    std::atomic<uint64_t> outputUnderflows_{0};
+    std::atomic<uint64_t> outputOverflows_{0};
+    std::atomic<uint64_t> primingOutput_{0};
+
+    std::array<std::atomic<uint64_t>, CallbackStatsSnapshot::HISTOGRAM_BINS> histogram_{};
+};
+
+} // namespace pan
@@ -21,6 +21,10 @@ public:
     virtual ~Chorus() = default;
     
     void process(AudioBuffer& buffer, size_t numFrames) override;
+    double getTailSeconds() const override { return (baseDelay_ + depth_) / 1000.0; }
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(rate_).add(depth_).add(baseDelay_).add(mix_);
+    }
     std::string getName() const override { return "Chorus"; }
     void reset() override;
     
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pan {
+
+class AudioBuffer;
+
+/**
+ * Sample formats a device stream can use. Int24 is packed (3 bytes per sample).
+ */
+enum class SampleFormat {
+    Float32,
+    Int16,
+    Int24,
+    Int32
+};
+
+size_t getSampleFormatBytes(SampleFormat format);
+const char* getSampleFormatName(SampleFormat format);
+
+/**
+ * Conversion between the engine's planar float buffers and a device's
+ * interleaved buffer, for any channel count and sample format.
+ *
+ * Float stereo and mono paths (the common case) and float to int16 stereo are
+ * vectorised; other layouts use a loop with the channel pointers hoisted. When
+ * dither is enabled, integer output gets TPDF dither of +/-1 LSB before
+ * rounding. Nothing here allocates, so it is safe to call from the callback.
+ */
+class DeviceIoConverter {
+public:
+    DeviceIoConverter() = default;
+
+    void setFormat(SampleFormat format) { format_ = format; }
+    SampleFormat getFormat() const { return format_; }
+
+    // Dither only affects integer formats
+    void setDitherEnabled(bool enabled) { ditherEnabled_ = enabled; }
+    bool isDitherEnabled() const { return ditherEnabled_; }
+
+    // Device -> engine. Channels the device doesn't provide are cleared; extra device channels are dropped.
+    void deinterleave(const void* device, size_t deviceChannels, AudioBuffer& dest,
+                      size_t destOffset, size_t numFrames) const;
+
+    // Engine -> device. Device channels the buffer doesn't have are written as silence.
+    void interleave(const AudioBuffer& source, size_t sourceOffset, void* device,
+                    size_t deviceChannels, size_t numFrames);
+
+private:
+    float nextDither();
+
+    SampleFormat format_ = SampleFormat::Float32;
+    bool ditherEnabled_ = false;
+    uint32_t ditherState_ = 0x9E3779B9u;
+};
+
+} // namespace pan
@@ -40,6 +40,9 @@ public:
     void process(AudioBuffer& buffer, size_t numFrames) override;
     std::string getName() const override { return "Distortion"; }
     void reset() override;
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(drive_).add(tone_).add(mix_).add(type_);
+    }
     
     void loadPreset(Preset preset);
     Preset getCurrentPreset() const { return currentPreset_; }
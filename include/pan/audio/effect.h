@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <memory>
+#include "pan/audio/parameter_hash.h"
 
 namespace pan {
 
@@ -19,10 +23,35 @@ public:
     virtual std::string getName() const = 0;
     virtual void reset() = 0;  // Reset internal state
     
+    // How long output can go on after the input falls silent, in seconds.
+    // Tracks stop processing an idle instrument's effects once this has passed.
+    // Infinity for effects that make sound from silence.
+    virtual double getTailSeconds() const { return 0.0; }
+    
+    // Restart any random source from seed, so renders repeat exactly.
+    // Effects without randomness ignore it and report 0.
+    virtual void setSeed(uint32_t /*seed*/) {}
+    virtual uint32_t getSeed() const { return 0; }
+    
+    // Fold every setting that shapes the output (not running state) into hash,
+    // so a frozen track can tell its effects have been edited
+    virtual void hashParameters(ParameterHash& hash) const = 0;
+    
     bool isEnabled() const { return enabled_; }
     void setEnabled(bool enabled) { enabled_ = enabled; }
     
 protected:
+    // Time for a feedback loop of loopSeconds and gain feedback to ring down by 80 dB
+    static double feedbackTailSeconds(double loopSeconds, float feedback) {
+        if (feedback <= 0.0f) {
+            return loopSeconds;
+        }
+        if (feedback >= 1.0f) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return loopSeconds * std::ceil(std::log(1e-4) / std::log(static_cast<double>(feedback)));
+    }
+    
     bool enabled_ = true;
 };
 
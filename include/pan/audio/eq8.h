@@ -51,6 +51,8 @@ public:
     virtual ~EQ8() = default;
     
     void process(AudioBuffer& buffer, size_t numFrames) override;
+    double getTailSeconds() const override;
+    void hashParameters(ParameterHash& hash) const override;
     std::string getName() const override { return "EQ8"; }
     void reset() override;
     
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "pan/audio/audio_buffer.h"
+
+namespace pan {
+
+/**
+ * A track rendered ahead of time ("frozen"): instrument, clips and effects
+ * bounced to a buffer that starts at the top of the arrangement, tagged with
+ * the fingerprint (ParameterHash) of the settings it was rendered from.
+ * Playback reads it in place of running the instrument and effects; once the
+ * live settings hash differently the render is stale and should be dropped.
+ */
+class FrozenAudio {
+public:
+    FrozenAudio(AudioBuffer audio, uint64_t fingerprint);
+
+    uint64_t getFingerprint() const { return fingerprint_; }
+    size_t getNumFrames() const { return audio_.getNumFrames(); }
+    size_t getNumChannels() const { return audio_.getNumChannels(); }
+    const AudioBuffer& getAudio() const { return audio_; }
+
+    // Whether [position, position + numFrames) overlaps the render
+    bool covers(int64_t position, size_t numFrames) const;
+
+    // Copy frames [position, position + numFrames) of the render to the start of
+    // dest; frames outside the render come out silent. Real-time safe.
+    void read(AudioBuffer& dest, int64_t position, size_t numFrames) const;
+
+private:
+    AudioBuffer audio_;
+    uint64_t fingerprint_;
+};
+
+} // namespace pan
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pan {
+
+/**
+ * How Sampler reads between sample frames when a note plays the sample at
+ * another rate. Ordered from cheapest to best.
+ */
+enum class InterpolationQuality {
+    Linear,  // Two points; aliases and dulls when pitched far
+    Cubic,   // Four-point Hermite
+    Sinc     // Polyphase windowed sinc, band-limited to the playback rate
+};
+
+/**
+ * Windowed-sinc kernels for InterpolationQuality::Sinc.
+ *
+ * Level 0 is a Kaiser-windowed sinc with its cutoff just below the source
+ * Nyquist, for playback at or below the source rate. Reading faster than
+ * the source (pitching up) would fold everything above the new Nyquist back
+ * down, so each level above lowers the cutoff by a quarter octave and
+ * lengthens the kernel to match, up to two octaves of speed-up. Finer steps
+ * keep a note pitched up a semitone from losing a whole octave of top end.
+ * Every kernel is tabulated at NUM_PHASES + 1
+ * fractional offsets; lookups interpolate between neighbouring rows. The
+ * bank is built once and read-only afterwards, like WavetableBank.
+ */
+class SincKernelBank {
+public:
+    static constexpr size_t NUM_PHASES = 256;
+    static constexpr size_t LEVELS_PER_OCTAVE = 4;
+    static constexpr size_t NUM_LEVELS = 2 * LEVELS_PER_OCTAVE + 1;  // Band-limited up to two octaves of speed-up
+    static constexpr size_t BASE_TAPS = 32;  // Level 0
+    static constexpr size_t MAX_TAPS = 128;  // Top level
+
+    // Built on first use (thread-safe)
+    static const SincKernelBank& get();
+
+    // Kernel for a read increment in source frames per output frame: the
+    // first level whose cutoff stays below the playback Nyquist
+    static size_t selectLevel(double increment) {
+        if (!(increment > 1.0)) {
+            return 0;
+        }
+        double level = std::ceil(std::log2(increment) * LEVELS_PER_OCTAVE - 1e-9);
+        return level < static_cast<double>(NUM_LEVELS - 1) ? static_cast<size_t>(level) : NUM_LEVELS - 1;
+    }
+    // Level speed-up: 2^(level / LEVELS_PER_OCTAVE)
+    static double getSpeedUp(size_t level) {
+        return std::exp2(static_cast<double>(level) / LEVELS_PER_OCTAVE);
+    }
+    // BASE_TAPS times the speed-up, rounded up to a multiple of 4 for the SIMD loop
+    static size_t getTaps(size_t level) {
+        static constexpr size_t TAPS[NUM_LEVELS] = {32, 40, 48, 56, 64, 80, 92, 108, 128};
+        return TAPS[level];
+    }
+
+    // getTaps(level) coefficients for fraction phase / NUM_PHASES, applied to
+    // source frames [index - (taps / 2 - 1), index + taps / 2]. The next row
+    // follows directly, up to phase NUM_PHASES.
+    const float* getKernel(size_t level, size_t phase) const {
+        return levels_[level].data() + phase * getTaps(level);
+    }
+
+private:
+    SincKernelBank();
+
+    std::vector<std::vector<float>> levels_;  // (NUM_PHASES + 1) x taps each
+};
+
+// Largest getInterpolationReach() of any quality and increment
+constexpr size_t MAX_INTERPOLATION_REACH = SincKernelBank::MAX_TAPS / 2;
+
+// Frames read either side of a position: [index - (reach - 1), index + reach]
+size_t getInterpolationReach(InterpolationQuality quality, double increment);
+
+// Resample count frames: out[k] is src read at positions[k] + fractions[k],
+// with fractions in [0, 1). src must hold getInterpolationReach() frames
+// either side of every position. srcR and outR may be null for mono.
+// Real-time safe once SincKernelBank::get() has been called.
+void interpolate(InterpolationQuality quality, double increment,
+                 const float* srcL, const float* srcR, const uint32_t* positions, const float* fractions,
+                 float* outL, float* outR, size_t count);
+
+/**
+ * Sample-rate converter for whole files, used by ResampleCache. Offline, so
+ * it affords a longer, steeper kernel than the playback levels: its cutoff
+ * sits just below the lower of the two Nyquists, passing everything up to
+ * about 0.445 of that rate. Read positions and the window around them work
+ * as for interpolate(), in source frames.
+ */
+class SincResampler {
+public:
+    static constexpr size_t TAPS = 128;
+    static constexpr size_t NUM_PHASES = 1024;
+    static constexpr size_t REACH = TAPS / 2;  // As getInterpolationReach()
+
+    SincResampler(double sourceRate, double targetRate);
+
+    // Source frames per target frame
+    double getIncrement() const { return increment_; }
+
+    void process(const float* srcL, const float* srcR, const uint32_t* positions, const float* fractions,
+                 float* outL, float* outR, size_t count) const;
+
+private:
+    double increment_;
+    std::vector<float> kernel_;  // (NUM_PHASES + 1) x TAPS
+};
+
+} // namespace pan
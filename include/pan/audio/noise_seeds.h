@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "pan/dsp/random.h"
+
+namespace pan {
+
+/**
+ * Noise seeds for a project's instruments and effects. Each slot on a track
+ * (the instrument, a drum pad, an effect) gets a stream of its own derived
+ * from the project seed, so two tracks with the same noise patch never play
+ * the same noise and a render repeats exactly. Pads are a fixed set, so a
+ * pad's noise never changes. An effect's slot is its position in the chain:
+ * appending one leaves the rest alone, but inserting, removing or reordering
+ * reseeds every effect after the change.
+ */
+struct NoiseSeeds {
+    static constexpr uint32_t INSTRUMENT_SLOT = 0;
+    static uint32_t padSlot(size_t pad) { return 1 + static_cast<uint32_t>(pad); }
+    static uint32_t effectSlot(size_t effect) { return 0x10000 + static_cast<uint32_t>(effect); }
+
+    static uint32_t forSlot(uint32_t projectSeed, uint32_t track, uint32_t slot) {
+        return dsp::Random::derive(dsp::Random::derive(projectSeed, track), slot);
+    }
+
+    // Seed target (anything with setSeed/getSeed). Unless restart is set, a
+    // target already on seed keeps its running stream, so reseeding a live
+    // project only touches what is new or has moved. True if it was reseeded.
+    template <typename T>
+    static bool assign(T& target, uint32_t seed, bool restart) {
+        if (!restart && target.getSeed() == seed) {
+            return false;
+        }
+        target.setSeed(seed);
+        return true;
+    }
+};
+
+} // namespace pan
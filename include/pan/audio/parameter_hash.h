@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace pan {
+
+/**
+ * 64-bit FNV-1a fingerprint of a set of settings. Fold in every value that
+ * affects the rendered sound; two states with the same values in the same
+ * order hash equal. Used to tell whether a frozen render is still current.
+ */
+class ParameterHash {
+public:
+    ParameterHash& add(float value) {
+        value = value == 0.0f ? 0.0f : value;  // -0 and +0 sound the same
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return addBytes(&bits, sizeof(bits));
+    }
+
+    ParameterHash& add(double value) {
+        value = value == 0.0 ? 0.0 : value;
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return addBytes(&bits, sizeof(bits));
+    }
+
+    ParameterHash& add(const std::string& value) {
+        add(value.size());
+        return addBytes(value.data(), value.size());
+    }
+
+    // Integers, bools and enums
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, ParameterHash&>::type
+    add(T value) {
+        uint64_t widened = static_cast<uint64_t>(value);
+        return addBytes(&widened, sizeof(widened));
+    }
+
+    uint64_t get() const { return hash_; }
+
+private:
+    ParameterHash& addBytes(const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash_ = (hash_ ^ bytes[i]) * 0x100000001B3ull;
+        }
+        return *this;
+    }
+
+    uint64_t hash_ = 0xCBF29CE484222325ull;
+};
+
+} // namespace pan
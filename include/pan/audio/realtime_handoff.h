@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pan {
+
+/**
+ * Hands an object from non-real-time threads to the audio thread without the
+ * audio thread ever taking a lock.
+ *
+ * The writer publishes a new object by swapping an atomic pointer; the previous
+ * object is retired rather than deleted and freed later by collectGarbage(),
+ * called from a non-real-time thread once no reader can still hold it. Readers
+ * only touch two atomics, so read() is wait-free. Works for anything from a
+ * single callback up to a complete render graph built during project load.
+ *
+ * Readers must not hold a ReadScope across blocks - reclamation waits for a
+ * moment with no active readers.
+ */
+template <typename T>
+class RealtimeHandoff {
+public:
+    class ReadScope {
+    public:
+        ReadScope(ReadScope&& other) noexcept : owner_(other.owner_), value_(other.value_) {
+            other.owner_ = nullptr;
+            other.value_ = nullptr;
+        }
+        ~ReadScope() {
+            if (owner_) {
+                owner_->activeReaders_.fetch_sub(1, std::memory_order_seq_cst);
+            }
+        }
+
+        ReadScope(const ReadScope&) = delete;
+        ReadScope& operator=(const ReadScope&) = delete;
+        ReadScope& operator=(ReadScope&&) = delete;
+
+        T* get() const { return value_; }
+        T* operator->() const { return value_; }
+        T& operator*() const { return *value_; }
+        explicit operator bool() const { return value_ != nullptr; }
+
+    private:
+        friend class RealtimeHandoff;
+        explicit ReadScope(RealtimeHandoff* owner) : owner_(owner) {
+            owner_->activeReaders_.fetch_add(1, std::memory_order_seq_cst);
+            value_ = owner_->current_.load(std::memory_order_seq_cst);
+        }
+
+        RealtimeHandoff* owner_;
+        T* value_ = nullptr;
+    };
+
+    RealtimeHandoff() = default;
+    ~RealtimeHandoff() {
+        delete current_.load();
+        for (T* retired : retired_) {
+            delete retired;
+        }
+    }
+
+    RealtimeHandoff(const RealtimeHandoff&) = delete;
+    RealtimeHandoff& operator=(const RealtimeHandoff&) = delete;
+
+    // Real-time safe. The object stays valid for the lifetime of the scope.
+    ReadScope read() { return ReadScope(this); }
+
+    // Writer side (never from the audio thread). Passing nullptr clears the slot.
+    void publish(std::unique_ptr<T> value) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        T* previous = current_.exchange(value.release(), std::memory_order_seq_cst);
+        if (previous) {
+            retired_.push_back(previous);
+        }
+    }
+
+    // Free retired objects if no reader is active. Returns the number freed.
+    size_t collectGarbage() {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        if (retired_.empty() || activeReaders_.load(std::memory_order_seq_cst) != 0) {
+            return 0;
+        }
+        // Any reader arriving from here on sees the current object, not a retired one
+        size_t freed = retired_.size();
+        for (T* retired : retired_) {
+            delete retired;
+        }
+        retired_.clear();
+        return freed;
+    }
+
+    size_t getRetiredCount() const {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        return retired_.size();
+    }
+
+private:
+    std::atomic<T*> current_{nullptr};
+    std::atomic<int> activeReaders_{0};
+
+    mutable std::mutex writerMutex_;
+    std::vector<T*> retired_;
+};
+
+} // namespace pan
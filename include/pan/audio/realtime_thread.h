@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace pan {
+
+class AudioBuffer;
+
+/**
+ * How audio threads should be set up: SCHED_FIFO priority, CPU pinning, and
+ * flush-to-zero/denormals-are-zero so decaying feedback paths (synth release
+ * tails, reverb combs) don't fall into slow denormal arithmetic.
+ */
+struct RealtimeThreadPolicy {
+    bool elevatePriority = true;
+    int priority = 70;              // SCHED_FIFO priority (1-99); render workers use one less
+    bool lockMemory = true;         // mlock the engine's pre-allocated buffers
+    bool flushDenormals = true;
+    int cpu = -1;                   // Pin the audio thread here and workers to the following CPUs (-1 = don't pin)
+};
+
+/**
+ * What applying a policy to one thread actually achieved
+ */
+struct RealtimeThreadReport {
+    bool applied = false;
+    bool realtimePriority = false;  // Running under SCHED_FIFO/SCHED_RR
+    int priority = 0;
+    int priorityError = 0;          // errno from the SCHED_FIFO request (EPERM without rtprio)
+    bool niceFallback = false;      // Raised the nice level instead
+    bool denormalsFlushed = false;
+    bool affinitySet = false;
+    int affinityError = 0;
+};
+
+/**
+ * Engine-wide view: the audio thread, the render workers and locked memory
+ */
+struct RealtimeDiagnostics {
+    RealtimeThreadReport audioThread;   // Filled in on the first device callback
+    size_t renderWorkers = 0;
+    size_t realtimeRenderWorkers = 0;
+    bool memoryLocked = false;
+    size_t lockedBytes = 0;
+    int memoryLockError = 0;            // errno from mlock (ENOMEM/EPERM past RLIMIT_MEMLOCK)
+
+    std::string describe() const;
+};
+
+namespace realtime {
+
+// Apply policy to the calling thread. cpuOffset is added to policy.cpu so a
+// group of threads can be pinned to consecutive cores. Does not allocate.
+RealtimeThreadReport applyToCurrentThread(const RealtimeThreadPolicy& policy, int cpuOffset = 0);
+
+// Flush-to-zero + denormals-are-zero for the calling thread (SSE MXCSR / ARM FPCR)
+bool enableDenormalFlushing();
+bool isDenormalFlushingEnabled();
+
+// Page-lock a buffer's storage. Returns false and sets *error to errno on failure.
+bool lockBuffer(const AudioBuffer& buffer, int* error = nullptr);
+// Undo lockBuffer() before the buffer is freed or reallocated
+void unlockBuffer(const AudioBuffer& buffer);
+size_t getBufferBytes(const AudioBuffer& buffer);
+
+/**
+ * Enables denormal flushing for a scope and restores the previous mode, for
+ * code that borrows a non-audio thread (e.g. offline renders).
+ */
+class ScopedDenormalFlush {
+public:
+    explicit ScopedDenormalFlush(bool enable = true);
+    ~ScopedDenormalFlush();
+
+    ScopedDenormalFlush(const ScopedDenormalFlush&) = delete;
+    ScopedDenormalFlush& operator=(const ScopedDenormalFlush&) = delete;
+
+private:
+    unsigned long long saved_ = 0;
+    bool active_ = false;
+};
+
+} // namespace realtime
+} // namespace pan
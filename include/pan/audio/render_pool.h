@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pan/audio/realtime_thread.h"
+
+namespace pan {
+
+/**
+ * Pool of pre-spawned worker threads for rendering independent tasks (tracks)
+ * inside the audio callback.
+ *
+ * Tasks are split into one range per participant; the calling thread works on
+ * its own range and then steals from the back of the others, so a worker that
+ * wakes late simply finds its work already done. run() returns only after every
+ * task has finished. If parallel blocks keep overrunning their deadline the
+ * pool drops to serial execution for a while before trying again.
+ *
+ * Between blocks the workers spin on the generation counter for about one
+ * block interval before parking, so during playback run() normally finds them
+ * awake. Parked workers are woken with a futex wake on the generation word
+ * (Linux), which the audio thread issues without taking a lock.
+ */
+class RenderPool {
+public:
+    using TaskFunction = void (*)(void* context, size_t taskIndex);
+
+    struct Stats {
+        uint64_t parallelBlocks = 0;
+        uint64_t serialBlocks = 0;
+        uint64_t deadlineMisses = 0;
+        uint64_t stolenTasks = 0;
+    };
+
+    RenderPool();
+    ~RenderPool();
+
+    RenderPool(const RenderPool&) = delete;
+    RenderPool& operator=(const RenderPool&) = delete;
+
+    // Number of worker threads in addition to the calling thread (0 = serial).
+    // Must not be called while run() is executing on another thread.
+    void setNumThreads(size_t numThreads);
+    size_t getNumThreads() const { return workers_.size(); }
+
+    // Execute fn(context, i) for i in [0, taskCount). Returns true if the block ran in parallel.
+    bool run(size_t taskCount, TaskFunction fn, void* context, double deadlineSeconds);
+
+    template <typename Fn>
+    bool run(size_t taskCount, Fn& fn, double deadlineSeconds) {
+        return run(taskCount, [](void* ctx, size_t i) { (*static_cast<Fn*>(ctx))(i); }, &fn, deadlineSeconds);
+    }
+
+    // Thread policy for the workers; each applies it before its next job (workers
+    // created later pick it up too). Workers run one priority step below the policy.
+    void setRealtimePolicy(const RealtimeThreadPolicy& policy);
+    size_t getRealtimeWorkerCount() const { return realtimeWorkers_.load(std::memory_order_relaxed); }
+
+    bool isSerialFallbackActive() const { return serialFallbackBlocks_.load(std::memory_order_relaxed) > 0; }
+    Stats getStats() const;
+
+    // Consecutive overruns before falling back, and how many blocks to stay serial
+    static constexpr int MAX_CONSECUTIVE_MISSES = 3;
+    static constexpr int SERIAL_FALLBACK_BLOCKS = 512;
+    static constexpr size_t MAX_TASKS = 0xFFFF;
+    // Upper bound on how long an idle worker spins before parking
+    static constexpr double MAX_SPIN_SECONDS = 0.01;
+
+private:
+    // Packed range: [generation:32 | front:16 | back:16]
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> range{0};
+    };
+
+    void workerLoop(size_t slotIndex);
+    void waitForJob(uint32_t seen);
+    void wakeSleepers();
+    void runSerial(size_t taskCount, TaskFunction fn, void* context);
+    bool executeFrom(size_t slotIndex, uint32_t generation, TaskFunction fn, void* context);
+    bool claimFront(size_t slotIndex, uint32_t generation, size_t& taskIndex);
+    bool claimBack(size_t slotIndex, uint32_t generation, size_t& taskIndex);
+
+    std::vector<std::thread> workers_;
+    std::unique_ptr<Slot[]> slots_;
+    size_t numSlots_ = 0;
+
+    // Current job, published before generation_ is bumped
+    std::atomic<TaskFunction> jobFunction_{nullptr};
+    std::atomic<void*> jobContext_{nullptr};
+    std::atomic<uint32_t> generation_{0};
+    std::atomic<size_t> remaining_{0};
+
+    // Parked workers. Spinning workers aren't counted, so the audio thread
+    // only issues a wake when someone is actually asleep.
+    std::atomic<int> sleepers_{0};
+    std::atomic<bool> stopping_{false};
+    // Time between the last two run() calls, bounds the workers' spin
+    std::atomic<int64_t> blockIntervalNanos_{0};
+    std::chrono::steady_clock::time_point lastRunTime_{};
+#if !defined(__linux__)
+    // Fallback parking: the audio thread notifies without the lock and workers
+    // wait with a timeout, so a missed notify costs at most that timeout
+    std::mutex parkMutex_;
+    std::condition_variable parkCondition_;
+#endif
+
+    // Guarded by policyMutex_; workers compare policyEpoch_ with the epoch they last applied
+    std::mutex policyMutex_;
+    RealtimeThreadPolicy policy_;
+    std::atomic<uint32_t> policyEpoch_{0};
+    std::atomic<size_t> realtimeWorkers_{0};
+
+    // Deadline tracking
+    int consecutiveMisses_ = 0;
+    std::atomic<int> serialFallbackBlocks_{0};
+
+    std::atomic<uint64_t> parallelBlocks_{0};
+    std::atomic<uint64_t> serialBlocks_{0};
+    std::atomic<uint64_t> deadlineMisses_{0};
+    std::atomic<uint64_t> stolenTasks_{0};
+};
+
+} // namespace pan
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "pan/audio/sampler.h"
+
+namespace pan {
+
+/**
+ * Samples converted to the engine's sample rate, kept on disk.
+ *
+ * SamplePool converts a file whose rate differs from the one it is loading
+ * for: the first time, the whole sample is run through a SincResampler and
+ * written as a 32-bit float WAV under getDirectory(). The file is named by a
+ * hash of the source's path, size and modification time plus the target
+ * rate, so later loads, in this session or the next, read the conversion
+ * directly and an edited source is never matched with a stale one. The
+ * directory is kept under getMaxBytes() by deleting the oldest conversions.
+ * Thread-safe.
+ */
+class ResampleCache {
+public:
+    static ResampleCache& get();
+
+    // Conversion progress, 0 to 1, called on the converting thread
+    using ProgressCallback = std::function<void(float fraction)>;
+
+    // Defaults to $XDG_CACHE_HOME/pan/resampled, else ~/.cache/pan/resampled,
+    // else pan-resampled in the system temp directory. Created on first write.
+    void setDirectory(const std::string& directory);
+    std::string getDirectory() const;
+
+    // Size cap for the directory, checked by prune()
+    static constexpr uintmax_t DEFAULT_MAX_BYTES = uintmax_t(2) << 30;
+    void setMaxBytes(uintmax_t maxBytes);
+    uintmax_t getMaxBytes() const;
+
+    // Delete the oldest conversions until the directory fits in getMaxBytes(),
+    // sparing keep (the one just written). Samples streaming from a deleted
+    // file keep reading it through their open descriptor.
+    void prune(const std::string& keep);
+
+    // Where the conversion of this version of a file goes, whether or not it exists yet
+    std::string getCachePath(const std::string& sourcePath, uintmax_t fileSize, int64_t modified,
+                             double targetRate) const;
+
+    // Resample source (resident or streamed) to targetRate and write it to
+    // cachePath. The file appears whole or not at all, so concurrent
+    // conversions of the same source are harmless. False on error.
+    static bool convert(const Sample& source, double targetRate, const std::string& cachePath,
+                        const ProgressCallback& onProgress = nullptr);
+
+private:
+    ResampleCache();
+
+    mutable std::mutex mutex_;
+    std::string directory_;
+    uintmax_t maxBytes_ = DEFAULT_MAX_BYTES;
+};
+
+} // namespace pan
@@ -14,6 +14,10 @@ public:
     ~ResonatorBank() override = default;
     
     void process(AudioBuffer& buffer, size_t numFrames) override;
+    double getTailSeconds() const override;
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(rootHz_).add(spreadSemi_).add(decay_).add(mix_);
+    }
     std::string getName() const override { return "Resonator Bank"; }
     void reset() override;
     
@@ -14,6 +14,10 @@ public:
     virtual ~Reverb() = default;
     
     void process(AudioBuffer& buffer, size_t numFrames) override;
+    double getTailSeconds() const override;
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(roomSize_).add(damping_).add(wetLevel_).add(dryLevel_).add(width_);
+    }
     std::string getName() const override { return "Reverb"; }
     void reset() override;
     
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace pan {
+
+/**
+ * Marks the current thread as running real-time audio code for the guard's
+ * lifetime. The engine holds one around the process callback and the render
+ * pool holds one while a worker executes tasks.
+ *
+ * In builds configured with PAN_RT_ALLOC_CHECK, global operator new is
+ * replaced and any heap allocation made while a guard is active aborts the
+ * process with a message, so stray allocations show up immediately in testing
+ * instead of as occasional xruns. Without the option the guard only keeps a
+ * thread-local depth counter.
+ */
+class RealtimeAllocationGuard {
+public:
+    RealtimeAllocationGuard();
+    ~RealtimeAllocationGuard();
+
+    RealtimeAllocationGuard(const RealtimeAllocationGuard&) = delete;
+    RealtimeAllocationGuard& operator=(const RealtimeAllocationGuard&) = delete;
+
+    // True if the calling thread is inside a guard
+    static bool isActive();
+
+    // True if the allocation check was compiled in
+    static bool isCheckEnabled();
+};
+
+} // namespace pan
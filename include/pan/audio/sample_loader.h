@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pan {
+
+class Sampler;
+struct Sample;
+
+/**
+ * Loads samples on background threads so the GUI never waits for a decode.
+ *
+ * load() queues a job; a worker decodes it through SamplePool, at the
+ * sampler's engine rate as Sampler::loadSample() does. poll(), called
+ * regularly from the thread that owns the samplers (the GUI's), reports
+ * progress, swaps finished samples into their samplers with
+ * Sampler::setSample() and runs the completion callbacks. It also frees the
+ * samples the audio thread has let go of. Callbacks run inside poll(), never
+ * on a worker. A newer load for the same sampler supersedes an older one that
+ * hasn't been installed yet.
+ */
+class SampleLoader {
+public:
+    using ProgressCallback = std::function<void(float fraction)>;
+    using DoneCallback = std::function<void(bool loaded)>;  // false: failed or superseded
+
+    static constexpr size_t DEFAULT_THREADS = 2;
+
+    explicit SampleLoader(size_t numThreads = DEFAULT_THREADS);
+    // Drops queued jobs and waits for the running ones; their callbacks never run
+    ~SampleLoader();
+
+    SampleLoader(const SampleLoader&) = delete;
+    SampleLoader& operator=(const SampleLoader&) = delete;
+
+    // The sampler is held weakly: if it's gone by the time the decode
+    // finishes, the result is dropped
+    void load(const std::shared_ptr<Sampler>& sampler, const std::string& path,
+              DoneCallback onDone = nullptr, ProgressCallback onProgress = nullptr);
+
+    void poll();
+
+    // Nothing queued, decoding or waiting for poll()
+    bool isIdle() const;
+    // Block until every job queued so far has decoded, then poll()
+    void waitUntilIdle();
+
+private:
+    struct Job {
+        std::weak_ptr<Sampler> sampler;
+        const Sampler* key = nullptr;  // Identity only, for superseding
+        std::string path;
+        size_t streamingThreshold = 0;
+        double preloadSeconds = 0.0;
+        double targetRate = 0.0;
+        uint64_t id = 0;
+        DoneCallback onDone;
+        ProgressCallback onProgress;
+
+        std::atomic<float> progress{0.0f};
+        float reportedProgress = 0.0f;  // poll() only
+        bool finished = false;          // Guarded by mutex_
+        std::shared_ptr<const Sample> result;
+    };
+
+    void run();
+    bool isLatest(const Job& job) const;  // Caller holds mutex_
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;  // Workers: a job was queued, or stopping
+    std::condition_variable idle_;  // waitUntilIdle: a job finished
+    std::deque<std::shared_ptr<Job>> queue_;
+    std::vector<std::shared_ptr<Job>> jobs_;      // Queued, decoding or finished, until poll()
+    std::map<const Sampler*, uint64_t> latest_;   // Newest job id per sampler
+    std::vector<std::weak_ptr<Sampler>> garbage_; // Samplers with retired samples to free
+    std::vector<std::thread> threads_;
+    uint64_t nextId_ = 1;
+    bool stopping_ = false;
+};
+
+} // namespace pan
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include "pan/audio/sampler.h"
+
+namespace pan {
+
+/**
+ * Process-wide cache of decoded samples.
+ *
+ * Entries are keyed by path plus the file's size and modification time, so
+ * an edited file is decoded again while holders of the old version keep it.
+ * Samples are immutable once pooled and shared as shared_ptr<const Sample>
+ * by every sampler, drum pad and browser preview that uses the file. An
+ * entry nobody else holds stays cached until the pool is over its memory
+ * budget; then unused entries go, least recently used first. Files loaded
+ * for another sample rate than their own are converted through
+ * ResampleCache. Thread-safe.
+ */
+class SamplePool {
+public:
+    static SamplePool& get();
+
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(512) << 20;  // bytes
+
+    // Decode progress, 0 to 1, called on the loading thread
+    using ProgressCallback = std::function<void(float fraction)>;
+
+    // The decoded sample, from the cache when the file hasn't changed.
+    // streamingThreshold and preloadSeconds are as for Sampler; with a
+    // targetRate the sample comes back converted to that rate (0 keeps the
+    // file's own). All three are part of the key. nullptr if the file can't
+    // be read or decoded.
+    std::shared_ptr<const Sample> load(const std::string& path,
+                                       size_t streamingThreshold = Sampler::DEFAULT_STREAMING_THRESHOLD,
+                                       double preloadSeconds = Sampler::DEFAULT_STREAMING_PRELOAD_SECONDS,
+                                       double targetRate = 0.0,
+                                       const ProgressCallback& onProgress = nullptr);
+
+    // Evicts at once if usage is over the new budget
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+
+    // Resident bytes of every cached sample, in use or not
+    size_t getMemoryUsage() const;
+    size_t getNumEntries() const;
+
+    // Drop every entry nothing else holds
+    void purgeUnused();
+
+    // Resident bytes of one sample (streamed samples count their preload only)
+    static size_t getMemorySize(const Sample& sample);
+
+private:
+    SamplePool() = default;
+
+    struct Key {
+        std::string path;
+        size_t streamingThreshold;
+        double preloadSeconds;
+        double targetRate;
+        bool operator<(const Key& other) const {
+            return std::tie(path, streamingThreshold, preloadSeconds, targetRate) <
+                   std::tie(other.path, other.streamingThreshold, other.preloadSeconds, other.targetRate);
+        }
+    };
+    struct Entry {
+        Key key;
+        uintmax_t fileSize = 0;
+        int64_t modified = 0;  // File time, in its clock's ticks
+        std::shared_ptr<const Sample> sample;
+        size_t bytes = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    // Caller holds mutex_
+    void evict(size_t budget);
+    void erase(EntryList::iterator it);
+
+    mutable std::mutex mutex_;
+    EntryList entries_;  // Most recently used first
+    std::map<Key, EntryList::iterator> index_;
+    size_t budget_ = DEFAULT_MEMORY_BUDGET;
+    size_t usage_ = 0;
+};
+
+} // namespace pan
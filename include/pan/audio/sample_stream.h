@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pan {
+
+/**
+ * A WAV file's sample data, read on demand with pread() instead of loaded
+ * whole. Safe to read from several threads at once.
+ */
+class SampleFile {
+public:
+    // Parses the header; nullptr if the file can't be opened or isn't PCM/float WAV
+    static std::shared_ptr<SampleFile> open(const std::string& path);
+    ~SampleFile();
+
+    SampleFile(const SampleFile&) = delete;
+    SampleFile& operator=(const SampleFile&) = delete;
+
+    size_t getNumFrames() const { return numFrames_; }
+    int getNumChannels() const { return channels_; }
+    int getBitsPerSample() const { return bitsPerSample_; }
+    double getSampleRate() const { return sampleRate_; }
+
+    // Decode frames [first, first + count) into left and right (right may be
+    // null; mono files write only left). scratch holds the raw bytes. Returns
+    // the frames actually read; short at the end of the file or on an I/O error.
+    size_t read(size_t first, size_t count, float* left, float* right, std::vector<uint8_t>& scratch) const;
+
+    // Ask the OS to start fetching these frames in the background
+    void willNeed(size_t first, size_t count) const;
+
+private:
+    SampleFile() = default;
+
+    int fd_ = -1;
+    uint64_t dataOffset_ = 0;
+    size_t numFrames_ = 0;
+    int channels_ = 0;
+    int bitsPerSample_ = 0;
+    bool isFloat_ = false;
+    double sampleRate_ = 44100.0;
+};
+
+/**
+ * Disk-to-voice stream for one sampler voice.
+ *
+ * The audio thread starts a stream at a region of a SampleFile and reads
+ * frames by their index in the stream: frames start..end, then, when looping,
+ * loopStart..end over and over. The SampleStreamer thread reads ahead of the
+ * play head into a ring of RING_FRAMES. Neither side locks; a frame that
+ * hasn't arrived yet is reported missing so the voice can play silence.
+ */
+class VoiceStream {
+public:
+    static constexpr size_t RING_FRAMES = 32768;  // Power of two
+
+    // Registers with SampleStreamer; file stays open until the stream is destroyed
+    VoiceStream(std::shared_ptr<SampleFile> file, bool stereo);
+    ~VoiceStream();
+
+    VoiceStream(const VoiceStream&) = delete;
+    VoiceStream& operator=(const VoiceStream&) = delete;
+
+    // Audio thread. skip frames at the front of the stream are never read
+    // (they are resident elsewhere) and the disk starts after them.
+    void start(size_t startFrame, size_t endFrame, size_t loopStartFrame, bool looping, size_t skip);
+    void stop();
+
+    // Audio thread: frames of the current stream from the last consume() up
+    // to this have arrived
+    uint64_t available() const;
+
+    // Audio thread: frame index of the current stream, already checked against available()
+    float left(uint64_t index) const { return left_[index & (RING_FRAMES - 1)]; }
+    float right(uint64_t index) const { return stereo_ ? right_[index & (RING_FRAMES - 1)] : left(index); }
+
+    // Audio thread: everything before index has been played and may be overwritten
+    void consume(uint64_t index);
+
+    // Streamer thread: read the next chunk if there's room. Returns false when
+    // there was nothing to do.
+    bool fill(std::vector<uint8_t>& scratch);
+
+private:
+    static constexpr size_t FILL_CHUNK = 4096;
+    static constexpr int GENERATION_SHIFT = 48;
+    static constexpr uint64_t COUNT_MASK = (uint64_t(1) << GENERATION_SHIFT) - 1;
+    static constexpr uint64_t GENERATION_MASK = 0xFFFF;
+
+    static uint64_t pack(uint64_t generation, uint64_t count) {
+        return ((generation & GENERATION_MASK) << GENERATION_SHIFT) | (count & COUNT_MASK);
+    }
+
+    std::shared_ptr<SampleFile> file_;
+    bool stereo_;
+    std::unique_ptr<float[]> left_;
+    std::unique_ptr<float[]> right_;
+
+    // The request, written by start()/stop() under a sequence counter: odd
+    // while being written, and sequence / 2 is the stream's generation
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> startFrame_{0};
+    std::atomic<uint64_t> endFrame_{0};
+    std::atomic<uint64_t> loopStartFrame_{0};
+    std::atomic<uint64_t> skip_{0};
+    std::atomic<bool> looping_{false};
+    std::atomic<bool> active_{false};
+
+    // Both tagged with the generation they belong to (see pack())
+    alignas(64) std::atomic<uint64_t> available_{0};  // Written by the streamer
+    alignas(64) std::atomic<uint64_t> consumed_{0};   // Written by the audio thread
+
+    // Streamer thread only
+    uint64_t fillGeneration_ = ~uint64_t(0);
+    uint64_t produced_ = 0;
+};
+
+/**
+ * The background thread that keeps every VoiceStream topped up. Started by
+ * the first stream and shared by all samplers.
+ */
+class SampleStreamer {
+public:
+    static SampleStreamer& get();
+    ~SampleStreamer();
+
+    void add(VoiceStream* stream);
+    // Blocks until the thread is done with stream, but not for reads of other streams
+    void remove(VoiceStream* stream);
+
+    // Sleep between passes that found nothing to read
+    static constexpr int IDLE_SLEEP_MICROSECONDS = 1000;
+
+private:
+    SampleStreamer() = default;
+    void run();
+
+    // Each pass fills a snapshot of streams_ with mutex_ released, so disk
+    // reads never hold up add() or remove()
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable filled_;  // A fill finished; remove() waits on it
+    std::vector<VoiceStream*> streams_;
+    VoiceStream* filling_ = nullptr;  // The stream being read right now, if any
+    uint64_t removals_ = 0;           // Tells a pass its snapshot may hold removed streams
+    std::thread thread_;
+    bool stopping_ = false;
+};
+
+} // namespace pan
@@ -4,19 +4,29 @@
 #include <string>
 #include <memory>
 #include <cstdint>
-#include <mutex>
 #include <array>
+#include <atomic>
+#include <algorithm>
+#include "pan/audio/interpolation.h"
+#include "pan/audio/parameter_hash.h"
+#include "pan/audio/realtime_handoff.h"
+#include "pan/audio/sample_stream.h"
+#include "pan/dsp/random.h"
+#include "pan/midi/midi_event_queue.h"
+#include "pan/midi/voice_allocator.h"
 
 namespace pan {
 
 /**
- * Sample - holds audio data loaded from a WAV file
+ * Sample - holds audio data loaded from a WAV file. A streamed sample keeps
+ * only its first frames in dataL/dataR; the rest is read from stream.
+ * Samples come from SamplePool and are shared read-only between samplers.
  */
 struct Sample {
     std::vector<float> dataL;        // Left channel (or mono)
     std::vector<float> dataR;        // Right channel (empty if mono)
+    std::shared_ptr<SampleFile> stream;  // Set when the sample streams from disk
     double sampleRate = 44100.0;
-    int rootNote = 60;               // MIDI note at which sample plays at original pitch (C4)
     std::string name;
     std::string filePath;
     bool stereo = false;
@@ -24,6 +34,9 @@ struct Sample {
     // For waveform display (downsampled)
     std::vector<float> waveformDisplay;  // Normalized -1 to 1, ~512 points
     
+    // Length of the whole sample, resident or not
+    size_t getNumFrames() const { return stream ? stream->getNumFrames() : dataL.size(); }
+    
     void generateWaveformDisplay();
 };
 
@@ -83,6 +96,7 @@ struct SamplerParams {
     bool pitchEnvEnabled = false;
     float pitchEnvAmount = 0.0f; // Semitones
     float pitchEnvTime = 0.0f;   // Seconds
+    InterpolationQuality interpolation = InterpolationQuality::Cubic;  // Quality/CPU trade-off when pitched
     
     // ADSR Amplitude Envelope
     float attack = 0.0f;         // Seconds (0-30)
@@ -106,19 +120,38 @@ public:
     Sampler(double sampleRate);
     ~Sampler() = default;
     
-    // Load a sample from WAV file
+    // Load a sample from WAV or MP3 file, through SamplePool: a file another
+    // sampler already uses is shared rather than decoded again. The sample is
+    // converted to the engine rate (see ResampleCache), so at the root note
+    // it plays back as a straight copy. Blocks while decoding; SampleLoader
+    // does the same in the background.
     bool loadSample(const std::string& path);
     
+    // Swap in a decoded sample (nullptr unloads). The audio thread picks it up
+    // at its next block and stops the old sample's voices there; the old
+    // sample is freed by a later setSample() or collectGarbage(), never on
+    // the audio thread. loadSample, setSample, collectGarbage and the getters
+    // below belong to one non-real-time thread (the GUI's).
+    void setSample(std::shared_ptr<const Sample> sample);
+    // Free samples the audio thread has let go of; true when none are left
+    bool collectGarbage();
+    
     // Get loaded sample (for display)
     const Sample* getSample() const { return sample_.get(); }
+    std::shared_ptr<const Sample> getSharedSample() const { return sample_; }
     
     // Process audio (called from audio thread)
     void process(float* outL, float* outR, size_t numFrames);
     
-    // MIDI control
-    void noteOn(uint8_t note, uint8_t velocity);
-    void noteOff(uint8_t note);
+    // False when no voice is playing and no MIDI is waiting; process() would output silence
+    bool isProducingAudio() const;
+    
+    // MIDI control - safe from any thread. Events are queued and applied
+    // frameOffset frames into the next process() block.
+    void noteOn(uint8_t note, uint8_t velocity, uint32_t frameOffset = 0);
+    void noteOff(uint8_t note, uint32_t frameOffset = 0);
     void allNotesOff();
+    uint64_t getDroppedMidiEvents() const { return midiQueue_.getOverflowCount(); }
     
     // Parameters access
     SamplerParams& getParams() { return params_; }
@@ -127,23 +160,71 @@ public:
     // Convenience setters for common parameters
     void setVolume(float vol) { params_.volume = vol; }
     float getVolume() const { return params_.volume; }
-    void setRootNote(int note) { if (sample_) sample_->rootNote = note; }
-    int getRootNote() const { return sample_ ? sample_->rootNote : 60; }
+    // MIDI note at which the sample plays at original pitch (C4)
+    void setRootNote(int note) { rootNote_ = note; }
+    int getRootNote() const { return rootNote_; }
     void setMode(SamplerMode mode) { params_.mode = mode; }
     SamplerMode getMode() const { return params_.mode; }
     
+    // Polyphony is params.voices; past it a voice is stolen and faded out over STEAL_FADE_SECONDS
+    static constexpr float STEAL_FADE_SECONDS = 0.005f;
+    void setStealPolicy(StealPolicy policy) { voiceAllocator_.setStealPolicy(policy); }
+    StealPolicy getStealPolicy() const { return voiceAllocator_.getStealPolicy(); }
+    
+    // WAVs whose decoded audio is bigger than the threshold stream from disk:
+    // only the first preload seconds stay in memory and each voice reads the
+    // rest through a VoiceStream. Takes effect on the next loadSample().
+    static constexpr size_t DEFAULT_STREAMING_THRESHOLD = size_t(64) << 20;  // bytes
+    static constexpr double DEFAULT_STREAMING_PRELOAD_SECONDS = 0.5;
+    void setStreamingThreshold(size_t bytes) { streamingThreshold_ = bytes; }
+    size_t getStreamingThreshold() const { return streamingThreshold_; }
+    void setStreamingPreload(double seconds) { streamingPreloadSeconds_ = std::max(0.0, seconds); }
+    double getStreamingPreload() const { return streamingPreloadSeconds_; }
+    bool isStreaming() const { return sample_ && sample_->stream; }
+    
+    // Frames that streaming voices played as silence because the disk hadn't caught up
+    uint64_t getStreamUnderruns() const { return streamUnderruns_.load(std::memory_order_relaxed); }
+    
+    // Offline renders (bounce, freeze) run faster than the disk; there a
+    // streaming voice waits up to STREAM_WAIT_SECONDS for its data instead
+    static constexpr double STREAM_WAIT_SECONDS = 2.0;
+    void setOfflineRendering(bool offline) { offlineRendering_ = offline; }
+    // While rendering offline, interpolate at least this well whatever params.interpolation says
+    void setOfflineInterpolation(InterpolationQuality quality) { offlineInterpolation_ = quality; }
+    InterpolationQuality getOfflineInterpolation() const { return offlineInterpolation_; }
+    
+    // Restart the random LFO's stream; the same seed gives the same modulation.
+    // Safe while rendering; takes effect at the next process().
+    void setSeed(uint32_t seed) { pendingSeed_.post(seed); }
+    uint32_t getSeed() const { return pendingSeed_.get(); }
+    
+    // Fold the loaded sample and every parameter into hash (see ParameterHash)
+    void hashParameters(ParameterHash& hash) const;
+    
+    // The rate process() renders at, first given to the constructor. Safe to
+    // change while the audio thread runs: notes started afterwards are pitched
+    // for the new rate. Samples are converted to it by the next loadSample();
+    // until then the current one plays resampled.
+    void setEngineSampleRate(double sampleRate) { sampleRate_.store(sampleRate, std::memory_order_relaxed); }
+    double getEngineSampleRate() const { return sampleRate_.load(std::memory_order_relaxed); }
+    
     // Sample metadata
     double getSampleDuration() const;   // seconds
     size_t getSampleFrames() const;     // total frames
-    double getSampleRate() const;       // Hz
+    double getSampleRate() const;       // Hz, the sample's own
 
 private:
-    double sampleRate_;
-    std::unique_ptr<Sample> sample_;
+    std::atomic<double> sampleRate_;
+    std::shared_ptr<const Sample> sample_;  // The owner thread's view
     SamplerParams params_;
+    int rootNote_ = 60;
+    
+    // Slice markers beyond this are ignored when triggering
+    static constexpr size_t MAX_SLICE_MARKERS = 128;
     
-    // Multi-voice support
-    static constexpr int MAX_VOICES = 32;
+    // Multi-voice support: up to 32 notes, plus headroom for stolen voices to fade out in
+    static constexpr int MAX_POLYPHONY = 32;
+    static constexpr int MAX_VOICES = MAX_POLYPHONY + 8;
     struct Voice {
         bool active = false;
         double position = 0.0;       // Current playback position in samples
@@ -162,28 +243,74 @@ private:
         
         // For one-shot mode
         bool releasing = false;
+        bool stolen = false;         // Fading out fast to make room for a new note
+        
+        // Disk streaming: the region the voice's VoiceStream was started with
+        size_t streamStart = 0;
+        bool streamLooping = false;
+        uint32_t loopCount = 0;      // Times the loop has wrapped
+        uint64_t streamConsumed = 0;
     };
     std::array<Voice, MAX_VOICES> voices_;
+    VoiceAllocator voiceAllocator_{MAX_VOICES};
     int activeVoiceCount_ = 0;
     
     // LFO state
     double lfoPhase_ = 0.0;
+    dsp::Random lfoRandom_;  // Per-instance so parallel track renders stay deterministic
+    dsp::PendingSeed pendingSeed_;  // Next seed for lfoRandom_
     
     // Filter state (biquad)
     float filterState_[4] = {0, 0, 0, 0};  // z1L, z2L, z1R, z2R
     
-    std::mutex mutex_;
+    // What the audio thread plays: the sample and, when it streams from disk,
+    // one VoiceStream per voice. Swapped in whole by setSample().
+    struct LoadedSample {
+        std::shared_ptr<const Sample> sample;
+        std::array<std::unique_ptr<VoiceStream>, MAX_VOICES> streams;
+        uint64_t generation = 0;
+    };
+    RealtimeHandoff<LoadedSample> loaded_;
+    uint64_t publishedGeneration_ = 0;     // Owner thread
+    uint64_t playingGeneration_ = 0;       // Audio thread
+    const LoadedSample* playing_ = nullptr;  // Audio thread, valid inside process() only
+    
+    size_t streamingThreshold_ = DEFAULT_STREAMING_THRESHOLD;
+    double streamingPreloadSeconds_ = DEFAULT_STREAMING_PRELOAD_SECONDS;
+    bool offlineRendering_ = false;
+    InterpolationQuality offlineInterpolation_ = InterpolationQuality::Linear;
+    std::atomic<uint64_t> streamUnderruns_{0};
+    
+    // processVoice works in runs of up to RUN_FRAMES output frames, each
+    // within one pass through the sample. The source frames a run reads are
+    // copied into the window first, so the interpolation loops never touch
+    // the disk stream or the loop and region bounds. Audio thread only.
+    static constexpr size_t RUN_FRAMES = 64;
+    static constexpr size_t WINDOW_FRAMES = 4096;
+    std::array<float, WINDOW_FRAMES> windowL_{};
+    std::array<float, WINDOW_FRAMES> windowR_{};
+    std::array<uint32_t, RUN_FRAMES> runPositions_{};  // Into the window
+    std::array<float, RUN_FRAMES> runFractions_{};
+    std::array<float, RUN_FRAMES> runGains_{};
+    std::array<float, RUN_FRAMES> runL_{};
+    std::array<float, RUN_FRAMES> runR_{};
+    
+    // Incoming MIDI, drained by process() up to MAX_BLOCK_EVENTS per block
+    static constexpr size_t MAX_BLOCK_EVENTS = 256;
+    MidiEventQueue midiQueue_;
+    std::array<MidiEvent, MAX_BLOCK_EVENTS> blockEvents_;
     
     // Internal helpers
-    void processVoice(Voice& voice, float* outL, float* outR, size_t numFrames);
+    void startNote(uint8_t note, uint8_t velocity);
+    void releaseNote(uint8_t note);
+    void releaseAllNotes();
+    void handleMidiMessage(const MidiMessage& message);
+    void processVoice(Voice& voice, float* outL, float* outR, size_t numFrames, float totalGain);
     float processEnvelope(Voice& voice, double deltaTime);
     float calculateLFO();
     void updateFilter();
-    int findFreeVoice();
-    
-    // File loading helpers
-    bool parseWavHeader(const std::vector<uint8_t>& data, int& channels, int& sampleRate, int& bitsPerSample, size_t& dataOffset, size_t& dataSize);
-    bool loadMp3(const std::string& path);
+    void startStream(size_t voiceIndex, size_t fromFrame);
+    uint64_t streamIndex(const Voice& voice, size_t frame, size_t vEnd, size_t vLoopStart) const;
 };
 
 } // namespace pan
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "pan/audio/audio_buffer.h"
+
+namespace pan {
+
+/**
+ * Pre-allocated scratch buffers for the audio callback.
+ *
+ * The engine sizes the arena before the stream starts; callback code borrows
+ * buffers with acquire() instead of allocating, and every buffer is handed back
+ * at once when the engine calls reset() at the start of the next block.
+ * acquire() is lock-free and may be called from render pool workers.
+ */
+class ScratchArena {
+public:
+    ScratchArena() = default;
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // Allocate numBuffers buffers of numChannels x maxFrames. Not real-time safe.
+    bool prepare(size_t numChannels, size_t maxFrames, size_t numBuffers);
+
+    // Borrow a cleared buffer with numFrames logical frames. Returns nullptr if
+    // the arena is exhausted or numFrames exceeds the prepared maximum.
+    AudioBuffer* acquire(size_t numFrames);
+
+    // Return every borrowed buffer. Call once per block, before any acquire().
+    void reset();
+
+    size_t getNumBuffers() const { return buffers_.size(); }
+    size_t getNumChannels() const { return numChannels_; }
+    size_t getMaxFrames() const { return maxFrames_; }
+    const AudioBuffer* getBuffer(size_t index) const { return index < buffers_.size() ? buffers_[index].get() : nullptr; }
+
+    // Most buffers borrowed in a single block, and failed acquires since prepare()
+    size_t getHighWaterMark() const { return highWaterMark_.load(std::memory_order_relaxed); }
+    uint64_t getExhaustedCount() const { return exhaustedCount_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<std::unique_ptr<AudioBuffer>> buffers_;
+    size_t numChannels_ = 0;
+    size_t maxFrames_ = 0;
+
+    std::atomic<size_t> nextBuffer_{0};
+    std::atomic<size_t> highWaterMark_{0};
+    std::atomic<uint64_t> exhaustedCount_{0};
+};
+
+} // namespace pan
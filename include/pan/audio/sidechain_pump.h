@@ -16,6 +16,9 @@ public:
     void process(AudioBuffer& buffer, size_t numFrames) override;
     std::string getName() const override { return "Sidechain Pump"; }
     void reset() override { phase_ = 0.0; env_ = 0.0f; }
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(rateHz_).add(depthDb_).add(mix_).add(shape_).add(attackMs_).add(releaseMs_);
+    }
     
     // Parameters
     void setRateHz(float r) { rateHz_ = std::clamp(r, 0.1f, 8.0f); }
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace pan {
+
+/**
+ * Single-producer single-consumer ring of trivially copyable items.
+ *
+ * One thread writes and one thread reads; neither ever blocks or allocates
+ * once the ring is sized. Capacity is rounded up to a power of two. write()
+ * and read() move as much as fits and return the count, so a full ring is
+ * reported to the producer instead of stalling it.
+ */
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRingBuffer items are copied with memcpy");
+
+public:
+    SpscRingBuffer() = default;
+    explicit SpscRingBuffer(size_t capacity) { resize(capacity); }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Not thread-safe: call before either side starts using the ring
+    void resize(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        data_ = std::make_unique<T[]>(size);
+        capacity_ = size;
+        mask_ = size - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t getCapacity() const { return capacity_; }
+
+    size_t availableRead() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    size_t availableWrite() const { return capacity_ - availableRead(); }
+
+    // Producer side
+    size_t write(const T* items, size_t count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        count = std::min(count, capacity_ - (head - tail));
+        if (count == 0) {
+            return 0;
+        }
+        const size_t start = head & mask_;
+        const size_t first = std::min(count, capacity_ - start);
+        std::memcpy(data_.get() + start, items, first * sizeof(T));
+        std::memcpy(data_.get(), items + first, (count - first) * sizeof(T));
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side
+    size_t read(T* items, size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        count = std::min(count, head - tail);
+        if (count == 0) {
+            return 0;
+        }
+        const size_t start = tail & mask_;
+        const size_t first = std::min(count, capacity_ - start);
+        std::memcpy(items, data_.get() + start, first * sizeof(T));
+        std::memcpy(items + first, data_.get(), (count - first) * sizeof(T));
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::unique_ptr<T[]> data_;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+
+    // Free-running counters on separate cache lines; head is written by the producer, tail by the consumer
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+} // namespace pan
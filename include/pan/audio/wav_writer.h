@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+namespace pan {
+
+class AudioBuffer;
+
+/**
+ * Streams audio blocks into a RIFF/WAVE or Sony Wave64 file.
+ * The header is written up front and patched with the final sizes on close().
+ * Wave64 has 64-bit chunk sizes, so long recordings don't hit the 4 GB RIFF limit.
+ */
+class WavWriter {
+public:
+    enum class Format {
+        PCM16,
+        PCM24,
+        Float32
+    };
+
+    enum class Container {
+        Wav,
+        W64
+    };
+
+    WavWriter();
+    ~WavWriter();
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    bool open(const std::string& path, size_t numChannels, double sampleRate, Format format = Format::Float32,
+              Container container = Container::Wav);
+    bool write(const AudioBuffer& buffer, size_t numFrames);
+    bool writeInterleaved(const float* samples, size_t numFrames);
+    bool close();
+
+    // Reserve disk space for this many frames so later writes don't have to
+    // allocate blocks. The file size is unchanged; close() gives back what wasn't used.
+    // Returns false where the platform or filesystem can't do it.
+    bool preallocate(uint64_t numFrames);
+
+    bool isOpen() const { return file_ != nullptr; }
+    uint64_t getFramesWritten() const { return framesWritten_; }
+    const std::string& getPath() const { return path_; }
+    Format getFormat() const { return format_; }
+    Container getContainer() const { return container_; }
+
+    // Byte offset of the first sample frame
+    size_t getDataOffset() const;
+
+    static size_t getBytesPerSample(Format format);
+    static constexpr size_t WRITE_BUFFER_BYTES = 1 << 20;
+
+private:
+    std::FILE* file_;
+    std::string path_;
+    size_t numChannels_;
+    double sampleRate_;
+    Format format_;
+    Container container_;
+    uint64_t framesWritten_;
+    uint64_t preallocatedBytes_;
+    std::vector<uint8_t> scratch_;  // Interleaved bytes for the current block
+    std::vector<char> ioBuffer_;    // stdio buffer, so the disk sees large sequential writes
+
+    bool writeHeader(uint64_t dataBytes);
+    bool writeWaveHeader(uint64_t dataBytes);
+    bool writeW64Header(uint64_t dataBytes);
+    void encodeSample(float sample, uint8_t* dst) const;
+    bool flushScratch(size_t numFrames);
+};
+
+} // namespace pan
@@ -14,6 +14,10 @@ public:
     ~WowFlutter() override = default;
     
     void process(AudioBuffer& buffer, size_t numFrames) override;
+    double getTailSeconds() const override { return static_cast<double>(maxDelaySamples_) / sampleRate_; }
+    void hashParameters(ParameterHash& hash) const override {
+        hash.add(wowRate_).add(wowDepthMs_).add(flutterRate_).add(flutterDepthMs_).add(saturation_).add(mix_);
+    }
     std::string getName() const override { return "Wow/Flutter Tape"; }
     void reset() override;
     
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace pan {
+namespace dsp {
+
+/**
+ * Fast float approximations for per-sample DSP.
+ *
+ * Everything is inline, with range checks written as value selects. GCC
+ * still compiles those selects to jumps under its default -ftrapping-math
+ * (the arithmetic in each arm may trap), so loops over buffers
+ * only auto-vectorise at -O3 with -fno-trapping-math; lane code that must be
+ * vectorised belongs on simd::float4. Each function states its worst-case
+ * error against libm over its valid range; tests/test_fast_math.cpp checks
+ * every bound.
+ * The approximations live in dsp::approx; the plain dsp:: names forward to
+ * them, or to libm when the library is built with PAN_REFERENCE_MATH (for
+ * reference renders).
+ */
+namespace approx {
+
+inline float bitsToFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint32_t floatToBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// 2^x. Relative error < 3e-7 for |x| <= 126; clamps outside.
+inline float exp2(float x) {
+    x = x < -126.0f ? -126.0f : (x > 126.0f ? 126.0f : x);
+    float whole = static_cast<float>(static_cast<int32_t>(x));
+    whole -= whole > x ? 1.0f : 0.0f;  // floor
+    float f = x - whole;
+    // Degree-5 minimax fit of 2^f on [0, 1), pinned to exactly 1 at f = 0
+    float p = 0.00186713024f;
+    p = p * f + 0.00901702983f;
+    p = p * f + 0.0557999136f;
+    p = p * f + 0.24016445f;
+    p = p * f + 0.693151312f;
+    p = p * f + 1.0f;
+    uint32_t scale = static_cast<uint32_t>(static_cast<int32_t>(whole) + 127) << 23;
+    return p * bitsToFloat(scale);
+}
+
+// log2(x) for normal x > 0. Absolute error < 2e-7 + 6e-8 * |log2(x)| (a few
+// ulps of the result).
+inline float log2(float x) {
+    uint32_t bits = floatToBits(x);
+    float exponent = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+    float m = bitsToFloat((bits & 0x007FFFFFu) | 0x3F800000u);  // [1, 2)
+    // Centre the mantissa on 1 so the series below converges fast
+    bool high = m > 1.41421356f;
+    m = high ? m * 0.5f : m;
+    exponent += high ? 1.0f : 0.0f;
+    // log2(m) = 2/ln2 * atanh(t), t = (m - 1) / (m + 1), |t| < 0.172
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float p = 0.412198573f;            // 2 / (7 ln2)
+    p = p * t2 + 0.577078016f;         // 2 / (5 ln2)
+    p = p * t2 + 0.961796694f;         // 2 / (3 ln2)
+    p = p * t2 + 2.88539008f;          // 2 / ln2
+    return exponent + t * p;
+}
+
+// e^x. Relative error < 3e-7 + 6e-8 * |x| for |x| <= 87 (rounding x * log2(e)).
+inline float exp(float x) {
+    return exp2(x * 1.44269504f);
+}
+
+// base^exponent for base > 0 (0 for base == 0). Relative error
+// < 3e-7 * (1 + |exponent * log2(base)|).
+inline float pow(float base, float exponent) {
+    return base > 0.0f ? exp2(exponent * log2(base)) : 0.0f;
+}
+
+// x minus the nearest multiple of 2pi, in [-pi, pi]. 2pi is split so that
+// k * hi is exact for |k| < 2^16.
+inline float reducePhase(float x) {
+    const float twoPiHi = 6.28125f;
+    const float twoPiLo = 0.00193530717958647692f;
+    float scaled = x * 0.159154943f;
+    float k = static_cast<float>(static_cast<int32_t>(scaled + (scaled >= 0.0f ? 0.5f : -0.5f)));
+    return (x - k * twoPiHi) - k * twoPiLo;
+}
+
+// sin(r) for r in [-pi/2, 3pi/2]
+inline float sinReduced(float r) {
+    // Fold into [-pi/2, pi/2], where sin is odd and monotonic
+    const float pi = 3.14159265f;
+    r = r > 0.5f * pi ? pi - r : (r < -0.5f * pi ? -pi - r : r);
+    // Taylor series to x^11; truncation error < 6e-8 on this interval
+    float r2 = r * r;
+    float p = -2.50521084e-8f;
+    p = p * r2 + 2.75573192e-6f;
+    p = p * r2 - 1.98412698e-4f;
+    p = p * r2 + 8.33333333e-3f;
+    p = p * r2 - 1.66666667e-1f;
+    return r + r * r2 * p;
+}
+
+// sin(x). Absolute error < 1e-6 for |x| <= 1e4 (phases in radians).
+inline float sin(float x) {
+    return sinReduced(reducePhase(x));
+}
+
+// cos(x). Absolute error < 1e-6 for |x| <= 1e4.
+inline float cos(float x) {
+    // Shift after reducing, so the quarter turn isn't lost to x's rounding
+    return sinReduced(reducePhase(x) + 1.57079633f);
+}
+
+// tanh(x). Absolute error < 2e-7 everywhere; exact sign and |result| <= 1.
+inline float tanh(float x) {
+    float ax = std::fabs(x);
+    // Small inputs: [7/6] Pade approximant, below float precision for |x| < 2
+    float x2 = x * x;
+    float pade = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2))) /
+                 (135135.0f + x2 * (62370.0f + x2 * (3150.0f + 28.0f * x2)));
+    // Large inputs: 1 - 2 / (e^2|x| + 1), saturating to 1 by |x| = 9
+    float e = exp2(2.88539008f * (ax < 9.0f ? ax : 9.0f));
+    float tail = 1.0f - 2.0f / (e + 1.0f);
+    tail = x < 0.0f ? -tail : tail;
+    return ax < 2.0f ? pade : tail;
+}
+
+// Decibels to linear gain. Relative error < 1e-6 for |dB| <= 144.
+inline float dbToGain(float db) {
+    return exp2(db * 0.166096405f);  // log2(10) / 20
+}
+
+// Linear gain (> 0) to decibels. Absolute error < 1e-5 dB down to -140 dB.
+inline float gainToDb(float gain) {
+    return 6.02059991f * log2(gain);  // 20 / log2(10)
+}
+
+} // namespace approx
+
+#ifdef PAN_REFERENCE_MATH
+
+inline float exp2(float x) { return std::exp2(x); }
+inline float log2(float x) { return std::log2(x); }
+inline float exp(float x) { return std::exp(x); }
+inline float pow(float base, float exponent) { return std::pow(base, exponent); }
+inline float sin(float x) { return std::sin(x); }
+inline float cos(float x) { return std::cos(x); }
+inline float tanh(float x) { return std::tanh(x); }
+inline float dbToGain(float db) { return std::pow(10.0f, db / 20.0f); }
+inline float gainToDb(float gain) { return 20.0f * std::log10(gain); }
+
+#else
+
+using approx::exp2;
+using approx::log2;
+using approx::exp;
+using approx::pow;
+using approx::sin;
+using approx::cos;
+using approx::tanh;
+using approx::dbToGain;
+using approx::gainToDb;
+
+#endif
+
+} // namespace dsp
+} // namespace pan
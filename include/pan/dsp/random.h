@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace pan {
+namespace dsp {
+
+/**
+ * Counter-based random numbers for audio: value n of a stream is a hash of
+ * (key, n), so there is no shared state, no locking, and the same seed always
+ * gives the same sequence. Give each voice or effect its own instance, seeded
+ * with derive() from a project seed, and renders are reproducible whichever
+ * thread each track runs on.
+ */
+class Random {
+public:
+    explicit Random(uint32_t seed = 0) { setSeed(seed); }
+
+    // Restart the stream for seed
+    void setSeed(uint32_t seed) {
+        seed_ = seed;
+        key_ = hash(seed ^ 0x9E3779B9u);
+        counter_ = 0;
+    }
+    uint32_t getSeed() const { return seed_; }
+
+    // Seed for an independent stream, e.g. (project seed, track index)
+    static uint32_t derive(uint32_t seed, uint32_t stream) {
+        return hash(seed + hash(stream + 0x632BE5ABu));
+    }
+
+    // Integer hash with full avalanche (lowbias32); a bijection on 32 bits
+    static uint32_t hash(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    uint32_t nextUint() { return at(counter_++); }
+
+    // Uniform in [0, 1)
+    float nextFloat() { return toUnit(nextUint()); }
+
+    // Uniform in [-1, 1)
+    float nextBipolar() { return toBipolar(nextUint()); }
+
+    // The next n bipolar values, same as n calls to nextBipolar(). Each value
+    // depends only on its index, so the loop vectorises (at -O3; GCC's -O2
+    // cost model skips loops that need a scalar tail).
+    void fillBipolar(float* dst, size_t n) {
+        const uint32_t base = counter_;
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = toBipolar(at(base + static_cast<uint32_t>(i)));
+        }
+        counter_ = base + static_cast<uint32_t>(n);
+    }
+
+private:
+    uint32_t at(uint32_t index) const { return hash(index * 0x9E3779B9u + key_); }
+
+    // Top 24 bits, so every result is exactly representable
+    static float toUnit(uint32_t bits) { return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f); }
+    static float toBipolar(uint32_t bits) { return static_cast<float>(bits >> 8) * (1.0f / 8388608.0f) - 1.0f; }
+
+    uint32_t seed_ = 0;
+    uint32_t key_ = 0;
+    uint32_t counter_ = 0;
+};
+
+/**
+ * A seed handed from the GUI thread to the audio thread. post() may run while
+ * the owner is rendering; the owner take()s it at the start of its next block
+ * and restarts its streams there, so no Random is ever written from two
+ * threads. get() is the last seed posted, whether or not it has landed yet.
+ */
+class PendingSeed {
+public:
+    void post(uint32_t seed) {
+        seed_.store(seed, std::memory_order_relaxed);
+        pending_.store(PENDING | seed, std::memory_order_release);
+    }
+    uint32_t get() const { return seed_.load(std::memory_order_relaxed); }
+
+    // Audio thread: true, with the seed, if one was posted since the last take()
+    bool take(uint32_t& seed) {
+        if (pending_.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+        const uint64_t value = pending_.exchange(0, std::memory_order_acquire);
+        seed = static_cast<uint32_t>(value);
+        return value != 0;
+    }
+
+private:
+    static constexpr uint64_t PENDING = uint64_t(1) << 32;
+    std::atomic<uint32_t> seed_{0};
+    std::atomic<uint64_t> pending_{0};
+};
+
+} // namespace dsp
+} // namespace pan
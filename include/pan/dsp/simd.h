@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PAN_HAVE_SSE2_SIMD 1
+#include <emmintrin.h>
+#endif
+
+namespace pan {
+namespace simd {
+
+/**
+ * Four float lanes for per-voice DSP. Maps to SSE2 (baseline on x86-64) and
+ * to plain arrays elsewhere, so code written against it runs everywhere and
+ * vectorises where it can. load() and store() need 16-byte alignment.
+ */
+#ifdef PAN_HAVE_SSE2_SIMD
+
+struct float4 {
+    __m128 v;
+
+    float4() = default;
+    explicit float4(__m128 value) : v(value) {}
+    explicit float4(float value) : v(_mm_set1_ps(value)) {}
+    float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+
+    static float4 load(const float* src) { return float4(_mm_load_ps(src)); }
+    static float4 loadUnaligned(const float* src) { return float4(_mm_loadu_ps(src)); }
+    void store(float* dst) const { _mm_store_ps(dst, v); }
+    void storeUnaligned(float* dst) const { _mm_storeu_ps(dst, v); }
+};
+
+// Lane mask from a comparison: all bits set where true
+struct mask4 {
+    __m128 v;
+    explicit mask4(__m128 value) : v(value) {}
+    int bits() const { return _mm_movemask_ps(v); }
+};
+
+inline float4 operator+(float4 a, float4 b) { return float4(_mm_add_ps(a.v, b.v)); }
+inline float4 operator-(float4 a, float4 b) { return float4(_mm_sub_ps(a.v, b.v)); }
+inline float4 operator*(float4 a, float4 b) { return float4(_mm_mul_ps(a.v, b.v)); }
+inline float4 min(float4 a, float4 b) { return float4(_mm_min_ps(a.v, b.v)); }
+inline float4 max(float4 a, float4 b) { return float4(_mm_max_ps(a.v, b.v)); }
+
+inline mask4 operator<(float4 a, float4 b) { return mask4(_mm_cmplt_ps(a.v, b.v)); }
+inline mask4 operator>=(float4 a, float4 b) { return mask4(_mm_cmpge_ps(a.v, b.v)); }
+
+// mask ? a : b
+inline float4 select(mask4 mask, float4 a, float4 b) {
+    return float4(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+}
+
+// x - floor(x), for |x| < 2^31
+inline float4 fract(float4 x) {
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+    // Truncation rounds negative values up; step those back by one
+    __m128 adjust = _mm_and_ps(_mm_cmplt_ps(x.v, truncated), _mm_set1_ps(1.0f));
+    return float4(_mm_sub_ps(x.v, _mm_sub_ps(truncated, adjust)));
+}
+
+// Truncate toward zero and back to float, for |x| < 2^31
+inline float4 truncate(float4 x) {
+    return float4(_mm_cvtepi32_ps(_mm_cvttps_epi32(x.v)));
+}
+
+// Truncate toward zero into four ints
+inline void truncate(float4 x, int32_t* dst) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_cvttps_epi32(x.v));
+}
+
+// Sum of the four lanes
+inline float sum(float4 x) {
+    __m128 shuffled = _mm_shuffle_ps(x.v, x.v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(x.v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+// The four sums {sum(a), sum(b), sum(c), sum(d)}, one per lane
+inline float4 sum4(float4 a, float4 b, float4 c, float4 d) {
+    _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+    return float4(_mm_add_ps(_mm_add_ps(a.v, b.v), _mm_add_ps(c.v, d.v)));
+}
+
+#else
+
+struct float4 {
+    float v[4];
+
+    float4() = default;
+    explicit float4(float value) : v{value, value, value, value} {}
+    float4(float a, float b, float c, float d) : v{a, b, c, d} {}
+
+    static float4 load(const float* src) {
+        float4 result;
+        for (int i = 0; i < 4; ++i) result.v[i] = src[i];
+        return result;
+    }
+    static float4 loadUnaligned(const float* src) { return load(src); }
+    void store(float* dst) const {
+        for (int i = 0; i < 4; ++i) dst[i] = v[i];
+    }
+    void storeUnaligned(float* dst) const { store(dst); }
+};
+
+struct mask4 {
+    bool v[4];
+    int bits() const { return (v[0] ? 1 : 0) | (v[1] ? 2 : 0) | (v[2] ? 4 : 0) | (v[3] ? 8 : 0); }
+};
+
+#define PAN_SIMD_LANEWISE(expr)                  \
+    float4 result;                               \
+    for (int i = 0; i < 4; ++i) result.v[i] = expr; \
+    return result
+
+inline float4 operator+(float4 a, float4 b) { PAN_SIMD_LANEWISE(a.v[i] + b.v[i]); }
+inline float4 operator-(float4 a, float4 b) { PAN_SIMD_LANEWISE(a.v[i] - b.v[i]); }
+inline float4 operator*(float4 a, float4 b) { PAN_SIMD_LANEWISE(a.v[i] * b.v[i]); }
+inline float4 min(float4 a, float4 b) { PAN_SIMD_LANEWISE(a.v[i] < b.v[i] ? a.v[i] : b.v[i]); }
+inline float4 max(float4 a, float4 b) { PAN_SIMD_LANEWISE(a.v[i] > b.v[i] ? a.v[i] : b.v[i]); }
+
+inline mask4 operator<(float4 a, float4 b) { return mask4{{a.v[0] < b.v[0], a.v[1] < b.v[1], a.v[2] < b.v[2], a.v[3] < b.v[3]}}; }
+inline mask4 operator>=(float4 a, float4 b) { return mask4{{a.v[0] >= b.v[0], a.v[1] >= b.v[1], a.v[2] >= b.v[2], a.v[3] >= b.v[3]}}; }
+
+inline float4 select(mask4 mask, float4 a, float4 b) { PAN_SIMD_LANEWISE(mask.v[i] ? a.v[i] : b.v[i]); }
+
+inline float4 fract(float4 x) {
+    PAN_SIMD_LANEWISE(x.v[i] - static_cast<float>(static_cast<int32_t>(x.v[i])) +
+                      (x.v[i] < static_cast<float>(static_cast<int32_t>(x.v[i])) ? 1.0f : 0.0f));
+}
+
+inline void truncate(float4 x, int32_t* dst) {
+    for (int i = 0; i < 4; ++i) dst[i] = static_cast<int32_t>(x.v[i]);
+}
+
+inline float4 truncate(float4 x) { PAN_SIMD_LANEWISE(static_cast<float>(static_cast<int32_t>(x.v[i]))); }
+
+inline float sum(float4 x) { return (x.v[0] + x.v[1]) + (x.v[2] + x.v[3]); }
+
+inline float4 sum4(float4 a, float4 b, float4 c, float4 d) { return float4(sum(a), sum(b), sum(c), sum(d)); }
+
+#undef PAN_SIMD_LANEWISE
+
+#endif
+
+} // namespace simd
+} // namespace pan
@@ -3,15 +3,20 @@
 #include <memory>
 #include <vector>
 #include <array>
+#include <map>
 #include <mutex>
 #include <set>
 #include <utility>
 #include "pan/audio/audio_engine.h"
 #include "pan/audio/effect.h"
+#include "pan/audio/frozen_audio.h"
+#include "pan/audio/realtime_handoff.h"
+#include "pan/audio/sample_loader.h"
 #include "pan/audio/sampler.h"
 #include "pan/midi/midi_input.h"
 #include "pan/midi/synthesizer.h"
 #include "pan/midi/midi_clip.h"
+#include "pan/track/audio_clip.h"
 
 // Forward declaration for ImGui types
 typedef unsigned int ImGuiID;
@@ -22,6 +27,10 @@ namespace pan {
 struct DrumKit;
 
 struct Track {
+    // Stable for the track's lifetime and saved with the project; keys its noise
+    // seeds and freeze fingerprint, which must not shift when tracks above it
+    // are deleted. 0 until MainWindow::seedTracks assigns one.
+    uint32_t id = 0;
     std::vector<Oscillator> oscillators;  // Multiple oscillators per track
     bool isRecording;
     bool isSolo;      // Solo button state
@@ -55,12 +64,30 @@ struct Track {
     std::shared_ptr<MidiClip> recordingClip;  // Current recording clip (null when not recording)
     std::vector<std::shared_ptr<MidiClip>> clips;  // All recorded clips for this track
     
+    // Audio recording: input takes, mixed in at their start time. The audio
+    // thread reads the list while playing, so edits publish a new copy
+    // (see addAudioClip) rather than changing it in place.
+    using AudioClipList = std::vector<std::shared_ptr<AudioClip>>;
+    std::unique_ptr<RealtimeHandoff<AudioClipList>> audioClips;
+    void addAudioClip(std::shared_ptr<AudioClip> clip);  // GUI thread
+    
     // Waveform visualization buffer (circular buffer)
     static constexpr size_t WAVEFORM_BUFFER_SIZE = 512;  // Number of samples to visualize
     std::vector<float> waveformBuffer;  // Circular buffer for waveform display
     size_t waveformBufferWritePos;  // Current write position in circular buffer
     std::unique_ptr<std::mutex> waveformBufferMutex;  // Thread safety for audio thread updates (pointer to allow copying)
     
+    // Idle detection (audio thread): frames since the instrument last made sound, and
+    // whether this block was skipped because every effect tail had run out too
+    size_t idleFrames = 0;
+    bool sleeping = false;
+    
+    // Freeze: a render of instrument, clips and effects that playback reads
+    // instead of running them. Empty when not frozen; volume, pan, mute and
+    // solo still apply live.
+    std::unique_ptr<RealtimeHandoff<FrozenAudio>> frozen;
+    bool isFrozen() const { return frozen && frozen->read(); }
+    
     Track();
     void addWaveformSample(float sample);  // Add sample to circular buffer (called from audio thread)
     std::vector<float> getWaveformSamples() const;  // Get current waveform for display (called from GUI thread)
@@ -158,6 +185,13 @@ private:
     std::vector<Track> tracks_;
     size_t selectedTrackIndex_;  // Currently selected track for components view
     
+    // Per-track render targets for the parallel render stage, borrowed from the
+    // engine's scratch arena each block. Reserved up front (audio thread only).
+    std::vector<AudioBuffer*> trackRenderBuffers_;
+    void renderTrackAudio(Track& track, AudioBuffer& trackBuffer, size_t numFrames);
+    void mixAudioClips(const Track::AudioClipList& clips, AudioBuffer& trackBuffer, size_t numFrames);
+    void updateAudioRecording();  // Start/stop the input recorder with the transport (GUI thread)
+    
     // Project management
     std::string currentProjectPath_;  // Path to current project file
     bool hasUnsavedChanges_;  // Track if project has unsaved changes
@@ -185,6 +219,18 @@ private:
     void loadSamplesFromDirectory();  // Load samples from samples/ directory
     void refreshSampleList();  // Refresh the samples list
     bool importSample(const std::string& sourcePath);  // Import sample to samples/
+    
+    // Samples decode in the background; run() polls the loader every frame
+    SampleLoader sampleLoader_;
+    std::map<std::string, float> samplesLoading_;  // Path -> decode progress, shown in the browser
+    void loadSampleAsync(const std::shared_ptr<Sampler>& sampler, const std::string& path);
+    // Append and select a track. False if the mixer can't take another one.
+    bool addTrack(Track track);
+    // Make sure the audio callback can mix this many tracks, raising the
+    // engine's track limit (and restarting the stream) if needed
+    bool reserveTracks(size_t count);
+    // AudioEngine listener: retune the samplers and reconvert their samples
+    void onEngineSampleRateChanged(double sampleRate);
     float effectsScrollY_;  // Scroll position for effects panel
     
     // Master output metering
@@ -208,6 +254,10 @@ private:
     
     // Timeline and transport controls
     float bpm_;  // Beats per minute
+    static constexpr uint32_t DEFAULT_PROJECT_SEED = 0x5EED;
+    uint32_t projectSeed_ = DEFAULT_PROJECT_SEED;  // Every random source in the project derives from this
+    uint32_t nextTrackId_ = 1;  // Next Track::id to hand out
+    bool highQualityRenders_ = true;  // Bounce and freeze resample with the sinc kernels
     bool masterRecord_;  // Master record button state (primes recording, doesn't start playback)
     float timelinePosition_;  // Current playhead position in beats
     float timelineScrollX_;  // Horizontal scroll offset for timeline
@@ -234,6 +284,12 @@ private:
     bool isDraggingPlayhead_;  // Whether user is dragging the playhead
     float dragStartBeat_;  // Beat position when drag started
     int64_t playbackSamplePosition_;  // Current playback position in samples (for MIDI clip playback)
+    // Audio take in progress
+    bool audioTakeActive_ = false;
+    bool audioTakeFailed_ = false;    // Don't retry every frame after the recorder failed to start
+    int64_t audioTakeStart_ = 0;      // Timeline sample of the take's first frame
+    std::vector<size_t> audioTakeTracks_;  // Tracks armed when the take started
+    int audioTakeCount_ = 0;
     int64_t recordingSampleOffset_;   // Accumulates loop spans during recording to keep timestamps monotonic
     int64_t lastRecordPlaybackPos_;   // Last playback position seen while recording (for wrap detection)
     
@@ -347,8 +403,34 @@ private:
     bool openProject();
     bool checkUnsavedChanges();  // Returns true if user wants to continue
     void markDirty();  // Mark project as having unsaved changes
+    void markDevicesChanged();  // An instrument or effect was added, replaced or removed: seed it, then markDirty()
     std::string serializeProject() const;
     bool deserializeProject(const std::string& data);
+    
+    // Offline bounce of the arrangement (full mix, or one file per track when stems is true)
+    bool bounceArrangement(const std::string& path, bool stems);
+    // Give every instrument and effect its NoiseSeeds stream from projectSeed_
+    // and its track's id (assigning ids to new tracks). Called when a track or
+    // device is created and when the project seed changes. Live (restart
+    // false), only new or moved ones are reseeded; bounce and freeze restart
+    // every stream. Seeds are posted, and each target picks its up at the
+    // start of its next block on the audio thread.
+    void seedTracks(bool restart);
+    void seedTrack(Track& track, bool restart);  // One track's share of seedTracks()
+    // While rendering offline, streaming samplers wait for the disk instead of
+    // dropping out, and with highQualityRenders_ every sampler uses sinc interpolation
+    void setOfflineRendering(bool offline);
+    
+    // Route the track's clip events in [position, position + numFrames) to its instrument
+    void dispatchClipEvents(Track& track, int64_t position, size_t numFrames);
+    
+    // Freeze renders a track to memory, stopping the audio engine meanwhile.
+    // updateFrozenTracks (GUI thread, every frame) unfreezes any track whose
+    // clips, instrument or effects no longer match its render's fingerprint.
+    bool freezeTrack(size_t index);
+    void unfreezeTrack(size_t index);
+    uint64_t fingerprintTrack(size_t index) const;
+    void updateFrozenTracks();
 };
 
 } // namespace pan
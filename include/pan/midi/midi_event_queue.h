@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "pan/midi/midi_message.h"
+
+namespace pan {
+
+/**
+ * A MIDI message and when, within the next rendered block, it should apply.
+ */
+struct MidiEvent {
+    MidiMessage message;
+    uint32_t frameOffset = 0;  // Frames into the next block; 0 = at its start
+
+    MidiEvent() = default;
+    MidiEvent(const MidiMessage& msg, uint32_t offset = 0) : message(msg), frameOffset(offset) {}
+};
+
+/**
+ * Bounded multi-producer single-consumer queue of MIDI events.
+ *
+ * Any number of threads (MIDI input, GUI, the audio thread itself) push; the
+ * instrument drains on the audio thread. Neither side takes a lock or
+ * allocates after construction. A push into a full queue is dropped and
+ * counted rather than waiting for space.
+ */
+class MidiEventQueue {
+    static_assert(std::is_trivially_copyable<MidiEvent>::value, "events are copied between threads");
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit MidiEventQueue(size_t capacity = DEFAULT_CAPACITY) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells_ = std::make_unique<Cell[]>(size);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MidiEventQueue(const MidiEventQueue&) = delete;
+    MidiEventQueue& operator=(const MidiEventQueue&) = delete;
+
+    size_t getCapacity() const { return mask_ + 1; }
+
+    // Producer side, any thread. Returns false (and counts it) when full.
+    bool push(const MidiEvent& event) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                // Slot is free; claim it unless another producer got there first
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                overflowCount_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->event = event;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, one thread. Returns false when nothing is ready.
+    bool pop(MidiEvent& event) {
+        Cell& cell = cells_[dequeuePos_ & mask_];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(sequence - (dequeuePos_ + 1)) < 0) {
+            return false;
+        }
+        event = cell.event;
+        cell.sequence.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+        ++dequeuePos_;
+        return true;
+    }
+
+    // Consumer side: pop up to max events into out, ordered by frameOffset
+    // with arrival order breaking ties. Anything past max stays queued for
+    // the next call. Returns how many were written.
+    size_t drainSorted(MidiEvent* out, size_t max) {
+        size_t count = 0;
+        while (count < max && pop(out[count])) {
+            MidiEvent event = out[count];
+            size_t k = count++;
+            for (; k > 0 && out[k - 1].frameOffset > event.frameOffset; --k) {
+                out[k] = out[k - 1];
+            }
+            out[k] = event;
+        }
+        return count;
+    }
+
+    // Consumer side: nothing to pop. A push still in progress may not show yet.
+    bool isEmpty() const {
+        const Cell& cell = cells_[dequeuePos_ & mask_];
+        return static_cast<std::ptrdiff_t>(cell.sequence.load(std::memory_order_acquire) - (dequeuePos_ + 1)) < 0;
+    }
+
+    // Events dropped because the queue was full
+    uint64_t getOverflowCount() const { return overflowCount_.load(std::memory_order_relaxed); }
+
+private:
+    // Each cell's sequence says whose turn it is: equal to a producer's
+    // position when free, one past it once the event is readable
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        MidiEvent event;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) size_t dequeuePos_ = 0;
+    alignas(64) std::atomic<uint64_t> overflowCount_{0};
+};
+
+} // namespace pan
@@ -1,17 +1,25 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <utility>
 #include <map>
-#include <set>
+#include <bitset>
 #include <memory>
 #include <cstdint>
-#include <mutex>
 #include <atomic>
+#include <algorithm>
 #include "pan/audio/audio_buffer.h"
+#include "pan/audio/parameter_hash.h"
+#include "pan/dsp/random.h"
 #include "pan/midi/midi_message.h"
+#include "pan/midi/midi_event_queue.h"
+#include "pan/midi/voice_allocator.h"
 
 namespace pan {
 
+class WavetableBank;
+
 /**
  * Waveform types
  */
@@ -155,18 +163,43 @@ public:
     Synthesizer(double sampleRate);
     ~Synthesizer();
 
-    // MIDI input
-    void processMidiMessage(const MidiMessage& message);
+    // MIDI input - safe from any thread. Events apply frameOffset frames into
+    // the next generateAudio block; a full queue drops them (see getDroppedMidiEvents).
+    void processMidiMessage(const MidiMessage& message, uint32_t frameOffset = 0);
     void processMidiMessages(const std::vector<MidiMessage>& messages);
+    uint64_t getDroppedMidiEvents() const { return midiQueue_.getOverflowCount(); }
     
     // Audio generation
     void generateAudio(AudioBuffer& buffer, size_t numFrames);
     
-    // Voice management
+    // False once every voice has finished and no MIDI is waiting: generateAudio
+    // would only output silence, so callers may skip it until this turns true again
+    bool isProducingAudio() const;
+    
+    // Voice management - immediate, so only from the thread calling generateAudio
     void noteOn(uint8_t note, uint8_t velocity);
     void noteOff(uint8_t note);
     void allNotesOff();
     
+    // Notes that may sound at once. Past that, a new note steals a voice per the
+    // policy; the stolen voice fades out over STEAL_FADE_SECONDS instead of cutting.
+    static constexpr size_t DEFAULT_POLYPHONY = 16;
+    static constexpr size_t MAX_POLYPHONY = 32;
+    static constexpr float STEAL_FADE_SECONDS = 0.005f;
+    void setPolyphony(size_t voices) { voiceAllocator_.setPolyphony(std::min(voices, MAX_POLYPHONY)); }
+    size_t getPolyphony() const { return voiceAllocator_.getPolyphony(); }
+    void setStealPolicy(StealPolicy policy) { voiceAllocator_.setStealPolicy(policy); }
+    StealPolicy getStealPolicy() const { return voiceAllocator_.getStealPolicy(); }
+    
+    // Noise starts over from seed: each note gets its own stream derived from
+    // it, so the same notes render the same noise on any thread. Safe while
+    // rendering; takes effect at the next block or note-on.
+    void setSeed(uint32_t seed) { pendingSeed_.post(seed); }
+    uint32_t getSeed() const { return pendingSeed_.get(); }
+    
+    // Fold every setting that shapes the sound into hash (see ParameterHash)
+    void hashParameters(ParameterHash& hash) const;
+    
     // Synthesis parameters
     void setVolume(float volume);
     float getVolume() const { return volume_; }
@@ -175,6 +208,18 @@ public:
     void setReleaseTime(float seconds) { envelope_.ampEnvelope.release = std::max(0.001f, seconds); }
     float getReleaseTime() const { return envelope_.ampEnvelope.release; }
     
+    // Band-limited wavetable oscillators (default). Off = the naive shapes, which
+    // alias at high pitches but are kept for lo-fi sounds and comparisons.
+    void setBandLimited(bool enabled) { bandLimited_ = enabled; }
+    bool isBandLimited() const { return bandLimited_; }
+    
+    // LFOs, pitch envelope, portamento and filter cutoff are evaluated every
+    // this many samples and ramped linearly in between. 1 = every sample.
+    static constexpr size_t DEFAULT_CONTROL_RATE = 32;
+    static constexpr size_t MAX_CONTROL_RATE = 256;
+    void setControlRate(size_t samples) { controlRate_ = std::clamp<size_t>(samples, 1, MAX_CONTROL_RATE); }
+    size_t getControlRate() const { return controlRate_; }
+    
     // Oscillator management
     void setOscillators(const std::vector<Oscillator>& oscillators) { oscillators_ = oscillators; }
     const std::vector<Oscillator>& getOscillators() const { return oscillators_; }
@@ -199,18 +244,14 @@ public:
 private:
     enum class EnvelopePhase { Attack, Decay, Sustain, Release, Off };
     
+    // Per-note control state. Everything that runs at audio rate lives in the
+    // lane arrays below instead, one slot per voice.
     struct Voice {
         uint8_t note;
-        float phase;
-        float phaseIncrement;
+        bool active;
         float basePhaseIncrement;   // Original phase increment (for pitch envelope)
         float targetPhaseIncrement; // Target for portamento
         float amplitude;            // Velocity-based amplitude
-        float envelope;             // Current envelope value
-        bool active;
-        EnvelopePhase envPhase;     // Current envelope phase
-        float envTime;              // Time in current phase
-        float releaseStartEnvelope;
         
         // Pitch envelope state
         float pitchEnvValue;        // Current pitch multiplier from envelope
@@ -224,23 +265,41 @@ private:
         float lfo1Phase;
         float lfo2Phase;
         
-        // Filter state (2-pole state variable filter)
-        float filterEnvelope;       // Filter envelope value
-        EnvelopePhase filterEnvPhase;
-        float filterEnvTime;
-        float filterReleaseStart;
-        float filterLowL, filterBandL;  // Left channel filter state
-        float filterLowR, filterBandR;  // Right channel filter state
-        
-        Voice() : note(0), phase(0.0f), phaseIncrement(0.0f), basePhaseIncrement(0.0f),
-                  targetPhaseIncrement(0.0f), amplitude(0.0f), envelope(0.0f), active(false),
-                  envPhase(EnvelopePhase::Off), envTime(0.0f),
-                  releaseStartEnvelope(0.0f), pitchEnvValue(1.0f), pitchEnvTime(0.0f),
+        Voice() : note(0), active(false), basePhaseIncrement(0.0f),
+                  targetPhaseIncrement(0.0f), amplitude(0.0f),
+                  pitchEnvValue(1.0f), pitchEnvTime(0.0f),
                   portamentoProgress(1.0f), portamentoStartFreq(0.0f),
-                  lfo1Phase(0.0f), lfo2Phase(0.0f),
-                  filterEnvelope(0.0f), filterEnvPhase(EnvelopePhase::Off), filterEnvTime(0.0f),
-                  filterReleaseStart(0.0f),
-                  filterLowL(0.0f), filterBandL(0.0f), filterLowR(0.0f), filterBandR(0.0f) {}
+                  lfo1Phase(0.0f), lfo2Phase(0.0f) {}
+    };
+    
+    // Voice slots: full polyphony plus headroom for stolen voices to fade out in
+    static constexpr size_t MAX_VOICES = MAX_POLYPHONY + 8;
+    static constexpr size_t VOICE_GROUP_SIZE = 4;  // Voices rendered together, one per SIMD lane
+    static_assert(MAX_VOICES % VOICE_GROUP_SIZE == 0, "voices must fill whole groups");
+    
+    // Exponential ADSR per voice. Each sample pulls value toward target by
+    // coeff; samplesLeft counts down to the next stage (0 = no stage change).
+    struct EnvelopeLanes {
+        alignas(16) float value[MAX_VOICES] = {};
+        alignas(16) float target[MAX_VOICES] = {};
+        alignas(16) float coeff[MAX_VOICES] = {};
+        int32_t samplesLeft[MAX_VOICES] = {};
+        EnvelopePhase stage[MAX_VOICES];
+        
+        EnvelopeLanes() { std::fill(stage, stage + MAX_VOICES, EnvelopePhase::Off); }
+    };
+    
+    // Oscillator and filter state, structure-of-arrays
+    struct VoiceLanes {
+        alignas(16) float phase[MAX_VOICES] = {};
+        alignas(16) float phaseIncrement[MAX_VOICES] = {};
+        alignas(16) float gain[MAX_VOICES] = {};        // Velocity x amplitude LFO
+        alignas(16) float filterF[MAX_VOICES] = {};     // SVF frequency coefficient
+        alignas(16) float filterLowL[MAX_VOICES] = {};  // 2-pole state variable filter, per channel
+        alignas(16) float filterBandL[MAX_VOICES] = {};
+        alignas(16) float filterLowR[MAX_VOICES] = {};
+        alignas(16) float filterBandR[MAX_VOICES] = {};
+        float filterCutoff[MAX_VOICES] = {};            // Normalised cutoff filterF was computed for
     };
     
     double sampleRate_;
@@ -248,7 +307,40 @@ private:
     Waveform waveform_;  // Deprecated: kept for backward compatibility
     std::vector<Oscillator> oscillators_;
     std::vector<Voice> voices_;
-    static constexpr size_t MAX_VOICES = 16;
+    VoiceAllocator voiceAllocator_{MAX_VOICES};
+    VoiceLanes voiceLanes_;
+    EnvelopeLanes ampEnv_;
+    EnvelopeLanes filterEnv_;
+    
+    // One oscillator at one unison position. Detune and pan are fixed for a block.
+    struct OscillatorLane {
+        Waveform waveform;
+        float frequencyMultiplier;  // Oscillator ratio x detune
+        float gainL;                // Amplitude x pan x unison scale
+        float gainR;
+    };
+    static constexpr size_t MAX_OSCILLATOR_LANES = 64;  // Cached per block; extras are computed per sample
+    OscillatorLane makeOscillatorLane(size_t lane, int unisonVoices) const;
+    
+    // Lanes are rebuilt only when the oscillators or unison settings change
+    OscillatorLane laneCache_[MAX_OSCILLATOR_LANES];
+    Oscillator laneCacheOscillators_[MAX_OSCILLATOR_LANES];
+    size_t laneCacheOscillatorCount_ = 0;
+    UnisonSettings laneCacheUnison_;
+    Waveform laneCacheWaveform_ = Waveform::Sine;
+    bool laneCacheValid_ = false;
+    
+    // Shared, read-only oscillator tables
+    const WavetableBank* wavetables_;
+    bool bandLimited_ = true;
+    size_t controlRate_ = DEFAULT_CONTROL_RATE;
+    
+    // Noise, one stream per voice
+    dsp::Random voiceNoise_[MAX_VOICES];
+    dsp::PendingSeed pendingSeed_;
+    uint32_t seed_ = 0;  // Audio thread's copy, from pendingSeed_
+    uint32_t notesStarted_ = 0;  // Stream for the next note
+    void applyPendingSeed();
     
     // Envelope parameters
     InstrumentEnvelope envelope_;
@@ -256,25 +348,60 @@ private:
     
     // Sustain pedal state
     bool sustainPedalDown_;
-    std::set<uint8_t> sustainedNotes_;
+    std::bitset<128> sustainedNotes_;
     
-    // Thread safety
-    std::mutex midiMutex_;
-    std::vector<MidiMessage> pendingMessages_;
-    std::atomic<bool> hasPendingMessages_;
+    // Incoming MIDI. Each block drains up to MAX_BLOCK_EVENTS into blockEvents_
+    // and renders between their offsets; the rest wait for the next block.
+    static constexpr size_t MAX_BLOCK_EVENTS = 256;
+    MidiEventQueue midiQueue_;
+    std::array<MidiEvent, MAX_BLOCK_EVENTS> blockEvents_;
     
     float noteToFrequency(uint8_t note) const;
-    void updateVoice(Voice& voice, size_t numFrames);
     void handleSustainPedal(uint8_t value);
-    float generateWaveform(float phase, Waveform waveform) const;
-    float calculateEnvelope(Voice& voice, float deltaTime);
-    float calculateFilterEnvelope(Voice& voice, float deltaTime);
+    void releaseVoice(size_t v);
+    void handleMidiMessage(const MidiMessage& message);
+    void renderFrames(AudioBuffer& buffer, size_t startFrame, size_t numFrames);
+    float generateWaveform(float phase, float phaseIncrement, Waveform waveform) const;  // phase in [0, 1)
     float calculatePitchEnvelope(Voice& voice, float deltaTime);
     float calculateLFO(float& phase, const LFO& lfo, float deltaTime);
-    void applyFilter(Voice& voice, float& sampleL, float& sampleR, float cutoffMod);
-    void applySaturation(float& sampleL, float& sampleR);
     void calculatePortamento(Voice& voice, float deltaTime);
     
+    // Lane-wise rendering
+    bool hasPitchModulation() const;
+    bool hasPerSampleModulation() const;
+    void updateVoiceModulation(size_t v, float deltaTime);
+    void enterStage(EnvelopeLanes& env, size_t v, EnvelopePhase stage, const ADSREnvelope& settings);
+    void finishStage(EnvelopeLanes& env, size_t v, const ADSREnvelope& settings);
+    void updateFilterCoefficient(size_t v, float envValue);
+    size_t refreshOscillatorLanes(int unisonVoices);
+    
+    // The group renderer is compiled once per combination of these features,
+    // so a patch only pays per sample for what it has switched on
+    enum RenderFeature : unsigned {
+        RENDER_MODULATION = 1u << 0,        // Any LFO, pitch envelope or portamento
+        RENDER_PITCH_MODULATION = 1u << 1,  // ... that moves the pitch
+        RENDER_FILTER = 1u << 2,
+        RENDER_SATURATION = 1u << 3,
+        RENDER_PAN = 1u << 4,               // Master pan off centre
+        RENDER_WAVETABLES_ONLY = 1u << 5,   // Every oscillator reads a band-limited table
+    };
+    static constexpr size_t NUM_RENDER_KERNELS = 1u << 6;
+    
+    template <unsigned Features>
+    void renderVoiceGroup(size_t first, AudioBuffer& buffer, size_t startFrame, size_t numFrames,
+                          const OscillatorLane* lanes, size_t laneCount, int unisonVoices,
+                          float outputGain);
+    using RenderKernel = void (Synthesizer::*)(size_t, AudioBuffer&, size_t, size_t, const OscillatorLane*,
+                                               size_t, int, float);
+    template <size_t... Features>
+    static std::array<RenderKernel, sizeof...(Features)> makeRenderKernels(std::index_sequence<Features...>) {
+        return {{&Synthesizer::renderVoiceGroup<Features>...}};
+    }
+    static const std::array<RenderKernel, NUM_RENDER_KERNELS> renderKernels_;
+    unsigned selectRenderFeatures() const;
+    unsigned renderFeatures_ = NUM_RENDER_KERNELS;  // None selected yet
+    RenderKernel renderKernel_ = nullptr;
+    
     // Track last played note for portamento
     uint8_t lastNote_ = 60;
     float lastPhaseIncrement_ = 0.0f;
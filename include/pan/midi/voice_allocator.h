@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace pan {
+
+/**
+ * Which sounding voice gives way when a note arrives at full polyphony.
+ */
+enum class StealPolicy {
+    Oldest,        // Longest-running voice
+    Quietest,      // Lowest reported level
+    SameNote,      // A voice already playing this note, else the oldest
+    ReleaseFirst   // The quietest released voice, else the oldest held one
+};
+
+/**
+ * Voice bookkeeping shared by the instruments.
+ *
+ * The allocator owns no audio; it tracks which of an instrument's voice slots
+ * are held, released, or fading out after being stolen, along with each one's
+ * start order and the level the instrument last reported. Polyphony caps the
+ * held and released voices; slots beyond it are headroom, so a stolen voice can
+ * fade out over a few milliseconds while the new note starts in a free slot.
+ * Only when no slot is free does a new note take over a voice outright.
+ *
+ * Not thread-safe; the instrument calls it from its render thread.
+ */
+class VoiceAllocator {
+public:
+    static constexpr size_t MAX_VOICES = 64;
+    static constexpr size_t NO_VOICE = static_cast<size_t>(-1);
+
+    enum class State { Free, Held, Released, Stolen };
+
+    struct Allocation {
+        size_t voice = NO_VOICE;   // Slot to start the new note in
+        size_t stolen = NO_VOICE;  // Voice to fade out quickly to make room
+    };
+
+    // numVoices slots (at most MAX_VOICES); polyphony starts at all of them
+    explicit VoiceAllocator(size_t numVoices);
+
+    size_t getNumVoices() const { return numVoices_; }
+
+    // Clamped to [1, getNumVoices()]
+    void setPolyphony(size_t polyphony);
+    size_t getPolyphony() const { return polyphony_; }
+
+    void setStealPolicy(StealPolicy policy) { policy_ = policy; }
+    StealPolicy getStealPolicy() const { return policy_; }
+
+    // Pick a slot for a new note, stealing per the policy when polyphony is full
+    Allocation allocate(uint8_t note);
+
+    // The note was let go; the voice sounds on but is first in line for ReleaseFirst
+    void release(size_t voice);
+    // The voice has gone silent and its slot is free again
+    void finish(size_t voice);
+    // Current loudness, for Quietest and ReleaseFirst
+    void setLevel(size_t voice, float level);
+    // Free every slot
+    void reset();
+
+    State getState(size_t voice) const { return slots_[voice].state; }
+    uint8_t getNote(size_t voice) const { return slots_[voice].note; }
+    // Held plus released voices, the ones polyphony limits
+    size_t getSoundingCount() const;
+    uint64_t getStealCount() const { return stealCount_; }
+
+private:
+    struct Slot {
+        State state = State::Free;
+        uint8_t note = 0;
+        uint64_t age = 0;  // Start order; lower is older
+        float level = 0.0f;
+    };
+
+    size_t pickVictim(uint8_t note) const;
+
+    std::array<Slot, MAX_VOICES> slots_;
+    size_t numVoices_;
+    size_t polyphony_;
+    StealPolicy policy_ = StealPolicy::Oldest;
+    uint64_t clock_ = 0;
+    uint64_t stealCount_ = 0;
+};
+
+} // namespace pan
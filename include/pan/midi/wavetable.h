@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "pan/midi/synthesizer.h"
+
+namespace pan {
+
+/**
+ * Band-limited, mipmapped wavetables for the basic Synthesizer waveforms.
+ *
+ * Each waveform has one table per octave, built by additive synthesis with
+ * only the harmonics that stay below Nyquist for that octave. lookup() picks
+ * the level from the phase increment and interpolates linearly between table
+ * points. The bank is built once and shared by every Synthesizer; it is
+ * read-only afterwards, so any number of audio threads can use it.
+ */
+class WavetableBank {
+public:
+    static constexpr size_t TABLE_SIZE = 2048;
+    static constexpr size_t NUM_LEVELS = 10;
+    static constexpr size_t MAX_HARMONICS = 512;  // Level 0; halved at every level above
+
+    // Built on first use (thread-safe)
+    static const WavetableBank& get();
+
+    // Sine, square, sawtooth and triangle have tables; noise does not
+    static bool hasTable(Waveform waveform) { return waveform != Waveform::Noise; }
+
+    // Table for a phase increment in cycles per sample: the first level whose
+    // top harmonic stays below Nyquist
+    static size_t selectLevel(float phaseIncrement) {
+        // ceil(log2(increment * 2 * MAX_HARMONICS)), read straight from the float's exponent
+        float scaled = std::fabs(phaseIncrement) * static_cast<float>(2 * MAX_HARMONICS);
+        if (!(scaled > 1.0f)) {
+            return 0;
+        }
+        uint32_t bits;
+        std::memcpy(&bits, &scaled, sizeof(bits));
+        int exponent = static_cast<int>(bits >> 23) - 127;
+        int level = exponent + ((bits & 0x7FFFFF) != 0 ? 1 : 0);
+        return level < static_cast<int>(NUM_LEVELS) ? static_cast<size_t>(level) : NUM_LEVELS - 1;
+    }
+
+    // TABLE_SIZE + 1 points; the last repeats the first so lookups never wrap
+    const float* getTable(Waveform waveform, size_t level) const {
+        if (level >= NUM_LEVELS) {
+            level = NUM_LEVELS - 1;
+        }
+        return tables_[waveformIndex(waveform) * NUM_LEVELS + level].data();
+    }
+
+    // phase in [0, 1)
+    float lookup(Waveform waveform, float phase, float phaseIncrement) const {
+        const float* table = getTable(waveform, selectLevel(phaseIncrement));
+        float position = phase * static_cast<float>(TABLE_SIZE);
+        size_t index = static_cast<size_t>(position);
+        if (index >= TABLE_SIZE) {
+            index = TABLE_SIZE - 1;
+        }
+        float frac = position - static_cast<float>(index);
+        return table[index] + frac * (table[index + 1] - table[index]);
+    }
+
+private:
+    WavetableBank();
+
+    using Table = std::array<float, TABLE_SIZE + 1>;
+    static constexpr size_t NUM_WAVEFORMS = 4;
+
+    static size_t waveformIndex(Waveform waveform) {
+        switch (waveform) {
+            case Waveform::Square: return 1;
+            case Waveform::Sawtooth: return 2;
+            case Waveform::Triangle: return 3;
+            default: return 0;
+        }
+    }
+    void buildLevels(size_t waveformSlot, float (*harmonicAmplitude)(size_t), bool cosine);
+
+    std::vector<Table> tables_;  // NUM_WAVEFORMS x NUM_LEVELS
+};
+
+} // namespace pan
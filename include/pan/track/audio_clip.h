@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -32,6 +33,10 @@ public:
     
     bool hasAudioData() const { return audioData_ != nullptr; }
     
+    // Identifies the audio data: every setAudioData() call gets a new id, never
+    // reused within the process, so a cached render can tell a clip's take changed
+    uint64_t getContentId() const { return contentId_; }
+    
     // Playback state
     bool isPlaying() const { return isPlaying_; }
     void setPlaying(bool playing) { isPlaying_ = playing; }
@@ -46,6 +51,7 @@ private:
     int64_t endTime_;    // End position in timeline (samples)
     
     std::shared_ptr<AudioBuffer> audioData_;  // The actual audio samples
+    uint64_t contentId_ = 0;
     bool isPlaying_;
     float gain_;  // Clip gain (0.0 to 2.0)
 };
@@ -11,6 +11,7 @@ namespace pan {
 class MidiClip;
 class Synthesizer;
 class EffectChain;
+class ScratchArena;
 
 /**
  * Represents a single audio track in the project
@@ -62,8 +63,14 @@ public:
     void addEffect(std::shared_ptr<EffectChain> effect);
     std::shared_ptr<EffectChain> getEffectChain() const { return effectChain_; }
 
-    // Processing
-    void process(AudioBuffer& buffer, size_t numFrames);
+    // Allocate the fallback buffer process() uses when no arena is passed or the
+    // arena runs dry. Not real-time safe; call before the stream starts.
+    void prepare(size_t numChannels, size_t maxFrames);
+
+    // Processing. Temporaries are borrowed from scratch when given, otherwise from
+    // the buffer allocated by prepare(); process() itself never allocates. MIDI
+    // audio is skipped for a block when neither has room for it.
+    void process(AudioBuffer& buffer, size_t numFrames, ScratchArena* scratch = nullptr);
     
     // MIDI synthesizer initialization
     void initializeSynthesizer(double sampleRate);
@@ -80,6 +87,7 @@ private:
     std::vector<std::shared_ptr<MidiClip>> midiClips_;
     std::shared_ptr<Synthesizer> synthesizer_;  // For MIDI tracks
     std::shared_ptr<EffectChain> effectChain_;
+    std::unique_ptr<AudioBuffer> fallbackBuffer_;  // Sized by prepare()
 };
 
 } // namespace pan
@@ -23,8 +23,8 @@ public:
     std::shared_ptr<Track> getTrack(size_t index) const;
     size_t getTrackCount() const { return tracks_.size(); }
 
-    // Processing
-    void processAllTracks(class AudioBuffer& buffer, size_t numFrames);
+    // Processing. Tracks borrow their temporaries from scratch when given.
+    void processAllTracks(class AudioBuffer& buffer, size_t numFrames, class ScratchArena* scratch = nullptr);
 
 private:
     std::vector<std::shared_ptr<Track>> tracks_;
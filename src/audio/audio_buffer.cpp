@@ -1,74 +1,258 @@
 #include "pan/audio/audio_buffer.h"
+#include "pan/audio/buffer_kernels.h"
 #include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <new>
 
 namespace pan {
 
-AudioBuffer::AudioBuffer(size_t numChannels, size_t numFrames)
-    : numChannels_(numChannels)
+static size_t paddedStride(size_t numFrames) {
+    const size_t floatsPerLine = AudioBuffer::ALIGNMENT / sizeof(float);
+    return (numFrames + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+}
+
+AudioBuffer::AudioBuffer(size_t numChannels, size_t numFrames) {
+    allocate(numChannels, numFrames);
+}
+
+AudioBuffer::AudioBuffer(float* data, size_t numChannels, size_t numFrames, size_t stride)
+    : data_(data)
+    , numChannels_(numChannels)
     , numFrames_(numFrames)
-    , channels_(numChannels)
+    , capacity_(numFrames)
+    , stride_(stride)
+    , ownsData_(false)
 {
-    for (auto& channel : channels_) {
-        channel.resize(numFrames, 0.0f);
+}
+
+AudioBuffer::~AudioBuffer() {
+    release();
+}
+
+AudioBuffer::AudioBuffer(const AudioBuffer& other) {
+    allocate(other.numChannels_, other.numFrames_);
+    copyFrom(other);
+}
+
+AudioBuffer& AudioBuffer::operator=(const AudioBuffer& other) {
+    if (this != &other) {
+        release();
+        allocate(other.numChannels_, other.numFrames_);
+        copyFrom(other);
     }
+    return *this;
+}
+
+AudioBuffer::AudioBuffer(AudioBuffer&& other) noexcept
+    : data_(other.data_)
+    , numChannels_(other.numChannels_)
+    , numFrames_(other.numFrames_)
+    , capacity_(other.capacity_)
+    , stride_(other.stride_)
+    , ownsData_(other.ownsData_)
+{
+    other.data_ = nullptr;
+    other.numChannels_ = other.numFrames_ = other.capacity_ = other.stride_ = 0;
+    other.ownsData_ = false;
+}
+
+AudioBuffer& AudioBuffer::operator=(AudioBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = other.data_;
+        numChannels_ = other.numChannels_;
+        numFrames_ = other.numFrames_;
+        capacity_ = other.capacity_;
+        stride_ = other.stride_;
+        ownsData_ = other.ownsData_;
+        other.data_ = nullptr;
+        other.numChannels_ = other.numFrames_ = other.capacity_ = other.stride_ = 0;
+        other.ownsData_ = false;
+    }
+    return *this;
+}
+
+void AudioBuffer::allocate(size_t numChannels, size_t numFrames) {
+    numChannels_ = numChannels;
+    numFrames_ = numFrames;
+    capacity_ = numFrames;
+    stride_ = paddedStride(numFrames);
+    ownsData_ = true;
+
+    size_t totalFloats = numChannels_ * stride_;
+    if (totalFloats == 0) {
+        data_ = nullptr;
+        return;
+    }
+    data_ = static_cast<float*>(::operator new(totalFloats * sizeof(float), std::align_val_t(ALIGNMENT)));
+    std::memset(data_, 0, totalFloats * sizeof(float));
+}
+
+void AudioBuffer::release() {
+    if (ownsData_ && data_) {
+        ::operator delete(data_, std::align_val_t(ALIGNMENT));
+    }
+    data_ = nullptr;
+    ownsData_ = false;
+}
+
+size_t AudioBuffer::clipLength(size_t startFrame, size_t numFrames) const {
+    if (startFrame >= numFrames_) {
+        return 0;
+    }
+    return std::min(numFrames, numFrames_ - startFrame);
+}
+
+bool AudioBuffer::setNumFrames(size_t numFrames) {
+    if (numFrames > capacity_) {
+        return false;
+    }
+    numFrames_ = numFrames;
+    return true;
+}
+
+AudioBuffer AudioBuffer::createView(size_t offset, size_t length) {
+    offset = std::min(offset, numFrames_);
+    length = clipLength(offset, length);
+    return AudioBuffer(data_ ? data_ + offset : nullptr, numChannels_, length, stride_);
 }
 
 float* AudioBuffer::getWritePointer(size_t channel) {
     if (channel >= numChannels_) {
         return nullptr;
     }
-    return channels_[channel].data();
+    return data_ + channel * stride_;
 }
 
 const float* AudioBuffer::getReadPointer(size_t channel) const {
     if (channel >= numChannels_) {
         return nullptr;
     }
-    return channels_[channel].data();
+    return data_ + channel * stride_;
 }
 
-std::vector<float>& AudioBuffer::getChannel(size_t channel) {
-    return channels_[channel];
+void AudioBuffer::clear() {
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        kernels::clear(getWritePointer(ch), numFrames_);
+    }
 }
 
-const std::vector<float>& AudioBuffer::getChannel(size_t channel) const {
-    return channels_[channel];
+void AudioBuffer::fill(float value) {
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        kernels::fill(getWritePointer(ch), value, numFrames_);
+    }
 }
 
-void AudioBuffer::clear() {
-    for (auto& channel : channels_) {
-        std::fill(channel.begin(), channel.end(), 0.0f);
+void AudioBuffer::applyGain(float gain) {
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        kernels::scale(getWritePointer(ch), gain, numFrames_);
     }
 }
 
-void AudioBuffer::fill(float value) {
-    for (auto& channel : channels_) {
-        std::fill(channel.begin(), channel.end(), value);
+void AudioBuffer::applyGainRamp(float startGain, float endGain) {
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        kernels::scaleRamp(getWritePointer(ch), startGain, endGain, numFrames_);
     }
 }
 
 void AudioBuffer::copyFrom(const AudioBuffer& other) {
-    if (numChannels_ != other.numChannels_ || numFrames_ != other.numFrames_) {
+    size_t channels = std::min(numChannels_, other.numChannels_);
+    size_t frames = std::min(numFrames_, other.numFrames_);
+    for (size_t ch = 0; ch < channels; ++ch) {
+        kernels::copy(getWritePointer(ch), other.getReadPointer(ch), frames);
+    }
+}
+
+void AudioBuffer::addFrom(const AudioBuffer& other, float gain) {
+    size_t channels = std::min(numChannels_, other.numChannels_);
+    size_t frames = std::min(numFrames_, other.numFrames_);
+    for (size_t ch = 0; ch < channels; ++ch) {
+        kernels::add(getWritePointer(ch), other.getReadPointer(ch), gain, frames);
+    }
+}
+
+void AudioBuffer::addFromWithRamp(const AudioBuffer& other, float startGain, float endGain) {
+    size_t channels = std::min(numChannels_, other.numChannels_);
+    size_t frames = std::min(numFrames_, other.numFrames_);
+    for (size_t ch = 0; ch < channels; ++ch) {
+        kernels::addRamp(getWritePointer(ch), other.getReadPointer(ch), startGain, endGain, frames);
+    }
+}
+
+void AudioBuffer::clear(size_t channel, size_t startFrame, size_t numFrames) {
+    size_t frames = clipLength(startFrame, numFrames);
+    if (channel < numChannels_ && frames > 0) {
+        kernels::clear(getWritePointer(channel) + startFrame, frames);
+    }
+}
+
+void AudioBuffer::applyGain(size_t channel, size_t startFrame, size_t numFrames, float gain) {
+    size_t frames = clipLength(startFrame, numFrames);
+    if (channel < numChannels_ && frames > 0) {
+        kernels::scale(getWritePointer(channel) + startFrame, gain, frames);
+    }
+}
+
+void AudioBuffer::applyGainRamp(size_t channel, size_t startFrame, size_t numFrames, float startGain, float endGain) {
+    size_t frames = clipLength(startFrame, numFrames);
+    if (channel < numChannels_ && frames > 0) {
+        kernels::scaleRamp(getWritePointer(channel) + startFrame, startGain, endGain, frames);
+    }
+}
+
+void AudioBuffer::copyFrom(size_t destChannel, size_t destStartFrame, const AudioBuffer& source,
+                           size_t sourceChannel, size_t sourceStartFrame, size_t numFrames) {
+    if (destChannel >= numChannels_ || sourceChannel >= source.numChannels_) {
         return;
     }
-    
-    for (size_t i = 0; i < numChannels_; ++i) {
-        std::copy(other.channels_[i].begin(), other.channels_[i].end(), channels_[i].begin());
+    size_t frames = std::min(clipLength(destStartFrame, numFrames), source.clipLength(sourceStartFrame, numFrames));
+    if (frames == 0) {
+        return;
     }
+    kernels::copy(getWritePointer(destChannel) + destStartFrame,
+                  source.getReadPointer(sourceChannel) + sourceStartFrame, frames);
 }
 
-void AudioBuffer::addFrom(const AudioBuffer& other, float gain) {
-    if (numChannels_ != other.numChannels_ || numFrames_ != other.numFrames_) {
+void AudioBuffer::addFrom(size_t destChannel, size_t destStartFrame, const AudioBuffer& source,
+                          size_t sourceChannel, size_t sourceStartFrame, size_t numFrames, float gain) {
+    if (destChannel >= numChannels_ || sourceChannel >= source.numChannels_) {
         return;
     }
-    
-    for (size_t i = 0; i < numChannels_; ++i) {
-        for (size_t j = 0; j < numFrames_; ++j) {
-            channels_[i][j] += other.channels_[i][j] * gain;
-        }
+    size_t frames = std::min(clipLength(destStartFrame, numFrames), source.clipLength(sourceStartFrame, numFrames));
+    if (frames == 0) {
+        return;
     }
+    kernels::add(getWritePointer(destChannel) + destStartFrame,
+                 source.getReadPointer(sourceChannel) + sourceStartFrame, gain, frames);
 }
 
-} // namespace pan
+float AudioBuffer::getPeak(size_t channel) const {
+    return getPeak(channel, 0, numFrames_);
+}
+
+float AudioBuffer::getPeak(size_t channel, size_t startFrame, size_t numFrames) const {
+    size_t frames = clipLength(startFrame, numFrames);
+    if (channel >= numChannels_ || frames == 0) {
+        return 0.0f;
+    }
+    return kernels::peak(getReadPointer(channel) + startFrame, frames);
+}
+
+float AudioBuffer::getRMS(size_t channel) const {
+    return getRMS(channel, 0, numFrames_);
+}
 
+float AudioBuffer::getRMS(size_t channel, size_t startFrame, size_t numFrames) const {
+    if (channel >= numChannels_) {
+        return 0.0f;
+    }
+    size_t frames = clipLength(startFrame, numFrames);
+    if (frames == 0) {
+        return 0.0f;
+    }
+    double sum = kernels::sumSquares(getReadPointer(channel) + startFrame, frames);
+    return static_cast<float>(std::sqrt(sum / static_cast<double>(frames)));
+}
+
+} // namespace pan
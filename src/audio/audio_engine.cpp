@@ -1,9 +1,18 @@
 #include "pan/audio/audio_engine.h"
 #include "pan/audio/audio_buffer.h"
 #include "pan/audio/audio_device.h"
+#include "pan/audio/render_pool.h"
+#include "pan/audio/scratch_arena.h"
+#include "pan/audio/rt_alloc_check.h"
+#include "pan/audio/realtime_handoff.h"
+#include "pan/audio/device_io.h"
+#include "pan/audio/realtime_thread.h"
+#include "pan/audio/callback_stats.h"
+#include "pan/audio/audio_recorder.h"
 #include <iostream>
 #include <thread>
-#include <mutex>
+#include <chrono>
+#include <algorithm>
 #include <cmath>
 #include <string>
 #include <cstring>
@@ -20,26 +29,145 @@ public:
     double sampleRate = 44100.0;
     size_t bufferSize = 512;
     bool running = false;
-    ProcessCallback processCallback;
-    std::mutex callbackMutex;  // Always available for thread safety
+    SampleRateListener sampleRateListener;
+
+    // Set the rate, telling the listener if it changed
+    void changeSampleRate(double rate) {
+        if (rate == sampleRate) {
+            return;
+        }
+        sampleRate = rate;
+        if (sampleRateListener) {
+            sampleRateListener(rate);
+        }
+    }
+
+    std::atomic<bool> renderingOffline{false};
+    // Swapped without locks; replaced callbacks are freed by collectGarbage()
+    RealtimeHandoff<ProcessCallback> processCallback;
+    RenderPool renderPool;
+    ScratchArena scratchArena;
+    size_t maxTrackCount = 128;
     
-#ifdef PAN_USE_PORTAUDIO
-    PaStream* stream = nullptr;
+    // PortAudio may deliver larger blocks than requested - keep the same
+    // headroom as the device buffers
+    size_t maxBlockSize() const {
+        return std::max<size_t>(bufferSize, 512) * 2;
+    }
+    
+    bool prepareScratch(size_t numChannels, size_t maxFrames) {
+        // A few spare buffers for master-bus temporaries
+        size_t numBuffers = maxTrackCount * SCRATCH_BUFFERS_PER_TRACK + 4;
+        return scratchArena.prepare(numChannels, maxFrames, numBuffers);
+    }
+    
+    // Planar staging buffers between the device's interleaved buffers and the
+    // process callback. Sized once for maxBlockSize(); larger device blocks are
+    // processed in chunks rather than reallocating on the audio thread.
     std::unique_ptr<AudioBuffer> inputBuffer;
     std::unique_ptr<AudioBuffer> outputBuffer;
+    DeviceIoConverter deviceIo;
+    size_t deviceChannels = 2;
+    
+    // Stream configuration (see StreamConfig) and what the open stream negotiated
+    StreamConfig::HostApi hostApi = StreamConfig::HostApi::Default;
+    double suggestedLatency = 0.0;
+    bool duplex = false;
+    size_t streamOutputChannels = 2;
+    size_t streamInputChannels = 0;
+    StreamInfo streamInfo;
+    
+    // Real-time setup. The audio thread applies the policy itself on its first
+    // callback; the report is published through audioThreadConfigured.
+    RealtimeThreadPolicy realtimePolicy;
+    RealtimeThreadReport audioThreadReport;
+    std::atomic<bool> audioThreadConfigured{false};
+    CallbackStats callbackStats;
+    AudioRecorder recorder;
+    bool memoryLocked = false;
+    size_t lockedBytes = 0;
+    int memoryLockError = 0;
+    
+    // Every buffer the callback touches that the engine owns
+    template <typename Fn>
+    void forEachDspBuffer(Fn&& fn) {
+        fn(inputBuffer.get());
+        fn(outputBuffer.get());
+        for (size_t i = 0; i < scratchArena.getNumBuffers(); ++i) {
+            fn(scratchArena.getBuffer(i));
+        }
+    }
     
-    Impl() : inputBuffer(nullptr), outputBuffer(nullptr) {}
+    // Page-lock the DSP buffers. Call unlockDspMemory() before anything that
+    // may reallocate them, so freed pages don't stay locked.
+    void lockDspMemory() {
+        memoryLocked = false;
+        lockedBytes = 0;
+        memoryLockError = 0;
+        if (!realtimePolicy.lockMemory) {
+            return;
+        }
+        bool ok = true;
+        forEachDspBuffer([&](const AudioBuffer* buffer) {
+            if (buffer && ok) {
+                ok = realtime::lockBuffer(*buffer, &memoryLockError);
+                if (ok) {
+                    lockedBytes += realtime::getBufferBytes(*buffer);
+                }
+            }
+        });
+        memoryLocked = ok;
+        if (!ok) {
+            std::cerr << "AudioEngine: could not lock DSP memory (" << std::strerror(memoryLockError)
+                      << ") - check the memlock limit" << std::endl;
+        }
+    }
     
-    void initializeBuffers(size_t numChannels, size_t numFrames) {
-        inputBuffer = std::make_unique<AudioBuffer>(numChannels, numFrames);
-        outputBuffer = std::make_unique<AudioBuffer>(numChannels, numFrames);
+    void unlockDspMemory() {
+        if (!memoryLocked && lockedBytes == 0) {
+            return;
+        }
+        forEachDspBuffer([](const AudioBuffer* buffer) {
+            if (buffer) {
+                realtime::unlockBuffer(*buffer);
+            }
+        });
+        memoryLocked = false;
+        lockedBytes = 0;
+    }
+    
+    // The process callback always sees at least a stereo bus
+    void prepareDeviceBuffers(size_t numChannels, size_t maxFrames) {
+        numChannels = std::max<size_t>(numChannels, 2);
+        if (!outputBuffer || outputBuffer->getNumChannels() != numChannels ||
+            outputBuffer->getCapacity() < maxFrames) {
+            inputBuffer = std::make_unique<AudioBuffer>(numChannels, maxFrames);
+            outputBuffer = std::make_unique<AudioBuffer>(numChannels, maxFrames);
+        }
     }
-#else
-    Impl() = default;
+    
+#ifdef PAN_USE_PORTAUDIO
+    PaStream* stream = nullptr;
 #endif
 };
 
+#ifdef PAN_USE_PORTAUDIO
+static PaSampleFormat toPaSampleFormat(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Int16: return paInt16;
+        case SampleFormat::Int24: return paInt24;
+        case SampleFormat::Int32: return paInt32;
+        case SampleFormat::Float32: break;
+    }
+    return paFloat32;
+}
+#endif
+
 AudioEngine::AudioEngine() : pImpl(std::make_unique<Impl>()) {
+    // Leave one core for the GUI and the rest of the system
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    size_t workers = hardwareThreads > 1 ? std::min<size_t>(hardwareThreads - 1, 4) : 0;
+    pImpl->renderPool.setNumThreads(workers);
 }
 
 AudioEngine::~AudioEngine() {
@@ -55,9 +183,7 @@ bool AudioEngine::initialize() {
     }
     std::cout << "AudioEngine: Initialized with PortAudio" << std::endl;
     
-    // Initialize buffers with maximum expected size (bufferSize might be adjusted by PortAudio)
-    // Use a larger size to handle variable frame sizes in callbacks
-    pImpl->initializeBuffers(2, pImpl->bufferSize * 2);
+    pImpl->prepareDeviceBuffers(pImpl->deviceChannels, pImpl->maxBlockSize());
     
     return true;
 #else
@@ -70,6 +196,7 @@ void AudioEngine::shutdown() {
     if (pImpl->running) {
         stop();
     }
+    pImpl->unlockDspMemory();
     pImpl->currentDevice.reset();
     
 #ifdef PAN_USE_PORTAUDIO
@@ -112,20 +239,34 @@ bool AudioEngine::start() {
     if (pImpl->running) {
         return true;
     }
+    if (pImpl->renderingOffline) {
+        std::cerr << "Cannot start audio engine while an offline render is in progress" << std::endl;
+        return false;
+    }
+    // The buffers may be reallocated for a new track count or block size
+    pImpl->unlockDspMemory();
+    if (!pImpl->prepareScratch(2, pImpl->maxBlockSize())) {
+        return false;
+    }
+    pImpl->prepareDeviceBuffers(pImpl->deviceChannels, pImpl->maxBlockSize());
+    pImpl->lockDspMemory();
+    pImpl->renderPool.setRealtimePolicy(pImpl->realtimePolicy);
+    pImpl->audioThreadConfigured = false;
+    pImpl->callbackStats.reset();
     
 #ifdef PAN_USE_PORTAUDIO
-    if (!pImpl->processCallback) {
+    if (!hasProcessCallback()) {
         std::cerr << "Cannot start audio engine: no process callback set" << std::endl;
         return false;
     }
     
-    // List available host APIs and prefer PulseAudio (which works with PipeWire)
+    // List available host APIs
     int numHostApis = Pa_GetHostApiCount();
     PaHostApiIndex pulseApiIndex = -1;
     PaHostApiIndex alsaApiIndex = -1;
+    PaHostApiIndex jackApiIndex = -1;
     
     std::cout << "Available PortAudio host APIs:" << std::endl;
-    PaHostApiIndex jackApiIndex = -1;
     for (int i = 0; i < numHostApis; ++i) {
         const PaHostApiInfo* apiInfo = Pa_GetHostApiInfo(i);
         if (apiInfo) {
@@ -144,32 +285,45 @@ bool AudioEngine::start() {
         }
     }
     
-    // Use PulseAudio backend if available - it's designed to work with PipeWire
-    // and won't interfere with system audio like direct ALSA can
     PaHostApiIndex preferredApi = -1;
-    if (pulseApiIndex >= 0) {
-        preferredApi = pulseApiIndex;
-        std::cout << "Using PulseAudio API (compatible with PipeWire, won't interfere with system audio)" << std::endl;
-    } else if (alsaApiIndex >= 0) {
-        preferredApi = alsaApiIndex;
-        std::cout << "Using ALSA API (fallback)" << std::endl;
-    } else if (numHostApis > 0) {
-        // Fallback to first available API
-        preferredApi = 0;
-    }
-    
-    if (preferredApi >= 0) {
-        const PaHostApiInfo* apiInfo = Pa_GetHostApiInfo(preferredApi);
-        std::cout << "Using host API: " << apiInfo->name << std::endl;
-    } else {
+    switch (pImpl->hostApi) {
+        case StreamConfig::HostApi::Jack: preferredApi = jackApiIndex; break;
+        case StreamConfig::HostApi::Alsa: preferredApi = alsaApiIndex; break;
+        case StreamConfig::HostApi::Pulse: preferredApi = pulseApiIndex; break;
+        case StreamConfig::HostApi::Default: break;
+    }
+    if (preferredApi < 0 && pImpl->hostApi != StreamConfig::HostApi::Default) {
+        std::cerr << "Requested host API " << getHostApiName(pImpl->hostApi)
+                  << " is not available, falling back to the default" << std::endl;
+    }
+    
+    // By default use PulseAudio if available - it's designed to work with PipeWire
+    // and won't interfere with system audio like direct ALSA can
+    if (preferredApi < 0) {
+        if (pulseApiIndex >= 0) {
+            preferredApi = pulseApiIndex;
+        } else if (alsaApiIndex >= 0) {
+            preferredApi = alsaApiIndex;
+        } else if (numHostApis > 0) {
+            preferredApi = 0;
+        }
+    }
+    
+    const PaHostApiInfo* hostApiInfo = preferredApi >= 0 ? Pa_GetHostApiInfo(preferredApi) : nullptr;
+    if (!hostApiInfo) {
         std::cerr << "No suitable host API found!" << std::endl;
         return false;
     }
+    std::cout << "Using host API: " << hostApiInfo->name << std::endl;
+    const bool isPulse = preferredApi == pulseApiIndex;
     
+    // Open the chosen host API's default device; the global default belongs to
+    // whichever API PortAudio lists first
     PaStreamParameters outputParameters;
-    // Use the default device - PipeWire will handle routing
-    // Don't try to select a specific device as that can interfere
-    outputParameters.device = Pa_GetDefaultOutputDevice();
+    outputParameters.device = hostApiInfo->defaultOutputDevice;
+    if (outputParameters.device == paNoDevice) {
+        outputParameters.device = Pa_GetDefaultOutputDevice();
+    }
     if (outputParameters.device == paNoDevice) {
         std::cerr << "No default output device found" << std::endl;
         return false;
@@ -180,55 +334,75 @@ bool AudioEngine::start() {
     std::cout << "Max output channels: " << deviceInfo->maxOutputChannels << std::endl;
     std::cout << "Device default sample rate: " << deviceInfo->defaultSampleRate << std::endl;
     
-    // Use the device's default sample rate (JACK uses 48000, ALSA often uses 44100)
-    if (deviceInfo->defaultSampleRate > 0) {
-        std::cout << "Setting sample rate from " << pImpl->sampleRate << " to " << deviceInfo->defaultSampleRate << std::endl;
-        pImpl->sampleRate = deviceInfo->defaultSampleRate;  // Keep as double
-        std::cout << "Sample rate is now: " << pImpl->sampleRate << " Hz" << std::endl;
-    } else {
-        std::cerr << "WARNING: Device default sample rate is invalid: " << deviceInfo->defaultSampleRate << std::endl;
+    size_t outputChannels = pImpl->deviceChannels;
+    if (deviceInfo->maxOutputChannels > 0 && outputChannels > static_cast<size_t>(deviceInfo->maxOutputChannels)) {
+        std::cerr << "Device supports " << deviceInfo->maxOutputChannels << " output channels, requested "
+                  << outputChannels << std::endl;
+        outputChannels = static_cast<size_t>(deviceInfo->maxOutputChannels);
     }
     
-    outputParameters.channelCount = 2;
-    outputParameters.sampleFormat = paFloat32;
-    // Use default high latency - this is safer and won't interfere with system audio
-    // Low latency can cause conflicts with PipeWire's buffer management
-    outputParameters.suggestedLatency = deviceInfo->defaultHighOutputLatency;
+    // Pulse/PipeWire keeps its high default latency - low latency there can fight
+    // PipeWire's own buffer management. JACK and ALSA go as low as the device allows.
+    outputParameters.channelCount = static_cast<int>(outputChannels);
+    outputParameters.sampleFormat = toPaSampleFormat(pImpl->deviceIo.getFormat());
+    if (pImpl->suggestedLatency > 0.0) {
+        outputParameters.suggestedLatency = pImpl->suggestedLatency;
+    } else {
+        outputParameters.suggestedLatency = isPulse ? deviceInfo->defaultHighOutputLatency
+                                                    : deviceInfo->defaultLowOutputLatency;
+    }
     outputParameters.hostApiSpecificStreamInfo = nullptr;
     
-    // Open output-only stream (input is optional)
     PaStreamParameters* inputParameters = nullptr;
     PaStreamParameters inputParams;
-    PaDeviceIndex inputDevice = paNoDevice;
-    if (preferredApi >= 0) {
-        const PaHostApiInfo* apiInfo = Pa_GetHostApiInfo(preferredApi);
-        inputDevice = apiInfo->defaultInputDevice;
-    } else {
-        inputDevice = Pa_GetDefaultInputDevice();
+    const PaDeviceInfo* inputInfo = nullptr;
+    size_t inputChannels = 0;
+    if (pImpl->duplex) {
+        PaDeviceIndex inputDevice = hostApiInfo->defaultInputDevice;
+        if (inputDevice == paNoDevice) {
+            inputDevice = Pa_GetDefaultInputDevice();
+        }
+        inputInfo = inputDevice != paNoDevice ? Pa_GetDeviceInfo(inputDevice) : nullptr;
+        if (inputInfo && inputInfo->maxInputChannels > 0) {
+            inputChannels = std::min(pImpl->deviceChannels, static_cast<size_t>(inputInfo->maxInputChannels));
+            inputParams.device = inputDevice;
+            inputParams.channelCount = static_cast<int>(inputChannels);
+            inputParams.sampleFormat = outputParameters.sampleFormat;
+            if (pImpl->suggestedLatency > 0.0) {
+                inputParams.suggestedLatency = pImpl->suggestedLatency;
+            } else {
+                inputParams.suggestedLatency = isPulse ? inputInfo->defaultHighInputLatency
+                                                       : inputInfo->defaultLowInputLatency;
+            }
+            inputParams.hostApiSpecificStreamInfo = nullptr;
+            inputParameters = &inputParams;
+            std::cout << "Input device: " << inputInfo->name << std::endl;
+        } else {
+            std::cerr << "Duplex requested but no input device found - opening output only" << std::endl;
+            inputInfo = nullptr;
+        }
     }
     
-    if (inputDevice != paNoDevice) {
-        inputParams.device = inputDevice;
-        inputParams.channelCount = 2;
-        inputParams.sampleFormat = paFloat32;
-        inputParams.suggestedLatency = Pa_GetDeviceInfo(inputDevice)->defaultLowInputLatency;
-        inputParams.hostApiSpecificStreamInfo = nullptr;
-        inputParameters = &inputParams;
+    // Honor the configured sample rate; only fall back to the device default if the device refuses it
+    double sampleRate = pImpl->sampleRate;
+    PaError supported = Pa_IsFormatSupported(inputParameters, &outputParameters, sampleRate);
+    if (supported != paFormatIsSupported && deviceInfo->defaultSampleRate > 0) {
+        std::cerr << "Sample rate " << sampleRate << " Hz not supported (" << Pa_GetErrorText(supported)
+                  << "), using device default " << deviceInfo->defaultSampleRate << " Hz" << std::endl;
+        sampleRate = deviceInfo->defaultSampleRate;
     }
     
-    std::cout << "Opening stream with callback at: " << (void*)audioCallback << std::endl;
-    // Use a reasonable buffer size that won't interfere with system audio
-    // 512 frames is a good balance - not too small (causes underruns) not too large (interferes)
-    unsigned long framesPerBuffer = 512;
-    std::cout << "Using buffer size: " << framesPerBuffer << " frames" << std::endl;
-    
-    std::cout << "Opening stream with sample rate: " << pImpl->sampleRate << " Hz" << std::endl;
+    unsigned long framesPerBuffer = pImpl->bufferSize > 0 ? static_cast<unsigned long>(pImpl->bufferSize)
+                                                          : paFramesPerBufferUnspecified;
+    std::cout << "Opening stream: " << sampleRate << " Hz, " << pImpl->bufferSize << " frames, "
+              << getSampleFormatName(pImpl->deviceIo.getFormat()) << ", suggested latency "
+              << outputParameters.suggestedLatency << "s" << (inputParameters ? ", duplex" : "") << std::endl;
     
     PaError err = Pa_OpenStream(
         &pImpl->stream,
-        nullptr,  // No input - output only
+        inputParameters,
         &outputParameters,
-        pImpl->sampleRate,
+        sampleRate,
         framesPerBuffer,
         paClipOff,
         audioCallback,
@@ -241,20 +415,36 @@ bool AudioEngine::start() {
         return false;
     }
     
-    std::cout << "Stream opened successfully!" << std::endl;
-    
-    // Check what buffer size PortAudio actually chose
+    // Record what the host actually negotiated
     const PaStreamInfo* streamInfo = Pa_GetStreamInfo(pImpl->stream);
+    const double configuredRate = pImpl->sampleRate;
+    pImpl->sampleRate = streamInfo && streamInfo->sampleRate > 0 ? streamInfo->sampleRate : sampleRate;
+    pImpl->streamOutputChannels = outputChannels;
+    pImpl->streamInputChannels = inputChannels;
+    
+    StreamInfo& info = pImpl->streamInfo;
+    info = StreamInfo{};
+    info.open = true;
+    info.hostApiName = hostApiInfo->name;
+    info.outputDeviceName = deviceInfo->name;
+    info.inputDeviceName = inputInfo ? inputInfo->name : "";
+    info.sampleRate = pImpl->sampleRate;
+    info.bufferSize = pImpl->bufferSize;
+    info.numOutputChannels = outputChannels;
+    info.numInputChannels = inputChannels;
     if (streamInfo) {
-        std::cout << "Actual stream latency - input: " << streamInfo->inputLatency 
-                  << "s, output: " << streamInfo->outputLatency << "s" << std::endl;
+        info.outputLatency = streamInfo->outputLatency;
+        info.inputLatency = streamInfo->inputLatency;
     }
+    std::cout << "Stream latency - input: " << info.inputLatency
+              << "s, output: " << info.outputLatency << "s" << std::endl;
     
     err = Pa_StartStream(pImpl->stream);
     if (err != paNoError) {
         std::cerr << "Failed to start audio stream: " << Pa_GetErrorText(err) << std::endl;
         Pa_CloseStream(pImpl->stream);
         pImpl->stream = nullptr;
+        pImpl->streamInfo = StreamInfo{};
         return false;
     }
     
@@ -274,18 +464,17 @@ bool AudioEngine::start() {
         std::cerr << "Warning: Stream reports as stopped!" << std::endl;
     }
     
-    // Get stream info (already got it above, but get again to show final state)
-    const PaStreamInfo* finalStreamInfo = Pa_GetStreamInfo(pImpl->stream);
-    if (finalStreamInfo) {
-        std::cout << "Stream latency - input: " << finalStreamInfo->inputLatency 
-                  << "s, output: " << finalStreamInfo->outputLatency << "s" << std::endl;
-    }
-    
     pImpl->running = true;
     std::cout << "AudioEngine: Started (Sample Rate: " << pImpl->sampleRate 
               << ", Buffer Size: " << pImpl->bufferSize << ")" << std::endl;
+    // Set before the stream started, since the callback reads it; reported now it's running
+    if (pImpl->sampleRate != configuredRate && pImpl->sampleRateListener) {
+        pImpl->sampleRateListener(pImpl->sampleRate);
+    }
     return true;
 #else
+    pImpl->streamOutputChannels = pImpl->deviceChannels;
+    pImpl->streamInputChannels = pImpl->duplex ? pImpl->deviceChannels : 0;  // As if the input opened
     pImpl->running = true;
     std::cout << "AudioEngine: Started (no audio backend - PortAudio not found)" << std::endl;
     return true;
@@ -317,7 +506,12 @@ bool AudioEngine::stop() {
     }
 #endif
     
+    // No more input is coming; finish any take in progress
+    pImpl->recorder.stop();
+    
+    pImpl->streamInfo = StreamInfo{};
     pImpl->running = false;
+    pImpl->processCallback.collectGarbage();
     std::cout << "AudioEngine: Stopped" << std::endl;
     return true;
 }
@@ -327,70 +521,366 @@ bool AudioEngine::isRunning() const {
 }
 
 void AudioEngine::setSampleRate(double sampleRate) {
-    if (pImpl->running) {
+    if (pImpl->running || pImpl->renderingOffline) {
         std::cerr << "Cannot change sample rate while engine is running" << std::endl;
         return;
     }
-    pImpl->sampleRate = sampleRate;
+    pImpl->changeSampleRate(sampleRate);
 }
 
 double AudioEngine::getSampleRate() const {
     return pImpl->sampleRate;
 }
 
+void AudioEngine::setSampleRateListener(SampleRateListener listener) {
+    pImpl->sampleRateListener = std::move(listener);
+}
+
 void AudioEngine::setBufferSize(size_t bufferSize) {
-    if (pImpl->running) {
+    if (pImpl->running || pImpl->renderingOffline) {
         std::cerr << "Cannot change buffer size while engine is running" << std::endl;
         return;
     }
     pImpl->bufferSize = bufferSize;
-    
-#ifdef PAN_USE_PORTAUDIO
-    // Reinitialize buffers with new size if already initialized
-    if (pImpl->inputBuffer) {
-        pImpl->initializeBuffers(2, bufferSize);
-    }
-#endif
 }
 
 size_t AudioEngine::getBufferSize() const {
     return pImpl->bufferSize;
 }
 
+bool AudioEngine::setStreamConfig(const StreamConfig& config) {
+    if (pImpl->running || pImpl->renderingOffline) {
+        std::cerr << "Cannot change stream configuration while engine is running" << std::endl;
+        return false;
+    }
+    if (config.sampleRate <= 0.0 || config.numChannels == 0) {
+        std::cerr << "Invalid stream configuration: sample rate and channel count must be positive" << std::endl;
+        return false;
+    }
+    pImpl->hostApi = config.hostApi;
+    pImpl->bufferSize = config.bufferSize;
+    pImpl->suggestedLatency = config.suggestedLatency;
+    pImpl->duplex = config.duplex;
+    pImpl->deviceChannels = config.numChannels;
+    pImpl->deviceIo.setFormat(config.format);
+    pImpl->deviceIo.setDitherEnabled(config.dither);
+    pImpl->changeSampleRate(config.sampleRate);
+    return true;
+}
+
+StreamConfig AudioEngine::getStreamConfig() const {
+    StreamConfig config;
+    config.hostApi = pImpl->hostApi;
+    config.sampleRate = pImpl->sampleRate;
+    config.bufferSize = pImpl->bufferSize;
+    config.suggestedLatency = pImpl->suggestedLatency;
+    config.duplex = pImpl->duplex;
+    config.numChannels = pImpl->deviceChannels;
+    config.format = pImpl->deviceIo.getFormat();
+    config.dither = pImpl->deviceIo.isDitherEnabled();
+    return config;
+}
+
+StreamInfo AudioEngine::getStreamInfo() const {
+    return pImpl->streamInfo;
+}
+
+const char* AudioEngine::getHostApiName(StreamConfig::HostApi hostApi) {
+    switch (hostApi) {
+        case StreamConfig::HostApi::Jack: return "JACK";
+        case StreamConfig::HostApi::Alsa: return "ALSA";
+        case StreamConfig::HostApi::Pulse: return "PulseAudio";
+        case StreamConfig::HostApi::Default: break;
+    }
+    return "Default";
+}
+
 void AudioEngine::setProcessCallback(ProcessCallback callback) {
-    std::lock_guard<std::mutex> lock(pImpl->callbackMutex);
-    pImpl->processCallback = callback;
+    if (callback) {
+        pImpl->processCallback.publish(std::make_unique<ProcessCallback>(std::move(callback)));
+    } else {
+        pImpl->processCallback.publish(nullptr);
+    }
+    // Opportunistically free anything the audio thread has already moved past
+    pImpl->processCallback.collectGarbage();
+}
+
+bool AudioEngine::hasProcessCallback() {
+    auto callback = pImpl->processCallback.read();
+    return callback && *callback;
+}
+
+size_t AudioEngine::collectGarbage() {
+    return pImpl->processCallback.collectGarbage();
 }
 
 void AudioEngine::processAudioCallback(AudioBuffer& input, AudioBuffer& output, size_t numFrames) {
-    std::lock_guard<std::mutex> lock(pImpl->callbackMutex);
-    if (pImpl->processCallback) {
-        pImpl->processCallback(input, output, numFrames);
+    RealtimeAllocationGuard allocationGuard;
+    pImpl->scratchArena.reset();
+    auto callback = pImpl->processCallback.read();
+    if (callback && *callback) {
+        (*callback)(input, output, numFrames);
     }
 }
 
 AudioBuffer* AudioEngine::getInputBuffer() {
-#ifdef PAN_USE_PORTAUDIO
     return pImpl->inputBuffer.get();
-#else
-    return nullptr;
-#endif
 }
 
 AudioBuffer* AudioEngine::getOutputBuffer() {
-#ifdef PAN_USE_PORTAUDIO
     return pImpl->outputBuffer.get();
-#else
-    return nullptr;
-#endif
 }
 
-void AudioEngine::resizeBuffersIfNeeded(size_t numChannels, size_t numFrames) {
-#ifdef PAN_USE_PORTAUDIO
-    if (!pImpl->outputBuffer || pImpl->outputBuffer->getNumFrames() < numFrames) {
-        pImpl->initializeBuffers(numChannels, numFrames);
+void AudioEngine::processDeviceBlock(const void* deviceInput, void* deviceOutput, size_t numFrames,
+                                     uint32_t statusFlags, double outputLatencySeconds) {
+    AudioBuffer* input = pImpl->inputBuffer.get();
+    AudioBuffer* output = pImpl->outputBuffer.get();
+    const size_t bytesPerSample = getSampleFormatBytes(pImpl->deviceIo.getFormat());
+    const size_t outputChannels = pImpl->streamOutputChannels;
+    const size_t inputChannels = pImpl->streamInputChannels;
+    if (!deviceOutput || numFrames == 0) {
+        return;
     }
-#endif
+    if (!pImpl->audioThreadConfigured.load(std::memory_order_relaxed)) {
+        pImpl->audioThreadReport = realtime::applyToCurrentThread(pImpl->realtimePolicy);
+        pImpl->audioThreadConfigured.store(true, std::memory_order_release);
+    }
+    const auto callbackStart = std::chrono::steady_clock::now();
+    if (!input || !output || output->getCapacity() == 0) {
+        std::memset(deviceOutput, 0, numFrames * outputChannels * bytesPerSample);
+        return;
+    }
+    
+    const size_t outputFrameBytes = outputChannels * bytesPerSample;
+    const size_t inputFrameBytes = inputChannels * bytesPerSample;
+    const size_t maxChunk = output->getCapacity();
+    for (size_t offset = 0; offset < numFrames;) {
+        size_t chunk = std::min(maxChunk, numFrames - offset);
+        input->setNumFrames(chunk);
+        output->setNumFrames(chunk);
+        
+        if (deviceInput && inputChannels > 0) {
+            pImpl->deviceIo.deinterleave(static_cast<const uint8_t*>(deviceInput) + offset * inputFrameBytes,
+                                         inputChannels, *input, 0, chunk);
+            pImpl->recorder.push(*input, chunk);
+        } else {
+            input->clear();
+        }
+        output->clear();
+        processAudioCallback(*input, *output, chunk);
+        pImpl->deviceIo.interleave(*output, 0, static_cast<uint8_t*>(deviceOutput) + offset * outputFrameBytes,
+                                   outputChannels, chunk);
+        offset += chunk;
+    }
+    
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - callbackStart).count();
+    pImpl->callbackStats.record(elapsed, numFrames, pImpl->sampleRate, statusFlags, outputLatencySeconds);
+}
+
+bool AudioEngine::setRealtimePolicy(const RealtimeThreadPolicy& policy) {
+    if (pImpl->running) {
+        std::cerr << "Cannot change real-time policy while engine is running" << std::endl;
+        return false;
+    }
+    pImpl->realtimePolicy = policy;
+    return true;
+}
+
+AudioRecorder& AudioEngine::getRecorder() {
+    return pImpl->recorder;
+}
+
+CallbackStatsSnapshot AudioEngine::getCallbackStats() const {
+    return pImpl->callbackStats.snapshot();
+}
+
+void AudioEngine::resetCallbackStats() {
+    pImpl->callbackStats.reset();
+}
+
+RealtimeThreadPolicy AudioEngine::getRealtimePolicy() const {
+    return pImpl->realtimePolicy;
+}
+
+RealtimeDiagnostics AudioEngine::getRealtimeDiagnostics() const {
+    RealtimeDiagnostics diagnostics;
+    if (pImpl->audioThreadConfigured.load(std::memory_order_acquire)) {
+        diagnostics.audioThread = pImpl->audioThreadReport;
+    }
+    diagnostics.renderWorkers = pImpl->renderPool.getNumThreads();
+    diagnostics.realtimeRenderWorkers = pImpl->renderPool.getRealtimeWorkerCount();
+    diagnostics.memoryLocked = pImpl->memoryLocked;
+    diagnostics.lockedBytes = pImpl->lockedBytes;
+    diagnostics.memoryLockError = pImpl->memoryLockError;
+    return diagnostics;
+}
+
+bool AudioEngine::setDeviceFormat(SampleFormat format, bool dither) {
+    if (pImpl->running || pImpl->renderingOffline) {
+        std::cerr << "Cannot change device sample format while engine is running" << std::endl;
+        return false;
+    }
+    pImpl->deviceIo.setFormat(format);
+    pImpl->deviceIo.setDitherEnabled(dither);
+    return true;
+}
+
+SampleFormat AudioEngine::getDeviceFormat() const {
+    return pImpl->deviceIo.getFormat();
+}
+
+bool AudioEngine::isDeviceDitherEnabled() const {
+    return pImpl->deviceIo.isDitherEnabled();
+}
+
+bool AudioEngine::setRenderThreadCount(size_t numThreads) {
+    if (pImpl->running || pImpl->renderingOffline) {
+        std::cerr << "Cannot change render thread count while the engine is running" << std::endl;
+        return false;
+    }
+    pImpl->renderPool.setNumThreads(numThreads);
+    return true;
+}
+
+size_t AudioEngine::getRenderThreadCount() const {
+    return pImpl->renderPool.getNumThreads();
+}
+
+RenderPool& AudioEngine::getRenderPool() {
+    return pImpl->renderPool;
+}
+
+bool AudioEngine::setMaxTrackCount(size_t maxTracks) {
+    if (pImpl->running || pImpl->renderingOffline) {
+        std::cerr << "Cannot change max track count while the engine is running" << std::endl;
+        return false;
+    }
+    pImpl->maxTrackCount = maxTracks;
+    return true;
+}
+
+size_t AudioEngine::getMaxTrackCount() const {
+    return pImpl->maxTrackCount;
+}
+
+size_t AudioEngine::getMaxBlockSize() const {
+    return pImpl->maxBlockSize();
+}
+
+ScratchArena& AudioEngine::getScratchArena() {
+    return pImpl->scratchArena;
+}
+
+bool AudioEngine::isRenderingOffline() const {
+    return pImpl->renderingOffline;
+}
+
+bool AudioEngine::renderOffline(const OfflineRenderOptions& options, OfflineRenderProgress* result) {
+    if (pImpl->running) {
+        std::cerr << "Cannot render offline while the engine is running" << std::endl;
+        return false;
+    }
+    if (options.blockSize == 0 || options.numChannels == 0) {
+        std::cerr << "Offline render: block size and channel count must be non-zero" << std::endl;
+        return false;
+    }
+    if (pImpl->renderingOffline.exchange(true)) {
+        std::cerr << "Offline render already in progress" << std::endl;
+        return false;
+    }
+    pImpl->unlockDspMemory();  // Nothing plays while stopped; start() locks the buffers again
+    if (!pImpl->prepareScratch(std::max<size_t>(options.numChannels, 2),
+                               std::max(options.blockSize, pImpl->maxBlockSize()))) {
+        pImpl->renderingOffline = false;
+        return false;
+    }
+    
+    AudioBuffer input(options.numChannels, options.blockSize);
+    AudioBuffer output(options.numChannels, options.blockSize);
+    
+    // Decaying tails hit denormals offline too; restore the caller's FP mode afterwards
+    realtime::ScopedDenormalFlush denormalFlush(pImpl->realtimePolicy.flushDenormals);
+    
+    OfflineRenderProgress progress;
+    progress.totalFrames = options.totalFrames;
+    
+    const double sampleRate = pImpl->sampleRate;
+    const auto startTime = std::chrono::steady_clock::now();
+    size_t nextReport = options.progressIntervalFrames;
+    bool ok = true;
+    
+    auto updateTiming = [&]() {
+        progress.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        double audioSeconds = static_cast<double>(progress.framesRendered) / sampleRate;
+        progress.realtimeFactor = progress.elapsedSeconds > 0.0 ? audioSeconds / progress.elapsedSeconds : 0.0;
+    };
+    
+    while (progress.framesRendered < options.totalFrames) {
+        size_t numFrames = std::min(options.blockSize, options.totalFrames - progress.framesRendered);
+        
+        // Same contract as the device callback: silent input, cleared output
+        input.clear();
+        output.clear();
+        processAudioCallback(input, output, numFrames);
+        
+        if (options.sink && !options.sink(output, numFrames)) {
+            std::cerr << "Offline render: sink rejected block at frame " << progress.framesRendered << std::endl;
+            ok = false;
+            break;
+        }
+        progress.framesRendered += numFrames;
+        
+        if (options.progress && progress.framesRendered >= nextReport &&
+            progress.framesRendered < options.totalFrames) {
+            nextReport += std::max<size_t>(options.progressIntervalFrames, 1);
+            updateTiming();
+            if (!options.progress(progress)) {
+                progress.cancelled = true;
+                ok = false;
+                break;
+            }
+        }
+    }
+    
+    updateTiming();
+    if (options.progress && !progress.cancelled) {
+        options.progress(progress);
+    }
+    if (result) {
+        *result = progress;
+    }
+    
+    pImpl->renderingOffline = false;
+    std::cout << "AudioEngine: Offline render " << (ok ? "finished" : "stopped") << " ("
+              << progress.framesRendered << "/" << progress.totalFrames << " frames, "
+              << progress.realtimeFactor << "x real time)" << std::endl;
+    return ok;
+}
+
+bool AudioEngine::renderOfflineToFile(const std::string& path, size_t totalFrames, WavWriter::Format format,
+                                      std::function<bool(const OfflineRenderProgress&)> progress,
+                                      OfflineRenderProgress* result) {
+    WavWriter writer;
+    const size_t numChannels = 2;
+    if (!writer.open(path, numChannels, pImpl->sampleRate, format)) {
+        return false;
+    }
+    
+    OfflineRenderOptions options;
+    options.totalFrames = totalFrames;
+    options.blockSize = pImpl->bufferSize > 0 ? pImpl->bufferSize : 512;
+    options.numChannels = numChannels;
+    options.progressIntervalFrames = static_cast<size_t>(pImpl->sampleRate);
+    options.progress = std::move(progress);
+    options.sink = [&writer](const AudioBuffer& block, size_t numFrames) {
+        return writer.write(block, numFrames);
+    };
+    
+    bool ok = renderOffline(options, result);
+    if (!writer.close()) {
+        ok = false;
+    }
+    return ok;
 }
 
 } // namespace pan
@@ -407,74 +897,20 @@ extern "C" int audioCallback(const void* inputBuffer, void* outputBuffer,
         return paContinue;
     }
     
-    // Get AudioEngine instance
     pan::AudioEngine* engine = static_cast<pan::AudioEngine*>(userData);
     if (!engine) {
-        // Zero output buffer as fallback
-        memset(outputBuffer, 0, framesPerBuffer * 2 * sizeof(float));
-        return paContinue;
+        return paAbort;
     }
     
-    // Get input/output buffers
-    pan::AudioBuffer* inputBuf = engine->getInputBuffer();
-    pan::AudioBuffer* outputBuf = engine->getOutputBuffer();
-    
-    if (!outputBuf) {
-        // Zero output buffer as fallback
-        memset(outputBuffer, 0, framesPerBuffer * 2 * sizeof(float));
-        return paContinue;
+    // Time from now until the first output sample reaches the DAC, if the host knows it
+    double outputLatency = 0.0;
+    if (timeInfo && timeInfo->outputBufferDacTime > 0.0 && timeInfo->currentTime > 0.0) {
+        outputLatency = timeInfo->outputBufferDacTime - timeInfo->currentTime;
     }
     
-    // Resize buffers if needed (PortAudio may use variable frame sizes)
-    engine->resizeBuffersIfNeeded(2, framesPerBuffer);
-    inputBuf = engine->getInputBuffer();
-    outputBuf = engine->getOutputBuffer();
-    
-    // Copy input from PortAudio (if available) - interleaved format
-    if (inputBuffer && inputBuf) {
-        const float* in = static_cast<const float*>(inputBuffer);
-        for (size_t ch = 0; ch < inputBuf->getNumChannels() && ch < 2; ++ch) {
-            float* channelData = inputBuf->getWritePointer(ch);
-            for (unsigned long i = 0; i < framesPerBuffer && i < inputBuf->getNumFrames(); ++i) {
-                channelData[i] = in[i * 2 + ch];
-            }
-        }
-    } else if (inputBuf) {
-        inputBuf->clear();
-    }
-    
-    // Clear output buffer
-    outputBuf->clear();
-    
-    // Call user's process callback - this will generate the sine wave
-    engine->processAudioCallback(*inputBuf, *outputBuf, framesPerBuffer);
-    
-    // Copy output to PortAudio buffer (interleaved format: L, R, L, R, ...)
-    float* out = static_cast<float*>(outputBuffer);
-    size_t numChannels = outputBuf->getNumChannels();
-    
-    // Ensure buffer is large enough
-    if (outputBuf->getNumFrames() < framesPerBuffer) {
-        memset(outputBuffer, 0, framesPerBuffer * 2 * sizeof(float));
-        return paContinue;
-    }
-    
-    // Copy from AudioBuffer (de-interleaved) to PortAudio buffer (interleaved)
-    // PortAudio expects interleaved: [L0, R0, L1, R1, L2, R2, ...]
-    for (unsigned long i = 0; i < framesPerBuffer; ++i) {
-        if (numChannels >= 1) {
-            const float* leftChannel = outputBuf->getReadPointer(0);
-            out[i * 2 + 0] = leftChannel[i];  // Left channel
-        } else {
-            out[i * 2 + 0] = 0.0f;
-        }
-        if (numChannels >= 2) {
-            const float* rightChannel = outputBuf->getReadPointer(1);
-            out[i * 2 + 1] = rightChannel[i];  // Right channel
-        } else {
-            out[i * 2 + 1] = 0.0f;
-        }
-    }
+    // Conversion, chunking, instrumentation and the process callback all happen in the engine
+    engine->processDeviceBlock(inputBuffer, outputBuffer, framesPerBuffer,
+                               static_cast<uint32_t>(statusFlags), outputLatency);
     
     return paContinue;
 }
@@ -0,0 +1,223 @@
+#include "pan/audio/audio_recorder.h"
+#include "pan/audio/audio_buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace pan {
+
+namespace {
+
+// How long the writer sleeps when less than a chunk is waiting
+constexpr auto WRITER_POLL_INTERVAL = std::chrono::milliseconds(5);
+
+float decodeSample(const uint8_t* src, WavWriter::Format format) {
+    switch (format) {
+        case WavWriter::Format::PCM16: {
+            int16_t value = static_cast<int16_t>(src[0] | (src[1] << 8));
+            return static_cast<float>(value) / 32767.0f;
+        }
+        case WavWriter::Format::PCM24: {
+            int32_t value = src[0] | (src[1] << 8) | (src[2] << 16);
+            if (value & 0x800000) {
+                value -= 0x1000000;
+            }
+            return static_cast<float>(value) / 8388607.0f;
+        }
+        case WavWriter::Format::Float32: {
+            uint32_t bits = static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+                            (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+    }
+    return 0.0f;
+}
+
+} // namespace
+
+AudioRecorder::AudioRecorder() = default;
+
+AudioRecorder::~AudioRecorder() {
+    stop();
+}
+
+bool AudioRecorder::start(const Options& options) {
+    stop();
+
+    if (options.numChannels == 0 || options.sampleRate <= 0.0 || options.writeChunkFrames == 0) {
+        std::cerr << "AudioRecorder: Invalid recording options" << std::endl;
+        return false;
+    }
+    if (!writer_.open(options.path, options.numChannels, options.sampleRate, options.format, options.container)) {
+        return false;
+    }
+    if (options.preallocateSeconds > 0.0) {
+        writer_.preallocate(static_cast<uint64_t>(options.preallocateSeconds * options.sampleRate));
+    }
+
+    options_ = options;
+    hasTake_ = false;
+
+    // The ring holds at least two write chunks so the writer can always take a full one
+    size_t ringFrames = static_cast<size_t>(options.ringSeconds * options.sampleRate);
+    ringFrames = std::max(ringFrames, options.writeChunkFrames * 2);
+    ring_.resize(ringFrames * options.numChannels);
+    pushScratch_.assign(PUSH_CHUNK_FRAMES * options.numChannels, 0.0f);
+    writeScratch_.assign(options.writeChunkFrames * options.numChannels, 0.0f);
+
+    framesRecorded_ = 0;
+    droppedFrames_ = 0;
+    writeError_ = false;
+    stopping_ = false;
+
+    writerThread_ = std::thread(&AudioRecorder::writerLoop, this);
+    recording_.store(true, std::memory_order_seq_cst);
+    return true;
+}
+
+bool AudioRecorder::stop() {
+    if (!writerThread_.joinable()) {
+        return true;
+    }
+
+    // After this no new push() starts; wait out one that already passed the check
+    recording_.store(false, std::memory_order_seq_cst);
+    while (activePushes_.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+
+    stopping_.store(true, std::memory_order_release);
+    writerThread_.join();
+
+    bool ok = writer_.close() && !writeError_.load(std::memory_order_relaxed);
+    hasTake_ = true;
+
+    uint64_t dropped = droppedFrames_.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        std::cerr << "AudioRecorder: Dropped " << dropped << " frames while recording " << options_.path
+                  << " (disk too slow)" << std::endl;
+    }
+    return ok;
+}
+
+void AudioRecorder::push(const AudioBuffer& input, size_t numFrames) {
+    activePushes_.fetch_add(1, std::memory_order_seq_cst);
+    if (!recording_.load(std::memory_order_seq_cst)) {
+        activePushes_.fetch_sub(1, std::memory_order_seq_cst);
+        return;
+    }
+
+    const size_t numChannels = options_.numChannels;
+    numFrames = std::min(numFrames, input.getNumFrames());
+    uint64_t dropped = 0;
+
+    for (size_t offset = 0; offset < numFrames;) {
+        // Only whole frames go into the ring, so the writer always reads whole frames
+        size_t room = ring_.availableWrite() / numChannels;
+        size_t chunk = std::min({PUSH_CHUNK_FRAMES, numFrames - offset, room});
+        if (chunk == 0) {
+            dropped += numFrames - offset;
+            break;
+        }
+
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            // Missing input channels are recorded as silence
+            const float* src = ch < input.getNumChannels() ? input.getReadPointer(ch) + offset : nullptr;
+            float* dst = pushScratch_.data() + ch;
+            for (size_t i = 0; i < chunk; ++i, dst += numChannels) {
+                *dst = src ? src[i] : 0.0f;
+            }
+        }
+        ring_.write(pushScratch_.data(), chunk * numChannels);
+        offset += chunk;
+    }
+
+    if (dropped > 0) {
+        droppedFrames_.store(droppedFrames_.load(std::memory_order_relaxed) + dropped, std::memory_order_relaxed);
+    }
+    activePushes_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void AudioRecorder::writerLoop() {
+    const size_t numChannels = options_.numChannels;
+    const size_t chunkFrames = options_.writeChunkFrames;
+
+    while (true) {
+        bool draining = stopping_.load(std::memory_order_acquire);
+        size_t available = ring_.availableRead() / numChannels;
+
+        if (available == 0 && draining) {
+            return;
+        }
+        if (available < chunkFrames && !draining) {
+            std::this_thread::sleep_for(WRITER_POLL_INTERVAL);
+            continue;
+        }
+
+        size_t frames = std::min(available, chunkFrames);
+        ring_.read(writeScratch_.data(), frames * numChannels);
+
+        // On a write error keep draining so push() never sees a full ring because of us
+        if (!writeError_.load(std::memory_order_relaxed)) {
+            if (writer_.writeInterleaved(writeScratch_.data(), frames)) {
+                framesRecorded_.fetch_add(frames, std::memory_order_relaxed);
+            } else {
+                writeError_.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+std::shared_ptr<AudioBuffer> AudioRecorder::readTake() const {
+    if (!hasTake_ || writerThread_.joinable()) {
+        return nullptr;
+    }
+
+    const size_t numChannels = options_.numChannels;
+    const size_t numFrames = static_cast<size_t>(framesRecorded_.load(std::memory_order_relaxed));
+    const size_t bytesPerSample = WavWriter::getBytesPerSample(options_.format);
+    if (numFrames == 0) {
+        return nullptr;
+    }
+
+    std::FILE* file = std::fopen(options_.path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "AudioRecorder: Cannot open take: " << options_.path << std::endl;
+        return nullptr;
+    }
+    if (std::fseek(file, static_cast<long>(writer_.getDataOffset()), SEEK_SET) != 0) {
+        std::fclose(file);
+        return nullptr;
+    }
+
+    auto take = std::make_shared<AudioBuffer>(numChannels, numFrames);
+    std::vector<uint8_t> bytes(options_.writeChunkFrames * numChannels * bytesPerSample);
+
+    for (size_t offset = 0; offset < numFrames;) {
+        size_t frames = std::min(options_.writeChunkFrames, numFrames - offset);
+        size_t frameBytes = numChannels * bytesPerSample;
+        if (std::fread(bytes.data(), frameBytes, frames, file) != frames) {
+            std::cerr << "AudioRecorder: Take is shorter than expected: " << options_.path << std::endl;
+            std::fclose(file);
+            return nullptr;
+        }
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            float* dst = take->getWritePointer(ch) + offset;
+            const uint8_t* src = bytes.data() + ch * bytesPerSample;
+            for (size_t i = 0; i < frames; ++i, src += frameBytes) {
+                dst[i] = decodeSample(src, options_.format);
+            }
+        }
+        offset += frames;
+    }
+
+    std::fclose(file);
+    return take;
+}
+
+} // namespace pan
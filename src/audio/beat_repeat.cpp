@@ -9,8 +9,6 @@ BeatRepeat::BeatRepeat(double sampleRate)
     bufSize_ = static_cast<size_t>(sampleRate_ * 2.0); // 2 seconds max
     bufL_.assign(bufSize_, 0.0f);
     bufR_.assign(bufSize_, 0.0f);
-    std::random_device rd;
-    rng_.seed(rd());
     reset();
 }
 
@@ -27,8 +25,12 @@ void BeatRepeat::reset() {
 
 void BeatRepeat::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    uint32_t seed = 0;
+    if (pendingSeed_.take(seed)) {
+        rng_.setSeed(seed);
+    }
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     if (intervalSamples_ == 0) intervalSamples_ = 1;
     if (gateSamples_ == 0) gateSamples_ = 1;
@@ -67,7 +69,7 @@ void BeatRepeat::process(AudioBuffer& buffer, size_t numFrames) {
         // trigger
         if (intervalCounter_ >= intervalSamples_) {
             intervalCounter_ = 0;
-            if (dist_(rng_) <= chance_) {
+            if (rng_.nextFloat() < chance_) {
                 repeating_ = true;
                 playPos_ = (writePos_ + bufSize_ - gateSamples_) % bufSize_;
             } else {
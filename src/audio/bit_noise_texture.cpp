@@ -6,19 +6,28 @@ namespace pan {
 BitNoiseTexture::BitNoiseTexture(double sampleRate)
     : sampleRate_(sampleRate)
 {
-    std::random_device rd;
-    rng_.seed(rd());
 }
 
 void BitNoiseTexture::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    uint32_t seed = 0;
+    if (pendingSeed_.take(seed)) {
+        rng_.setSeed(seed);
+    }
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     float step = 1.0f / ((1 << bits_) - 1);
     float tiltCoeff = 1.0f - std::exp(-2.0f * static_cast<float>(M_PI) * (tilt_ > 0 ? 8000.0f : 1200.0f) / static_cast<float>(sampleRate_));
     
     for (size_t i = 0; i < numFrames; ++i) {
+        const size_t chunkPos = i % NOISE_CHUNK;
+        if (chunkPos == 0) {
+            size_t count = std::min(NOISE_CHUNK, numFrames - i);
+            rng_.fillBipolar(noiseL_, count);
+            rng_.fillBipolar(noiseR_, count);
+        }
+        
         // Downsample hold
         if (phase_ % static_cast<size_t>(downsampleFactor_) == 0) {
             heldL_ = std::round(left[i] / step) * step;
@@ -26,8 +35,8 @@ void BitNoiseTexture::process(AudioBuffer& buffer, size_t numFrames) {
         }
         phase_++;
         
-        float nl = noise_ * dist_(rng_);
-        float nr = noise_ * dist_(rng_);
+        float nl = noise_ * noiseL_[chunkPos];
+        float nr = noise_ * noiseR_[chunkPos];
         
         float wetL = heldL_ + nl;
         float wetR = heldR_ + nr;
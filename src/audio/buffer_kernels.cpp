@@ -0,0 +1,241 @@
+#include "pan/audio/buffer_kernels.h"
+#include "audio/buffer_kernels_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PAN_HAVE_SSE2_KERNELS 1
+#include <emmintrin.h>
+#endif
+
+namespace pan {
+namespace kernels {
+
+// ---------------------------------------------------------------------------
+// Scalar reference implementation
+// ---------------------------------------------------------------------------
+namespace scalar {
+
+static void clear(float* dst, size_t n) {
+    std::memset(dst, 0, n * sizeof(float));
+}
+
+static void fill(float* dst, float value, size_t n) {
+    std::fill(dst, dst + n, value);
+}
+
+static void copy(float* dst, const float* src, size_t n) {
+    if (dst != src) {
+        std::memmove(dst, src, n * sizeof(float));
+    }
+}
+
+static void add(float* dst, const float* src, float gain, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void addRamp(float* dst, const float* src, float startGain, float endGain, size_t n) {
+    const float step = n > 0 ? (endGain - startGain) / static_cast<float>(n) : 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] += src[i] * (startGain + step * static_cast<float>(i));
+    }
+}
+
+static void scale(float* dst, float gain, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] *= gain;
+    }
+}
+
+static void scaleRamp(float* dst, float startGain, float endGain, size_t n) {
+    const float step = n > 0 ? (endGain - startGain) / static_cast<float>(n) : 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] *= startGain + step * static_cast<float>(i);
+    }
+}
+
+static float peak(const float* src, size_t n) {
+    float result = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        result = std::max(result, std::abs(src[i]));
+    }
+    return result;
+}
+
+static double sumSquares(const float* src, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(src[i]) * src[i];
+    }
+    return sum;
+}
+
+static const KernelTable table = {
+    clear, fill, copy, add, addRamp, scale, scaleRamp, peak, sumSquares, "scalar"
+};
+
+} // namespace scalar
+
+// ---------------------------------------------------------------------------
+// SSE2 (baseline on x86-64)
+// ---------------------------------------------------------------------------
+#ifdef PAN_HAVE_SSE2_KERNELS
+namespace sse2 {
+
+static void fill(float* dst, float value, size_t n) {
+    const __m128 v = _mm_set1_ps(value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(dst + i, v);
+    }
+    for (; i < n; ++i) {
+        dst[i] = value;
+    }
+}
+
+static void clear(float* dst, size_t n) {
+    fill(dst, 0.0f, n);
+}
+
+static void add(float* dst, const float* src, float gain, size_t n) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 a0 = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        __m128 a1 = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+        _mm_storeu_ps(dst + i, a0);
+        _mm_storeu_ps(dst + i + 4, a1);
+    }
+    for (; i < n; ++i) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void addRamp(float* dst, const float* src, float startGain, float endGain, size_t n) {
+    const float step = n > 0 ? (endGain - startGain) / static_cast<float>(n) : 0.0f;
+    const __m128 start = _mm_set1_ps(startGain);
+    const __m128 stepV = _mm_set1_ps(step);
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lane);
+        __m128 g = _mm_add_ps(start, _mm_mul_ps(stepV, index));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    }
+    for (; i < n; ++i) {
+        dst[i] += src[i] * (startGain + step * static_cast<float>(i));
+    }
+}
+
+static void scale(float* dst, float gain, size_t n) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), g));
+    }
+    for (; i < n; ++i) {
+        dst[i] *= gain;
+    }
+}
+
+static void scaleRamp(float* dst, float startGain, float endGain, size_t n) {
+    const float step = n > 0 ? (endGain - startGain) / static_cast<float>(n) : 0.0f;
+    const __m128 start = _mm_set1_ps(startGain);
+    const __m128 stepV = _mm_set1_ps(step);
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lane);
+        __m128 g = _mm_add_ps(start, _mm_mul_ps(stepV, index));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), g));
+    }
+    for (; i < n; ++i) {
+        dst[i] *= startGain + step * static_cast<float>(i);
+    }
+}
+
+static float peak(const float* src, size_t n) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 m = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(src + i), absMask));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, m);
+    float result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    for (; i < n; ++i) {
+        result = std::max(result, std::abs(src[i]));
+    }
+    return result;
+}
+
+static double sumSquares(const float* src, size_t n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(src + i);
+        __m128d lo = _mm_cvtps_pd(v);
+        __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(lo, lo));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(hi, hi));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        sum += static_cast<double>(src[i]) * src[i];
+    }
+    return sum;
+}
+
+static const KernelTable table = {
+    clear, fill, scalar::copy, add, addRamp, scale, scaleRamp, peak, sumSquares, "sse2"
+};
+
+} // namespace sse2
+#endif
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+static const KernelTable& selectTable() {
+#ifdef PAN_HAVE_AVX2_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return getAvx2Table();
+    }
+#endif
+#ifdef PAN_HAVE_SSE2_KERNELS
+    return sse2::table;
+#else
+    return scalar::table;
+#endif
+}
+
+static const KernelTable& activeTable() {
+    static const KernelTable& table = selectTable();
+    return table;
+}
+
+void clear(float* dst, size_t n) { activeTable().clear(dst, n); }
+void fill(float* dst, float value, size_t n) { activeTable().fill(dst, value, n); }
+void copy(float* dst, const float* src, size_t n) { activeTable().copy(dst, src, n); }
+void add(float* dst, const float* src, float gain, size_t n) { activeTable().add(dst, src, gain, n); }
+void addRamp(float* dst, const float* src, float startGain, float endGain, size_t n) {
+    activeTable().addRamp(dst, src, startGain, endGain, n);
+}
+void scale(float* dst, float gain, size_t n) { activeTable().scale(dst, gain, n); }
+void scaleRamp(float* dst, float startGain, float endGain, size_t n) {
+    activeTable().scaleRamp(dst, startGain, endGain, n);
+}
+float peak(const float* src, size_t n) { return activeTable().peak(src, n); }
+double sumSquares(const float* src, size_t n) { return activeTable().sumSquares(src, n); }
+const char* getImplementationName() { return activeTable().name; }
+
+} // namespace kernels
+} // namespace pan
@@ -0,0 +1,151 @@
+// AVX2 buffer kernels. This file alone is compiled with -mavx2; nothing here
+// runs unless buffer_kernels.cpp has confirmed CPU support at runtime.
+//
+// Avoid inline library templates (std::max, std::abs, ...) in this file: their
+// AVX2-compiled copies could be merged with the baseline ones at link time.
+#include "audio/buffer_kernels_impl.h"
+#include <cstring>
+#include <immintrin.h>
+
+namespace pan {
+namespace kernels {
+namespace avx2 {
+
+static inline float absMax(float current, float sample) {
+    float magnitude = sample < 0.0f ? -sample : sample;
+    return magnitude > current ? magnitude : current;
+}
+
+static void fill(float* dst, float value, size_t n) {
+    const __m256 v = _mm256_set1_ps(value);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, v);
+    }
+    for (; i < n; ++i) {
+        dst[i] = value;
+    }
+}
+
+static void clear(float* dst, size_t n) {
+    fill(dst, 0.0f, n);
+}
+
+static void copy(float* dst, const float* src, size_t n) {
+    if (dst != src) {
+        std::memmove(dst, src, n * sizeof(float));
+    }
+}
+
+static void add(float* dst, const float* src, float gain, size_t n) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a0 = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+        __m256 a1 = _mm256_add_ps(_mm256_loadu_ps(dst + i + 8), _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), g));
+        _mm256_storeu_ps(dst + i, a0);
+        _mm256_storeu_ps(dst + i + 8, a1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+    }
+    for (; i < n; ++i) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void addRamp(float* dst, const float* src, float startGain, float endGain, size_t n) {
+    const float step = n > 0 ? (endGain - startGain) / static_cast<float>(n) : 0.0f;
+    const __m256 start = _mm256_set1_ps(startGain);
+    const __m256 stepV = _mm256_set1_ps(step);
+    const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lane);
+        __m256 g = _mm256_add_ps(start, _mm256_mul_ps(stepV, index));
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+    }
+    for (; i < n; ++i) {
+        dst[i] += src[i] * (startGain + step * static_cast<float>(i));
+    }
+}
+
+static void scale(float* dst, float gain, size_t n) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), g));
+    }
+    for (; i < n; ++i) {
+        dst[i] *= gain;
+    }
+}
+
+static void scaleRamp(float* dst, float startGain, float endGain, size_t n) {
+    const float step = n > 0 ? (endGain - startGain) / static_cast<float>(n) : 0.0f;
+    const __m256 start = _mm256_set1_ps(startGain);
+    const __m256 stepV = _mm256_set1_ps(step);
+    const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lane);
+        __m256 g = _mm256_add_ps(start, _mm256_mul_ps(stepV, index));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), g));
+    }
+    for (; i < n; ++i) {
+        dst[i] *= startGain + step * static_cast<float>(i);
+    }
+}
+
+static float peak(const float* src, size_t n) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 m = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        m = _mm256_max_ps(m, _mm256_and_ps(_mm256_loadu_ps(src + i), absMask));
+    }
+    __m128 m4 = _mm_max_ps(_mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, m4);
+    float result = 0.0f;
+    for (float lane : lanes) {
+        result = absMax(result, lane);
+    }
+    for (; i < n; ++i) {
+        result = absMax(result, src[i]);
+    }
+    return result;
+}
+
+static double sumSquares(const float* src, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(src + i);
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(lo, lo));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(hi, hi));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) {
+        sum += static_cast<double>(src[i]) * src[i];
+    }
+    return sum;
+}
+
+static const KernelTable table = {
+    clear, fill, copy, add, addRamp, scale, scaleRamp, peak, sumSquares, "avx2"
+};
+
+} // namespace avx2
+
+const KernelTable& getAvx2Table() {
+    return avx2::table;
+}
+
+} // namespace kernels
+} // namespace pan
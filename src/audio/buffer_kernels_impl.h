@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+// Per-ISA kernel implementations, selected at runtime by buffer_kernels.cpp
+
+namespace pan {
+namespace kernels {
+
+struct KernelTable {
+    void (*clear)(float*, size_t);
+    void (*fill)(float*, float, size_t);
+    void (*copy)(float*, const float*, size_t);
+    void (*add)(float*, const float*, float, size_t);
+    void (*addRamp)(float*, const float*, float, float, size_t);
+    void (*scale)(float*, float, size_t);
+    void (*scaleRamp)(float*, float, float, size_t);
+    float (*peak)(const float*, size_t);
+    double (*sumSquares)(const float*, size_t);
+    const char* name;
+};
+
+#ifdef PAN_HAVE_AVX2_KERNELS
+// Defined in buffer_kernels_avx2.cpp, which is the only file built with -mavx2
+const KernelTable& getAvx2Table();
+#endif
+
+} // namespace kernels
+} // namespace pan
@@ -0,0 +1,138 @@
+#include "pan/audio/callback_stats.h"
+#include <cmath>
+#include <sstream>
+
+namespace pan {
+
+namespace {
+
+// Smoothing for the running load figure, ~100 callbacks
+constexpr double LOAD_SMOOTHING = 0.01;
+
+size_t histogramBin(double durationSeconds) {
+    double micros = durationSeconds * 1e6;
+    if (micros < 2.0) {
+        return 0;
+    }
+    size_t bin = static_cast<size_t>(std::log2(micros));
+    return bin < CallbackStatsSnapshot::HISTOGRAM_BINS ? bin : CallbackStatsSnapshot::HISTOGRAM_BINS - 1;
+}
+
+} // namespace
+
+double CallbackStatsSnapshot::getBinLowerMicros(size_t bin) {
+    return bin == 0 ? 0.0 : std::ldexp(1.0, static_cast<int>(bin));
+}
+
+std::string CallbackStatsSnapshot::toJson() const {
+    std::ostringstream out;
+    out << "{\"callbacks\":" << callbacks
+        << ",\"deadlineMisses\":" << deadlineMisses
+        << ",\"framesProcessed\":" << framesProcessed
+        << ",\"lastDurationUs\":" << lastDurationSeconds * 1e6
+        << ",\"maxDurationUs\":" << maxDurationSeconds * 1e6
+        << ",\"averageDurationUs\":" << averageDurationSeconds * 1e6
+        << ",\"load\":" << load
+        << ",\"peakLoad\":" << peakLoad
+        << ",\"averageLoad\":" << averageLoad
+        << ",\"inputUnderflows\":" << inputUnderflows
+        << ",\"inputOverflows\":" << inputOverflows
+        << ",\"outputUnderflows\":" << outputUnderflows
+        << ",\"outputOverflows\":" << outputOverflows
+        << ",\"primingOutput\":" << primingOutput
+        << ",\"outputLatencyMs\":" << outputLatencySeconds * 1e3
+        << ",\"durationHistogram\":[";
+    for (size_t bin = 0; bin < HISTOGRAM_BINS; ++bin) {
+        if (bin > 0) {
+            out << ",";
+        }
+        out << "{\"fromUs\":" << getBinLowerMicros(bin) << ",\"count\":" << durationHistogram[bin] << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+void CallbackStats::clear() {
+    for (auto* counter : {&callbacks_, &deadlineMisses_, &framesProcessed_, &totalNanos_,
+                          &inputUnderflows_, &inputOverflows_, &outputUnderflows_, &outputOverflows_,
+                          &primingOutput_}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+    for (auto* value : {&lastDuration_, &maxDuration_, &load_, &peakLoad_, &loadSum_, &outputLatency_}) {
+        value->store(0.0, std::memory_order_relaxed);
+    }
+    for (auto& bin : histogram_) {
+        bin.store(0, std::memory_order_relaxed);
+    }
+}
+
+void CallbackStats::record(double durationSeconds, size_t numFrames, double sampleRate, uint32_t statusFlags,
+                           double outputLatencySeconds) {
+    if (resetRequested_.exchange(false, std::memory_order_acquire)) {
+        clear();
+    }
+
+    // Single writer: plain load + store is enough and avoids locked instructions
+    const double budget = sampleRate > 0.0 ? static_cast<double>(numFrames) / sampleRate : 0.0;
+    const double load = budget > 0.0 ? durationSeconds / budget : 0.0;
+    const uint64_t count = callbacks_.load(std::memory_order_relaxed);
+
+    callbacks_.store(count + 1, std::memory_order_relaxed);
+    framesProcessed_.store(framesProcessed_.load(std::memory_order_relaxed) + numFrames, std::memory_order_relaxed);
+    totalNanos_.store(totalNanos_.load(std::memory_order_relaxed) + static_cast<uint64_t>(durationSeconds * 1e9),
+                      std::memory_order_relaxed);
+    if (budget > 0.0 && durationSeconds > budget) {
+        bump(deadlineMisses_);
+    }
+
+    lastDuration_.store(durationSeconds, std::memory_order_relaxed);
+    if (durationSeconds > maxDuration_.load(std::memory_order_relaxed)) {
+        maxDuration_.store(durationSeconds, std::memory_order_relaxed);
+    }
+    double smoothed = count == 0 ? load : load_.load(std::memory_order_relaxed) +
+                                          (load - load_.load(std::memory_order_relaxed)) * LOAD_SMOOTHING;
+    load_.store(smoothed, std::memory_order_relaxed);
+    if (load > peakLoad_.load(std::memory_order_relaxed)) {
+        peakLoad_.store(load, std::memory_order_relaxed);
+    }
+    loadSum_.store(loadSum_.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    if (outputLatencySeconds > 0.0) {
+        outputLatency_.store(outputLatencySeconds, std::memory_order_relaxed);
+    }
+
+    if (statusFlags & InputUnderflow) bump(inputUnderflows_);
+    if (statusFlags & InputOverflow) bump(inputOverflows_);
+    if (statusFlags & OutputUnderflow) bump(outputUnderflows_);
+    if (statusFlags & OutputOverflow) bump(outputOverflows_);
+    if (statusFlags & PrimingOutput) bump(primingOutput_);
+
+    bump(histogram_[histogramBin(durationSeconds)]);
+}
+
+CallbackStatsSnapshot CallbackStats::snapshot() const {
+    CallbackStatsSnapshot snap;
+    snap.callbacks = callbacks_.load(std::memory_order_relaxed);
+    snap.deadlineMisses = deadlineMisses_.load(std::memory_order_relaxed);
+    snap.framesProcessed = framesProcessed_.load(std::memory_order_relaxed);
+    snap.lastDurationSeconds = lastDuration_.load(std::memory_order_relaxed);
+    snap.maxDurationSeconds = maxDuration_.load(std::memory_order_relaxed);
+    snap.load = load_.load(std::memory_order_relaxed);
+    snap.peakLoad = peakLoad_.load(std::memory_order_relaxed);
+    if (snap.callbacks > 0) {
+        snap.averageDurationSeconds = static_cast<double>(totalNanos_.load(std::memory_order_relaxed)) * 1e-9 /
+                                      static_cast<double>(snap.callbacks);
+        snap.averageLoad = loadSum_.load(std::memory_order_relaxed) / static_cast<double>(snap.callbacks);
+    }
+    snap.inputUnderflows = inputUnderflows_.load(std::memory_order_relaxed);
+    snap.inputOverflows = inputOverflows_.load(std::memory_order_relaxed);
+    snap.outputUnderflows = outputUnderflows_.load(std::memory_order_relaxed);
+    snap.outputOverflows = outputOverflows_.load(std::memory_order_relaxed);
+    snap.primingOutput = primingOutput_.load(std::memory_order_relaxed);
+    snap.outputLatencySeconds = outputLatency_.load(std::memory_order_relaxed);
+    for (size_t bin = 0; bin < CallbackStatsSnapshot::HISTOGRAM_BINS; ++bin) {
+        snap.durationHistogram[bin] = histogram_[bin].load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+} // namespace pan
@@ -1,4 +1,5 @@
 #include "pan/audio/chorus.h"
+#include "pan/dsp/fast_math.h"
 #include <algorithm>
 
 namespace pan {
@@ -74,8 +75,8 @@ float Chorus::readDelayInterpolated(const std::vector<float>& buffer, float dela
 void Chorus::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
     
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     // Convert parameters to samples
     float baseDelaySamples = (baseDelay_ / 1000.0f) * static_cast<float>(sampleRate_);
@@ -86,7 +87,7 @@ void Chorus::process(AudioBuffer& buffer, size_t numFrames) {
     
     for (size_t i = 0; i < numFrames; ++i) {
         // Calculate LFO value (sine wave, -1 to +1)
-        float lfoValue = static_cast<float>(std::sin(lfoPhase_));
+        float lfoValue = dsp::sin(static_cast<float>(lfoPhase_));
         lfoPhase_ += lfoIncrement;
         if (lfoPhase_ >= 2.0 * M_PI) {
             lfoPhase_ -= 2.0 * M_PI;
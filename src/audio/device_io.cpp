@@ -0,0 +1,309 @@
+#include "pan/audio/device_io.h"
+#include "pan/audio/audio_buffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PAN_HAVE_SSE2_DEVICE_IO 1
+#include <emmintrin.h>
+#endif
+
+namespace pan {
+
+namespace {
+
+// Same factor in both directions so integer samples round-trip exactly;
+// +1.0f clips to the largest positive code.
+constexpr float INT16_SCALE = 32768.0f;
+constexpr float INT24_SCALE = 8388608.0f;
+constexpr double INT32_SCALE = 2147483648.0;
+
+inline int32_t quantize(float value, float lo, float hi) {
+    value = std::min(std::max(value, lo), hi);
+    return static_cast<int32_t>(std::lrint(value));
+}
+
+inline void writeInt24(uint8_t* dst, int32_t value) {
+    dst[0] = static_cast<uint8_t>(value & 0xFF);
+    dst[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    dst[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+}
+
+inline int32_t readInt24(const uint8_t* src) {
+    uint32_t bits = static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+                    (static_cast<uint32_t>(src[2]) << 16);
+    return static_cast<int32_t>(bits << 8) >> 8;
+}
+
+// ---------------------------------------------------------------------------
+// Stereo fast paths
+// ---------------------------------------------------------------------------
+#ifdef PAN_HAVE_SSE2_DEVICE_IO
+
+void interleaveStereoFloat(const float* left, const float* right, float* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+    for (; i < n; ++i) {
+        dst[2 * i] = left[i];
+        dst[2 * i + 1] = right[i];
+    }
+}
+
+void deinterleaveStereoFloat(const float* src, float* left, float* right, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(src + 2 * i);
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    for (; i < n; ++i) {
+        left[i] = src[2 * i];
+        right[i] = src[2 * i + 1];
+    }
+}
+
+void interleaveStereoInt16(const float* left, const float* right, int16_t* dst, size_t n) {
+    const __m128 scale = _mm_set1_ps(INT16_SCALE);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 l = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(left + i), scale), lo), hi);
+        __m128 r = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(right + i), scale), lo), hi);
+        __m128i a = _mm_cvtps_epi32(_mm_unpacklo_ps(l, r));
+        __m128i b = _mm_cvtps_epi32(_mm_unpackhi_ps(l, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_packs_epi32(a, b));
+    }
+    for (; i < n; ++i) {
+        dst[2 * i] = static_cast<int16_t>(quantize(left[i] * INT16_SCALE, -32768.0f, 32767.0f));
+        dst[2 * i + 1] = static_cast<int16_t>(quantize(right[i] * INT16_SCALE, -32768.0f, 32767.0f));
+    }
+}
+
+void deinterleaveStereoInt16(const int16_t* src, float* left, float* right, size_t n) {
+    const __m128 scale = _mm_set1_ps(1.0f / INT16_SCALE);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+        // Sign-extend to 32 bits by placing each sample in the high half and shifting back down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(lo), scale);
+        __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(hi), scale);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    for (; i < n; ++i) {
+        left[i] = static_cast<float>(src[2 * i]) / INT16_SCALE;
+        right[i] = static_cast<float>(src[2 * i + 1]) / INT16_SCALE;
+    }
+}
+
+#endif
+
+} // namespace
+
+size_t getSampleFormatBytes(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Float32: return 4;
+        case SampleFormat::Int16: return 2;
+        case SampleFormat::Int24: return 3;
+        case SampleFormat::Int32: return 4;
+    }
+    return 4;
+}
+
+const char* getSampleFormatName(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Float32: return "float32";
+        case SampleFormat::Int16: return "int16";
+        case SampleFormat::Int24: return "int24";
+        case SampleFormat::Int32: return "int32";
+    }
+    return "unknown";
+}
+
+float DeviceIoConverter::nextDither() {
+    // Two xorshift32 draws; their difference is triangular over (-1, 1) LSB
+    auto draw = [this]() {
+        ditherState_ ^= ditherState_ << 13;
+        ditherState_ ^= ditherState_ >> 17;
+        ditherState_ ^= ditherState_ << 5;
+        return static_cast<float>(ditherState_ >> 8) * (1.0f / 16777216.0f);
+    };
+    float a = draw();
+    float b = draw();
+    return a - b;
+}
+
+void DeviceIoConverter::deinterleave(const void* device, size_t deviceChannels, AudioBuffer& dest,
+                                     size_t destOffset, size_t numFrames) const {
+    const size_t destFrames = dest.getNumFrames();
+    const size_t n = destOffset < destFrames ? std::min(numFrames, destFrames - destOffset) : 0;
+    const size_t destChannels = dest.getNumChannels();
+    if (n == 0 || destChannels == 0) {
+        return;
+    }
+    if (!device || deviceChannels == 0) {
+        for (size_t ch = 0; ch < destChannels; ++ch) {
+            dest.clear(ch, destOffset, n);
+        }
+        return;
+    }
+
+    const size_t channels = std::min(destChannels, deviceChannels);
+    for (size_t ch = channels; ch < destChannels; ++ch) {
+        dest.clear(ch, destOffset, n);
+    }
+
+#ifdef PAN_HAVE_SSE2_DEVICE_IO
+    if (deviceChannels == 2 && channels == 2) {
+        float* left = dest.getWritePointer(0) + destOffset;
+        float* right = dest.getWritePointer(1) + destOffset;
+        if (format_ == SampleFormat::Float32) {
+            deinterleaveStereoFloat(static_cast<const float*>(device), left, right, n);
+            return;
+        }
+        if (format_ == SampleFormat::Int16) {
+            deinterleaveStereoInt16(static_cast<const int16_t*>(device), left, right, n);
+            return;
+        }
+    }
+#endif
+
+    for (size_t ch = 0; ch < channels; ++ch) {
+        float* out = dest.getWritePointer(ch) + destOffset;
+        switch (format_) {
+            case SampleFormat::Float32: {
+                const float* in = static_cast<const float*>(device) + ch;
+                if (deviceChannels == 1) {
+                    std::memcpy(out, in, n * sizeof(float));
+                    break;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = in[i * deviceChannels];
+                }
+                break;
+            }
+            case SampleFormat::Int16: {
+                const int16_t* in = static_cast<const int16_t*>(device) + ch;
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = static_cast<float>(in[i * deviceChannels]) / INT16_SCALE;
+                }
+                break;
+            }
+            case SampleFormat::Int24: {
+                const uint8_t* in = static_cast<const uint8_t*>(device) + ch * 3;
+                const size_t frameBytes = deviceChannels * 3;
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = static_cast<float>(readInt24(in + i * frameBytes)) / INT24_SCALE;
+                }
+                break;
+            }
+            case SampleFormat::Int32: {
+                const int32_t* in = static_cast<const int32_t*>(device) + ch;
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = static_cast<float>(static_cast<double>(in[i * deviceChannels]) / INT32_SCALE);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void DeviceIoConverter::interleave(const AudioBuffer& source, size_t sourceOffset, void* device,
+                                   size_t deviceChannels, size_t numFrames) {
+    if (!device || deviceChannels == 0 || numFrames == 0) {
+        return;
+    }
+    const size_t bytesPerSample = getSampleFormatBytes(format_);
+    const size_t frameBytes = deviceChannels * bytesPerSample;
+    const size_t sourceFrames = source.getNumFrames();
+    const size_t n = sourceOffset < sourceFrames ? std::min(numFrames, sourceFrames - sourceOffset) : 0;
+    const size_t channels = std::min(source.getNumChannels(), deviceChannels);
+
+    // Zero is silence in every supported format, so missing frames and
+    // channels can be cleared bytewise
+    if (n < numFrames) {
+        std::memset(static_cast<uint8_t*>(device) + n * frameBytes, 0, (numFrames - n) * frameBytes);
+    }
+    if (n == 0) {
+        return;
+    }
+    if (channels < deviceChannels) {
+        uint8_t* bytes = static_cast<uint8_t*>(device);
+        for (size_t i = 0; i < n; ++i) {
+            std::memset(bytes + i * frameBytes + channels * bytesPerSample, 0,
+                        (deviceChannels - channels) * bytesPerSample);
+        }
+    }
+
+    const bool dither = ditherEnabled_ && format_ != SampleFormat::Float32;
+
+#ifdef PAN_HAVE_SSE2_DEVICE_IO
+    if (deviceChannels == 2 && channels == 2 && !dither) {
+        const float* left = source.getReadPointer(0) + sourceOffset;
+        const float* right = source.getReadPointer(1) + sourceOffset;
+        if (format_ == SampleFormat::Float32) {
+            interleaveStereoFloat(left, right, static_cast<float*>(device), n);
+            return;
+        }
+        if (format_ == SampleFormat::Int16) {
+            interleaveStereoInt16(left, right, static_cast<int16_t*>(device), n);
+            return;
+        }
+    }
+#endif
+
+    for (size_t ch = 0; ch < channels; ++ch) {
+        const float* in = source.getReadPointer(ch) + sourceOffset;
+        switch (format_) {
+            case SampleFormat::Float32: {
+                float* out = static_cast<float*>(device) + ch;
+                if (deviceChannels == 1) {
+                    std::memcpy(out, in, n * sizeof(float));
+                    break;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    out[i * deviceChannels] = in[i];
+                }
+                break;
+            }
+            case SampleFormat::Int16: {
+                int16_t* out = static_cast<int16_t*>(device) + ch;
+                for (size_t i = 0; i < n; ++i) {
+                    float value = in[i] * INT16_SCALE + (dither ? nextDither() : 0.0f);
+                    out[i * deviceChannels] = static_cast<int16_t>(quantize(value, -32768.0f, 32767.0f));
+                }
+                break;
+            }
+            case SampleFormat::Int24: {
+                uint8_t* out = static_cast<uint8_t*>(device) + ch * 3;
+                for (size_t i = 0; i < n; ++i) {
+                    float value = in[i] * INT24_SCALE + (dither ? nextDither() : 0.0f);
+                    writeInt24(out + i * frameBytes, quantize(value, -8388608.0f, 8388607.0f));
+                }
+                break;
+            }
+            case SampleFormat::Int32: {
+                // float can't hold INT32_MAX exactly, so scale and clamp in double
+                int32_t* out = static_cast<int32_t*>(device) + ch;
+                for (size_t i = 0; i < n; ++i) {
+                    double value = static_cast<double>(in[i]) * INT32_SCALE + (dither ? nextDither() : 0.0f);
+                    value = std::min(std::max(value, -2147483648.0), 2147483647.0);
+                    out[i * deviceChannels] = static_cast<int32_t>(std::llrint(value));
+                }
+                break;
+            }
+        }
+    }
+}
+
+} // namespace pan
@@ -1,4 +1,5 @@
 #include "pan/audio/distortion.h"
+#include "pan/dsp/fast_math.h"
 #include <algorithm>
 
 namespace pan {
@@ -55,7 +56,7 @@ float Distortion::waveshape(float input) {
     switch (type_) {
         case Type::SoftClip:
             // Tanh soft clipping - smooth, tube-like saturation
-            return std::tanh(input);
+            return dsp::tanh(input);
             
         case Type::HardClip:
             // Digital hard clipping - harsh, aggressive
@@ -65,26 +66,26 @@ float Distortion::waveshape(float input) {
             // Asymmetric soft clipping - amp-like character
             // Positive side clips harder than negative
             if (input > 0) {
-                return 1.0f - std::exp(-input);
+                return 1.0f - dsp::exp(-input);
             } else {
-                return -1.0f + std::exp(input);
+                return -1.0f + dsp::exp(input);
             }
             
         case Type::Fuzz:
             // Extreme distortion - almost square wave
             // Uses a steeper sigmoid
-            return std::tanh(input * 3.0f) * 0.9f + std::tanh(input) * 0.1f;
+            return dsp::tanh(input * 3.0f) * 0.9f + dsp::tanh(input) * 0.1f;
             
         default:
-            return std::tanh(input);
+            return dsp::tanh(input);
     }
 }
 
 void Distortion::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
     
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     // Calculate low-pass filter coefficient from tone parameter
     // tone_ = 0 -> very dark (low cutoff), tone_ = 1 -> bright (high cutoff)
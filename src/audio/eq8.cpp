@@ -229,11 +229,29 @@ float EQ8::processBiquad(int bandIndex, float input, bool isLeft) {
     return output;
 }
 
+double EQ8::getTailSeconds() const {
+    // A resonant band rings with time constant Q / (pi f); 80 dB takes ln(1e4) of those
+    double tail = 0.0;
+    for (const auto& band : bands_) {
+        if (band.enabled && band.frequency > 0.0f) {
+            tail = std::max(tail, std::log(1e4) * band.q / (M_PI * band.frequency));
+        }
+    }
+    return tail;
+}
+
+void EQ8::hashParameters(ParameterHash& hash) const {
+    hash.add(outputGain_);
+    for (const auto& band : bands_) {
+        hash.add(band.enabled).add(band.type).add(band.frequency).add(band.gain).add(band.q);
+    }
+}
+
 void EQ8::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
     
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     for (size_t i = 0; i < numFrames; ++i) {
         float sampleL = left[i];
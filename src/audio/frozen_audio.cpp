@@ -0,0 +1,43 @@
+#include "pan/audio/frozen_audio.h"
+#include <algorithm>
+#include <utility>
+
+namespace pan {
+
+FrozenAudio::FrozenAudio(AudioBuffer audio, uint64_t fingerprint)
+    : audio_(std::move(audio))
+    , fingerprint_(fingerprint)
+{
+}
+
+bool FrozenAudio::covers(int64_t position, size_t numFrames) const {
+    return position < static_cast<int64_t>(audio_.getNumFrames()) &&
+           position + static_cast<int64_t>(numFrames) > 0;
+}
+
+void FrozenAudio::read(AudioBuffer& dest, int64_t position, size_t numFrames) const {
+    numFrames = std::min(numFrames, dest.getNumFrames());
+    const size_t channels = dest.getNumChannels();
+    if (!covers(position, numFrames) || audio_.getNumChannels() == 0) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            dest.clear(ch, 0, numFrames);
+        }
+        return;
+    }
+
+    // Split the block into silence before the render, the overlap, and silence after it
+    const int64_t renderFrames = static_cast<int64_t>(audio_.getNumFrames());
+    const size_t lead = position < 0 ? static_cast<size_t>(-position) : 0;
+    const size_t source = static_cast<size_t>(std::max<int64_t>(position, 0));
+    const size_t overlap = static_cast<size_t>(std::min<int64_t>(
+        static_cast<int64_t>(numFrames - lead), renderFrames - static_cast<int64_t>(source)));
+    for (size_t ch = 0; ch < channels; ++ch) {
+        // Mono renders feed every channel
+        size_t sourceChannel = std::min(ch, audio_.getNumChannels() - 1);
+        dest.clear(ch, 0, lead);
+        dest.copyFrom(ch, lead, audio_, sourceChannel, source, overlap);
+        dest.clear(ch, lead + overlap, numFrames - lead - overlap);
+    }
+}
+
+} // namespace pan
@@ -0,0 +1,272 @@
+#include "pan/audio/interpolation.h"
+#include "pan/dsp/simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace pan {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Cutoff at level 0, in cycles per source frame. With the Kaiser window
+// below the transition band ends at the source Nyquist.
+constexpr double BASE_CUTOFF = 0.42;
+constexpr double KAISER_BETA = 8.6;  // About 90 dB of stopband rejection
+
+// SincResampler: passband to about 0.445 of the lower rate, transition
+// centred just under its Nyquist, about 100 dB of rejection
+constexpr double RESAMPLER_CUTOFF = 0.47;
+constexpr double RESAMPLER_BETA = 10.0;
+
+// Modified Bessel function of the first kind, order 0
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Frame offset of four reads' points, gathered one lane per read
+simd::float4 gather(const float* src, const uint32_t* positions, int offset) {
+    return simd::float4(src[positions[0] + offset], src[positions[1] + offset], src[positions[2] + offset],
+                        src[positions[3] + offset]);
+}
+
+// Four output frames per float4, then any left over one at a time
+void interpolateLinear(const float* src, const uint32_t* positions, const float* fractions, float* out, size_t count) {
+    using simd::float4;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        const float4 x0 = gather(src, positions + k, 0);
+        const float4 x1 = gather(src, positions + k, 1);
+        (x0 + float4::loadUnaligned(fractions + k) * (x1 - x0)).storeUnaligned(out + k);
+    }
+    for (; k < count; ++k) {
+        const float* x = src + positions[k];
+        out[k] = x[0] + fractions[k] * (x[1] - x[0]);
+    }
+}
+
+// Catmull-Rom: passes through every frame, continuous first derivative
+void interpolateCubic(const float* src, const uint32_t* positions, const float* fractions, float* out, size_t count) {
+    using simd::float4;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        const float4 x0 = gather(src, positions + k, -1);
+        const float4 x1 = gather(src, positions + k, 0);
+        const float4 x2 = gather(src, positions + k, 1);
+        const float4 x3 = gather(src, positions + k, 2);
+        const float4 t = float4::loadUnaligned(fractions + k);
+        const float4 c1 = float4(0.5f) * (x2 - x0);
+        const float4 c2 = x0 - float4(2.5f) * x1 + float4(2.0f) * x2 - float4(0.5f) * x3;
+        const float4 c3 = float4(0.5f) * (x3 - x0) + float4(1.5f) * (x1 - x2);
+        (((c3 * t + c2) * t + c1) * t + x1).storeUnaligned(out + k);
+    }
+    for (; k < count; ++k) {
+        const float* x = src + positions[k] - 1;
+        const float t = fractions[k];
+        const float c1 = 0.5f * (x[2] - x[0]);
+        const float c2 = x[0] - 2.5f * x[1] + 2.0f * x[2] - 0.5f * x[3];
+        const float c3 = 0.5f * (x[3] - x[0]) + 1.5f * (x[1] - x[2]);
+        out[k] = ((c3 * t + c2) * t + c1) * t + x[1];
+    }
+}
+
+// Tabulate a Kaiser-windowed sinc low-pass at numPhases + 1 fractions;
+// cutoff is in cycles per source frame
+void fillSincTable(float* table, size_t taps, size_t numPhases, double cutoff, double beta) {
+    const double windowNorm = besselI0(beta);
+    const double half = static_cast<double>(taps / 2);
+    std::vector<double> row(taps);
+    for (size_t phase = 0; phase <= numPhases; ++phase) {
+        const double fraction = static_cast<double>(phase) / numPhases;
+        double sum = 0.0;
+        for (size_t j = 0; j < taps; ++j) {
+            // Distance from the read position to this tap's frame
+            double t = static_cast<double>(j) - (half - 1.0) - fraction;
+            double x = 2.0 * cutoff * t;
+            double sinc = x == 0.0 ? 1.0 : std::sin(PI * x) / (PI * x);
+            double w = t / half;
+            double window = std::fabs(w) >= 1.0 ? 0.0 : besselI0(beta * std::sqrt(1.0 - w * w)) / windowNorm;
+            row[j] = sinc * window;
+            sum += row[j];
+        }
+        // Unity gain at DC for every fraction, so steady signals don't pick up a ripple
+        for (size_t j = 0; j < taps; ++j) {
+            table[phase * taps + j] = static_cast<float>(row[j] / sum);
+        }
+    }
+}
+
+// Taps j..j+3 of one frame: its kernel row blended toward the next, applied to both channels
+template <bool Stereo>
+inline void accumulateTaps(const float* kernel, size_t taps, simd::float4 blend, const float* left,
+                           const float* right, size_t j, simd::float4& sumL, simd::float4& sumR) {
+    using simd::float4;
+    const float4 a = float4::loadUnaligned(kernel + j);
+    const float4 coefficients = a + blend * (float4::loadUnaligned(kernel + taps + j) - a);
+    sumL = sumL + coefficients * float4::loadUnaligned(left + j);
+    if (Stereo) {
+        sumR = sumR + coefficients * float4::loadUnaligned(right + j);
+    }
+}
+
+// Four output frames at once, each with its own kernel row, blend and
+// accumulators, interleaved tap by tap so the four chains overlap; sum4
+// folds the accumulators into four outputs
+template <bool Stereo>
+void convolveFour(const float* table, size_t taps, const float* rows, const float* blends, const float* srcL,
+                  const float* srcR, const uint32_t* positions, size_t before, float* outL, float* outR) {
+    using simd::float4;
+    const float* kernel[4];
+    const float* left[4];
+    const float* right[4] = {};
+    for (int i = 0; i < 4; ++i) {
+        kernel[i] = table + static_cast<size_t>(rows[i]) * taps;
+        left[i] = srcL + positions[i] - before;
+        if (Stereo) {
+            right[i] = srcR + positions[i] - before;
+        }
+    }
+    const float4 b0(blends[0]), b1(blends[1]), b2(blends[2]), b3(blends[3]);
+    float4 l0(0.0f), l1(0.0f), l2(0.0f), l3(0.0f);
+    float4 r0(0.0f), r1(0.0f), r2(0.0f), r3(0.0f);
+    for (size_t j = 0; j < taps; j += 4) {
+        accumulateTaps<Stereo>(kernel[0], taps, b0, left[0], right[0], j, l0, r0);
+        accumulateTaps<Stereo>(kernel[1], taps, b1, left[1], right[1], j, l1, r1);
+        accumulateTaps<Stereo>(kernel[2], taps, b2, left[2], right[2], j, l2, r2);
+        accumulateTaps<Stereo>(kernel[3], taps, b3, left[3], right[3], j, l3, r3);
+    }
+    simd::sum4(l0, l1, l2, l3).storeUnaligned(outL);
+    if (Stereo) {
+        simd::sum4(r0, r1, r2, r3).storeUnaligned(outR);
+    }
+}
+
+// Apply a table from fillSincTable at each position + fraction
+void convolveSinc(const float* table, size_t taps, size_t numPhases, const float* srcL, const float* srcR,
+                  const uint32_t* positions, const float* fractions, float* outL, float* outR, size_t count) {
+    using simd::float4;
+    const size_t before = taps / 2 - 1;
+    const float4 rows(static_cast<float>(numPhases));
+    const float4 lastRow(static_cast<float>(numPhases - 1));
+
+    // Four frames at a time, their phases in one vector
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        const float4 phase = float4::loadUnaligned(fractions + k) * rows;
+        const float4 row = simd::min(simd::truncate(phase), lastRow);
+        alignas(16) float rowIndex[4];
+        alignas(16) float blend[4];
+        row.store(rowIndex);
+        (phase - row).store(blend);
+        if (srcR) {
+            convolveFour<true>(table, taps, rowIndex, blend, srcL, srcR, positions + k, before, outL + k, outR + k);
+        } else {
+            convolveFour<false>(table, taps, rowIndex, blend, srcL, nullptr, positions + k, before, outL + k, nullptr);
+        }
+    }
+
+    for (; k < count; ++k) {
+        float phase = fractions[k] * static_cast<float>(numPhases);
+        size_t row = static_cast<size_t>(phase);
+        if (row >= numPhases) {
+            row = numPhases - 1;
+        }
+        const float4 blend(phase - static_cast<float>(row));
+        const float* kernel = table + row * taps;
+        const float* next = kernel + taps;
+        const float* left = srcL + positions[k] - before;
+        const float* right = srcR ? srcR + positions[k] - before : nullptr;
+
+        // Taps four at a time; the kernel for this exact fraction is blended from the two nearest rows
+        float4 sumL(0.0f);
+        float4 sumR(0.0f);
+        for (size_t j = 0; j < taps; j += 4) {
+            const float4 a = float4::loadUnaligned(kernel + j);
+            const float4 coefficients = a + blend * (float4::loadUnaligned(next + j) - a);
+            sumL = sumL + coefficients * float4::loadUnaligned(left + j);
+            if (right) {
+                sumR = sumR + coefficients * float4::loadUnaligned(right + j);
+            }
+        }
+        outL[k] = simd::sum(sumL);
+        if (right) {
+            outR[k] = simd::sum(sumR);
+        }
+    }
+}
+
+void interpolateSinc(double increment, const float* srcL, const float* srcR, const uint32_t* positions,
+                     const float* fractions, float* outL, float* outR, size_t count) {
+    const size_t level = SincKernelBank::selectLevel(increment);
+    convolveSinc(SincKernelBank::get().getKernel(level, 0), SincKernelBank::getTaps(level),
+                 SincKernelBank::NUM_PHASES, srcL, srcR, positions, fractions, outL, outR, count);
+}
+
+} // namespace
+
+const SincKernelBank& SincKernelBank::get() {
+    static const SincKernelBank bank;
+    return bank;
+}
+
+SincKernelBank::SincKernelBank()
+    : levels_(NUM_LEVELS)
+{
+    for (size_t level = 0; level < NUM_LEVELS; ++level) {
+        const size_t taps = getTaps(level);
+        levels_[level].resize((NUM_PHASES + 1) * taps);
+        fillSincTable(levels_[level].data(), taps, NUM_PHASES, BASE_CUTOFF / getSpeedUp(level), KAISER_BETA);
+    }
+}
+
+SincResampler::SincResampler(double sourceRate, double targetRate)
+    : increment_(sourceRate / targetRate)
+    , kernel_((NUM_PHASES + 1) * TAPS)
+{
+    // Band-limit to whichever Nyquist is lower: the source's when upsampling,
+    // the target's when downsampling
+    const double cutoff = RESAMPLER_CUTOFF * std::min(1.0, targetRate / sourceRate);
+    fillSincTable(kernel_.data(), TAPS, NUM_PHASES, cutoff, RESAMPLER_BETA);
+}
+
+void SincResampler::process(const float* srcL, const float* srcR, const uint32_t* positions, const float* fractions,
+                            float* outL, float* outR, size_t count) const {
+    convolveSinc(kernel_.data(), TAPS, NUM_PHASES, srcL, srcR, positions, fractions, outL, outR, count);
+}
+
+size_t getInterpolationReach(InterpolationQuality quality, double increment) {
+    switch (quality) {
+        case InterpolationQuality::Cubic: return 2;
+        case InterpolationQuality::Sinc: return SincKernelBank::getTaps(SincKernelBank::selectLevel(increment)) / 2;
+        default: return 1;
+    }
+}
+
+void interpolate(InterpolationQuality quality, double increment,
+                 const float* srcL, const float* srcR, const uint32_t* positions, const float* fractions,
+                 float* outL, float* outR, size_t count) {
+    switch (quality) {
+        case InterpolationQuality::Sinc:
+            interpolateSinc(increment, srcL, srcR, positions, fractions, outL, outR, count);
+            return;
+        case InterpolationQuality::Cubic:
+            interpolateCubic(srcL, positions, fractions, outL, count);
+            if (srcR) interpolateCubic(srcR, positions, fractions, outR, count);
+            return;
+        default:
+            interpolateLinear(srcL, positions, fractions, outL, count);
+            if (srcR) interpolateLinear(srcR, positions, fractions, outR, count);
+            return;
+    }
+}
+
+} // namespace pan
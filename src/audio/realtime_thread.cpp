@@ -0,0 +1,239 @@
+#include "pan/audio/realtime_thread.h"
+#include "pan/audio/audio_buffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PAN_HAVE_PTHREAD_SCHED 1
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define PAN_HAVE_MXCSR 1
+#endif
+
+namespace pan {
+namespace realtime {
+
+namespace {
+
+#if defined(PAN_HAVE_MXCSR)
+// FTZ (bit 15) and DAZ (bit 6)
+constexpr unsigned long long FLUSH_BITS = 0x8040;
+unsigned long long readFloatControl() { return _mm_getcsr(); }
+void writeFloatControl(unsigned long long value) { _mm_setcsr(static_cast<unsigned int>(value)); }
+constexpr bool HAVE_FLOAT_CONTROL = true;
+#elif defined(__aarch64__)
+// FPCR.FZ (bit 24) covers both inputs and outputs
+constexpr unsigned long long FLUSH_BITS = 1ull << 24;
+unsigned long long readFloatControl() {
+    unsigned long long value;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(value));
+    return value;
+}
+void writeFloatControl(unsigned long long value) { __asm__ __volatile__("msr fpcr, %0" : : "r"(value)); }
+constexpr bool HAVE_FLOAT_CONTROL = true;
+#else
+constexpr unsigned long long FLUSH_BITS = 0;
+unsigned long long readFloatControl() { return 0; }
+void writeFloatControl(unsigned long long) {}
+constexpr bool HAVE_FLOAT_CONTROL = false;
+#endif
+
+#ifdef PAN_HAVE_PTHREAD_SCHED
+void elevatePriority(const RealtimeThreadPolicy& policy, RealtimeThreadReport& report) {
+    pthread_t self = pthread_self();
+    int currentPolicy = 0;
+    sched_param param{};
+    const int minPriority = sched_get_priority_min(SCHED_FIFO);
+    const int maxPriority = sched_get_priority_max(SCHED_FIFO);
+    const int requested = std::min(std::max(policy.priority, minPriority), maxPriority);
+
+    // The host (JACK, some ALSA setups) may already run us real-time
+    if (pthread_getschedparam(self, &currentPolicy, &param) == 0 &&
+        (currentPolicy == SCHED_FIFO || currentPolicy == SCHED_RR) && param.sched_priority >= requested) {
+        report.realtimePriority = true;
+        report.priority = param.sched_priority;
+        return;
+    }
+
+    param.sched_priority = requested;
+    int err = pthread_setschedparam(self, SCHED_FIFO, &param);
+#ifdef __linux__
+    // Without CAP_SYS_NICE, RLIMIT_RTPRIO caps the priority we may ask for
+    if (err == EPERM) {
+        rlimit limit{};
+        if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur > 0 &&
+            limit.rlim_cur < static_cast<rlim_t>(requested)) {
+            param.sched_priority = static_cast<int>(limit.rlim_cur);
+            err = pthread_setschedparam(self, SCHED_FIFO, &param);
+        }
+    }
+#endif
+    if (err == 0) {
+        report.realtimePriority = true;
+        report.priority = param.sched_priority;
+        return;
+    }
+    report.priorityError = err;
+
+#ifdef __linux__
+    // Best effort: a lower nice value still helps under CFS
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    report.niceFallback = setpriority(PRIO_PROCESS, static_cast<id_t>(tid), -10) == 0;
+#endif
+}
+#endif
+
+void pinToCpu(int cpu, RealtimeThreadReport& report) {
+#ifdef __linux__
+    unsigned int numCpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<unsigned int>(cpu) % numCpus, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    report.affinitySet = err == 0;
+    report.affinityError = err;
+#else
+    (void)cpu;
+    report.affinityError = ENOSYS;
+#endif
+}
+
+} // namespace
+
+RealtimeThreadReport applyToCurrentThread(const RealtimeThreadPolicy& policy, int cpuOffset) {
+    RealtimeThreadReport report;
+    report.applied = true;
+    if (policy.flushDenormals) {
+        report.denormalsFlushed = enableDenormalFlushing();
+    }
+#ifdef PAN_HAVE_PTHREAD_SCHED
+    if (policy.elevatePriority) {
+        elevatePriority(policy, report);
+    }
+#else
+    report.priorityError = policy.elevatePriority ? ENOSYS : 0;
+#endif
+    if (policy.cpu >= 0) {
+        pinToCpu(policy.cpu + cpuOffset, report);
+    }
+    return report;
+}
+
+bool enableDenormalFlushing() {
+    if (!HAVE_FLOAT_CONTROL) {
+        return false;
+    }
+    writeFloatControl(readFloatControl() | FLUSH_BITS);
+    return isDenormalFlushingEnabled();
+}
+
+bool isDenormalFlushingEnabled() {
+    return HAVE_FLOAT_CONTROL && (readFloatControl() & FLUSH_BITS) == FLUSH_BITS;
+}
+
+size_t getBufferBytes(const AudioBuffer& buffer) {
+    return buffer.getNumChannels() * buffer.getChannelStride() * sizeof(float);
+}
+
+bool lockBuffer(const AudioBuffer& buffer, int* error) {
+    const float* data = buffer.getReadPointer(0);
+    size_t bytes = getBufferBytes(buffer);
+    if (!data || bytes == 0) {
+        return true;
+    }
+#ifdef PAN_HAVE_PTHREAD_SCHED
+    if (mlock(data, bytes) != 0) {
+        if (error) {
+            *error = errno;
+        }
+        return false;
+    }
+    return true;
+#else
+    if (error) {
+        *error = ENOSYS;
+    }
+    return false;
+#endif
+}
+
+void unlockBuffer(const AudioBuffer& buffer) {
+    const float* data = buffer.getReadPointer(0);
+    size_t bytes = getBufferBytes(buffer);
+#ifdef PAN_HAVE_PTHREAD_SCHED
+    if (data && bytes > 0) {
+        munlock(data, bytes);
+    }
+#else
+    (void)data;
+    (void)bytes;
+#endif
+}
+
+ScopedDenormalFlush::ScopedDenormalFlush(bool enable) {
+    if (enable && HAVE_FLOAT_CONTROL) {
+        saved_ = readFloatControl();
+        active_ = true;
+        enableDenormalFlushing();
+    }
+}
+
+ScopedDenormalFlush::~ScopedDenormalFlush() {
+    if (active_) {
+        writeFloatControl(saved_);
+    }
+}
+
+} // namespace realtime
+
+std::string RealtimeDiagnostics::describe() const {
+    std::ostringstream out;
+    out << "Audio thread: ";
+    if (!audioThread.applied) {
+        out << "not configured yet";
+    } else {
+        if (audioThread.realtimePriority) {
+            out << "SCHED_FIFO priority " << audioThread.priority;
+        } else {
+            out << "normal priority";
+            if (audioThread.priorityError != 0) {
+                out << " (real-time request failed: " << std::strerror(audioThread.priorityError) << ")";
+            }
+            if (audioThread.niceFallback) {
+                out << ", raised nice level";
+            }
+        }
+        out << ", denormals " << (audioThread.denormalsFlushed ? "flushed" : "not flushed");
+        if (audioThread.affinitySet) {
+            out << ", pinned";
+        } else if (audioThread.affinityError != 0) {
+            out << ", pinning failed (" << std::strerror(audioThread.affinityError) << ")";
+        }
+    }
+    out << "\nRender workers: " << realtimeRenderWorkers << "/" << renderWorkers << " real-time";
+    out << "\nMemory: ";
+    if (memoryLocked) {
+        out << lockedBytes << " bytes locked";
+    } else if (memoryLockError != 0) {
+        out << "locking failed (" << std::strerror(memoryLockError) << ")";
+    } else {
+        out << "not locked";
+    }
+    return out.str();
+}
+
+} // namespace pan
@@ -0,0 +1,305 @@
+#include "pan/audio/render_pool.h"
+#include "pan/audio/rt_alloc_check.h"
+#include <algorithm>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace pan {
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+#ifdef __linux__
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+static inline uint32_t* futexWord(std::atomic<uint32_t>& word) {
+    return reinterpret_cast<uint32_t*>(&word);
+}
+#endif
+
+static inline uint64_t packRange(uint32_t generation, size_t front, size_t back) {
+    return (static_cast<uint64_t>(generation) << 32) |
+           (static_cast<uint64_t>(front & 0xFFFF) << 16) |
+           static_cast<uint64_t>(back & 0xFFFF);
+}
+
+RenderPool::RenderPool() {
+    setNumThreads(0);
+}
+
+RenderPool::~RenderPool() {
+    setNumThreads(0);
+}
+
+void RenderPool::setNumThreads(size_t numThreads) {
+    // Stop existing workers. Bumping the generation keeps a worker that is
+    // about to park from sleeping through the wake.
+    stopping_ = true;
+    generation_.fetch_add(1, std::memory_order_seq_cst);
+    wakeSleepers();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    stopping_ = false;
+    realtimeWorkers_ = 0;
+
+    // Slot 0 belongs to the calling (audio) thread
+    numSlots_ = numThreads + 1;
+    slots_ = std::make_unique<Slot[]>(numSlots_);
+    consecutiveMisses_ = 0;
+    blockIntervalNanos_ = 0;
+    lastRunTime_ = {};
+    serialFallbackBlocks_ = 0;
+
+    workers_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&RenderPool::workerLoop, this, i + 1);
+    }
+}
+
+void RenderPool::setRealtimePolicy(const RealtimeThreadPolicy& policy) {
+    std::lock_guard<std::mutex> lock(policyMutex_);
+    policy_ = policy;
+    policy_.priority = std::max(policy.priority - 1, 1);
+    realtimeWorkers_ = 0;
+    policyEpoch_.fetch_add(1, std::memory_order_relaxed);
+}
+
+RenderPool::Stats RenderPool::getStats() const {
+    Stats stats;
+    stats.parallelBlocks = parallelBlocks_.load(std::memory_order_relaxed);
+    stats.serialBlocks = serialBlocks_.load(std::memory_order_relaxed);
+    stats.deadlineMisses = deadlineMisses_.load(std::memory_order_relaxed);
+    stats.stolenTasks = stolenTasks_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void RenderPool::runSerial(size_t taskCount, TaskFunction fn, void* context) {
+    for (size_t i = 0; i < taskCount; ++i) {
+        fn(context, i);
+    }
+    serialBlocks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool RenderPool::claimFront(size_t slotIndex, uint32_t generation, size_t& taskIndex) {
+    auto& range = slots_[slotIndex].range;
+    uint64_t value = range.load(std::memory_order_acquire);
+    while (true) {
+        size_t front = (value >> 16) & 0xFFFF;
+        size_t back = value & 0xFFFF;
+        if (static_cast<uint32_t>(value >> 32) != generation || front >= back) {
+            return false;
+        }
+        if (range.compare_exchange_weak(value, packRange(generation, front + 1, back),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+            taskIndex = front;
+            return true;
+        }
+    }
+}
+
+bool RenderPool::claimBack(size_t slotIndex, uint32_t generation, size_t& taskIndex) {
+    auto& range = slots_[slotIndex].range;
+    uint64_t value = range.load(std::memory_order_acquire);
+    while (true) {
+        size_t front = (value >> 16) & 0xFFFF;
+        size_t back = value & 0xFFFF;
+        if (static_cast<uint32_t>(value >> 32) != generation || front >= back) {
+            return false;
+        }
+        if (range.compare_exchange_weak(value, packRange(generation, front, back - 1),
+                                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+            taskIndex = back - 1;
+            return true;
+        }
+    }
+}
+
+bool RenderPool::executeFrom(size_t slotIndex, uint32_t generation, TaskFunction fn, void* context) {
+    bool didWork = false;
+    size_t taskIndex = 0;
+
+    // Own range first, from the front
+    while (claimFront(slotIndex, generation, taskIndex)) {
+        fn(context, taskIndex);
+        remaining_.fetch_sub(1, std::memory_order_acq_rel);
+        didWork = true;
+    }
+
+    // Then steal from the back of everyone else's range
+    for (size_t k = 1; k < numSlots_; ++k) {
+        size_t victim = (slotIndex + k) % numSlots_;
+        while (claimBack(victim, generation, taskIndex)) {
+            fn(context, taskIndex);
+            remaining_.fetch_sub(1, std::memory_order_acq_rel);
+            stolenTasks_.fetch_add(1, std::memory_order_relaxed);
+            didWork = true;
+        }
+    }
+    return didWork;
+}
+
+bool RenderPool::run(size_t taskCount, TaskFunction fn, void* context, double deadlineSeconds) {
+    if (taskCount == 0 || !fn) {
+        return false;
+    }
+    if (workers_.empty() || taskCount == 1 || taskCount > MAX_TASKS) {
+        runSerial(taskCount, fn, context);
+        return false;
+    }
+
+    int fallback = serialFallbackBlocks_.load(std::memory_order_relaxed);
+    if (fallback > 0) {
+        serialFallbackBlocks_.store(fallback - 1, std::memory_order_relaxed);
+        runSerial(taskCount, fn, context);
+        return false;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    if (lastRunTime_.time_since_epoch().count() != 0) {
+        auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(startTime - lastRunTime_);
+        blockIntervalNanos_.store(interval.count(), std::memory_order_relaxed);
+    }
+    lastRunTime_ = startTime;
+
+    // Publish the job, then bump the generation so workers pick it up
+    uint32_t generation = generation_.load(std::memory_order_relaxed) + 1;
+    jobFunction_.store(fn, std::memory_order_relaxed);
+    jobContext_.store(context, std::memory_order_relaxed);
+    remaining_.store(taskCount, std::memory_order_relaxed);
+    for (size_t s = 0; s < numSlots_; ++s) {
+        size_t begin = taskCount * s / numSlots_;
+        size_t end = taskCount * (s + 1) / numSlots_;
+        slots_[s].range.store(packRange(generation, begin, end), std::memory_order_relaxed);
+    }
+    generation_.store(generation, std::memory_order_seq_cst);
+
+    // Workers still spinning from the previous block pick the job up on their own
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        wakeSleepers();
+    }
+
+    executeFrom(0, generation, fn, context);
+
+    // Wait for tasks still running on workers
+    while (remaining_.load(std::memory_order_acquire) != 0) {
+        cpuRelax();
+    }
+
+    parallelBlocks_.fetch_add(1, std::memory_order_relaxed);
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (deadlineSeconds > 0.0 && elapsed > deadlineSeconds) {
+        deadlineMisses_.fetch_add(1, std::memory_order_relaxed);
+        if (++consecutiveMisses_ >= MAX_CONSECUTIVE_MISSES) {
+            consecutiveMisses_ = 0;
+            serialFallbackBlocks_.store(SERIAL_FALLBACK_BLOCKS, std::memory_order_relaxed);
+        }
+    } else {
+        consecutiveMisses_ = 0;
+    }
+    return true;
+}
+
+void RenderPool::wakeSleepers() {
+#ifdef __linux__
+    syscall(SYS_futex, futexWord(generation_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    parkCondition_.notify_all();
+#endif
+}
+
+void RenderPool::waitForJob(uint32_t seen) {
+    auto isReady = [&] {
+        return stopping_.load(std::memory_order_relaxed) || generation_.load(std::memory_order_acquire) != seen;
+    };
+
+    // Spin for about one block interval so back-to-back blocks find the worker
+    // awake: pause briefly, then yield so other threads on this core can run.
+    const int64_t interval = blockIntervalNanos_.load(std::memory_order_relaxed);
+    const auto spinBudget = std::chrono::nanoseconds(std::min<int64_t>(
+        interval + interval / 2, static_cast<int64_t>(MAX_SPIN_SECONDS * 1e9)));
+    const auto spinStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < 64; ++i) {
+        if (isReady()) {
+            return;
+        }
+        cpuRelax();
+    }
+    while (std::chrono::steady_clock::now() - spinStart < spinBudget) {
+        if (isReady()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    // Park. The sleeper count is raised before the final check, pairing with
+    // run() storing the generation before it reads the count.
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    while (!isReady()) {
+#ifdef __linux__
+        syscall(SYS_futex, futexWord(generation_), FUTEX_WAIT_PRIVATE, seen, nullptr, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(parkMutex_);
+        parkCondition_.wait_for(lock, std::chrono::milliseconds(1), isReady);
+#endif
+    }
+    sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void RenderPool::workerLoop(size_t slotIndex) {
+    uint32_t seen = generation_.load(std::memory_order_acquire);
+    uint32_t appliedEpoch = 0;
+
+    while (true) {
+        waitForJob(seen);
+        if (stopping_) {
+            return;
+        }
+
+        uint32_t epoch = policyEpoch_.load(std::memory_order_relaxed);
+        if (epoch != appliedEpoch) {
+            RealtimeThreadPolicy policy;
+            {
+                std::lock_guard<std::mutex> lock(policyMutex_);
+                appliedEpoch = policyEpoch_.load(std::memory_order_relaxed);
+                policy = policy_;
+            }
+            RealtimeThreadReport report = realtime::applyToCurrentThread(policy, static_cast<int>(slotIndex));
+            if (report.realtimePriority) {
+                realtimeWorkers_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // A claim only succeeds while this generation's job is unfinished,
+        // so the function and context loaded here belong to it.
+        uint32_t generation = generation_.load(std::memory_order_acquire);
+        seen = generation;
+        TaskFunction fn = jobFunction_.load(std::memory_order_acquire);
+        void* context = jobContext_.load(std::memory_order_acquire);
+        if (fn) {
+            RealtimeAllocationGuard allocationGuard;
+            executeFrom(slotIndex, generation, fn, context);
+        }
+    }
+}
+
+} // namespace pan
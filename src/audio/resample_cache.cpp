@@ -0,0 +1,259 @@
+#include "pan/audio/resample_cache.h"
+#include "pan/audio/interpolation.h"
+#include "pan/audio/parameter_hash.h"
+#include "pan/audio/wav_writer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace pan {
+
+namespace {
+
+// Bump whenever SincResampler's output changes, so old conversions aren't reused
+constexpr uint64_t CONVERTER_VERSION = 1;
+
+constexpr size_t CHUNK_FRAMES = 4096;  // Target frames converted per pass
+
+// Source frames [first, first + count) into left and right (null for mono),
+// silent outside the sample. Resident frames are copied, the rest read from
+// the sample's stream.
+bool readSource(const Sample& source, int64_t first, size_t count, float* left, float* right,
+                std::vector<uint8_t>& scratch) {
+    std::fill(left, left + count, 0.0f);
+    if (right) {
+        std::fill(right, right + count, 0.0f);
+    }
+    const int64_t begin = std::max<int64_t>(first, 0);
+    const int64_t end = std::min<int64_t>(first + static_cast<int64_t>(count),
+                                          static_cast<int64_t>(source.getNumFrames()));
+    const int64_t resident = static_cast<int64_t>(source.dataL.size());
+
+    const int64_t residentEnd = std::min(end, resident);
+    if (begin < residentEnd) {
+        std::copy(source.dataL.begin() + begin, source.dataL.begin() + residentEnd, left + (begin - first));
+        if (right) {
+            std::copy(source.dataR.begin() + begin, source.dataR.begin() + residentEnd, right + (begin - first));
+        }
+    }
+
+    const int64_t streamed = std::max(begin, resident);
+    if (streamed < end) {
+        if (!source.stream) {
+            return false;
+        }
+        const size_t n = static_cast<size_t>(end - streamed);
+        if (source.stream->read(static_cast<size_t>(streamed), n, left + (streamed - first),
+                                right ? right + (streamed - first) : nullptr, scratch) != n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ResampleCache& ResampleCache::get() {
+    static ResampleCache cache;
+    return cache;
+}
+
+ResampleCache::ResampleCache() {
+    namespace fs = std::filesystem;
+    const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (cacheHome && *cacheHome) {
+        directory_ = (fs::path(cacheHome) / "pan" / "resampled").string();
+    } else if (home && *home) {
+        directory_ = (fs::path(home) / ".cache" / "pan" / "resampled").string();
+    } else {
+        std::error_code error;
+        directory_ = (fs::temp_directory_path(error) / "pan-resampled").string();
+    }
+}
+
+void ResampleCache::setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+}
+
+std::string ResampleCache::getDirectory() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directory_;
+}
+
+void ResampleCache::setMaxBytes(uintmax_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBytes_ = maxBytes;
+}
+
+uintmax_t ResampleCache::getMaxBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxBytes_;
+}
+
+void ResampleCache::prune(const std::string& keep) {
+    namespace fs = std::filesystem;
+    struct Entry {
+        fs::path path;
+        uintmax_t size;
+        fs::file_time_type written;
+    };
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code error;
+    // Only finished conversions; a .partial file may still be being written
+    for (fs::directory_iterator it(getDirectory(), error), end; !error && it != end; it.increment(error)) {
+        if (!it->is_regular_file(error) || it->path().extension() != ".wav") {
+            continue;
+        }
+        Entry entry{it->path(), it->file_size(error), it->last_write_time(error)};
+        if (!error) {
+            total += entry.size;
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    const uintmax_t maxBytes = getMaxBytes();
+    if (total <= maxBytes) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.written < b.written; });
+    size_t removed = 0;
+    for (const Entry& entry : entries) {
+        if (total <= maxBytes) {
+            break;
+        }
+        if (fs::equivalent(entry.path, keep, error) || !fs::remove(entry.path, error)) {
+            continue;
+        }
+        total -= entry.size;
+        ++removed;
+    }
+    if (removed > 0) {
+        std::cout << "ResampleCache: Removed " << removed << " old conversion" << (removed == 1 ? "" : "s")
+                  << " to stay under " << (maxBytes >> 20) << " MB" << std::endl;
+    }
+}
+
+std::string ResampleCache::getCachePath(const std::string& sourcePath, uintmax_t fileSize, int64_t modified,
+                                        double targetRate) const {
+    const int64_t milliHertz = std::llround(targetRate * 1000.0);
+    ParameterHash hash;
+    hash.add(sourcePath).add(fileSize).add(modified).add(milliHertz).add(CONVERTER_VERSION);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx_%lld.wav", static_cast<unsigned long long>(hash.get()),
+                  static_cast<long long>(std::llround(targetRate)));
+    return (std::filesystem::path(getDirectory()) / name).string();
+}
+
+bool ResampleCache::convert(const Sample& source, double targetRate, const std::string& cachePath,
+                            const ProgressCallback& onProgress) {
+    namespace fs = std::filesystem;
+    const size_t inFrames = source.getNumFrames();
+    if (inFrames == 0 || source.sampleRate <= 0.0 || targetRate <= 0.0) {
+        std::cerr << "ResampleCache: Nothing to convert in " << source.filePath << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    fs::create_directories(fs::path(cachePath).parent_path(), error);
+    if (error) {
+        std::cerr << "ResampleCache: Cannot create " << fs::path(cachePath).parent_path() << ": "
+                  << error.message() << std::endl;
+        return false;
+    }
+
+    // Written under a name of its own and renamed into place once complete
+    std::ostringstream partial;
+    partial << cachePath << ".partial-" << std::this_thread::get_id();
+    const std::string tempPath = partial.str();
+
+    const size_t channels = source.stereo ? 2 : 1;
+    WavWriter writer;
+    if (!writer.open(tempPath, channels, targetRate, WavWriter::Format::Float32)) {
+        std::cerr << "ResampleCache: Cannot write " << tempPath << std::endl;
+        return false;
+    }
+
+    // Target frame n reads the source at n * sourceRate / targetRate; the
+    // product is exact, so positions don't drift over long files
+    const SincResampler resampler(source.sampleRate, targetRate);
+    auto sourcePosition = [&](size_t frame) {
+        return static_cast<double>(frame) * source.sampleRate / targetRate;
+    };
+    const size_t outFrames = static_cast<size_t>(
+        std::ceil(static_cast<double>(inFrames) * targetRate / source.sampleRate - 1e-9));
+    const int64_t reach = static_cast<int64_t>(SincResampler::REACH);
+
+    std::vector<float> windowL, windowR;
+    std::vector<uint32_t> positions(CHUNK_FRAMES);
+    std::vector<float> fractions(CHUNK_FRAMES);
+    std::vector<float> outL(CHUNK_FRAMES), outR(CHUNK_FRAMES);
+    std::vector<float> interleaved(CHUNK_FRAMES * channels);
+    std::vector<uint8_t> scratch;
+
+    bool ok = true;
+    for (size_t done = 0; done < outFrames && ok; ) {
+        const size_t count = std::min(CHUNK_FRAMES, outFrames - done);
+
+        // Every source frame the chunk's kernels touch
+        const int64_t base = static_cast<int64_t>(std::floor(sourcePosition(done))) - (reach - 1);
+        const int64_t last = static_cast<int64_t>(std::floor(sourcePosition(done + count - 1)));
+        const size_t windowFrames = static_cast<size_t>(last + reach + 1 - base);
+        windowL.resize(windowFrames);
+        windowR.resize(source.stereo ? windowFrames : 0);
+        if (!readSource(source, base, windowFrames, windowL.data(), source.stereo ? windowR.data() : nullptr,
+                        scratch)) {
+            std::cerr << "ResampleCache: Read error in " << source.filePath << std::endl;
+            ok = false;
+            break;
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            const double position = sourcePosition(done + k);
+            const double whole = std::floor(position);
+            positions[k] = static_cast<uint32_t>(static_cast<int64_t>(whole) - base);
+            fractions[k] = static_cast<float>(position - whole);
+        }
+        resampler.process(windowL.data(), source.stereo ? windowR.data() : nullptr, positions.data(),
+                          fractions.data(), outL.data(), outR.data(), count);
+
+        for (size_t k = 0; k < count; ++k) {
+            interleaved[k * channels] = outL[k];
+            if (source.stereo) {
+                interleaved[k * channels + 1] = outR[k];
+            }
+        }
+        ok = writer.writeInterleaved(interleaved.data(), count);
+        done += count;
+        if (onProgress) {
+            onProgress(static_cast<float>(done) / outFrames);
+        }
+    }
+
+    ok = writer.close() && ok;
+    if (ok) {
+        fs::rename(tempPath, cachePath, error);
+        ok = !error;
+    }
+    if (!ok) {
+        std::cerr << "ResampleCache: Failed to convert " << source.filePath << std::endl;
+        fs::remove(tempPath, error);
+        return false;
+    }
+
+    std::cout << "ResampleCache: Converted '" << source.name << "' from " << source.sampleRate << " to "
+              << targetRate << " Hz (" << outFrames << " frames)" << std::endl;
+    return true;
+}
+
+} // namespace pan
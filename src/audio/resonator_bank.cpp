@@ -16,6 +16,14 @@ void ResonatorBank::reset() {
     }
 }
 
+double ResonatorBank::getTailSeconds() const {
+    size_t longest = 1;
+    for (const auto& comb : combs_) {
+        longest = std::max(longest, comb.delay);
+    }
+    return feedbackTailSeconds(static_cast<double>(longest) / sampleRate_, decay_);
+}
+
 void ResonatorBank::recalcDelays() {
     float ratios[3] = {1.0f, std::pow(2.0f, spreadSemi_ / 12.0f), std::pow(2.0f, -spreadSemi_ / 24.0f)};
     for (int i = 0; i < 3; ++i) {
@@ -31,8 +39,8 @@ void ResonatorBank::recalcDelays() {
 
 void ResonatorBank::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     for (size_t i = 0; i < numFrames; ++i) {
         float inputL = left[i];
@@ -1,5 +1,6 @@
 #include "pan/audio/reverb.h"
 #include "pan/audio/audio_buffer.h"
+#include "pan/dsp/fast_math.h"
 #include <cmath>
 #include <algorithm>
 
@@ -162,8 +163,8 @@ void Reverb::process(AudioBuffer& buffer, size_t numFrames) {
         float outR = inputR * dryLevel_ + outputR * wet1 + outputL * wet2;
         
         // Soft clipping to prevent harsh distortion
-        leftChannel[i] = std::tanh(outL);
-        rightChannel[i] = std::tanh(outR);
+        leftChannel[i] = dsp::tanh(outL);
+        rightChannel[i] = dsp::tanh(outR);
     }
 }
 
@@ -211,6 +212,16 @@ void Reverb::setWidth(float width) {
     width_ = std::clamp(width, 0.0f, 1.0f);
 }
 
+double Reverb::getTailSeconds() const {
+    // The longest comb rings longest; damping only shortens it
+    size_t longest = 0;
+    for (const auto& filter : combFiltersR_) {
+        longest = std::max(longest, filter.bufferSize);
+    }
+    float feedback = combFiltersR_.empty() ? 0.0f : combFiltersR_.front().feedback;
+    return feedbackTailSeconds(static_cast<double>(longest) / sampleRate_, feedback);
+}
+
 void Reverb::updateFilters() {
     float roomSize = roomSize_ * 0.28f + 0.7f;
     float damp = damping_ * 0.4f;
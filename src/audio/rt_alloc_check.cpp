@@ -0,0 +1,84 @@
+#include "pan/audio/rt_alloc_check.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace pan {
+
+// Plain int so no dynamic initialisation (and no allocation) happens on first use
+static thread_local int realtimeDepth = 0;
+
+RealtimeAllocationGuard::RealtimeAllocationGuard() {
+    ++realtimeDepth;
+}
+
+RealtimeAllocationGuard::~RealtimeAllocationGuard() {
+    --realtimeDepth;
+}
+
+bool RealtimeAllocationGuard::isActive() {
+    return realtimeDepth > 0;
+}
+
+bool RealtimeAllocationGuard::isCheckEnabled() {
+#ifdef PAN_RT_ALLOC_CHECK
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace pan
+
+#ifdef PAN_RT_ALLOC_CHECK
+
+static void* checkedAllocate(std::size_t size) {
+    if (pan::realtimeDepth > 0) {
+        std::fputs("PAN_RT_ALLOC_CHECK: heap allocation inside the audio callback\n", stderr);
+        std::abort();
+    }
+    void* ptr = std::malloc(size > 0 ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+static void* checkedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    if (pan::realtimeDepth > 0) {
+        std::fputs("PAN_RT_ALLOC_CHECK: heap allocation inside the audio callback\n", stderr);
+        std::abort();
+    }
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = ((size > 0 ? size : 1) + align - 1) / align * align;
+    void* ptr = std::aligned_alloc(align, rounded);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size) { return checkedAllocate(size); }
+void* operator new[](std::size_t size) { return checkedAllocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return checkedAllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return checkedAllocateAligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return checkedAllocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return checkedAllocate(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+#endif
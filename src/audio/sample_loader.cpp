@@ -0,0 +1,155 @@
+#include "pan/audio/sample_loader.h"
+#include "pan/audio/sample_pool.h"
+#include "pan/audio/sampler.h"
+#include <algorithm>
+
+namespace pan {
+
+SampleLoader::SampleLoader(size_t numThreads) {
+    numThreads = std::max<size_t>(1, numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads_.emplace_back(&SampleLoader::run, this);
+    }
+}
+
+SampleLoader::~SampleLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void SampleLoader::load(const std::shared_ptr<Sampler>& sampler, const std::string& path,
+                        DoneCallback onDone, ProgressCallback onProgress) {
+    auto job = std::make_shared<Job>();
+    job->sampler = sampler;
+    job->key = sampler.get();
+    job->path = path;
+    // Read here, on the sampler's owner thread, rather than on a worker
+    job->streamingThreshold = sampler->getStreamingThreshold();
+    job->preloadSeconds = sampler->getStreamingPreload();
+    job->targetRate = sampler->getEngineSampleRate();
+    job->onDone = std::move(onDone);
+    job->onProgress = std::move(onProgress);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->id = nextId_++;
+        latest_[job->key] = job->id;
+        jobs_.push_back(job);
+        queue_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+bool SampleLoader::isLatest(const Job& job) const {
+    auto it = latest_.find(job.key);
+    return it != latest_.end() && it->second == job.id;
+}
+
+void SampleLoader::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        std::shared_ptr<Job> job = std::move(queue_.front());
+        queue_.pop_front();
+
+        // Superseded or orphaned before it started: nothing to decode
+        if (isLatest(*job) && !job->sampler.expired()) {
+            lock.unlock();
+            Job* raw = job.get();
+            job->result = SamplePool::get().load(job->path, job->streamingThreshold, job->preloadSeconds,
+                                                 job->targetRate, [raw](float fraction) {
+                                                     raw->progress.store(fraction, std::memory_order_relaxed);
+                                                 });
+            lock.lock();
+        }
+        job->finished = true;
+        idle_.notify_all();
+    }
+}
+
+void SampleLoader::poll() {
+    std::vector<std::shared_ptr<Job>> finished;
+    std::vector<std::pair<std::shared_ptr<Job>, float>> progress;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto keep = jobs_.begin();
+        for (auto& job : jobs_) {
+            if (job->finished) {
+                finished.push_back(std::move(job));
+                continue;
+            }
+            float fraction = job->progress.load(std::memory_order_relaxed);
+            if (fraction != job->reportedProgress) {
+                job->reportedProgress = fraction;
+                if (job->onProgress) {
+                    progress.emplace_back(job, fraction);
+                }
+            }
+            *keep++ = std::move(job);
+        }
+        jobs_.erase(keep, jobs_.end());
+
+        // Decide which results install before anything is forgotten
+        for (auto& job : finished) {
+            if (!isLatest(*job)) {
+                job->result.reset();
+            }
+        }
+        for (const auto& job : finished) {
+            if (isLatest(*job)) {
+                latest_.erase(job->key);
+            }
+        }
+    }
+
+    // Callbacks and swaps run without the lock, so they may queue more loads
+    for (const auto& [job, fraction] : progress) {
+        job->onProgress(fraction);
+    }
+    for (const auto& job : finished) {
+        std::shared_ptr<Sampler> sampler = job->sampler.lock();
+        bool loaded = sampler && job->result;
+        if (loaded) {
+            sampler->setSample(std::move(job->result));
+            garbage_.push_back(sampler);
+        }
+        if (job->onDone) {
+            job->onDone(loaded);
+        }
+    }
+
+    // The audio thread lets go of a replaced sample at its next block; free
+    // it once it has
+    garbage_.erase(std::remove_if(garbage_.begin(), garbage_.end(),
+                                  [](const std::weak_ptr<Sampler>& weak) {
+                                      std::shared_ptr<Sampler> sampler = weak.lock();
+                                      return !sampler || sampler->collectGarbage();
+                                  }),
+                   garbage_.end());
+}
+
+bool SampleLoader::isIdle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.empty();
+}
+
+void SampleLoader::waitUntilIdle() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] {
+            return std::all_of(jobs_.begin(), jobs_.end(), [](const auto& job) { return job->finished; });
+        });
+    }
+    poll();
+}
+
+} // namespace pan
@@ -0,0 +1,327 @@
+#include "pan/audio/sample_pool.h"
+#include "pan/audio/resample_cache.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+// MP3 decoding support
+#define MINIMP3_IMPLEMENTATION
+#include "minimp3.h"
+#include "minimp3_ex.h"
+
+namespace pan {
+
+namespace {
+
+// File name without directory or extension
+std::string sampleName(const std::string& path) {
+    size_t lastSlash = path.find_last_of("/\\");
+    std::string name = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : path;
+    size_t dotPos = name.rfind('.');
+    if (dotPos != std::string::npos) {
+        name = name.substr(0, dotPos);
+    }
+    return name;
+}
+
+int reportMp3Progress(void* userData, size_t fileSize, uint64_t offset, mp3dec_frame_info_t*) {
+    const auto& onProgress = *static_cast<const SamplePool::ProgressCallback*>(userData);
+    if (onProgress && fileSize > 0) {
+        onProgress(static_cast<float>(static_cast<double>(offset) / fileSize));
+    }
+    return 0;
+}
+
+std::unique_ptr<Sample> decodeMp3(const std::string& path, const SamplePool::ProgressCallback& onProgress) {
+    mp3dec_t mp3d;
+    mp3dec_file_info_t info;
+
+    if (mp3dec_load(&mp3d, path.c_str(), &info, reportMp3Progress,
+                    const_cast<SamplePool::ProgressCallback*>(&onProgress))) {
+        std::cerr << "SamplePool: Failed to decode MP3: " << path << std::endl;
+        return nullptr;
+    }
+
+    if (info.samples == 0) {
+        std::cerr << "SamplePool: MP3 has no samples: " << path << std::endl;
+        free(info.buffer);
+        return nullptr;
+    }
+
+    auto sample = std::make_unique<Sample>();
+    sample->sampleRate = info.hz;
+    sample->stereo = (info.channels == 2);
+    sample->filePath = path;
+    sample->name = sampleName(path);
+
+    // minimp3 outputs interleaved int16_t samples
+    size_t numFrames = info.samples / info.channels;
+    sample->dataL.resize(numFrames);
+    if (info.channels == 2) {
+        sample->dataR.resize(numFrames);
+    }
+    for (size_t i = 0; i < numFrames; ++i) {
+        sample->dataL[i] = info.buffer[i * info.channels] / 32768.0f;
+        if (info.channels == 2) {
+            sample->dataR[i] = info.buffer[i * info.channels + 1] / 32768.0f;
+        }
+    }
+    free(info.buffer);
+
+    sample->generateWaveformDisplay();
+
+    std::cout << "SamplePool: Loaded MP3 '" << sample->name << "' ("
+              << numFrames << " frames, " << info.channels << " ch, "
+              << info.hz << " Hz)" << std::endl;
+    return sample;
+}
+
+std::unique_ptr<Sample> decodeWav(const std::string& path, size_t streamingThreshold, double preloadSeconds,
+                                  const SamplePool::ProgressCallback& onProgress) {
+    // Only the header is read here; the audio is read below, or streamed
+    std::shared_ptr<SampleFile> file = SampleFile::open(path);
+    if (!file) {
+        std::cerr << "SamplePool: Cannot open file or invalid WAV: " << path << std::endl;
+        return nullptr;
+    }
+
+    auto sample = std::make_unique<Sample>();
+    sample->sampleRate = file->getSampleRate();
+    sample->stereo = (file->getNumChannels() == 2);
+    sample->filePath = path;
+    sample->name = sampleName(path);
+
+    // Large files stream; their first moments stay resident so notes start without waiting on the disk
+    size_t numFrames = file->getNumFrames();
+    size_t resident = numFrames;
+    size_t decodedBytes = numFrames * (sample->stereo ? 2 : 1) * sizeof(float);
+    if (decodedBytes > streamingThreshold) {
+        resident = std::min(numFrames, static_cast<size_t>(preloadSeconds * sample->sampleRate));
+    }
+    if (resident < numFrames) {
+        sample->stream = file;
+    }
+
+    // Convert audio data, a chunk at a time
+    sample->dataL.resize(resident);
+    if (sample->stereo) {
+        sample->dataR.resize(resident);
+    }
+    const size_t chunkFrames = 65536;
+    std::vector<uint8_t> scratch;
+    for (size_t done = 0; done < resident; ) {
+        size_t count = std::min(chunkFrames, resident - done);
+        float* right = sample->stereo ? sample->dataR.data() + done : nullptr;
+        if (file->read(done, count, sample->dataL.data() + done, right, scratch) != count) {
+            std::cerr << "SamplePool: Read error in " << path << std::endl;
+            return nullptr;
+        }
+        done += count;
+        if (onProgress) {
+            onProgress(static_cast<float>(done) / resident);
+        }
+    }
+
+    sample->generateWaveformDisplay();
+
+    std::cout << "SamplePool: Loaded sample '" << sample->name << "' ("
+              << numFrames << " samples, " << file->getNumChannels() << " ch, "
+              << file->getSampleRate() << " Hz, " << file->getBitsPerSample() << " bit"
+              << (sample->stream ? ", streaming" : "") << ")" << std::endl;
+    return sample;
+}
+
+std::unique_ptr<Sample> decode(const std::string& path, size_t streamingThreshold, double preloadSeconds,
+                               const SamplePool::ProgressCallback& onProgress) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".mp3" ? decodeMp3(path, onProgress) : decodeWav(path, streamingThreshold, preloadSeconds, onProgress);
+}
+
+// Progress of one stage of a load, reported as the part [from, to] of the whole
+SamplePool::ProgressCallback stageProgress(const SamplePool::ProgressCallback& onProgress, float from, float to) {
+    if (!onProgress) {
+        return nullptr;
+    }
+    return [&onProgress, from, to](float fraction) { onProgress(from + (to - from) * fraction); };
+}
+
+// The file at targetRate: read from ResampleCache when this version of it
+// was converted before, otherwise decoded and converted now. converted is
+// false when the file comes back as it is, because it was at the rate
+// already or conversion failed (then it plays resampled).
+std::unique_ptr<Sample> decodeAtRate(const std::string& path, uintmax_t fileSize, int64_t modified,
+                                     size_t streamingThreshold, double preloadSeconds, double targetRate,
+                                     const SamplePool::ProgressCallback& onProgress, bool& converted) {
+    converted = true;
+    const std::string cachePath = ResampleCache::get().getCachePath(path, fileSize, modified, targetRate);
+
+    // The converted file stands in for the original, streaming from the cache if it's large
+    auto readConverted = [&](const SamplePool::ProgressCallback& progress) -> std::unique_ptr<Sample> {
+        std::unique_ptr<Sample> sample = decodeWav(cachePath, streamingThreshold, preloadSeconds, progress);
+        if (sample) {
+            sample->filePath = path;
+            sample->name = sampleName(path);
+            sample->sampleRate = targetRate;
+        }
+        return sample;
+    };
+
+    std::error_code error;
+    if (std::filesystem::exists(cachePath, error)) {
+        if (auto sample = readConverted(onProgress)) {
+            return sample;
+        }
+        std::filesystem::remove(cachePath, error);  // Damaged; convert again
+    }
+
+    converted = false;
+    std::unique_ptr<Sample> source = decode(path, streamingThreshold, preloadSeconds,
+                                            stageProgress(onProgress, 0.0f, 0.4f));
+    if (!source || source->sampleRate == targetRate) {
+        return source;
+    }
+    if (!ResampleCache::convert(*source, targetRate, cachePath, stageProgress(onProgress, 0.4f, 0.9f))) {
+        return source;
+    }
+    ResampleCache::get().prune(cachePath);
+    if (auto sample = readConverted(stageProgress(onProgress, 0.9f, 1.0f))) {
+        converted = true;
+        return sample;
+    }
+    return source;
+}
+
+} // namespace
+
+SamplePool& SamplePool::get() {
+    static SamplePool pool;
+    return pool;
+}
+
+size_t SamplePool::getMemorySize(const Sample& sample) {
+    return (sample.dataL.size() + sample.dataR.size() + sample.waveformDisplay.size()) * sizeof(float);
+}
+
+std::shared_ptr<const Sample> SamplePool::load(const std::string& path, size_t streamingThreshold,
+                                               double preloadSeconds, double targetRate,
+                                               const ProgressCallback& onProgress) {
+    std::error_code error;
+    const uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error) {
+        std::cerr << "SamplePool: Cannot open file: " << path << std::endl;
+        return nullptr;
+    }
+    const int64_t modified = static_cast<int64_t>(
+        std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    const Key key{path, streamingThreshold, preloadSeconds, targetRate};
+    // Files that need no conversion are pooled once, under their own rate
+    const Key nativeKey{path, streamingThreshold, preloadSeconds, 0.0};
+
+    // Hit: move to the front of the LRU list
+    auto find = [&](const Key& key) -> std::shared_ptr<const Sample> {
+        auto found = index_.find(key);
+        if (found == index_.end()) {
+            return nullptr;
+        }
+        EntryList::iterator it = found->second;
+        if (it->fileSize != fileSize || it->modified != modified) {
+            erase(it);  // The file changed; anyone holding the old version keeps it
+            return nullptr;
+        }
+        entries_.splice(entries_.begin(), entries_, it);
+        return it->sample;
+    };
+    auto lookup = [&]() -> std::shared_ptr<const Sample> {
+        if (auto sample = find(key)) {
+            return sample;
+        }
+        if (targetRate > 0.0) {
+            auto sample = find(nativeKey);
+            if (sample && sample->sampleRate == targetRate) {
+                return sample;
+            }
+        }
+        return nullptr;
+    };
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto sample = lookup()) {
+            return sample;
+        }
+    }
+
+    // Decode without the lock, so other lookups carry on meanwhile
+    bool converted = false;
+    std::shared_ptr<const Sample> decoded = targetRate > 0.0
+        ? decodeAtRate(path, fileSize, modified, streamingThreshold, preloadSeconds, targetRate, onProgress,
+                       converted)
+        : decode(path, streamingThreshold, preloadSeconds, onProgress);
+    if (!decoded) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Another thread may have decoded the same file in the meantime; share theirs
+    if (auto sample = find(converted ? key : nativeKey)) {
+        return sample;
+    }
+    Entry entry;
+    entry.key = converted ? key : nativeKey;
+    entry.fileSize = fileSize;
+    entry.modified = modified;
+    entry.sample = decoded;
+    entry.bytes = getMemorySize(*decoded);
+    entries_.push_front(std::move(entry));
+    index_[entries_.front().key] = entries_.begin();
+    usage_ += entries_.front().bytes;
+    evict(budget_);
+    return decoded;
+}
+
+void SamplePool::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    evict(budget_);
+}
+
+size_t SamplePool::getMemoryBudget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+size_t SamplePool::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usage_;
+}
+
+size_t SamplePool::getNumEntries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void SamplePool::purgeUnused() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict(0);
+}
+
+void SamplePool::evict(size_t budget) {
+    // Oldest first. use_count() == 1 means only the pool holds it, and since
+    // new holders only come through the pool, that can't change under the lock.
+    auto it = entries_.end();
+    while (it != entries_.begin() && usage_ > budget) {
+        --it;
+        if (it->sample.use_count() == 1) {
+            erase(it++);
+        }
+    }
+}
+
+void SamplePool::erase(EntryList::iterator it) {
+    usage_ -= it->bytes;
+    index_.erase(it->key);
+    entries_.erase(it);
+}
+
+} // namespace pan
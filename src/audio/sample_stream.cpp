@@ -0,0 +1,339 @@
+#include "pan/audio/sample_stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pan {
+
+namespace {
+
+uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readLe32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// pread until done; short only at end of file or on error
+size_t preadFully(int fd, void* dst, size_t bytes, uint64_t offset) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = ::pread(fd, static_cast<uint8_t*>(dst) + done, bytes - done, static_cast<off_t>(offset + done));
+        if (n <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return done;
+}
+
+} // namespace
+
+std::shared_ptr<SampleFile> SampleFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    std::shared_ptr<SampleFile> file(new SampleFile());
+    file->fd_ = fd;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return nullptr;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+
+    uint8_t riff[12];
+    if (preadFully(fd, riff, sizeof(riff), 0) != sizeof(riff) ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        return nullptr;
+    }
+
+    // Walk the chunks for "fmt " and "data" without reading the audio itself
+    bool haveFormat = false;
+    uint64_t pos = 12;
+    while (pos + 8 <= fileSize) {
+        uint8_t header[8];
+        if (preadFully(fd, header, sizeof(header), pos) != sizeof(header)) {
+            return nullptr;
+        }
+        const uint32_t chunkSize = readLe32(header + 4);
+
+        if (std::memcmp(header, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (chunkSize < sizeof(fmt) || preadFully(fd, fmt, sizeof(fmt), pos + 8) != sizeof(fmt)) {
+                return nullptr;
+            }
+            const uint16_t audioFormat = readLe16(fmt);
+            if (audioFormat != 1 && audioFormat != 3) {
+                // Only PCM (1) or IEEE float (3) supported
+                return nullptr;
+            }
+            file->channels_ = readLe16(fmt + 2);
+            file->sampleRate_ = readLe32(fmt + 4);
+            file->bitsPerSample_ = readLe16(fmt + 14);
+            file->isFloat_ = audioFormat == 3;
+            haveFormat = true;
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            const bool supported = file->bitsPerSample_ == 16 || file->bitsPerSample_ == 24 ||
+                                   file->bitsPerSample_ == 32;
+            if (!haveFormat || file->channels_ < 1 || !supported || file->sampleRate_ <= 0.0) {
+                return nullptr;
+            }
+            // A truncated file keeps the frames it has
+            const uint64_t dataBytes = std::min<uint64_t>(chunkSize, fileSize - (pos + 8));
+            file->dataOffset_ = pos + 8;
+            file->numFrames_ = static_cast<size_t>(dataBytes / (file->channels_ * (file->bitsPerSample_ / 8)));
+#ifdef __linux__
+            posix_fadvise(fd, static_cast<off_t>(file->dataOffset_), 0, POSIX_FADV_SEQUENTIAL);
+#endif
+            return file;
+        }
+
+        // Chunks are word-aligned
+        pos += 8 + static_cast<uint64_t>(chunkSize) + (chunkSize % 2);
+    }
+    return nullptr;
+}
+
+SampleFile::~SampleFile() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+size_t SampleFile::read(size_t first, size_t count, float* left, float* right, std::vector<uint8_t>& scratch) const {
+    if (first >= numFrames_) {
+        return 0;
+    }
+    count = std::min(count, numFrames_ - first);
+    const size_t bytesPerSample = static_cast<size_t>(bitsPerSample_ / 8);
+    const size_t frameBytes = bytesPerSample * static_cast<size_t>(channels_);
+    scratch.resize(count * frameBytes);
+    const size_t got = preadFully(fd_, scratch.data(), count * frameBytes, dataOffset_ + first * frameBytes) / frameBytes;
+
+    const int numOut = (right && channels_ >= 2) ? 2 : 1;
+    float* out[2] = {left, right};
+    for (int c = 0; c < numOut; ++c) {
+        const uint8_t* src = scratch.data() + c * bytesPerSample;
+        float* dst = out[c];
+        for (size_t i = 0; i < got; ++i, src += frameBytes) {
+            if (bitsPerSample_ == 16) {
+                dst[i] = static_cast<int16_t>(readLe16(src)) / 32768.0f;
+            } else if (bitsPerSample_ == 24) {
+                int32_t value = static_cast<int32_t>(src[0] | (src[1] << 8) | (src[2] << 16));
+                if (value & 0x800000) value |= static_cast<int32_t>(0xFF000000);  // Sign extend
+                dst[i] = value / 8388608.0f;
+            } else if (isFloat_) {
+                std::memcpy(&dst[i], src, sizeof(float));
+            } else {
+                dst[i] = static_cast<int32_t>(readLe32(src)) / 2147483648.0f;
+            }
+        }
+    }
+    return got;
+}
+
+void SampleFile::willNeed(size_t first, size_t count) const {
+#ifdef __linux__
+    if (first >= numFrames_) {
+        return;
+    }
+    count = std::min(count, numFrames_ - first);
+    const uint64_t frameBytes = static_cast<uint64_t>(bitsPerSample_ / 8) * channels_;
+    posix_fadvise(fd_, static_cast<off_t>(dataOffset_ + first * frameBytes), static_cast<off_t>(count * frameBytes),
+                  POSIX_FADV_WILLNEED);
+#else
+    (void)first;
+    (void)count;
+#endif
+}
+
+VoiceStream::VoiceStream(std::shared_ptr<SampleFile> file, bool stereo)
+    : file_(std::move(file))
+    , stereo_(stereo)
+    , left_(new float[RING_FRAMES]())
+    , right_(stereo ? new float[RING_FRAMES]() : nullptr)
+{
+    SampleStreamer::get().add(this);
+}
+
+VoiceStream::~VoiceStream() {
+    SampleStreamer::get().remove(this);
+}
+
+void VoiceStream::start(size_t startFrame, size_t endFrame, size_t loopStartFrame, bool looping, size_t skip) {
+    const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    startFrame_.store(startFrame, std::memory_order_relaxed);
+    endFrame_.store(endFrame, std::memory_order_relaxed);
+    loopStartFrame_.store(loopStartFrame, std::memory_order_relaxed);
+    skip_.store(skip, std::memory_order_relaxed);
+    looping_.store(looping, std::memory_order_relaxed);
+    active_.store(true, std::memory_order_relaxed);
+    consumed_.store(pack((sequence + 2) / 2, 0), std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void VoiceStream::stop() {
+    const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    active_.store(false, std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+uint64_t VoiceStream::available() const {
+    const uint64_t generation = sequence_.load(std::memory_order_relaxed) / 2;
+    const uint64_t value = available_.load(std::memory_order_acquire);
+    return (value >> GENERATION_SHIFT) == (generation & GENERATION_MASK) ? (value & COUNT_MASK) : 0;
+}
+
+void VoiceStream::consume(uint64_t index) {
+    const uint64_t generation = sequence_.load(std::memory_order_relaxed) / 2;
+    consumed_.store(pack(generation, index), std::memory_order_release);
+}
+
+bool VoiceStream::fill(std::vector<uint8_t>& scratch) {
+    // Take a consistent copy of the request; if start() is mid-write, try next pass
+    const uint64_t sequence = sequence_.load(std::memory_order_acquire);
+    if (sequence & 1) {
+        return false;
+    }
+    const uint64_t start = startFrame_.load(std::memory_order_relaxed);
+    const uint64_t end = endFrame_.load(std::memory_order_relaxed);
+    const uint64_t loopStart = loopStartFrame_.load(std::memory_order_relaxed);
+    const uint64_t skip = skip_.load(std::memory_order_relaxed);
+    const bool looping = looping_.load(std::memory_order_relaxed);
+    const bool active = active_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) != sequence || !active || end <= start) {
+        return false;
+    }
+
+    const uint64_t generation = (sequence / 2) & GENERATION_MASK;
+    if (generation != fillGeneration_) {
+        fillGeneration_ = generation;
+        produced_ = skip;
+    }
+    const uint64_t consumed = consumed_.load(std::memory_order_acquire);
+    if ((consumed >> GENERATION_SHIFT) != generation) {
+        return false;
+    }
+
+    // A voice that ran ahead of the disk skips what it has already played through
+    produced_ = std::max(produced_, consumed & COUNT_MASK);
+
+    const uint64_t firstPass = end - start;
+    const uint64_t loopLength = end - std::min(loopStart, end - 1);
+    const uint64_t total = looping ? COUNT_MASK : firstPass;
+    const uint64_t limit = std::min(total, (consumed & COUNT_MASK) + RING_FRAMES);
+    if (produced_ >= limit) {
+        return false;
+    }
+
+    uint64_t remaining = std::min<uint64_t>(limit - produced_, FILL_CHUNK);
+    uint64_t frame = 0;
+    while (remaining > 0) {
+        // Map the stream index to a file frame and read up to the end of that run
+        uint64_t runLeft;
+        if (produced_ < firstPass) {
+            frame = start + produced_;
+            runLeft = end - frame;
+        } else {
+            frame = end - loopLength + (produced_ - firstPass) % loopLength;
+            runLeft = end - frame;
+        }
+        const size_t slot = static_cast<size_t>(produced_ & (RING_FRAMES - 1));
+        const size_t n = static_cast<size_t>(std::min({remaining, runLeft, static_cast<uint64_t>(RING_FRAMES - slot)}));
+        size_t got = file_->read(static_cast<size_t>(frame), n, left_.get() + slot,
+                                 stereo_ ? right_.get() + slot : nullptr, scratch);
+        if (got < n) {
+            // Unreadable: hand over silence rather than leave the voice waiting
+            std::fill(left_.get() + slot + got, left_.get() + slot + n, 0.0f);
+            if (stereo_) {
+                std::fill(right_.get() + slot + got, right_.get() + slot + n, 0.0f);
+            }
+        }
+        produced_ += n;
+        remaining -= n;
+        frame += n;
+    }
+    available_.store(pack(generation, produced_), std::memory_order_release);
+
+    file_->willNeed(static_cast<size_t>(frame), FILL_CHUNK);
+    return true;
+}
+
+SampleStreamer& SampleStreamer::get() {
+    static SampleStreamer streamer;
+    return streamer;
+}
+
+SampleStreamer::~SampleStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SampleStreamer::add(VoiceStream* stream) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        streams_.push_back(stream);
+        if (!thread_.joinable()) {
+            thread_ = std::thread(&SampleStreamer::run, this);
+        }
+    }
+    wake_.notify_all();
+}
+
+void SampleStreamer::remove(VoiceStream* stream) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    streams_.erase(std::remove(streams_.begin(), streams_.end(), stream), streams_.end());
+    ++removals_;
+    filled_.wait(lock, [&] { return filling_ != stream; });
+}
+
+void SampleStreamer::run() {
+    std::vector<uint8_t> scratch;
+    std::vector<VoiceStream*> pass;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        bool didWork = false;
+        pass.assign(streams_.begin(), streams_.end());
+        const uint64_t removals = removals_;
+        for (VoiceStream* stream : pass) {
+            // Skip anything removed (and maybe destroyed) since the snapshot
+            if (removals_ != removals && std::find(streams_.begin(), streams_.end(), stream) == streams_.end()) {
+                continue;
+            }
+            filling_ = stream;
+            lock.unlock();
+            const bool filled = stream->fill(scratch);
+            lock.lock();
+            filling_ = nullptr;
+            filled_.notify_all();
+            didWork |= filled;
+        }
+        if (streams_.empty()) {
+            wake_.wait(lock);
+        } else if (!didWork) {
+            // Voices only tell us they've moved on through atomics, so poll
+            wake_.wait_for(lock, std::chrono::microseconds(IDLE_SLEEP_MICROSECONDS));
+        }
+    }
+}
+
+} // namespace pan
@@ -1,36 +1,56 @@
 #include "pan/audio/sampler.h"
-#include <fstream>
+#include "pan/audio/sample_pool.h"
+#include "pan/dsp/fast_math.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <chrono>
 #include <cstring>
-
-// MP3 decoding support
-#define MINIMP3_IMPLEMENTATION
-#include "minimp3.h"
-#include "minimp3_ex.h"
+#include <thread>
 
 namespace pan {
 
 void Sample::generateWaveformDisplay() {
     waveformDisplay.clear();
-    if (dataL.empty()) return;
+    const size_t numFrames = getNumFrames();
+    if (numFrames == 0) return;
     
     // Generate ~512 points for display
     const size_t displayPoints = 512;
     waveformDisplay.resize(displayPoints);
     
-    size_t samplesPerPoint = std::max(size_t(1), dataL.size() / displayPoints);
+    size_t samplesPerPoint = std::max(size_t(1), numFrames / displayPoints);
+    
+    // Past the resident head, only a window at the start of each point is read from disk
+    const size_t streamedWindow = 2048;
+    std::vector<float> windowL, windowR;
+    std::vector<uint8_t> scratch;
     
     for (size_t i = 0; i < displayPoints; ++i) {
         size_t startSample = i * samplesPerPoint;
-        size_t endSample = std::min(startSample + samplesPerPoint, dataL.size());
+        size_t endSample = std::min(startSample + samplesPerPoint, numFrames);
+        if (startSample >= endSample) {
+            waveformDisplay[i] = 0.0f;
+            continue;
+        }
+        
+        const float* left = dataL.data() + std::min(startSample, dataL.size());
+        const float* right = (stereo && !dataR.empty()) ? dataR.data() + std::min(startSample, dataR.size()) : nullptr;
+        if (endSample > dataL.size()) {
+            size_t count = std::min(endSample - startSample, streamedWindow);
+            windowL.resize(count);
+            windowR.resize(count);
+            count = stream->read(startSample, count, windowL.data(), stereo ? windowR.data() : nullptr, scratch);
+            endSample = startSample + count;
+            left = windowL.data();
+            right = stereo ? windowR.data() : nullptr;
+        }
         
         float maxVal = 0.0f;
-        for (size_t j = startSample; j < endSample; ++j) {
-            float val = std::abs(dataL[j]);
-            if (stereo && j < dataR.size()) {
-                val = std::max(val, std::abs(dataR[j]));
+        for (size_t j = 0; j < endSample - startSample; ++j) {
+            float val = std::abs(left[j]);
+            if (right) {
+                val = std::max(val, std::abs(right[j]));
             }
             maxVal = std::max(maxVal, val);
         }
@@ -41,6 +61,8 @@ void Sample::generateWaveformDisplay() {
 Sampler::Sampler(double sampleRate)
     : sampleRate_(sampleRate)
 {
+    SincKernelBank::get();  // Build the tables here rather than on the audio thread
+    
     // Initialize all voices
     for (auto& voice : voices_) {
         voice.active = false;
@@ -49,29 +71,20 @@ Sampler::Sampler(double sampleRate)
 }
 
 double Sampler::getSampleDuration() const {
-    if (!sample_ || sample_->dataL.empty()) return 0.0;
-    return static_cast<double>(sample_->dataL.size()) / sample_->sampleRate;
+    if (!sample_ || sample_->getNumFrames() == 0) return 0.0;
+    return static_cast<double>(sample_->getNumFrames()) / sample_->sampleRate;
 }
 
 size_t Sampler::getSampleFrames() const {
     if (!sample_) return 0;
-    return sample_->dataL.size();
+    return sample_->getNumFrames();
 }
 
 double Sampler::getSampleRate() const {
-    if (!sample_) return sampleRate_;
+    if (!sample_) return getEngineSampleRate();
     return sample_->sampleRate;
 }
 
-int Sampler::findFreeVoice() {
-    // First, look for an inactive voice
-    for (int i = 0; i < params_.voices && i < MAX_VOICES; ++i) {
-        if (!voices_[i].active) return i;
-    }
-    // If all voices are active, steal the oldest one (voice 0)
-    return 0;
-}
-
 float Sampler::processEnvelope(Voice& voice, double deltaTime) {
     float targetLevel = 0.0f;
     float rate = 0.0f;
@@ -102,7 +115,11 @@ float Sampler::processEnvelope(Voice& voice, double deltaTime) {
             break;
             
         case Voice::EnvStage::Release:
-            rate = params_.release > 0.001f ? (voice.envLevel / params_.release) : 1000.0f;
+            if (voice.stolen) {
+                rate = 1.0f / STEAL_FADE_SECONDS;
+            } else {
+                rate = params_.release > 0.001f ? (voice.envLevel / params_.release) : 1000.0f;
+            }
             voice.envLevel -= rate * static_cast<float>(deltaTime);
             if (voice.envLevel <= 0.0f) {
                 voice.envLevel = 0.0f;
@@ -127,7 +144,7 @@ float Sampler::calculateLFO() {
     
     switch (params_.lfoWaveform) {
         case 0: // Sine
-            lfoValue = std::sin(phase * 2.0 * M_PI);
+            lfoValue = dsp::sin(static_cast<float>(phase * 2.0 * M_PI));
             break;
         case 1: // Triangle
             lfoValue = 1.0f - 4.0f * std::abs(std::fmod(phase + 0.25, 1.0) - 0.5f);
@@ -139,275 +156,121 @@ float Sampler::calculateLFO() {
             lfoValue = phase < 0.5 ? 1.0f : -1.0f;
             break;
         case 4: // Random (sample & hold)
-            lfoValue = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+            lfoValue = lfoRandom_.nextBipolar();
             break;
     }
     
     return lfoValue * params_.lfoAmount;
 }
 
-bool Sampler::parseWavHeader(const std::vector<uint8_t>& data, int& channels, int& sampleRate, 
-                             int& bitsPerSample, size_t& dataOffset, size_t& dataSize) {
-    if (data.size() < 44) return false;
-    
-    // Check RIFF header
-    if (memcmp(data.data(), "RIFF", 4) != 0) return false;
-    if (memcmp(data.data() + 8, "WAVE", 4) != 0) return false;
-    
-    // Find fmt chunk
-    size_t pos = 12;
-    while (pos + 8 < data.size()) {
-        uint32_t chunkSize = *reinterpret_cast<const uint32_t*>(data.data() + pos + 4);
-        
-        if (memcmp(data.data() + pos, "fmt ", 4) == 0) {
-            if (pos + 24 > data.size()) return false;
-            
-            uint16_t audioFormat = *reinterpret_cast<const uint16_t*>(data.data() + pos + 8);
-            if (audioFormat != 1 && audioFormat != 3) {
-                // Only PCM (1) or IEEE float (3) supported
-                return false;
-            }
-            
-            channels = *reinterpret_cast<const uint16_t*>(data.data() + pos + 10);
-            sampleRate = *reinterpret_cast<const uint32_t*>(data.data() + pos + 12);
-            bitsPerSample = *reinterpret_cast<const uint16_t*>(data.data() + pos + 22);
-            
-            pos += 8 + chunkSize;
-        } else if (memcmp(data.data() + pos, "data", 4) == 0) {
-            dataOffset = pos + 8;
-            dataSize = chunkSize;
-            return true;
-        } else {
-            pos += 8 + chunkSize;
-        }
-        
-        // Ensure chunk is word-aligned
-        if (chunkSize % 2 != 0) pos++;
-    }
-    
-    return false;
-}
-
-bool Sampler::loadMp3(const std::string& path) {
-    mp3dec_t mp3d;
-    mp3dec_file_info_t info;
-    
-    if (mp3dec_load(&mp3d, path.c_str(), &info, NULL, NULL)) {
-        std::cerr << "Sampler: Failed to decode MP3: " << path << std::endl;
-        return false;
-    }
-    
-    if (info.samples == 0) {
-        std::cerr << "Sampler: MP3 has no samples: " << path << std::endl;
-        free(info.buffer);
+bool Sampler::loadSample(const std::string& path) {
+    std::shared_ptr<const Sample> sample = SamplePool::get().load(path, streamingThreshold_, streamingPreloadSeconds_,
+                                                                  getEngineSampleRate());
+    if (!sample) {
         return false;
     }
-    
-    // Create new sample
-    auto newSample = std::make_unique<Sample>();
-    newSample->sampleRate = info.hz;
-    newSample->stereo = (info.channels == 2);
-    newSample->filePath = path;
-    
-    // Extract filename as name
-    size_t lastSlash = path.find_last_of("/\\");
-    newSample->name = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : path;
-    // Remove extension
-    size_t dotPos = newSample->name.rfind('.');
-    if (dotPos != std::string::npos) {
-        newSample->name = newSample->name.substr(0, dotPos);
-    }
-    
-    // Convert to float format
-    size_t numFrames = info.samples / info.channels;
-    newSample->dataL.resize(numFrames);
-    if (info.channels == 2) {
-        newSample->dataR.resize(numFrames);
-    }
-    
-    // minimp3 outputs interleaved int16_t samples
-    for (size_t i = 0; i < numFrames; ++i) {
-        newSample->dataL[i] = info.buffer[i * info.channels] / 32768.0f;
-        if (info.channels == 2) {
-            newSample->dataR[i] = info.buffer[i * info.channels + 1] / 32768.0f;
-        }
-    }
-    
-    free(info.buffer);
-    
-    // Generate waveform display
-    newSample->generateWaveformDisplay();
-    
-    sample_ = std::move(newSample);
-    // Reset all voices
-    for (auto& voice : voices_) {
-        voice.active = false;
-        voice.envStage = Voice::EnvStage::Off;
-    }
-    
-    std::cout << "Sampler: Loaded MP3 '" << sample_->name << "' (" 
-              << numFrames << " frames, " << info.channels << " ch, " 
-              << info.hz << " Hz)" << std::endl;
-    
+    setSample(std::move(sample));
     return true;
 }
 
-bool Sampler::loadSample(const std::string& path) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // Detect file type by extension
-    std::string ext;
-    size_t dotPos = path.rfind('.');
-    if (dotPos != std::string::npos) {
-        ext = path.substr(dotPos);
-        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    }
-    
-    // Handle MP3 files
-    if (ext == ".mp3") {
-        return loadMp3(path);
-    }
-    
-    // Read entire file for WAV
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        std::cerr << "Sampler: Cannot open file: " << path << std::endl;
-        return false;
-    }
-    
-    size_t fileSize = file.tellg();
-    file.seekg(0);
-    
-    std::vector<uint8_t> data(fileSize);
-    file.read(reinterpret_cast<char*>(data.data()), fileSize);
-    file.close();
-    
-    // Parse WAV header
-    int channels, fileSampleRate, bitsPerSample;
-    size_t dataOffset, dataSize;
-    
-    if (!parseWavHeader(data, channels, fileSampleRate, bitsPerSample, dataOffset, dataSize)) {
-        std::cerr << "Sampler: Invalid WAV file: " << path << std::endl;
-        return false;
-    }
-    
-    // Create new sample
-    auto newSample = std::make_unique<Sample>();
-    newSample->sampleRate = fileSampleRate;
-    newSample->stereo = (channels == 2);
-    newSample->filePath = path;
-    
-    // Extract filename as name
-    size_t lastSlash = path.find_last_of("/\\");
-    newSample->name = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : path;
-    // Remove extension
-    {
-        size_t extDotPos = newSample->name.rfind('.');
-        if (extDotPos != std::string::npos) {
-            newSample->name = newSample->name.substr(0, extDotPos);
+void Sampler::setSample(std::shared_ptr<const Sample> sample) {
+    auto loaded = std::make_unique<LoadedSample>();
+    if (sample && sample->stream) {
+        for (auto& stream : loaded->streams) {
+            stream = std::make_unique<VoiceStream>(sample->stream, sample->stereo);
         }
     }
-    
-    // Convert audio data
-    size_t numSamples = dataSize / (channels * (bitsPerSample / 8));
-    newSample->dataL.resize(numSamples);
-    if (channels == 2) {
-        newSample->dataR.resize(numSamples);
+    loaded->sample = sample;
+    loaded->generation = ++publishedGeneration_;
+    sample_ = std::move(sample);
+    loaded_.publish(std::move(loaded));
+    collectGarbage();
+}
+
+bool Sampler::collectGarbage() {
+    loaded_.collectGarbage();
+    return loaded_.getRetiredCount() == 0;
+}
+
+void Sampler::noteOn(uint8_t note, uint8_t velocity, uint32_t frameOffset) {
+    midiQueue_.push(MidiEvent(MidiMessage(MidiMessageType::NoteOn, 0, note, velocity), frameOffset));
+}
+
+void Sampler::noteOff(uint8_t note, uint32_t frameOffset) {
+    midiQueue_.push(MidiEvent(MidiMessage(MidiMessageType::NoteOff, 0, note, 0), frameOffset));
+}
+
+void Sampler::allNotesOff() {
+    midiQueue_.push(MidiEvent(MidiMessage(MidiMessageType::ControlChange, 0, 123, 0)));
+}
+
+void Sampler::handleMidiMessage(const MidiMessage& msg) {
+    if (msg.isNoteOn()) {
+        startNote(msg.getNoteNumber(), msg.getVelocity());
+    } else if (msg.isNoteOff()) {
+        releaseNote(msg.getNoteNumber());
+    } else if (msg.getType() == MidiMessageType::ControlChange && msg.getData1() == 123) {
+        releaseAllNotes();
     }
-    
-    const uint8_t* audioData = data.data() + dataOffset;
-    
-    for (size_t i = 0; i < numSamples; ++i) {
-        if (bitsPerSample == 16) {
-            int16_t sampleL = *reinterpret_cast<const int16_t*>(audioData + i * channels * 2);
-            newSample->dataL[i] = sampleL / 32768.0f;
-            
-            if (channels == 2) {
-                int16_t sampleR = *reinterpret_cast<const int16_t*>(audioData + i * channels * 2 + 2);
-                newSample->dataR[i] = sampleR / 32768.0f;
-            }
-        } else if (bitsPerSample == 24) {
-            // 24-bit samples
-            int32_t sampleL = (audioData[i * channels * 3] | 
-                              (audioData[i * channels * 3 + 1] << 8) |
-                              (audioData[i * channels * 3 + 2] << 16));
-            if (sampleL & 0x800000) sampleL |= 0xFF000000;  // Sign extend
-            newSample->dataL[i] = sampleL / 8388608.0f;
-            
-            if (channels == 2) {
-                int32_t sampleR = (audioData[i * channels * 3 + 3] |
-                                  (audioData[i * channels * 3 + 4] << 8) |
-                                  (audioData[i * channels * 3 + 5] << 16));
-                if (sampleR & 0x800000) sampleR |= 0xFF000000;
-                newSample->dataR[i] = sampleR / 8388608.0f;
-            }
-        } else if (bitsPerSample == 32) {
-            // Assume 32-bit float
-            float sampleL = *reinterpret_cast<const float*>(audioData + i * channels * 4);
-            newSample->dataL[i] = sampleL;
-            
-            if (channels == 2) {
-                float sampleR = *reinterpret_cast<const float*>(audioData + i * channels * 4 + 4);
-                newSample->dataR[i] = sampleR;
-            }
+}
+
+void Sampler::startNote(uint8_t note, uint8_t velocity) {
+    if (!playing_ || !playing_->sample || playing_->sample->getNumFrames() == 0) return;
+    const Sample& sample = *playing_->sample;
+    
+    // Tell the allocator which voices have finished and how loud the rest are
+    for (size_t v = 0; v < voices_.size(); ++v) {
+        if (!voices_[v].active) {
+            voiceAllocator_.finish(v);
+        } else {
+            voiceAllocator_.setLevel(v, voices_[v].envLevel * voices_[v].velocity);
         }
     }
-    
-    // Generate waveform display
-    newSample->generateWaveformDisplay();
-    
-    sample_ = std::move(newSample);
-    // Reset all voices
-    for (auto& voice : voices_) {
-        voice.active = false;
-        voice.envStage = Voice::EnvStage::Off;
+    voiceAllocator_.setPolyphony(static_cast<size_t>(std::clamp(params_.voices, 1, MAX_POLYPHONY)));
+    
+    const VoiceAllocator::Allocation allocation = voiceAllocator_.allocate(note);
+    if (allocation.stolen != VoiceAllocator::NO_VOICE) {
+        Voice& victim = voices_[allocation.stolen];
+        victim.envStage = Voice::EnvStage::Release;
+        victim.releasing = true;
+        victim.stolen = true;
     }
-    
-    std::cout << "Sampler: Loaded sample '" << sample_->name << "' (" 
-              << numSamples << " samples, " << channels << " ch, " 
-              << fileSampleRate << " Hz, " << bitsPerSample << " bit)" << std::endl;
-    
-    return true;
-}
-
-void Sampler::noteOn(uint8_t note, uint8_t velocity) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!sample_ || sample_->dataL.empty()) return;
-    
-    // Find a free voice
-    int voiceIdx = findFreeVoice();
-    Voice& voice = voices_[voiceIdx];
+    Voice& voice = voices_[allocation.voice];
     
     // Calculate pitch shift based on note relative to root
-    int semitones = note - sample_->rootNote + params_.transpose;
+    int semitones = note - rootNote_ + params_.transpose;
     double detuneCents = params_.detune;
     double pitchRatio = std::pow(2.0, (semitones + detuneCents / 100.0) / 12.0);
     
-    // Adjust for sample rate difference
-    double srRatio = sample_->sampleRate / sampleRate_;
+    // Adjust for sample rate difference (none once loadSample() has converted it)
+    double srRatio = sample.sampleRate / getEngineSampleRate();
     
     // Determine slice boundaries
+    const size_t sampleLength = sample.getNumFrames();
     size_t startSample = 0;
-    size_t endSample = sample_->dataL.size();
+    size_t endSample = sampleLength;
     if (params_.mode == SamplerMode::Slice && !params_.sliceMarkers.empty()) {
-        // Build boundaries [0, markers...,1]
-        std::vector<float> boundaries;
-        boundaries.reserve(params_.sliceMarkers.size() + 2);
-        boundaries.push_back(0.0f);
-        for (float m : params_.sliceMarkers) boundaries.push_back(std::clamp(m, 0.0f, 1.0f));
-        boundaries.push_back(1.0f);
-        std::sort(boundaries.begin(), boundaries.end());
-        size_t numSlices = boundaries.size() - 1;
-        size_t idx = std::min<size_t>(numSlices - 1, static_cast<size_t>(std::max<int>(0, note - sample_->rootNote)));
+        // Build boundaries [0, markers...,1] on the stack - noteOn runs on the audio thread
+        std::array<float, MAX_SLICE_MARKERS + 2> boundaries;
+        size_t numBoundaries = 0;
+        boundaries[numBoundaries++] = 0.0f;
+        for (float m : params_.sliceMarkers) {
+            if (numBoundaries == boundaries.size() - 1) break;
+            boundaries[numBoundaries++] = std::clamp(m, 0.0f, 1.0f);
+        }
+        boundaries[numBoundaries++] = 1.0f;
+        std::sort(boundaries.begin(), boundaries.begin() + numBoundaries);
+        size_t numSlices = numBoundaries - 1;
+        size_t idx = std::min<size_t>(numSlices - 1, static_cast<size_t>(std::max<int>(0, note - rootNote_)));
         float s = boundaries[idx];
         float e = boundaries[idx + 1];
-        startSample = static_cast<size_t>(s * sample_->dataL.size());
-        endSample = static_cast<size_t>(e * sample_->dataL.size());
+        startSample = static_cast<size_t>(s * sampleLength);
+        endSample = static_cast<size_t>(e * sampleLength);
         endSample = std::max(endSample, startSample + 1);
     } else {
-        startSample = static_cast<size_t>(params_.startPos * sample_->dataL.size());
-        endSample = static_cast<size_t>((params_.startPos + params_.length) * sample_->dataL.size());
-        endSample = std::min(endSample, sample_->dataL.size());
+        startSample = static_cast<size_t>(params_.startPos * sampleLength);
+        endSample = static_cast<size_t>((params_.startPos + params_.length) * sampleLength);
+        endSample = std::min(endSample, sampleLength);
         endSample = std::max(endSample, startSample + 1);
     }
     
@@ -417,11 +280,15 @@ void Sampler::noteOn(uint8_t note, uint8_t velocity) {
     voice.velocity = velocity / 127.0f;
     voice.note = note;
     voice.releasing = false;
+    voice.stolen = false;
     voice.startSample = startSample;
     voice.endSample = endSample;
     voice.loopStartSample = params_.loopEnabled
-        ? startSample + static_cast<size_t>(params_.loopStart * (endSample - startSample))
+        ? std::min(startSample + static_cast<size_t>(params_.loopStart * (endSample - startSample)), endSample - 1)
         : startSample;
+    if (playing_->streams[allocation.voice]) {
+        startStream(allocation.voice, startSample);
+    }
     
     // Start envelope
     voice.envStage = Voice::EnvStage::Attack;
@@ -431,92 +298,275 @@ void Sampler::noteOn(uint8_t note, uint8_t velocity) {
     activeVoiceCount_ = std::min(activeVoiceCount_ + 1, params_.voices);
 }
 
-void Sampler::noteOff(uint8_t note) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+void Sampler::releaseNote(uint8_t note) {
     // One-shot mode ignores note off
     if (params_.mode == SamplerMode::OneShot) return;
     
     // Find the voice playing this note and release it
-    for (auto& voice : voices_) {
+    for (size_t v = 0; v < voices_.size(); ++v) {
+        Voice& voice = voices_[v];
         if (voice.active && voice.note == note && voice.envStage != Voice::EnvStage::Release) {
             voice.envStage = Voice::EnvStage::Release;
             voice.releasing = true;
+            voiceAllocator_.release(v);
         }
     }
 }
 
-void Sampler::allNotesOff() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& voice : voices_) {
-        if (voice.active) {
+void Sampler::releaseAllNotes() {
+    for (size_t v = 0; v < voices_.size(); ++v) {
+        Voice& voice = voices_[v];
+        if (voice.active && !voice.stolen) {
             voice.envStage = Voice::EnvStage::Release;
             voice.releasing = true;
+            voiceAllocator_.release(v);
         }
     }
 }
 
-void Sampler::process(float* outL, float* outR, size_t numFrames) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void Sampler::hashParameters(ParameterHash& hash) const {
+    hash.add(getEngineSampleRate()).add(sample_ != nullptr);
+    if (sample_) {
+        hash.add(sample_->filePath).add(sample_->getNumFrames()).add(sample_->sampleRate).add(rootNote_);
+    }
     
+    const SamplerParams& p = params_;
+    hash.add(p.mode).add(p.sliceMarkers.size());
+    for (float marker : p.sliceMarkers) {
+        hash.add(marker);
+    }
+    hash.add(p.sliceGridSlices).add(p.sliceCustom);
+    hash.add(p.gain).add(p.startPos).add(p.loopStart).add(p.length).add(p.fade).add(p.loopEnabled).add(p.snapEnabled);
+    hash.add(p.voices).add(p.retrigger).add(p.warpEnabled).add(p.warpBeats);
+    hash.add(p.filterEnabled).add(p.filterType).add(p.filterFreq).add(p.filterRes);
+    hash.add(p.lfoEnabled).add(p.lfoWaveform).add(p.lfoRate).add(p.lfoAmount).add(p.lfoTarget);
+    hash.add(p.transpose).add(p.detune).add(p.pitchEnvEnabled).add(p.pitchEnvAmount).add(p.pitchEnvTime);
+    hash.add(p.interpolation);
+    hash.add(p.attack).add(p.decay).add(p.sustain).add(p.release);
+    hash.add(p.pan).add(p.spread).add(p.volume);
+    hash.add(getStealPolicy());
+}
+
+bool Sampler::isProducingAudio() const {
+    if (!midiQueue_.isEmpty()) {
+        return true;
+    }
+    for (const auto& voice : voices_) {
+        if (voice.active) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Sampler::process(float* outL, float* outR, size_t numFrames) {
     // Clear output
     for (size_t i = 0; i < numFrames; ++i) {
         outL[i] = 0.0f;
         outR[i] = 0.0f;
     }
     
-    if (!sample_ || sample_->dataL.empty()) return;
+    uint32_t seed = 0;
+    if (pendingSeed_.take(seed)) {
+        lfoRandom_.setSeed(seed);
+    }
+    
+    // Pick up a sample published by setSample(); the old one's voices stop here
+    auto loaded = loaded_.read();
+    uint64_t generation = loaded ? loaded->generation : 0;
+    if (generation != playingGeneration_) {
+        for (auto& voice : voices_) {
+            voice.active = false;
+            voice.envStage = Voice::EnvStage::Off;
+        }
+        voiceAllocator_.reset();
+        activeVoiceCount_ = 0;
+        playingGeneration_ = generation;
+    }
+    
+    // Take this block's MIDI, ordered by offset
+    size_t numEvents = midiQueue_.drainSorted(blockEvents_.data(), blockEvents_.size());
+    if (numEvents == 0 && activeVoiceCount_ == 0) {
+        return;
+    }
+    
+    playing_ = loaded.get();
+    bool hasSample = playing_ && playing_->sample && playing_->sample->getNumFrames() > 0;
     
     // Calculate volume in linear
-    float volumeLinear = std::pow(10.0f, params_.volume / 20.0f);
-    float gainLinear = std::pow(10.0f, params_.gain / 20.0f);
+    float volumeLinear = dsp::dbToGain(params_.volume);
+    float gainLinear = dsp::dbToGain(params_.gain);
     float totalGain = volumeLinear * gainLinear;
     
+    // Render up to each event, apply it, carry on; late offsets land on the last frame
+    size_t rendered = 0;
+    for (size_t e = 0; e <= numEvents; ++e) {
+        size_t offset = numFrames;
+        if (e < numEvents) {
+            offset = std::min<size_t>(blockEvents_[e].frameOffset, numFrames > 0 ? numFrames - 1 : 0);
+        }
+        if (hasSample && offset > rendered) {
+            for (auto& voice : voices_) {
+                if (voice.active) {
+                    processVoice(voice, outL + rendered, outR + rendered, offset - rendered, totalGain);
+                }
+            }
+        }
+        rendered = std::max(rendered, offset);
+        if (e < numEvents) {
+            handleMidiMessage(blockEvents_[e].message);
+        }
+    }
+    
+    // Count active voices
+    activeVoiceCount_ = 0;
+    for (const auto& voice : voices_) {
+        if (voice.active) activeVoiceCount_++;
+    }
+    playing_ = nullptr;
+}
+
+void Sampler::startStream(size_t voiceIndex, size_t fromFrame) {
+    Voice& voice = voices_[voiceIndex];
+    voice.streamStart = fromFrame;
+    voice.streamLooping = params_.loopEnabled && params_.mode == SamplerMode::Classic;
+    voice.loopCount = 0;
+    voice.streamConsumed = 0;
+    
+    // The resident head is never fetched; the disk picks up where it ends
+    const size_t resident = playing_->sample->dataL.size();
+    const size_t skip = fromFrame < resident ? std::min(resident, voice.endSample) - fromFrame : 0;
+    playing_->streams[voiceIndex]->start(fromFrame, voice.endSample, voice.loopStartSample, voice.streamLooping, skip);
+}
+
+uint64_t Sampler::streamIndex(const Voice& voice, size_t frame, size_t vEnd, size_t vLoopStart) const {
+    if (voice.loopCount == 0) {
+        return frame - voice.streamStart;
+    }
+    return (vEnd - voice.streamStart) + static_cast<uint64_t>(voice.loopCount - 1) * (vEnd - vLoopStart) +
+           (frame - vLoopStart);
+}
+
+namespace {
+
+// Offline only: block until the streamer has delivered index, or give up
+uint64_t waitForStream(const VoiceStream& stream, uint64_t index) {
+    const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(Sampler::STREAM_WAIT_SECONDS));
+    uint64_t available = stream.available();
+    while (index >= available && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        available = stream.available();
+    }
+    return available;
+}
+
+} // namespace
+
+void Sampler::processVoice(Voice& voice, float* outL, float* outR, size_t numFrames, float totalGain) {
     // Update LFO phase
-    double lfoIncrement = params_.lfoRate / sampleRate_;
+    const double sampleRate = getEngineSampleRate();
+    double lfoIncrement = params_.lfoRate / sampleRate;
     
     // Calculate sample boundaries per voice
-    size_t sampleLength = sample_->dataL.size();
+    const Sample& sample = *playing_->sample;
+    size_t sampleLength = sample.getNumFrames();
+    size_t vEnd = voice.endSample > 0 ? std::min(voice.endSample, sampleLength) : sampleLength;
+    size_t vLoopStart = params_.loopEnabled ? voice.loopStartSample : voice.startSample;
+    bool looping = params_.loopEnabled && params_.mode == SamplerMode::Classic;
+    
+    // Frames past the resident head come from the voice's disk stream
+    const size_t resident = sample.dataL.size();
+    const bool stereo = sample.stereo && !sample.dataR.empty();
+    const size_t voiceIndex = static_cast<size_t>(&voice - voices_.data());
+    VoiceStream* stream = playing_->streams[voiceIndex].get();
+    if (stream && looping != voice.streamLooping && voice.position < vEnd) {
+        // Loop switched mid-note: the stream's order of frames no longer matches
+        startStream(voiceIndex, static_cast<size_t>(voice.position));
+    }
+    uint64_t available = stream ? stream->available() : 0;
+    uint64_t underruns = 0;
+    
+    const InterpolationQuality quality = offlineRendering_
+        ? std::max(params_.interpolation, offlineInterpolation_)
+        : params_.interpolation;
+    // Unpitched at the engine rate, every output frame lands exactly on a source frame
+    const bool straightCopy = voice.increment == 1.0 && voice.position == std::floor(voice.position);
+    const size_t reach = straightCopy ? 1 : getInterpolationReach(quality, voice.increment);
+    
+    auto fetch = [&](size_t frame, float& l, float& r) {
+        if (frame < resident) {
+            l = sample.dataL[frame];
+            r = stereo ? sample.dataR[frame] : l;
+            return true;
+        }
+        uint64_t index = streamIndex(voice, frame, vEnd, vLoopStart);
+        if (index >= available && offlineRendering_) {
+            // Keep what the next run may still read behind the play head
+            const uint64_t history = 2 * MAX_INTERPOLATION_REACH;
+            voice.streamConsumed = std::max(voice.streamConsumed, index > history ? index - history : 0);
+            stream->consume(voice.streamConsumed);
+            available = waitForStream(*stream, index);
+        }
+        if (index >= available) {
+            return false;
+        }
+        l = stream->left(index);
+        r = stream->right(index);
+        return true;
+    };
+    
+    // First frame of the pass the voice is in; taps never reach outside [passStart, vEnd)
+    auto passStart = [&]() -> size_t {
+        if (voice.loopCount > 0) return vLoopStart;
+        return stream ? voice.streamStart : voice.startSample;
+    };
+    
+    // Apply pan
+    float panL = 1.0f, panR = 1.0f;
+    if (params_.pan < 0) {
+        panR = 1.0f + params_.pan;
+    } else if (params_.pan > 0) {
+        panL = 1.0f - params_.pan;
+    }
     
-    // Process each active voice
-    for (auto& voice : voices_) {
-        if (!voice.active) continue;
-        
-        double deltaTime = 1.0 / sampleRate_;
-        
-        for (size_t i = 0; i < numFrames; ++i) {
-            // Process envelope
+    double deltaTime = 1.0 / sampleRate;
+    
+    size_t i = 0;
+    while (i < numFrames && voice.active) {
+        // Step the envelope and play head for a run of frames inside one pass
+        size_t count = 0;
+        size_t runFirst = i;
+        int64_t windowStart = 0;  // Source frame at window index 0
+        for (; i < numFrames && count < RUN_FRAMES; ++i) {
+            size_t pos = static_cast<size_t>(voice.position);
+            if (pos >= vEnd && looping) {
+                if (count > 0) break;  // The wrapped pass gets a run of its own
+                voice.position = static_cast<double>(vLoopStart);
+                pos = vLoopStart;
+                ++voice.loopCount;
+            }
+            if (count > 0 && static_cast<int64_t>(pos + reach) - windowStart >= static_cast<int64_t>(WINDOW_FRAMES)) {
+                break;
+            }
+            
             float envLevel = processEnvelope(voice, deltaTime);
             if (!voice.active) break;
             
-            // Check if we've reached the end
-            size_t pos = static_cast<size_t>(voice.position);
-            size_t vEnd = voice.endSample > 0 ? std::min(voice.endSample, sampleLength) : sampleLength;
-            size_t vLoopStart = params_.loopEnabled ? voice.loopStartSample : voice.startSample;
             if (pos >= vEnd) {
-                if (params_.loopEnabled && params_.mode == SamplerMode::Classic) {
-                    voice.position = static_cast<double>(vLoopStart);
-                    pos = vLoopStart;
+                // End of sample
+                if (params_.mode == SamplerMode::OneShot) {
+                    voice.active = false;
                 } else {
-                    // End of sample
-                    if (params_.mode == SamplerMode::OneShot) {
-                        voice.active = false;
-                    } else {
-                        voice.envStage = Voice::EnvStage::Release;
-                    }
-                    continue;
+                    voice.envStage = Voice::EnvStage::Release;
                 }
+                continue;
             }
             
-            // Linear interpolation for pitch shifting
-            size_t pos0 = pos;
-            size_t pos1 = std::min(pos0 + 1, sampleLength - 1);
-            float frac = static_cast<float>(voice.position - pos0);
-            
-            float sampleL = sample_->dataL[pos0] * (1.0f - frac) + sample_->dataL[pos1] * frac;
-            float sampleR = sampleL;
-            if (sample_->stereo && !sample_->dataR.empty()) {
-                sampleR = sample_->dataR[pos0] * (1.0f - frac) + sample_->dataR[pos1] * frac;
+            if (count == 0) {
+                runFirst = i;
+                windowStart = static_cast<int64_t>(pos) - static_cast<int64_t>(reach - 1);
             }
             
             // Apply LFO to volume if targeted
@@ -525,19 +575,10 @@ void Sampler::process(float* outL, float* outR, size_t numFrames) {
                 lfoMod = 1.0f + calculateLFO() * 0.5f;
             }
             
-            // Apply envelope and velocity
-            float amp = envLevel * voice.velocity * totalGain * lfoMod;
-            
-            // Apply pan
-            float panL = 1.0f, panR = 1.0f;
-            if (params_.pan < 0) {
-                panR = 1.0f + params_.pan;
-            } else if (params_.pan > 0) {
-                panL = 1.0f - params_.pan;
-            }
-            
-            outL[i] += sampleL * amp * panL;
-            outR[i] += sampleR * amp * panR;
+            runPositions_[count] = static_cast<uint32_t>(static_cast<int64_t>(pos) - windowStart);
+            runFractions_[count] = static_cast<float>(voice.position - static_cast<double>(pos));
+            runGains_[count] = envLevel * voice.velocity * totalGain * lfoMod;
+            ++count;
             
             // Advance position
             voice.position += voice.increment;
@@ -546,12 +587,62 @@ void Sampler::process(float* outL, float* outR, size_t numFrames) {
             lfoPhase_ += lfoIncrement;
             if (lfoPhase_ >= 1.0) lfoPhase_ -= 1.0;
         }
+        if (count == 0) {
+            continue;
+        }
+        
+        // Copy the run's source frames into the window. The stream delivers in
+        // order, so once a frame is missing every later one is too.
+        const int64_t first = static_cast<int64_t>(passStart());
+        const int64_t last = static_cast<int64_t>(vEnd) - 1;
+        const size_t length = runPositions_[count - 1] + reach + 1;
+        size_t valid = 0;
+        while (valid < length) {
+            size_t frame = static_cast<size_t>(std::clamp(windowStart + static_cast<int64_t>(valid), first, last));
+            if (!fetch(frame, windowL_[valid], windowR_[valid])) break;
+            ++valid;
+        }
+        
+        if (straightCopy) {
+            for (size_t k = 0; k < count; ++k) {
+                runL_[k] = windowL_[runPositions_[k]];
+                runR_[k] = windowR_[runPositions_[k]];
+            }
+        } else {
+            interpolate(quality, voice.increment, windowL_.data(), stereo ? windowR_.data() : nullptr,
+                        runPositions_.data(), runFractions_.data(), runL_.data(), runR_.data(), count);
+        }
+        
+        for (size_t k = 0; k < count; ++k) {
+            float sampleL = runL_[k];
+            float sampleR = stereo ? runR_[k] : sampleL;
+            if (runPositions_[k] + reach >= valid) {
+                // The disk is behind: play silence and keep time
+                sampleL = 0.0f;
+                sampleR = 0.0f;
+                ++underruns;
+            }
+            outL[runFirst + k] += sampleL * runGains_[k] * panL;
+            outR[runFirst + k] += sampleR * runGains_[k] * panR;
+        }
     }
     
-    // Count active voices
-    activeVoiceCount_ = 0;
-    for (const auto& voice : voices_) {
-        if (voice.active) activeVoiceCount_++;
+    if (stream) {
+        if (!voice.active) {
+            stream->stop();
+        } else if (voice.position < vEnd) {
+            // Let the streamer reuse the ring behind what the next block's taps read
+            size_t pos = static_cast<size_t>(voice.position);
+            size_t keepFrom = std::max(passStart(), pos > MAX_INTERPOLATION_REACH ? pos - MAX_INTERPOLATION_REACH : 0);
+            uint64_t index = streamIndex(voice, keepFrom, vEnd, vLoopStart);
+            if (index > voice.streamConsumed) {
+                voice.streamConsumed = index;
+                stream->consume(index);
+            }
+        }
+    }
+    if (underruns > 0) {
+        streamUnderruns_.fetch_add(underruns, std::memory_order_relaxed);
     }
 }
 
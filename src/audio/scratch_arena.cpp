@@ -0,0 +1,56 @@
+#include "pan/audio/scratch_arena.h"
+#include <iostream>
+
+namespace pan {
+
+bool ScratchArena::prepare(size_t numChannels, size_t maxFrames, size_t numBuffers) {
+    if (numChannels == 0 || maxFrames == 0) {
+        std::cerr << "ScratchArena: channel count and block size must be non-zero" << std::endl;
+        return false;
+    }
+
+    // Reuse the existing allocation when it already fits
+    if (numChannels != numChannels_ || maxFrames != maxFrames_ || numBuffers != buffers_.size()) {
+        buffers_.clear();
+        buffers_.reserve(numBuffers);
+        for (size_t i = 0; i < numBuffers; ++i) {
+            buffers_.push_back(std::make_unique<AudioBuffer>(numChannels, maxFrames));
+        }
+        numChannels_ = numChannels;
+        maxFrames_ = maxFrames;
+    }
+
+    nextBuffer_ = 0;
+    highWaterMark_ = 0;
+    exhaustedCount_ = 0;
+    return true;
+}
+
+AudioBuffer* ScratchArena::acquire(size_t numFrames) {
+    if (numFrames > maxFrames_) {
+        exhaustedCount_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    size_t index = nextBuffer_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= buffers_.size()) {
+        exhaustedCount_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    size_t used = index + 1;
+    size_t highWater = highWaterMark_.load(std::memory_order_relaxed);
+    while (used > highWater && !highWaterMark_.compare_exchange_weak(highWater, used, std::memory_order_relaxed)) {
+    }
+
+    AudioBuffer* buffer = buffers_[index].get();
+    buffer->setNumFrames(numFrames);
+    buffer->clear();
+    return buffer;
+}
+
+void ScratchArena::reset() {
+    nextBuffer_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace pan
@@ -1,4 +1,5 @@
 #include "pan/audio/sidechain_pump.h"
+#include "pan/dsp/fast_math.h"
 #include <algorithm>
 
 namespace pan {
@@ -8,8 +9,8 @@ SidechainPump::SidechainPump(double sampleRate)
 
 void SidechainPump::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     float depthLin = std::pow(10.0f, depthDb_ / 20.0f);
     double inc = (2.0 * M_PI * rateHz_) / sampleRate_;
@@ -18,8 +19,8 @@ void SidechainPump::process(AudioBuffer& buffer, size_t numFrames) {
     
     for (size_t i = 0; i < numFrames; ++i) {
         // Envelope is driven by a cosine LFO shaped
-        float lfo = 0.5f * (1.0f - std::cos(static_cast<float>(phase_)));
-        float shaped = std::pow(lfo, shape_);
+        float lfo = 0.5f * (1.0f - dsp::cos(static_cast<float>(phase_)));
+        float shaped = dsp::pow(lfo, shape_);
         float target = 1.0f - (1.0f - depthLin) * shaped; // 1 -> no duck, depthLin at peak
         
         if (target < env_) {
@@ -0,0 +1,289 @@
+#include "pan/audio/wav_writer.h"
+#include "pan/audio/audio_buffer.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace pan {
+
+static void putLE16(uint8_t* dst, uint16_t value) {
+    dst[0] = static_cast<uint8_t>(value & 0xFF);
+    dst[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+static void putLE32(uint8_t* dst, uint32_t value) {
+    dst[0] = static_cast<uint8_t>(value & 0xFF);
+    dst[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    dst[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+    dst[3] = static_cast<uint8_t>((value >> 24) & 0xFF);
+}
+
+static void putLE64(uint8_t* dst, uint64_t value) {
+    putLE32(dst, static_cast<uint32_t>(value & 0xFFFFFFFFull));
+    putLE32(dst + 4, static_cast<uint32_t>(value >> 32));
+}
+
+// Wave64 chunk IDs are GUIDs whose first four bytes spell the RIFF FourCC
+static const uint8_t W64_RIFF_GUID[16] = {'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11,
+                                          0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00};
+static const uint8_t W64_WAVE_GUID[16] = {'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11,
+                                          0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+static const uint8_t W64_FMT_GUID[16] = {'f', 'm', 't', ' ', 0xF3, 0xAC, 0xD3, 0x11,
+                                         0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+static const uint8_t W64_DATA_GUID[16] = {'d', 'a', 't', 'a', 0xF3, 0xAC, 0xD3, 0x11,
+                                          0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+
+static constexpr size_t WAVE_HEADER_BYTES = 44;
+static constexpr size_t W64_HEADER_BYTES = 40 + 40 + 24;  // riff + fmt chunk + data chunk header
+
+// PCM/float "fmt " payload shared by both containers
+static void putFormatChunk(uint8_t* dst, WavWriter::Format format, size_t numChannels, double sampleRate) {
+    const size_t bytesPerSample = WavWriter::getBytesPerSample(format);
+    const uint16_t audioFormat = (format == WavWriter::Format::Float32) ? 3 : 1;  // IEEE float or PCM
+    const uint32_t blockAlign = static_cast<uint32_t>(numChannels * bytesPerSample);
+    const uint32_t rate = static_cast<uint32_t>(std::lround(sampleRate));
+    putLE16(dst, audioFormat);
+    putLE16(dst + 2, static_cast<uint16_t>(numChannels));
+    putLE32(dst + 4, rate);
+    putLE32(dst + 8, rate * blockAlign);
+    putLE16(dst + 12, static_cast<uint16_t>(blockAlign));
+    putLE16(dst + 14, static_cast<uint16_t>(bytesPerSample * 8));
+}
+
+WavWriter::WavWriter()
+    : file_(nullptr)
+    , numChannels_(0)
+    , sampleRate_(44100.0)
+    , format_(Format::Float32)
+    , container_(Container::Wav)
+    , framesWritten_(0)
+    , preallocatedBytes_(0)
+{
+}
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+size_t WavWriter::getBytesPerSample(Format format) {
+    switch (format) {
+        case Format::PCM16: return 2;
+        case Format::PCM24: return 3;
+        case Format::Float32: return 4;
+    }
+    return 4;
+}
+
+size_t WavWriter::getDataOffset() const {
+    return container_ == Container::W64 ? W64_HEADER_BYTES : WAVE_HEADER_BYTES;
+}
+
+bool WavWriter::open(const std::string& path, size_t numChannels, double sampleRate, Format format,
+                     Container container) {
+    close();
+
+    if (numChannels == 0 || sampleRate <= 0.0) {
+        std::cerr << "WavWriter: Invalid stream parameters for " << path << std::endl;
+        return false;
+    }
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "WavWriter: Cannot open file for writing: " << path << std::endl;
+        return false;
+    }
+    ioBuffer_.resize(WRITE_BUFFER_BYTES);
+    std::setvbuf(file_, ioBuffer_.data(), _IOFBF, ioBuffer_.size());
+
+    path_ = path;
+    numChannels_ = numChannels;
+    sampleRate_ = sampleRate;
+    format_ = format;
+    container_ = container;
+    framesWritten_ = 0;
+
+    // Placeholder sizes - patched in close()
+    if (!writeHeader(0)) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool WavWriter::writeHeader(uint64_t dataBytes) {
+    bool ok = container_ == Container::W64 ? writeW64Header(dataBytes) : writeWaveHeader(dataBytes);
+    if (!ok) {
+        std::cerr << "WavWriter: Failed to write header: " << path_ << std::endl;
+    }
+    return ok;
+}
+
+bool WavWriter::writeWaveHeader(uint64_t dataBytes) {
+    // RIFF sizes are 32-bit; clamp oversized files rather than wrapping
+    const uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(dataBytes, 0xFFFFFFFFull - 36));
+
+    uint8_t header[WAVE_HEADER_BYTES];
+    std::memcpy(header, "RIFF", 4);
+    putLE32(header + 4, 36 + dataSize);
+    std::memcpy(header + 8, "WAVE", 4);
+    std::memcpy(header + 12, "fmt ", 4);
+    putLE32(header + 16, 16);
+    putFormatChunk(header + 20, format_, numChannels_, sampleRate_);
+    std::memcpy(header + 36, "data", 4);
+    putLE32(header + 40, dataSize);
+
+    return std::fseek(file_, 0, SEEK_SET) == 0 && std::fwrite(header, 1, sizeof(header), file_) == sizeof(header);
+}
+
+bool WavWriter::writeW64Header(uint64_t dataBytes) {
+    // Chunk sizes include the 24-byte GUID + size header; chunks are 8-byte aligned
+    const uint64_t paddedData = (dataBytes + 7) & ~uint64_t(7);
+
+    uint8_t header[W64_HEADER_BYTES];
+    std::memcpy(header, W64_RIFF_GUID, 16);
+    putLE64(header + 16, W64_HEADER_BYTES + paddedData);
+    std::memcpy(header + 24, W64_WAVE_GUID, 16);
+    std::memcpy(header + 40, W64_FMT_GUID, 16);
+    putLE64(header + 56, 24 + 16);
+    putFormatChunk(header + 64, format_, numChannels_, sampleRate_);
+    std::memcpy(header + 80, W64_DATA_GUID, 16);
+    putLE64(header + 96, 24 + dataBytes);
+
+    return std::fseek(file_, 0, SEEK_SET) == 0 && std::fwrite(header, 1, sizeof(header), file_) == sizeof(header);
+}
+
+void WavWriter::encodeSample(float sample, uint8_t* dst) const {
+    switch (format_) {
+        case Format::PCM16: {
+            float clamped = std::clamp(sample, -1.0f, 1.0f);
+            int16_t value = static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+            putLE16(dst, static_cast<uint16_t>(value));
+            break;
+        }
+        case Format::PCM24: {
+            float clamped = std::clamp(sample, -1.0f, 1.0f);
+            int32_t value = static_cast<int32_t>(std::lrint(clamped * 8388607.0f));
+            dst[0] = static_cast<uint8_t>(value & 0xFF);
+            dst[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+            dst[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+            break;
+        }
+        case Format::Float32: {
+            uint32_t bits;
+            std::memcpy(&bits, &sample, sizeof(bits));
+            putLE32(dst, bits);
+            break;
+        }
+    }
+}
+
+bool WavWriter::flushScratch(size_t numFrames) {
+    if (std::fwrite(scratch_.data(), 1, scratch_.size(), file_) != scratch_.size()) {
+        std::cerr << "WavWriter: Write failed: " << path_ << std::endl;
+        return false;
+    }
+    framesWritten_ += numFrames;
+    return true;
+}
+
+bool WavWriter::write(const AudioBuffer& buffer, size_t numFrames) {
+    if (!file_) {
+        return false;
+    }
+
+    numFrames = std::min(numFrames, buffer.getNumFrames());
+    if (numFrames == 0) {
+        return true;
+    }
+
+    const size_t bytesPerSample = getBytesPerSample(format_);
+    const size_t frameBytes = numChannels_ * bytesPerSample;
+    scratch_.resize(numFrames * frameBytes);
+
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        // Missing source channels are written as silence
+        const float* src = ch < buffer.getNumChannels() ? buffer.getReadPointer(ch) : nullptr;
+        uint8_t* dst = scratch_.data() + ch * bytesPerSample;
+
+        for (size_t i = 0; i < numFrames; ++i, dst += frameBytes) {
+            encodeSample(src ? src[i] : 0.0f, dst);
+        }
+    }
+
+    return flushScratch(numFrames);
+}
+
+bool WavWriter::writeInterleaved(const float* samples, size_t numFrames) {
+    if (!file_) {
+        return false;
+    }
+    if (numFrames == 0) {
+        return true;
+    }
+
+    const size_t bytesPerSample = getBytesPerSample(format_);
+    const size_t numSamples = numFrames * numChannels_;
+    scratch_.resize(numSamples * bytesPerSample);
+
+    uint8_t* dst = scratch_.data();
+    for (size_t i = 0; i < numSamples; ++i, dst += bytesPerSample) {
+        encodeSample(samples[i], dst);
+    }
+    return flushScratch(numFrames);
+}
+
+bool WavWriter::preallocate(uint64_t numFrames) {
+    if (!file_) {
+        return false;
+    }
+#ifdef __linux__
+    const uint64_t bytes = getDataOffset() + numFrames * numChannels_ * getBytesPerSample(format_);
+    if (fallocate(fileno(file_), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(bytes)) == 0) {
+        preallocatedBytes_ = std::max(preallocatedBytes_, bytes);
+        return true;
+    }
+#endif
+    // Not supported by this platform or filesystem; writes simply allocate as they go
+    return false;
+}
+
+bool WavWriter::close() {
+    if (!file_) {
+        return true;
+    }
+
+    uint64_t dataBytes = framesWritten_ * numChannels_ * getBytesPerSample(format_);
+
+    // RIFF chunks are word-aligned, Wave64 chunks 8-byte aligned
+    const uint64_t alignment = container_ == Container::W64 ? 8 : 2;
+    for (uint64_t pad = dataBytes; pad % alignment != 0; ++pad) {
+        std::fputc(0, file_);
+    }
+    bool ok = writeHeader(dataBytes);
+
+#ifdef __linux__
+    // Give back preallocated blocks past the end of the data
+    const uint64_t fileBytes = getDataOffset() + dataBytes + (alignment - dataBytes % alignment) % alignment;
+    if (preallocatedBytes_ > fileBytes && std::fflush(file_) == 0) {
+        fallocate(fileno(file_), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(fileBytes),
+                  static_cast<off_t>(preallocatedBytes_ - fileBytes));
+    }
+#endif
+    preallocatedBytes_ = 0;
+
+    if (std::fclose(file_) != 0) {
+        std::cerr << "WavWriter: Failed to close file: " << path_ << std::endl;
+        ok = false;
+    }
+    file_ = nullptr;
+    return ok;
+}
+
+} // namespace pan
@@ -1,4 +1,5 @@
 #include "pan/audio/wow_flutter.h"
+#include "pan/dsp/fast_math.h"
 #include <algorithm>
 
 namespace pan {
@@ -30,15 +31,15 @@ float WowFlutter::readDelayInterp(const std::vector<float>& buf, float delaySamp
 void WowFlutter::process(AudioBuffer& buffer, size_t numFrames) {
     if (!enabled_) return;
     
-    auto& left = buffer.getChannel(0);
-    auto& right = buffer.getChannel(1);
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getWritePointer(1);
     
     double wowInc = (2.0 * M_PI * wowRate_) / sampleRate_;
     double flutterInc = (2.0 * M_PI * flutterRate_) / sampleRate_;
     
     for (size_t i = 0; i < numFrames; ++i) {
-        float wow = std::sin(wowPhase_);
-        float flutter = std::sin(flutterPhase_);
+        float wow = dsp::sin(static_cast<float>(wowPhase_));
+        float flutter = dsp::sin(static_cast<float>(flutterPhase_));
         float delayMs = wowDepthMs_ * wow + flutterDepthMs_ * flutter + (wowDepthMs_ * 0.5f);
         float delaySamples = std::clamp(delayMs / 1000.0f * static_cast<float>(sampleRate_), 1.0f, static_cast<float>(maxDelaySamples_ - 2));
         
@@ -51,7 +52,7 @@ void WowFlutter::process(AudioBuffer& buffer, size_t numFrames) {
         float dR = readDelayInterp(delayR_, delaySamples);
         
         // soft saturation
-        auto sat = [&](float x) { return std::tanh(x * (1.0f + saturation_ * 4.0f)); };
+        auto sat = [&](float x) { return dsp::tanh(x * (1.0f + saturation_ * 4.0f)); };
         dL = dL * (1.0f - saturation_) + sat(dL) * saturation_;
         dR = dR * (1.0f - saturation_) + sat(dR) * saturation_;
         
@@ -9,6 +9,12 @@
 #include "pan/audio/bit_noise_texture.h"
 #include "pan/audio/resonator_bank.h"
 #include "pan/audio/sampler.h"
+#include "pan/audio/sample_pool.h"
+#include "pan/audio/render_pool.h"
+#include "pan/audio/scratch_arena.h"
+#include "pan/audio/noise_seeds.h"
+#include "pan/dsp/fast_math.h"
+#include "pan/dsp/random.h"
 #include <iostream>
 #include <filesystem>
 #include <fstream>
@@ -24,7 +30,9 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cctype>
 #include <ctime>
+#include <random>
 #include <set>
 #include <utility>
 #include <filesystem>
@@ -70,10 +78,21 @@ Track::Track()
     , waveformBuffer(WAVEFORM_BUFFER_SIZE, 0.0f)
     , waveformBufferWritePos(0)
     , waveformBufferMutex(std::make_unique<std::mutex>())
+    , audioClips(std::make_unique<RealtimeHandoff<AudioClipList>>())
+    , frozen(std::make_unique<RealtimeHandoff<FrozenAudio>>())
 {
     // Track starts empty - drag instruments/samples from browser to load
 }
 
+void Track::addAudioClip(std::shared_ptr<AudioClip> clip) {
+    auto updated = std::make_unique<AudioClipList>();
+    if (auto current = audioClips->read()) {
+        *updated = *current;
+    }
+    updated->push_back(std::move(clip));
+    audioClips->publish(std::move(updated));
+}
+
 void Track::addWaveformSample(float sample) {
     if (waveformBufferMutex) {
         std::lock_guard<std::mutex> lock(*waveformBufferMutex);
@@ -537,6 +556,7 @@ bool MainWindow::initializeAudio() {
         std::cerr << "Failed to initialize audio engine" << std::endl;
         return false;
     }
+    engine_->setSampleRateListener([this](double sampleRate) { onEngineSampleRateChanged(sampleRate); });
     
     // Create 1 track initially, auto-select it
     tracks_.resize(1);
@@ -549,6 +569,9 @@ bool MainWindow::initializeAudio() {
         track.isRecording = true;
     }
     
+    // Reserve so the callback can size the per-track buffer list without allocating
+    trackRenderBuffers_.reserve(engine_->getMaxTrackCount());
+    
     // Set up audio processing - mix all recording tracks and play back clips
     engine_->setProcessCallback([this](AudioBuffer& input, AudioBuffer& output, size_t numFrames) {
         output.clear();
@@ -591,46 +614,10 @@ bool MainWindow::initializeAudio() {
         
         // If playing, trigger MIDI events from clips
         if (isPlaying_) {
-        for (auto& track : tracks_) {
-                if (track.synth) {
-                    // Play back all completed clips on this track
-                    for (const auto& clip : track.clips) {
-                        const auto& events = clip->getEvents();
-                        int64_t clipStartSample = clip->getStartTime();
-                        
-                        // Check which events fall in this audio buffer time window
-                        for (const auto& event : events) {
-                            int64_t absoluteSamplePos = clipStartSample + event.timestamp;
-                            
-                            // If this event falls within the current buffer, trigger it
-                            if (absoluteSamplePos >= currentPlaybackPos && 
-                                absoluteSamplePos < currentPlaybackPos + static_cast<int64_t>(numFrames)) {
-                                // Route to appropriate instrument
-                                if (track.hasDrumKit && track.drumKit) {
-                                    // Route to drum kit - find pad for this MIDI note
-                                    int note = event.message.getNoteNumber();
-                                    DrumPad* pad = track.drumKit->getPadForNote(note);
-                                    if (pad && pad->sampler && !pad->samplePath.empty()) {
-                                        if (!pad->muted) {  // Respect mute
-                                            if (event.message.getType() == MidiMessageType::NoteOn) {
-                                                pad->sampler->noteOn(60, event.message.getVelocity());
-                                            } else if (event.message.getType() == MidiMessageType::NoteOff) {
-                                                pad->sampler->noteOff(60);
-                                            }
-                                        }
-                                    }
-                                } else if (track.hasSampler && track.sampler) {
-                                    if (event.message.getType() == MidiMessageType::NoteOn) {
-                                        track.sampler->noteOn(event.message.getNoteNumber(), event.message.getVelocity());
-                                    } else if (event.message.getType() == MidiMessageType::NoteOff) {
-                                        track.sampler->noteOff(event.message.getNoteNumber());
-                                    }
-                                } else if (track.synth) {
-                                    track.synth->processMidiMessage(event.message);
-                                }
-                            }
-                        }
-                    }
+            for (auto& track : tracks_) {
+                // A frozen track's clips are already in its render
+                if (track.synth && !track.isFrozen()) {
+                    dispatchClipEvents(track, currentPlaybackPos, numFrames);
                 }
             }
         }
@@ -644,116 +631,45 @@ bool MainWindow::initializeAudio() {
             }
         }
         
-        // Mix all recording tracks (armed tracks get live MIDI input)
-        for (auto& track : tracks_) {
-            if (track.synth || track.sampler) {
-                // Skip muted tracks, or non-soloed tracks when solo is active
-                bool shouldPlay = !track.isMuted && (!anySolo || track.isSolo);
-                
-                AudioBuffer trackBuffer(output.getNumChannels(), numFrames);
-                
-                // Use appropriate instrument for audio
-                if (track.hasDrumKit && track.drumKit) {
-                    // Process all drum pads and mix them
-                    float* leftOut = trackBuffer.getWritePointer(0);
-                    float* rightOut = trackBuffer.getNumChannels() > 1 ? trackBuffer.getWritePointer(1) : leftOut;
-                    
-                    // Clear buffer first
-                    for (size_t i = 0; i < numFrames; ++i) {
-                        leftOut[i] = 0.0f;
-                        if (rightOut != leftOut) rightOut[i] = 0.0f;
-                    }
-                    
-                    // Check for solo
-                    bool anyPadSolo = false;
-                    for (const auto& pad : track.drumKit->pads) {
-                        if (pad.solo) { anyPadSolo = true; break; }
-                    }
-                    
-                    // Mix all pads
-                    std::vector<float> padLeft(numFrames, 0.0f);
-                    std::vector<float> padRight(numFrames, 0.0f);
-                    
-                    for (auto& pad : track.drumKit->pads) {
-                        if (pad.muted || (anyPadSolo && !pad.solo)) continue;
-                        if (!pad.sampler || pad.samplePath.empty()) continue;
-                        
-                        // Process pad's sampler
-                        std::fill(padLeft.begin(), padLeft.end(), 0.0f);
-                        std::fill(padRight.begin(), padRight.end(), 0.0f);
-                        pad.sampler->process(padLeft.data(), padRight.data(), numFrames);
-                        
-                        // Apply pad volume and pan
-                        float vol = pad.volume;
-                        float panL = (pad.pan <= 0) ? 1.0f : (1.0f - pad.pan);
-                        float panR = (pad.pan >= 0) ? 1.0f : (1.0f + pad.pan);
-                        
-                        for (size_t i = 0; i < numFrames; ++i) {
-                            leftOut[i] += padLeft[i] * vol * panL;
-                            if (rightOut != leftOut) {
-                                rightOut[i] += padRight[i] * vol * panR;
-                            }
-                        }
-                    }
-                } else if (track.hasSampler && track.sampler) {
-                    float* leftOut = trackBuffer.getWritePointer(0);
-                    float* rightOut = trackBuffer.getNumChannels() > 1 ? trackBuffer.getWritePointer(1) : leftOut;
-                    track.sampler->process(leftOut, rightOut, numFrames);
-                } else if (track.synth) {
-                track.synth->generateAudio(trackBuffer, numFrames);
-                }
-                
-                // Apply effects chain
-                for (auto& effect : track.effects) {
-                    if (effect && effect->isEnabled()) {
-                        effect->process(trackBuffer, numFrames);
-                    }
-                }
-                
-                // Capture waveform samples for visualization (use first channel, after effects)
-                // Also calculate peak level for metering
-                if (trackBuffer.getNumChannels() > 0) {
-                    const float* trackSamples = trackBuffer.getReadPointer(0);
-                    float maxSample = 0.0f;
-                    for (size_t i = 0; i < numFrames; ++i) {
-                        track.addWaveformSample(trackSamples[i]);
-                        float absSample = std::abs(trackSamples[i]);
-                        if (absSample > maxSample) maxSample = absSample;
-                    }
-                    // Smooth peak level (fast attack, slow decay)
-                    if (maxSample > track.peakLevel) {
-                        track.peakLevel = maxSample;
-                    } else {
-                        track.peakLevel = track.peakLevel * 0.95f;  // Decay
-                    }
-                }
-                
-                // Mix into output (only if track should play)
-                if (shouldPlay) {
-                    float gain = std::pow(10.0f, track.volumeDb / 20.0f);
-                    float pan = std::clamp(track.pan, -1.0f, 1.0f);
-                    float angle = (pan + 1.0f) * 0.25f * static_cast<float>(M_PI); // 0..pi/2
-                    float lGain = gain * std::cos(angle);
-                    float rGain = gain * std::sin(angle);
-                    
-                    const float* trackL = trackBuffer.getReadPointer(0);
-                    const float* trackR = trackBuffer.getNumChannels() > 1 ? trackBuffer.getReadPointer(1) : trackL;
-                    
-                    float* outL = output.getWritePointer(0);
-                    float* outR = output.getNumChannels() > 1 ? output.getWritePointer(1) : outL;
-                    
-                    for (size_t i = 0; i < numFrames; ++i) {
-                        outL[i] += trackL[i] * lGain;
-                        if (output.getNumChannels() > 1) {
-                            outR[i] += trackR[i] * rGain;
-                        }
-                    }
-                }
-            } else {
-                // No synth - clear waveform buffer
-                for (size_t i = 0; i < numFrames && i < Track::WAVEFORM_BUFFER_SIZE; ++i) {
-                    track.addWaveformSample(0.0f);
-                }
+        // Render stage - tracks are independent, so fan them out across the render pool.
+        // Track buffers come from the engine's scratch arena, which addTrack() and
+        // deserializeProject() keep sized for every track (see reserveTracks()).
+        // The clamp only guards against allocating here if that ever fails.
+        ScratchArena& scratch = engine_->getScratchArena();
+        const size_t numTracks = std::min(tracks_.size(), trackRenderBuffers_.capacity());
+        trackRenderBuffers_.resize(numTracks);
+        for (size_t t = 0; t < numTracks; ++t) {
+            trackRenderBuffers_[t] = scratch.acquire(numFrames);
+        }
+        
+        auto renderTask = [this, numFrames](size_t t) {
+            if (trackRenderBuffers_[t]) {
+                renderTrackAudio(tracks_[t], *trackRenderBuffers_[t], numFrames);
+            }
+        };
+        double deadline = 0.8 * static_cast<double>(numFrames) / engine_->getSampleRate();
+        engine_->getRenderPool().run(numTracks, renderTask, deadline);
+        
+        // Summing stage - always in track order so the mix is identical to a serial render
+        for (size_t t = 0; t < numTracks; ++t) {
+            auto& track = tracks_[t];
+            // Skip muted tracks, or non-soloed tracks when solo is active
+            bool shouldPlay = !track.isMuted && (!anySolo || track.isSolo);
+            if (!(track.synth || track.sampler) || !shouldPlay || !trackRenderBuffers_[t] || track.sleeping) {
+                continue;
+            }
+            
+            const AudioBuffer& trackBuffer = *trackRenderBuffers_[t];
+            float gain = dsp::dbToGain(track.volumeDb);
+            float pan = std::clamp(track.pan, -1.0f, 1.0f);
+            float angle = (pan + 1.0f) * 0.25f * static_cast<float>(M_PI); // 0..pi/2
+            float lGain = gain * dsp::cos(angle);
+            float rGain = gain * dsp::sin(angle);
+            
+            output.addFrom(0, 0, trackBuffer, 0, 0, numFrames, lGain);
+            if (output.getNumChannels() > 1) {
+                size_t sourceRight = trackBuffer.getNumChannels() > 1 ? 1 : 0;
+                output.addFrom(1, 0, trackBuffer, sourceRight, 0, numFrames, rGain);
             }
         }
         
@@ -799,24 +715,8 @@ bool MainWindow::initializeAudio() {
         }
         
         // Calculate master output levels for metering
-        float maxL = 0.0f, maxR = 0.0f;
-        if (output.getNumChannels() >= 2) {
-            const float* leftSamples = output.getReadPointer(0);
-            const float* rightSamples = output.getReadPointer(1);
-            for (size_t i = 0; i < numFrames; ++i) {
-                float absL = std::abs(leftSamples[i]);
-                float absR = std::abs(rightSamples[i]);
-                if (absL > maxL) maxL = absL;
-                if (absR > maxR) maxR = absR;
-            }
-        } else if (output.getNumChannels() >= 1) {
-            const float* samples = output.getReadPointer(0);
-            for (size_t i = 0; i < numFrames; ++i) {
-                float absSample = std::abs(samples[i]);
-                if (absSample > maxL) maxL = absSample;
-            }
-            maxR = maxL;
-        }
+        float maxL = output.getPeak(0, 0, numFrames);
+        float maxR = output.getNumChannels() >= 2 ? output.getPeak(1, 0, numFrames) : maxL;
         
         // Smooth peak levels (fast attack, slow decay)
         if (maxL > masterPeakL_) masterPeakL_ = maxL;
@@ -826,6 +726,13 @@ bool MainWindow::initializeAudio() {
         else masterPeakR_ = masterPeakR_ * 0.95f;
     });
     
+    // Open the default input as well when audio recording is wanted
+    if (std::getenv("PAN_AUDIO_INPUT")) {
+        StreamConfig config = engine_->getStreamConfig();
+        config.duplex = true;
+        engine_->setStreamConfig(config);
+    }
+    
     // Start audio engine
     if (!engine_->start()) {
         std::cerr << "Failed to start audio engine" << std::endl;
@@ -835,6 +742,177 @@ bool MainWindow::initializeAudio() {
     return true;
 }
 
+void MainWindow::dispatchClipEvents(Track& track, int64_t position, size_t numFrames) {
+    // Play back all completed clips on this track
+    for (const auto& clip : track.clips) {
+        const auto& events = clip->getEvents();
+        int64_t clipStartSample = clip->getStartTime();
+        
+        // Check which events fall in this audio buffer time window
+        for (const auto& event : events) {
+            int64_t absoluteSamplePos = clipStartSample + event.timestamp;
+            
+            // If this event falls within the current buffer, trigger it
+            if (absoluteSamplePos >= position && 
+                absoluteSamplePos < position + static_cast<int64_t>(numFrames)) {
+                // Instruments apply it this many frames into the block
+                uint32_t frameOffset = static_cast<uint32_t>(absoluteSamplePos - position);
+                // Route to appropriate instrument
+                if (track.hasDrumKit && track.drumKit) {
+                    // Route to drum kit - find pad for this MIDI note
+                    int note = event.message.getNoteNumber();
+                    DrumPad* pad = track.drumKit->getPadForNote(note);
+                    if (pad && pad->sampler && !pad->samplePath.empty()) {
+                        if (!pad->muted) {  // Respect mute
+                            if (event.message.getType() == MidiMessageType::NoteOn) {
+                                pad->sampler->noteOn(60, event.message.getVelocity(), frameOffset);
+                            } else if (event.message.getType() == MidiMessageType::NoteOff) {
+                                pad->sampler->noteOff(60, frameOffset);
+                            }
+                        }
+                    }
+                } else if (track.hasSampler && track.sampler) {
+                    if (event.message.getType() == MidiMessageType::NoteOn) {
+                        track.sampler->noteOn(event.message.getNoteNumber(), event.message.getVelocity(), frameOffset);
+                    } else if (event.message.getType() == MidiMessageType::NoteOff) {
+                        track.sampler->noteOff(event.message.getNoteNumber(), frameOffset);
+                    }
+                } else if (track.synth) {
+                    track.synth->processMidiMessage(event.message, frameOffset);
+                }
+            }
+        }
+    }
+}
+
+void MainWindow::renderTrackAudio(Track& track, AudioBuffer& trackBuffer, size_t numFrames) {
+    if (!(track.synth || track.sampler)) {
+        // No synth - clear waveform buffer
+        for (size_t i = 0; i < numFrames && i < Track::WAVEFORM_BUFFER_SIZE; ++i) {
+            track.addWaveformSample(0.0f);
+        }
+        return;
+    }
+    
+    // A frozen track plays its render; its effect tails are baked in
+    auto frozen = track.frozen->read();
+    auto audioClips = track.audioClips->read();
+    
+    // An idle instrument whose effect tails have died away is skipped outright:
+    // no rendering, effects, metering or mixing until a note or clip wakes it
+    bool producing = false;
+    if (frozen) {
+        producing = isPlaying_ && frozen->covers(playbackSamplePosition_, numFrames);
+    } else if (track.hasDrumKit && track.drumKit) {
+        for (const auto& pad : track.drumKit->pads) {
+            producing = producing || (pad.sampler && pad.sampler->isProducingAudio());
+        }
+    } else if (track.hasSampler && track.sampler) {
+        producing = track.sampler->isProducingAudio();
+    } else if (track.synth) {
+        producing = track.synth->isProducingAudio();
+    }
+    if (isPlaying_ && audioClips) {
+        const int64_t blockEnd = playbackSamplePosition_ + static_cast<int64_t>(numFrames);
+        for (const auto& clip : *audioClips) {
+            producing = producing || (clip && clip->getStartTime() < blockEnd && clip->getEndTime() > playbackSamplePosition_);
+        }
+    }
+    
+    if (producing) {
+        track.idleFrames = 0;
+    } else {
+        double tailSeconds = 0.0;
+        for (const auto& effect : track.effects) {
+            if (effect && effect->isEnabled() && !frozen) {
+                tailSeconds = std::max(tailSeconds, effect->getTailSeconds());
+            }
+        }
+        if (static_cast<double>(track.idleFrames) >= tailSeconds * engine_->getSampleRate()) {
+            track.sleeping = true;
+            track.peakLevel *= 0.95f;
+            return;
+        }
+        track.idleFrames += numFrames;
+    }
+    track.sleeping = false;
+    
+    trackBuffer.clear();
+    
+    // Use appropriate instrument for audio
+    if (frozen) {
+        frozen->read(trackBuffer, playbackSamplePosition_, numFrames);
+    } else if (track.hasDrumKit && track.drumKit) {
+        // Process all drum pads and mix them
+        // Check for solo
+        bool anyPadSolo = false;
+        for (const auto& pad : track.drumKit->pads) {
+            if (pad.solo) { anyPadSolo = true; break; }
+        }
+        
+        // Mix all pads through a stereo scratch buffer
+        AudioBuffer* padBuffer = engine_->getScratchArena().acquire(numFrames);
+        float* padLeft = padBuffer ? padBuffer->getWritePointer(0) : nullptr;
+        float* padRight = padBuffer ? padBuffer->getWritePointer(1) : nullptr;
+        
+        for (auto& pad : track.drumKit->pads) {
+            if (!padBuffer) break;
+            if (pad.muted || (anyPadSolo && !pad.solo)) continue;
+            if (!pad.sampler || pad.samplePath.empty()) continue;
+            
+            // Process pad's sampler
+            padBuffer->clear();
+            pad.sampler->process(padLeft, padRight, numFrames);
+            
+            // Apply pad volume and pan
+            float vol = pad.volume;
+            float panL = (pad.pan <= 0) ? 1.0f : (1.0f - pad.pan);
+            float panR = (pad.pan >= 0) ? 1.0f : (1.0f + pad.pan);
+            
+            trackBuffer.addFrom(0, 0, *padBuffer, 0, 0, numFrames, vol * panL);
+            trackBuffer.addFrom(1, 0, *padBuffer, 1, 0, numFrames, vol * panR);
+        }
+    } else if (track.hasSampler && track.sampler) {
+        float* leftOut = trackBuffer.getWritePointer(0);
+        float* rightOut = trackBuffer.getNumChannels() > 1 ? trackBuffer.getWritePointer(1) : leftOut;
+        track.sampler->process(leftOut, rightOut, numFrames);
+    } else if (track.synth) {
+        track.synth->generateAudio(trackBuffer, numFrames);
+    }
+    
+    if (!frozen) {
+        // Recorded takes play through the track's effects like the instrument does
+        if (isPlaying_ && audioClips && !audioClips->empty()) {
+            mixAudioClips(*audioClips, trackBuffer, numFrames);
+        }
+        
+        // Apply effects chain
+        for (auto& effect : track.effects) {
+            if (effect && effect->isEnabled()) {
+                effect->process(trackBuffer, numFrames);
+            }
+        }
+    }
+    
+    // Capture waveform samples for visualization (use first channel, after effects)
+    // Also calculate peak level for metering
+    if (trackBuffer.getNumChannels() > 0) {
+        const float* trackSamples = trackBuffer.getReadPointer(0);
+        float maxSample = 0.0f;
+        for (size_t i = 0; i < numFrames; ++i) {
+            track.addWaveformSample(trackSamples[i]);
+            float absSample = std::abs(trackSamples[i]);
+            if (absSample > maxSample) maxSample = absSample;
+        }
+        // Smooth peak level (fast attack, slow decay)
+        if (maxSample > track.peakLevel) {
+            track.peakLevel = maxSample;
+        } else {
+            track.peakLevel = track.peakLevel * 0.95f;  // Decay
+        }
+    }
+}
+
 bool MainWindow::initializeMIDI() {
     midiInput_ = std::make_shared<MidiInput>();
     auto midiDevices = MidiInput::enumerateDevices();
@@ -864,15 +942,17 @@ bool MainWindow::initializeMIDI() {
                 for (size_t trackIdx = 0; trackIdx < tracks_.size(); ++trackIdx) {
                     auto& track = tracks_[trackIdx];
                     if (track.isRecording) {
-                        // Route to sampler if track has one, otherwise to synth
-                        if (track.hasSampler && track.sampler) {
+                        // Route to sampler if track has one, otherwise to synth.
+                        // A frozen track's instrument isn't running, so it gets nothing.
+                        const bool live = !track.isFrozen();
+                        if (live && track.hasSampler && track.sampler) {
                             if (msg.getType() == MidiMessageType::NoteOn && msg.getVelocity() > 0) {
                                 track.sampler->noteOn(msg.getNoteNumber(), msg.getVelocity());
                             } else if (msg.getType() == MidiMessageType::NoteOff || 
                                       (msg.getType() == MidiMessageType::NoteOn && msg.getVelocity() == 0)) {
                                 track.sampler->noteOff(msg.getNoteNumber());
                             }
-                        } else if (track.synth) {
+                        } else if (live && track.synth) {
                         track.synth->processMidiMessage(msg);
                         }
                         
@@ -930,6 +1010,15 @@ void MainWindow::shutdown() {
     }
     
     if (engine_) {
+        // Headless/CI runs can collect callback timing with PAN_CALLBACK_STATS=<file.json>
+        if (const char* statsPath = std::getenv("PAN_CALLBACK_STATS")) {
+            std::ofstream statsFile(statsPath);
+            if (statsFile) {
+                statsFile << engine_->getCallbackStats().toJson() << std::endl;
+            } else {
+                std::cerr << "Could not write callback stats to " << statsPath << std::endl;
+            }
+        }
         engine_->stop();
         engine_->shutdown();
         engine_.reset();
@@ -960,6 +1049,14 @@ void MainWindow::run() {
     while (!glfwWindowShouldClose(window) && !shouldQuit_) {
         glfwPollEvents();
         
+        // Free anything the audio thread has handed back
+        if (engine_) {
+            engine_->collectGarbage();
+            updateAudioRecording();
+            updateFrozenTracks();
+        }
+        sampleLoader_.poll();
+        
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -1034,8 +1131,8 @@ void MainWindow::processDroppedFiles() {
                                 double sampleRate = engine_ ? engine_->getSampleRate() : 44100.0;
                                 track.sampler = std::make_shared<Sampler>(sampleRate);
                             }
-                            track.sampler->loadSample(userSamples_[i].path);
-                            markDirty();
+                            loadSampleAsync(track.sampler, userSamples_[i].path);
+                            markDevicesChanged();
                             break;
                         }
                     }
@@ -1374,6 +1471,15 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
     ImGui::Separator();
     ImGui::Spacing();
     
+    // Samples decoding in the background
+    for (const auto& [path, progress] : samplesLoading_) {
+        std::string label = "Loading " + std::filesystem::path(path).filename().string();
+        ImGui::ProgressBar(progress, ImVec2(-1, 0), label.c_str());
+    }
+    if (!samplesLoading_.empty()) {
+        ImGui::Spacing();
+    }
+    
     // Basic Waves section
     if (ImGui::CollapsingHeader("Sounds", ImGuiTreeNodeFlags_DefaultOpen)) {
         const char* waveNames[] = { "Sine", "Square", "Sawtooth", "Triangle" };
@@ -1580,7 +1686,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                 for (auto& pad : track.drumKit->pads) {
                     pad.sampler = std::make_shared<Sampler>(sampleRate);
                 }
-                markDirty();
+                markDevicesChanged();
             }
         }
         if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1614,7 +1720,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                     }
                     // Populate kit with samples if available
                     loadDrumKitPreset(*track.drumKit, kitPresets[i]);
-                    markDirty();
+                    markDevicesChanged();
                 }
             }
             if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1646,7 +1752,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         newReverb->loadPreset(static_cast<Reverb::Preset>(i));
                         tracks_[selectedTrackIndex_].effects.push_back(newReverb);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 // Drag drop source for preset
@@ -1673,7 +1779,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         newChorus->loadPreset(static_cast<Chorus::Preset>(i));
                         tracks_[selectedTrackIndex_].effects.push_back(newChorus);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1699,7 +1805,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         newDistortion->loadPreset(static_cast<Distortion::Preset>(i));
                         tracks_[selectedTrackIndex_].effects.push_back(newDistortion);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1729,7 +1835,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         else { fx->setDepth(-36.0f); fx->setAttackMs(2.0f); fx->setReleaseMs(300.0f); }
                         tracks_[selectedTrackIndex_].effects.push_back(fx);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1758,7 +1864,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         else { fx->setWowDepthMs(5.5f); fx->setFlutterDepthMs(1.2f); }
                         tracks_[selectedTrackIndex_].effects.push_back(fx);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1787,7 +1893,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         else fx->setIntervalMs(100.0f);
                         tracks_[selectedTrackIndex_].effects.push_back(fx);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1816,7 +1922,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         else { fx->setBits(4); fx->setNoise(0.1f); }
                         tracks_[selectedTrackIndex_].effects.push_back(fx);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1845,7 +1951,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         else { fx->setDecay(0.9f); fx->setMix(0.3f); }
                         tracks_[selectedTrackIndex_].effects.push_back(fx);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -1871,7 +1977,7 @@ void MainWindow::renderSampleLibrary(ImGuiID target_dock_id) {
                         newEQ8->loadPreset(static_cast<EQ8::Preset>(i));
                         tracks_[selectedTrackIndex_].effects.push_back(newEQ8);
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
                 if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
@@ -2332,7 +2438,7 @@ void MainWindow::renderComponents(ImGuiID target_dock_id) {
                             if (newEffect && selectedTrackIndex_ < tracks_.size()) {
                                 tracks_[selectedTrackIndex_].effects.push_back(newEffect);
                                 g_switchToEffectsTab = true;
-                                markDirty();
+                                markDevicesChanged();
                                 effectsScrollY_ = 9999.0f;
                             }
                         }
@@ -2995,8 +3101,8 @@ void MainWindow::renderSamplerPanel(size_t trackIndex) {
                         double sampleRate = engine_ ? engine_->getSampleRate() : 44100.0;
                         track.sampler = std::make_shared<Sampler>(sampleRate);
                     }
-                    track.sampler->loadSample(userSamples_[sampleIdx].path);
-                    markDirty();
+                    loadSampleAsync(track.sampler, userSamples_[sampleIdx].path);
+                    markDevicesChanged();
                 }
             }
         }
@@ -3111,6 +3217,22 @@ void MainWindow::renderSamplerPanel(size_t trackIndex) {
     ImGui::SetCursorScreenPos(snapMin);
     ImGui::InvisibleButton("##snapBtn", ImVec2(toggleW, btnH));
     if (ImGui::IsItemClicked()) { params.snapEnabled = !params.snapEnabled; markDirty(); }
+    // Interpolation quality, right aligned: click to cycle LIN -> CUBIC -> SINC
+    const char* qualityNames[] = {"LIN", "CUBIC", "SINC"};
+    int qualityIdx = static_cast<int>(params.interpolation);
+    ImVec2 qualMin(contentX + contentW - toggleW, toggleY);
+    ImVec2 qualMax(contentX + contentW, toggleY + btnH);
+    drawList->AddRectFilled(qualMin, qualMax, buttonOff, 2.0f);
+    drawList->AddRect(qualMin, qualMax, IM_COL32(80, 80, 85, 255), 2.0f);
+    ImVec2 qualTxtSz = ImGui::CalcTextSize(qualityNames[qualityIdx]);
+    drawList->AddText(ImVec2(qualMin.x + (toggleW - qualTxtSz.x) / 2, toggleY + 1), textDim, qualityNames[qualityIdx]);
+    ImGui::SetCursorScreenPos(qualMin);
+    ImGui::InvisibleButton("##qualityBtn", ImVec2(toggleW, btnH));
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Pitch-shift quality (higher costs more CPU)");
+    if (ImGui::IsItemClicked()) {
+        params.interpolation = static_cast<InterpolationQuality>((qualityIdx + 1) % 3);
+        markDirty();
+    }
     
     // Slice mode dropdown for beat slicing
     if (params.mode == SamplerMode::Slice) {
@@ -3212,7 +3334,7 @@ void MainWindow::renderDrumRackPanel(size_t trackIndex) {
                 if (!pad.sampler) pad.sampler = std::make_shared<Sampler>(sampleRate);
             }
             loadDrumKitPreset(kit, kitNames[presetIdx]);
-            markDirty();
+            markDevicesChanged();
         }
         ImGui::EndDragDropTarget();
     }
@@ -3311,7 +3433,7 @@ void MainWindow::renderDrumRackPanel(size_t trackIndex) {
                             pad.sampleName = userSamples_[sampleIdx].name;
                             pad.waveform = userSamples_[sampleIdx].waveformDisplay;
                             if (pad.sampler) {
-                                pad.sampler->loadSample(pad.samplePath);
+                                loadSampleAsync(pad.sampler, pad.samplePath);
                             }
                             markDirty();
                         }
@@ -3521,7 +3643,7 @@ void MainWindow::renderEffectBox(size_t trackIndex, size_t effectIndex, std::sha
     
     if (closeHovered && ImGui::IsMouseClicked(0)) {
         tracks_[trackIndex].effects.erase(tracks_[trackIndex].effects.begin() + effectIndex);
-        markDirty();
+        markDevicesChanged();
         ImGui::EndChild();
         ImGui::PopStyleVar(2);
         ImGui::PopStyleColor(2);
@@ -4143,7 +4265,7 @@ void MainWindow::renderEffectBox(size_t trackIndex, size_t effectIndex, std::sha
                 if (newEffect && effectIndex < tracks_[trackIndex].effects.size()) {
                     // REPLACE the effect at this index
                     tracks_[trackIndex].effects[effectIndex] = newEffect;
-                    markDirty();
+                    markDevicesChanged();
                 }
             }
         }
@@ -4630,6 +4752,14 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
         }
         
         if (ImGui::BeginPopup("track_context_menu")) {
+            if (tracks_[i].isFrozen()) {
+                if (ImGui::MenuItem("Unfreeze Track")) {
+                    unfreezeTrack(i);
+                }
+            } else if (ImGui::MenuItem("Freeze Track", nullptr, false, tracks_[i].synth || tracks_[i].sampler)) {
+                freezeTrack(i);
+            }
+            
             // Rename option
             if (ImGui::MenuItem("Rename Track")) {
                 renamingTrackIndex_ = static_cast<int>(i);
@@ -4850,7 +4980,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                         tracks_[i].effects.push_back(newEffect);
                         selectedTrackIndex_ = i;
                         g_switchToEffectsTab = true;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
             }
@@ -4866,7 +4996,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                 double sampleRate = engine_ ? engine_->getSampleRate() : 44100.0;
                 tracks_[i].sampler = std::make_shared<Sampler>(sampleRate);
                 selectedTrackIndex_ = i;
-                markDirty();
+                markDevicesChanged();
             }
             // Accept Drum Rack drops on track headers
             if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("DRUMRACK")) {
@@ -4881,7 +5011,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                     pad.sampler = std::make_shared<Sampler>(sampleRate);
                 }
                 selectedTrackIndex_ = i;
-                markDirty();
+                markDevicesChanged();
             }
             // Accept Drum Kit preset drops
             if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("DRUMKIT_PRESET")) {
@@ -4900,7 +5030,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                 }
                 loadDrumKitPreset(*tracks_[i].drumKit, kitNames[presetIdx]);
                 selectedTrackIndex_ = i;
-                markDirty();
+                markDevicesChanged();
             }
             // Accept Sample drops on track headers (load sample into Sampler)
             if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SAMPLE")) {
@@ -4915,9 +5045,9 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                         // Create sampler and load sample
                         double sampleRate = engine_ ? engine_->getSampleRate() : 44100.0;
                         tracks_[i].sampler = std::make_shared<Sampler>(sampleRate);
-                        tracks_[i].sampler->loadSample(userSamples_[sampleIdx].path);
+                        loadSampleAsync(tracks_[i].sampler, userSamples_[sampleIdx].path);
                         selectedTrackIndex_ = i;
-                        markDirty();
+                        markDevicesChanged();
                     }
                 }
             }
@@ -5002,9 +5132,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
         newTrack.synth = std::make_shared<Synthesizer>(engine_->getSampleRate());
         newTrack.synth->setVolume(0.5f);
         newTrack.synth->setOscillators(newTrack.oscillators);
-        tracks_.push_back(std::move(newTrack));
-        selectedTrackIndex_ = tracks_.size() - 1;
-        markDirty();
+        addTrack(std::move(newTrack));
     }
     
     // Drop target for + Add Track button (accept instruments, sampler, samples)
@@ -5021,9 +5149,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
             newTrack.oscillators.clear();
             newTrack.instrumentName = "Sampler";
             newTrack.sampler = std::make_shared<Sampler>(engine_->getSampleRate());
-            tracks_.push_back(std::move(newTrack));
-            selectedTrackIndex_ = tracks_.size() - 1;
-            markDirty();
+            addTrack(std::move(newTrack));
         }
         // Accept Drum Rack
         if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("DRUMRACK")) {
@@ -5038,9 +5164,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
             for (auto& pad : newTrack.drumKit->pads) {
                 pad.sampler = std::make_shared<Sampler>(engine_->getSampleRate());
             }
-            tracks_.push_back(std::move(newTrack));
-            selectedTrackIndex_ = tracks_.size() - 1;
-            markDirty();
+            addTrack(std::move(newTrack));
         }
         // Accept Drum Kit preset
         if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("DRUMKIT_PRESET")) {
@@ -5059,9 +5183,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                 pad.sampler = std::make_shared<Sampler>(engine_->getSampleRate());
             }
             loadDrumKitPreset(*newTrack.drumKit, kitNames[presetIdx]);
-            tracks_.push_back(std::move(newTrack));
-            selectedTrackIndex_ = tracks_.size() - 1;
-            markDirty();
+            addTrack(std::move(newTrack));
         }
         // Accept Sample - create sampler with sample loaded
         if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SAMPLE")) {
@@ -5079,10 +5201,8 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                     newTrack.instrumentName = "Sampler: " + userSamples_[sampleIdx].name;
                     // Create sampler instance and load sample
                     newTrack.sampler = std::make_shared<Sampler>(engine_->getSampleRate());
-                    newTrack.sampler->loadSample(userSamples_[sampleIdx].path);
-                    tracks_.push_back(std::move(newTrack));
-                    selectedTrackIndex_ = tracks_.size() - 1;
-                    markDirty();
+                    loadSampleAsync(newTrack.sampler, userSamples_[sampleIdx].path);
+                    addTrack(std::move(newTrack));
                 }
             }
         }
@@ -5098,9 +5218,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                 newTrack.synth->setOscillators(newTrack.oscillators);
                 const char* waveNames[] = { "Sine", "Square", "Sawtooth", "Triangle" };
                 newTrack.instrumentName = waveNames[static_cast<int>(wave)];
-                tracks_.push_back(std::move(newTrack));
-                selectedTrackIndex_ = tracks_.size() - 1;
-                markDirty();
+                addTrack(std::move(newTrack));
             }
         }
         // Accept Instrument presets
@@ -5116,9 +5234,7 @@ void MainWindow::renderTracks(ImGuiID target_dock_id) {
                     newTrack.synth->setOscillators(newTrack.oscillators);
                     newTrack.synth->setEnvelope(instrumentPresets_[presetIdx].envelope);
                     newTrack.instrumentName = instrumentPresets_[presetIdx].name;
-                    tracks_.push_back(std::move(newTrack));
-                    selectedTrackIndex_ = tracks_.size() - 1;
-                    markDirty();
+                    addTrack(std::move(newTrack));
                 }
             }
         }
@@ -5243,6 +5359,19 @@ void MainWindow::renderMenuBar() {
                 showSaveAsDialog = true;
             }
             ImGui::Separator();
+            if (ImGui::MenuItem("Export Audio")) {
+                std::filesystem::path dir = currentProjectPath_.empty()
+                    ? std::filesystem::current_path()
+                    : std::filesystem::path(currentProjectPath_).parent_path();
+                bounceArrangement((dir / "bounce.wav").string(), false);
+            }
+            if (ImGui::MenuItem("Export Stems")) {
+                std::filesystem::path dir = currentProjectPath_.empty()
+                    ? std::filesystem::current_path()
+                    : std::filesystem::path(currentProjectPath_).parent_path();
+                bounceArrangement((dir / "stem.wav").string(), true);
+            }
+            ImGui::Separator();
             if (ImGui::MenuItem("Quit", "Ctrl+Q")) {
                 if (hasUnsavedChanges_) {
                     showUnsavedDialog = true;
@@ -5255,6 +5384,7 @@ void MainWindow::renderMenuBar() {
         }
         if (ImGui::BeginMenu("Options")) {
             ImGui::MenuItem("Preferences", nullptr, false, false);
+            ImGui::MenuItem("High Quality Renders", nullptr, &highQualityRenders_);
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
@@ -6180,6 +6310,15 @@ void MainWindow::renderTransportControls() {
     }
     
     ImGui::Dummy(ImVec2(masterMeterWidth, masterMeterHeight));
+    if (ImGui::IsItemHovered() && engine_) {
+        CallbackStatsSnapshot stats = engine_->getCallbackStats();
+        ImGui::SetTooltip("DSP load: %.0f%% (peak %.0f%%)\nCallback: %.2f ms avg, %.2f ms max\n"
+                          "Missed deadlines: %llu\nXruns: %llu",
+                          stats.load * 100.0, stats.peakLoad * 100.0,
+                          stats.averageDurationSeconds * 1e3, stats.maxDurationSeconds * 1e3,
+                          static_cast<unsigned long long>(stats.deadlineMisses),
+                          static_cast<unsigned long long>(stats.getXrunCount()));
+    }
     
     ImGui::End();
 #endif
@@ -6920,6 +7059,11 @@ void MainWindow::markDirty() {
     hasUnsavedChanges_ = true;
 }
 
+void MainWindow::markDevicesChanged() {
+    seedTracks(false);
+    markDirty();
+}
+
 bool MainWindow::checkUnsavedChanges() {
     return !hasUnsavedChanges_;
 }
@@ -6937,6 +7081,9 @@ void MainWindow::newProject() {
     
     selectedTrackIndex_ = 0;
     bpm_ = 120.0f;
+    projectSeed_ = DEFAULT_PROJECT_SEED;
+    nextTrackId_ = 1;
+    seedTracks(true);
     timelinePosition_ = 0.0f;
     timelineScrollX_ = 0.0f;
     isPlaying_ = false;
@@ -6959,6 +7106,7 @@ std::string MainWindow::serializeProject() const {
     //   - For each oscillator: waveform,freq_mult,amplitude
     //   - Number of clips
     //   - For each clip: ... (simplified for now, just save count)
+    // Last lines: random seed, then the track ids (both absent in older projects)
     
     data += std::to_string(bpm_) + "\n";
     data += std::to_string(tracks_.size()) + "\n";
@@ -6973,6 +7121,11 @@ std::string MainWindow::serializeProject() const {
         // For now, don't serialize clips (TODO: implement MIDI clip serialization)
         data += "0\n";  // Number of clips
     }
+    data += std::to_string(projectSeed_) + "\n";
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        data += (i > 0 ? " " : "") + std::to_string(tracks_[i].id);
+    }
+    data += "\n";
     
     return data;
 }
@@ -6990,6 +7143,10 @@ bool MainWindow::deserializeProject(const std::string& data) {
         std::getline(stream, line);
         size_t numTracks = std::stoul(line);
         
+        if (!reserveTracks(numTracks)) {
+            std::cerr << "Project has " << numTracks << " tracks but only " << engine_->getMaxTrackCount()
+                      << " can be mixed; the rest will be silent" << std::endl;
+        }
         tracks_.clear();
         tracks_.resize(numTracks);
         
@@ -7025,6 +7182,22 @@ bool MainWindow::deserializeProject(const std::string& data) {
             std::getline(stream, line);
         }
         
+        projectSeed_ = DEFAULT_PROJECT_SEED;
+        if (std::getline(stream, line) && !line.empty()) {
+            projectSeed_ = static_cast<uint32_t>(std::stoul(line));
+        }
+        // Saved ids keep the noise as it was; otherwise number the tracks in order
+        nextTrackId_ = 1;
+        if (std::getline(stream, line)) {
+            std::istringstream ids(line);
+            uint32_t id = 0;
+            for (size_t i = 0; i < tracks_.size() && ids >> id; ++i) {
+                tracks_[i].id = id;
+                nextTrackId_ = std::max(nextTrackId_, id + 1);
+            }
+        }
+        seedTracks(true);
+        
         selectedTrackIndex_ = 0;
         hasUnsavedChanges_ = false;
         return true;
@@ -7061,6 +7234,475 @@ bool MainWindow::openProject() {
     return false;
 }
 
+// Where a track's material ends: its latest MIDI event or the end of its last
+// audio clip. Clip events aren't kept sorted, so every event is checked.
+static int64_t getTrackEndSample(const Track& track) {
+    int64_t endSample = 0;
+    for (const auto& clip : track.clips) {
+        if (!clip) continue;
+        for (const auto& event : clip->getEvents()) {
+            endSample = std::max(endSample, clip->getStartTime() + event.timestamp);
+        }
+    }
+    if (auto audioClips = track.audioClips->read()) {
+        for (const auto& clip : *audioClips) {
+            if (clip) {
+                endSample = std::max(endSample, clip->getEndTime());
+            }
+        }
+    }
+    return endSample;
+}
+
+bool MainWindow::bounceArrangement(const std::string& path, bool stems) {
+    if (!engine_ || tracks_.empty()) {
+        return false;
+    }
+    
+    // Arrangement ends with the last track; leave two seconds for release and effect tails
+    double sampleRate = engine_->getSampleRate();
+    int64_t endSample = 0;
+    for (const auto& track : tracks_) {
+        endSample = std::max(endSample, getTrackEndSample(track));
+    }
+    if (endSample <= 0) {
+        std::cerr << "Bounce: arrangement is empty" << std::endl;
+        return false;
+    }
+    size_t totalFrames = static_cast<size_t>(endSample) + static_cast<size_t>(sampleRate * 2.0);
+    
+    bool wasRunning = engine_->isRunning();
+    if (wasRunning) {
+        engine_->stop();
+    }
+    
+    // Save transport state; the bounce always plays straight through from zero
+    bool savedPlaying = isPlaying_;
+    bool savedLoop = loopEnabled_;
+    bool savedClick = clickWhilePlaying_;
+    int64_t savedPosition = playbackSamplePosition_;
+    std::vector<bool> savedSolo;
+    for (const auto& track : tracks_) {
+        savedSolo.push_back(track.isSolo);
+    }
+    loopEnabled_ = false;
+    clickWhilePlaying_ = false;
+    isCountingIn_ = false;
+    setOfflineRendering(true);
+    
+    auto resetInstruments = [this]() {
+        for (auto& track : tracks_) {
+            if (track.synth) track.synth->allNotesOff();
+            if (track.sampler) track.sampler->allNotesOff();
+            if (track.drumKit) {
+                for (auto& pad : track.drumKit->pads) {
+                    if (pad.sampler) pad.sampler->allNotesOff();
+                }
+            }
+            for (auto& effect : track.effects) {
+                if (effect) effect->reset();
+            }
+        }
+        seedTracks(true);
+    };
+    
+    auto renderPass = [&](const std::string& file) {
+        resetInstruments();
+        playbackSamplePosition_ = 0;
+        isPlaying_ = true;
+        std::cout << "Bouncing to " << file << std::endl;
+        return engine_->renderOfflineToFile(file, totalFrames, WavWriter::Format::Float32,
+            [](const OfflineRenderProgress& progress) {
+                std::cout << "  " << static_cast<int>(progress.getFraction() * 100.0f) << "% ("
+                          << progress.realtimeFactor << "x real time)" << std::endl;
+                return true;
+            });
+    };
+    
+    bool ok = true;
+    if (!stems) {
+        ok = renderPass(path);
+    } else {
+        std::filesystem::path base(path);
+        for (size_t i = 0; i < tracks_.size() && ok; ++i) {
+            for (size_t j = 0; j < tracks_.size(); ++j) {
+                tracks_[j].isSolo = (i == j);
+            }
+            std::string trackName = tracks_[i].name.empty() ? "Track" : tracks_[i].name;
+            std::replace_if(trackName.begin(), trackName.end(),
+                            [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); }, '_');
+            std::filesystem::path stemPath = base.parent_path() /
+                (base.stem().string() + "_" + std::to_string(i + 1) + "_" + trackName + ".wav");
+            ok = renderPass(stemPath.string());
+        }
+    }
+    
+    // Restore transport and solo state
+    for (size_t i = 0; i < tracks_.size() && i < savedSolo.size(); ++i) {
+        tracks_[i].isSolo = savedSolo[i];
+    }
+    resetInstruments();
+    setOfflineRendering(false);
+    isPlaying_ = savedPlaying;
+    loopEnabled_ = savedLoop;
+    clickWhilePlaying_ = savedClick;
+    playbackSamplePosition_ = savedPosition;
+    
+    if (wasRunning) {
+        engine_->start();
+    }
+    return ok;
+}
+
+bool MainWindow::reserveTracks(size_t count) {
+    if (count <= engine_->getMaxTrackCount()) {
+        return true;
+    }
+    // The scratch arena is sized when the stream starts, so growing it means a restart
+    const size_t maxTracks = std::max(count, engine_->getMaxTrackCount() * 2);
+    bool wasRunning = engine_->isRunning();
+    if (wasRunning) {
+        engine_->stop();
+    }
+    bool ok = engine_->setMaxTrackCount(maxTracks);
+    if (ok) {
+        trackRenderBuffers_.reserve(maxTracks);
+        std::cout << "Raised the track limit to " << maxTracks << std::endl;
+    }
+    if (wasRunning) {
+        engine_->start();
+    }
+    return ok;
+}
+
+bool MainWindow::addTrack(Track track) {
+    if (!reserveTracks(tracks_.size() + 1)) {
+        std::cerr << "Cannot add a track: the mixer is limited to " << engine_->getMaxTrackCount()
+                  << " tracks right now" << std::endl;
+        return false;
+    }
+    tracks_.push_back(std::move(track));
+    seedTracks(false);
+    selectedTrackIndex_ = tracks_.size() - 1;
+    markDirty();
+    return true;
+}
+
+void MainWindow::loadSampleAsync(const std::shared_ptr<Sampler>& sampler, const std::string& path) {
+    if (!sampler) return;
+    samplesLoading_[path] = 0.0f;
+    sampleLoader_.load(sampler, path,
+        [this, path](bool) { samplesLoading_.erase(path); },
+        [this, path](float fraction) {
+            auto it = samplesLoading_.find(path);
+            if (it != samplesLoading_.end()) it->second = fraction;
+        });
+}
+
+void MainWindow::onEngineSampleRateChanged(double sampleRate) {
+    // Samples were converted for the old rate; they play resampled until the new conversions land
+    std::cout << "Engine sample rate changed to " << sampleRate << " Hz, converting samples" << std::endl;
+    auto follow = [&](const std::shared_ptr<Sampler>& sampler) {
+        if (!sampler) return;
+        sampler->setEngineSampleRate(sampleRate);
+        if (const Sample* sample = sampler->getSample()) {
+            loadSampleAsync(sampler, sample->filePath);
+        }
+    };
+    for (auto& track : tracks_) {
+        follow(track.sampler);
+        if (track.drumKit) {
+            for (auto& pad : track.drumKit->pads) {
+                follow(pad.sampler);
+            }
+        }
+    }
+}
+
+void MainWindow::setOfflineRendering(bool offline) {
+    // Samples still decoding would be missing from the render
+    if (offline) {
+        sampleLoader_.waitUntilIdle();
+    }
+    const InterpolationQuality quality = highQualityRenders_ ? InterpolationQuality::Sinc : InterpolationQuality::Linear;
+    for (auto& track : tracks_) {
+        if (track.sampler) {
+            track.sampler->setOfflineRendering(offline);
+            track.sampler->setOfflineInterpolation(quality);
+        }
+        if (track.drumKit) {
+            for (auto& pad : track.drumKit->pads) {
+                if (!pad.sampler) continue;
+                pad.sampler->setOfflineRendering(offline);
+                pad.sampler->setOfflineInterpolation(quality);
+            }
+        }
+    }
+}
+
+void MainWindow::seedTracks(bool restart) {
+    for (auto& track : tracks_) {
+        seedTrack(track, restart);
+    }
+}
+
+void MainWindow::seedTrack(Track& track, bool restart) {
+    if (track.id == 0) {
+        track.id = nextTrackId_++;
+    }
+    auto seedFor = [&](uint32_t slot) { return NoiseSeeds::forSlot(projectSeed_, track.id, slot); };
+    if (track.synth) NoiseSeeds::assign(*track.synth, seedFor(NoiseSeeds::INSTRUMENT_SLOT), restart);
+    if (track.sampler) NoiseSeeds::assign(*track.sampler, seedFor(NoiseSeeds::INSTRUMENT_SLOT), restart);
+    if (track.drumKit) {
+        for (size_t p = 0; p < track.drumKit->pads.size(); ++p) {
+            auto& pad = track.drumKit->pads[p];
+            if (pad.sampler) NoiseSeeds::assign(*pad.sampler, seedFor(NoiseSeeds::padSlot(p)), restart);
+        }
+    }
+    for (size_t e = 0; e < track.effects.size(); ++e) {
+        if (track.effects[e]) NoiseSeeds::assign(*track.effects[e], seedFor(NoiseSeeds::effectSlot(e)), restart);
+    }
+}
+
+uint64_t MainWindow::fingerprintTrack(size_t index) const {
+    // Everything that goes into the render; volume, pan, mute and solo are applied after it
+    const Track& track = tracks_[index];
+    ParameterHash hash;
+    hash.add(engine_ ? engine_->getSampleRate() : 0.0).add(projectSeed_).add(highQualityRenders_).add(track.id);
+    
+    hash.add(track.hasDrumKit).add(track.hasSampler);
+    if (track.hasDrumKit && track.drumKit) {
+        for (const auto& pad : track.drumKit->pads) {
+            hash.add(pad.samplePath).add(pad.volume).add(pad.pan).add(pad.muted).add(pad.solo).add(pad.midiNote);
+            if (pad.sampler) pad.sampler->hashParameters(hash);
+        }
+    } else if (track.hasSampler && track.sampler) {
+        track.sampler->hashParameters(hash);
+    } else if (track.synth) {
+        track.synth->hashParameters(hash);
+    }
+    
+    hash.add(track.clips.size());
+    for (const auto& clip : track.clips) {
+        if (!clip) continue;
+        hash.add(clip->getStartTime()).add(clip->getEvents().size());
+        for (const auto& event : clip->getEvents()) {
+            const MidiMessage& msg = event.message;
+            hash.add(event.timestamp).add(msg.getType()).add(msg.getChannel()).add(msg.getData1()).add(msg.getData2());
+        }
+    }
+    auto audioClips = track.audioClips->read();
+    hash.add(audioClips ? audioClips->size() : 0);
+    if (audioClips) {
+        for (const auto& clip : *audioClips) {
+            if (!clip) continue;
+            hash.add(clip->getContentId()).add(clip->getStartTime()).add(clip->getEndTime()).add(clip->getGain());
+        }
+    }
+    
+    hash.add(track.effects.size());
+    for (const auto& effect : track.effects) {
+        if (!effect) continue;
+        hash.add(effect->getName()).add(effect->isEnabled());
+        effect->hashParameters(hash);
+    }
+    return hash.get();
+}
+
+bool MainWindow::freezeTrack(size_t index) {
+    if (!engine_ || index >= tracks_.size()) {
+        return false;
+    }
+    Track& track = tracks_[index];
+    if (!(track.synth || track.sampler)) {
+        return false;
+    }
+    
+    // Render from the top of the arrangement to the track's last clip, plus its effect tails
+    double sampleRate = engine_->getSampleRate();
+    int64_t endSample = getTrackEndSample(track);
+    if (endSample <= 0) {
+        std::cerr << "Freeze: track has no clips" << std::endl;
+        return false;
+    }
+    double tailSeconds = 2.0;
+    for (const auto& effect : track.effects) {
+        if (effect && effect->isEnabled() && std::isfinite(effect->getTailSeconds())) {
+            tailSeconds = std::max(tailSeconds, effect->getTailSeconds());
+        }
+    }
+    tailSeconds = std::min(tailSeconds, 30.0);
+    size_t totalFrames = static_cast<size_t>(endSample) + static_cast<size_t>(sampleRate * tailSeconds);
+    
+    bool wasRunning = engine_->isRunning();
+    if (wasRunning) {
+        engine_->stop();
+    }
+    track.frozen->publish(nullptr);
+    
+    bool savedPlaying = isPlaying_;
+    int64_t savedPosition = playbackSamplePosition_;
+    auto resetTrack = [&track]() {
+        if (track.synth) track.synth->allNotesOff();
+        if (track.sampler) track.sampler->allNotesOff();
+        if (track.drumKit) {
+            for (auto& pad : track.drumKit->pads) {
+                if (pad.sampler) pad.sampler->allNotesOff();
+            }
+        }
+        for (auto& effect : track.effects) {
+            if (effect) effect->reset();
+        }
+        track.idleFrames = 0;
+        track.sleeping = false;
+    };
+    resetTrack();
+    seedTrack(track, true);  // Only this track; the others keep their running streams
+    setOfflineRendering(true);
+    isPlaying_ = true;
+    
+    // Same block loop as playback, minus the mixer. Drum pads borrow from the
+    // scratch arena, which nothing else is using while the engine is stopped.
+    const size_t blockSize = 512;
+    AudioBuffer render(2, totalFrames);
+    AudioBuffer block(2, blockSize);
+    for (size_t pos = 0; pos < totalFrames; pos += blockSize) {
+        size_t n = std::min(blockSize, totalFrames - pos);
+        engine_->getScratchArena().reset();
+        block.clear();
+        playbackSamplePosition_ = static_cast<int64_t>(pos);
+        if (track.synth) {
+            dispatchClipEvents(track, playbackSamplePosition_, n);
+        }
+        renderTrackAudio(track, block, n);
+        render.copyFrom(0, pos, block, 0, 0, n);
+        render.copyFrom(1, pos, block, 1, 0, n);
+    }
+    
+    resetTrack();
+    setOfflineRendering(false);
+    isPlaying_ = savedPlaying;
+    playbackSamplePosition_ = savedPosition;
+    
+    std::cout << "Froze track " << (index + 1) << ": " << (static_cast<double>(totalFrames) / sampleRate)
+              << " s, " << (totalFrames * 2 * sizeof(float) / (1024 * 1024)) << " MB" << std::endl;
+    track.frozen->publish(std::make_unique<FrozenAudio>(std::move(render), fingerprintTrack(index)));
+    
+    if (wasRunning) {
+        engine_->start();
+    }
+    return true;
+}
+
+void MainWindow::unfreezeTrack(size_t index) {
+    if (index >= tracks_.size()) {
+        return;
+    }
+    // The instrument was left reset by freezeTrack, so it picks up from silence
+    tracks_[index].frozen->publish(nullptr);
+    tracks_[index].idleFrames = 0;
+}
+
+void MainWindow::updateFrozenTracks() {
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        auto& track = tracks_[i];
+        bool stale = false;
+        {
+            auto frozen = track.frozen->read();
+            stale = frozen && frozen->getFingerprint() != fingerprintTrack(i);
+        }
+        if (stale) {
+            std::cout << "Track " << (i + 1) << " changed; unfreezing" << std::endl;
+            unfreezeTrack(i);
+        }
+        track.frozen->collectGarbage();
+    }
+}
+
+void MainWindow::mixAudioClips(const Track::AudioClipList& clips, AudioBuffer& trackBuffer, size_t numFrames) {
+    const int64_t blockStart = playbackSamplePosition_;
+    const int64_t blockEnd = blockStart + static_cast<int64_t>(numFrames);
+    
+    for (const auto& clip : clips) {
+        if (!clip || !clip->hasAudioData()) continue;
+        int64_t start = std::max(blockStart, clip->getStartTime());
+        int64_t end = std::min(blockEnd, clip->getEndTime());
+        if (start >= end) continue;
+        
+        const AudioBuffer& data = *clip->getAudioData();
+        size_t destOffset = static_cast<size_t>(start - blockStart);
+        size_t sourceOffset = static_cast<size_t>(start - clip->getStartTime());
+        size_t length = static_cast<size_t>(end - start);
+        for (size_t ch = 0; ch < trackBuffer.getNumChannels(); ++ch) {
+            // Mono takes go to every channel
+            size_t sourceChannel = std::min(ch, data.getNumChannels() - 1);
+            trackBuffer.addFrom(ch, destOffset, data, sourceChannel, sourceOffset, length, clip->getGain());
+        }
+    }
+}
+
+void MainWindow::updateAudioRecording() {
+    // Free clip lists replaced by earlier takes once the audio thread is done with them
+    for (auto& track : tracks_) {
+        track.audioClips->collectGarbage();
+    }
+    
+    AudioRecorder& recorder = engine_->getRecorder();
+    StreamInfo stream = engine_->getStreamInfo();
+    
+    bool anyArmed = false;
+    for (const auto& track : tracks_) {
+        if (track.isRecording) { anyArmed = true; break; }
+    }
+    bool wantTake = masterRecord_ && isPlaying_ && anyArmed && stream.numInputChannels > 0;
+    if (!wantTake) {
+        audioTakeFailed_ = false;
+    }
+    
+    if (wantTake && !audioTakeActive_ && !audioTakeFailed_) {
+        std::filesystem::create_directories("recordings");
+        AudioRecorder::Options options;
+        options.path = "recordings/take_" + std::to_string(++audioTakeCount_) + ".wav";
+        options.numChannels = stream.numInputChannels;
+        options.sampleRate = stream.sampleRate;
+        if (!recorder.start(options)) {
+            std::cerr << "Could not start audio recording to " << options.path << std::endl;
+            audioTakeFailed_ = true;
+            return;
+        }
+        
+        // What we hear was rendered a round trip earlier than what arrives at the input
+        int64_t latencySamples = static_cast<int64_t>(
+            std::lround((stream.inputLatency + stream.outputLatency) * stream.sampleRate));
+        audioTakeStart_ = playbackSamplePosition_ - latencySamples;
+        audioTakeTracks_.clear();
+        for (size_t i = 0; i < tracks_.size(); ++i) {
+            if (tracks_[i].isRecording) audioTakeTracks_.push_back(i);
+        }
+        audioTakeActive_ = true;
+        std::cout << "Recording audio input to " << options.path << std::endl;
+    } else if (!wantTake && audioTakeActive_) {
+        // The engine may already have stopped the recorder; stop() is then a no-op
+        recorder.stop();
+        audioTakeActive_ = false;
+        
+        std::shared_ptr<AudioBuffer> take = recorder.readTake();
+        if (!take) {
+            return;
+        }
+        std::string name = std::filesystem::path(recorder.getOptions().path).stem().string();
+        for (size_t index : audioTakeTracks_) {
+            if (index >= tracks_.size()) continue;
+            auto clip = std::make_shared<AudioClip>(name);
+            clip->setStartTime(audioTakeStart_);
+            clip->setAudioData(take);
+            tracks_[index].addAudioClip(clip);
+        }
+        std::cout << "Audio take " << name << ": " << take->getNumFrames() << " frames, "
+                  << recorder.getDroppedFrames() << " dropped" << std::endl;
+    }
+}
+
 void MainWindow::generateClickSound(AudioBuffer& buffer, size_t numFrames, bool isAccent) {
     // Generate a simple click sound (short sine wave beep)
     double sampleRate = engine_ ? engine_->getSampleRate() : 44100.0;
@@ -9671,7 +10313,7 @@ bool MainWindow::loadDrumKitPreset(DrumKit& kit, const std::string& presetName)
         pad.samplePath = path;
         pad.sampleName = fs::path(path).filename().string();
         pad.waveform.clear();  // waveform display optional
-        pad.sampler->loadSample(path);
+        loadSampleAsync(pad.sampler, path);
         loadedAny = true;
     }
     
@@ -9787,13 +10429,9 @@ void MainWindow::loadSamplesFromDirectory() {
                     info.path = entry.path().string();
                     info.name = entry.path().stem().string();
                     
-                    // Load waveform preview using a temporary Sampler
-                    Sampler tempSampler(44100.0);
-                    if (tempSampler.loadSample(info.path)) {
-                        const Sample* sample = tempSampler.getSample();
-                        if (sample) {
-                            info.waveformDisplay = sample->waveformDisplay;
-                        }
+                    // Waveform preview; the decoded sample stays pooled for tracks running at its own rate
+                    if (auto sample = SamplePool::get().load(info.path)) {
+                        info.waveformDisplay = sample->waveformDisplay;
                     }
                     
                     userSamples_.push_back(info);
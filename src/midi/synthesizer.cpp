@@ -1,23 +1,23 @@
 #include "pan/midi/synthesizer.h"
+#include "pan/midi/wavetable.h"
+#include "pan/dsp/fast_math.h"
+#include "pan/dsp/simd.h"
 #include <algorithm>
 #include <cmath>
-#include <random>
 
 namespace pan {
 
-// Static random generator for noise waveform
-static std::mt19937 noiseGen(42);
-static std::uniform_real_distribution<float> noiseDist(-1.0f, 1.0f);
-
 Synthesizer::Synthesizer(double sampleRate)
     : sampleRate_(sampleRate)
     , volume_(0.5f)
     , waveform_(Waveform::Sine)
     , voices_(MAX_VOICES)
+    , wavetables_(&WavetableBank::get())
     , releaseTime_(0.3f)
     , sustainPedalDown_(false)
-    , hasPendingMessages_(false)
 {
+    voiceAllocator_.setPolyphony(DEFAULT_POLYPHONY);
+    
     // Initialize with default envelope
     envelope_.ampEnvelope = ADSREnvelope(0.01f, 0.1f, 0.7f, 0.3f);
     
@@ -31,6 +31,41 @@ void Synthesizer::setVolume(float volume) {
 
 Synthesizer::~Synthesizer() = default;
 
+void Synthesizer::applyPendingSeed() {
+    uint32_t seed = 0;
+    if (pendingSeed_.take(seed)) {
+        seed_ = seed;
+        notesStarted_ = 0;
+    }
+}
+
+void Synthesizer::hashParameters(ParameterHash& hash) const {
+    hash.add(sampleRate_).add(volume_).add(waveform_).add(bandLimited_).add(controlRate_);
+    hash.add(getPolyphony()).add(getStealPolicy()).add(getSeed());
+    hash.add(oscillators_.size());
+    for (const auto& osc : oscillators_) {
+        hash.add(osc.waveform).add(osc.frequencyMultiplier).add(osc.amplitude).add(osc.detune).add(osc.pan);
+    }
+    
+    auto addADSR = [&hash](const ADSREnvelope& adsr) {
+        hash.add(adsr.attack).add(adsr.decay).add(adsr.sustain).add(adsr.release);
+    };
+    auto addLFO = [&hash](const LFO& lfo) {
+        hash.add(lfo.enabled).add(lfo.rate).add(lfo.depth).add(lfo.phaseOffset).add(lfo.target);
+    };
+    const InstrumentEnvelope& env = envelope_;
+    addADSR(env.ampEnvelope);
+    hash.add(env.pitchEnvelope.enabled).add(env.pitchEnvelope.startMultiplier).add(env.pitchEnvelope.decayTime);
+    addLFO(env.lfo1);
+    addLFO(env.lfo2);
+    hash.add(env.filter.enabled).add(env.filter.cutoff).add(env.filter.resonance).add(env.filter.envAmount);
+    addADSR(env.filter.envelope);
+    hash.add(env.saturation.enabled).add(env.saturation.drive).add(env.saturation.mix);
+    hash.add(env.portamento.enabled).add(env.portamento.time).add(env.portamento.legato);
+    hash.add(env.unison.enabled).add(env.unison.voices).add(env.unison.detune).add(env.unison.spread);
+    hash.add(env.masterVolume).add(env.pan);
+}
+
 float Synthesizer::noteToFrequency(uint8_t note) const {
     // A4 (MIDI note 69) = 440 Hz
     double noteValue = static_cast<double>(note);
@@ -39,38 +74,41 @@ float Synthesizer::noteToFrequency(uint8_t note) const {
 }
 
 void Synthesizer::noteOn(uint8_t note, uint8_t velocity) {
-    sustainedNotes_.erase(note);
+    sustainedNotes_.reset(note & 0x7F);
     
     // Check if this note is already playing
-    for (auto& voice : voices_) {
-        if (voice.note == note && (voice.active || voice.envelope > 0.0001f)) {
+    for (size_t v = 0; v < MAX_VOICES; ++v) {
+        Voice& voice = voices_[v];
+        if (voice.note == note && voiceAllocator_.getState(v) == VoiceAllocator::State::Held) {
             voice.active = false;
-            if (voice.envelope > 0.0f) {
-                voice.envPhase = EnvelopePhase::Release;
-                voice.envTime = 0.0f;
-                voice.releaseStartEnvelope = voice.envelope;
-            }
+            releaseVoice(v);
         }
     }
     
-    // Find an available voice or steal the oldest one
-    size_t voiceIndex = 0;
-    float oldestPhase = voices_[0].phase;
-    
-    for (size_t i = 0; i < MAX_VOICES; ++i) {
-        if (!voices_[i].active && voices_[i].envelope <= 0.0001f) {
-            voiceIndex = i;
-            break;
-        }
-        if (voices_[i].phase > oldestPhase) {
-            oldestPhase = voices_[i].phase;
-            voiceIndex = i;
+    // Tell the allocator which voices have gone quiet and how loud the rest are
+    for (size_t v = 0; v < MAX_VOICES; ++v) {
+        if (ampEnv_.stage[v] == EnvelopePhase::Off) {
+            voiceAllocator_.finish(v);
+        } else {
+            voiceAllocator_.setLevel(v, ampEnv_.value[v] * voices_[v].amplitude);
         }
     }
     
-    Voice& voice = voices_[voiceIndex];
+    const VoiceAllocator::Allocation allocation = voiceAllocator_.allocate(note);
+    if (allocation.stolen != VoiceAllocator::NO_VOICE) {
+        // Fade the stolen voice out quickly rather than cutting it off mid-cycle
+        ADSREnvelope fade = envelope_.ampEnvelope;
+        fade.release = STEAL_FADE_SECONDS;
+        voices_[allocation.stolen].active = false;
+        enterStage(ampEnv_, allocation.stolen, EnvelopePhase::Release, fade);
+    }
+    
+    const size_t v = allocation.voice;
+    Voice& voice = voices_[v];
     voice.note = note;
-    voice.phase = 0.0f;
+    voiceLanes_.phase[v] = 0.0f;
+    applyPendingSeed();
+    voiceNoise_[v].setSeed(dsp::Random::derive(seed_, notesStarted_++));
     
     float targetFreq = noteToFrequency(note) / static_cast<float>(sampleRate_);
     voice.targetPhaseIncrement = targetFreq;
@@ -78,21 +116,19 @@ void Synthesizer::noteOn(uint8_t note, uint8_t velocity) {
     // Handle portamento
     if (envelope_.portamento.enabled && lastPhaseIncrement_ > 0.0f) {
         voice.portamentoStartFreq = lastPhaseIncrement_;
-        voice.phaseIncrement = lastPhaseIncrement_;
         voice.basePhaseIncrement = lastPhaseIncrement_;
         voice.portamentoProgress = 0.0f;
     } else {
         voice.basePhaseIncrement = targetFreq;
-        voice.phaseIncrement = targetFreq;
         voice.portamentoProgress = 1.0f;
     }
+    voiceLanes_.phaseIncrement[v] = voice.basePhaseIncrement;
     
     voice.amplitude = (velocity / 127.0f);
-    voice.envelope = 0.0f;  // Start from 0, attack will bring it up
+    voiceLanes_.gain[v] = voice.amplitude;
     voice.active = true;
-    voice.envPhase = EnvelopePhase::Attack;
-    voice.envTime = 0.0f;
-    voice.releaseStartEnvelope = 0.0f;
+    ampEnv_.value[v] = 0.0f;  // Start from 0, attack will bring it up
+    enterStage(ampEnv_, v, EnvelopePhase::Attack, envelope_.ampEnvelope);
     
     // Initialize pitch envelope
     if (envelope_.pitchEnvelope.enabled) {
@@ -104,72 +140,97 @@ void Synthesizer::noteOn(uint8_t note, uint8_t velocity) {
     
     // Initialize filter envelope
     if (envelope_.filter.enabled) {
-        voice.filterEnvelope = 0.0f;
-        voice.filterEnvPhase = EnvelopePhase::Attack;
-        voice.filterEnvTime = 0.0f;
+        filterEnv_.value[v] = 0.0f;
+        enterStage(filterEnv_, v, EnvelopePhase::Attack, envelope_.filter.envelope);
     }
-    voice.filterLowL = voice.filterBandL = 0.0f;
-    voice.filterLowR = voice.filterBandR = 0.0f;
+    voiceLanes_.filterLowL[v] = voiceLanes_.filterBandL[v] = 0.0f;
+    voiceLanes_.filterLowR[v] = voiceLanes_.filterBandR[v] = 0.0f;
+    voiceLanes_.filterCutoff[v] = -1.0f;  // Force a coefficient update
     
     // Initialize LFO phases with random offset for natural variation
     voice.lfo1Phase = envelope_.lfo1.phaseOffset;
     voice.lfo2Phase = envelope_.lfo2.phaseOffset;
     
+    // Start the control-rate ramps from the modulators' initial values
+    updateVoiceModulation(v, 0.0f);
+    
     // Remember this note for portamento
     lastNote_ = note;
     lastPhaseIncrement_ = targetFreq;
 }
 
 void Synthesizer::noteOff(uint8_t note) {
-    for (auto& voice : voices_) {
+    for (size_t v = 0; v < MAX_VOICES; ++v) {
+        Voice& voice = voices_[v];
         if (voice.active && voice.note == note) {
             if (sustainPedalDown_) {
-                sustainedNotes_.insert(note);
+                sustainedNotes_.set(note & 0x7F);
                 voice.active = false;
             } else {
                 voice.active = false;
-                voice.envPhase = EnvelopePhase::Release;
-                voice.envTime = 0.0f;
-                voice.releaseStartEnvelope = voice.envelope;
-                
-                // Also release filter envelope
-                if (envelope_.filter.enabled) {
-                    voice.filterEnvPhase = EnvelopePhase::Release;
-                    voice.filterEnvTime = 0.0f;
-                    voice.filterReleaseStart = voice.filterEnvelope;
-                }
+                releaseVoice(v);
             }
         }
     }
 }
 
+void Synthesizer::releaseVoice(size_t v) {
+    voiceAllocator_.release(v);
+    // Released before its first frame, a voice goes straight to Off
+    enterStage(ampEnv_, v, EnvelopePhase::Release, envelope_.ampEnvelope);
+    if (envelope_.filter.enabled) {
+        enterStage(filterEnv_, v, EnvelopePhase::Release, envelope_.filter.envelope);
+    }
+}
+
 void Synthesizer::allNotesOff() {
-    sustainedNotes_.clear();
+    sustainedNotes_.reset();
     sustainPedalDown_ = false;
-    for (auto& voice : voices_) {
-        voice.active = false;
-        if (voice.envelope > 0.0f) {
-            voice.envPhase = EnvelopePhase::Release;
-            voice.envTime = 0.0f;
-            voice.releaseStartEnvelope = voice.envelope;
+    for (size_t v = 0; v < MAX_VOICES; ++v) {
+        voices_[v].active = false;
+        if (voiceAllocator_.getState(v) == VoiceAllocator::State::Held) {
+            releaseVoice(v);
         }
     }
 }
 
-void Synthesizer::processMidiMessage(const MidiMessage& message) {
-    std::lock_guard<std::mutex> lock(midiMutex_);
-    pendingMessages_.push_back(message);
-    hasPendingMessages_ = true;
+void Synthesizer::processMidiMessage(const MidiMessage& message, uint32_t frameOffset) {
+    midiQueue_.push(MidiEvent(message, frameOffset));
 }
 
 void Synthesizer::processMidiMessages(const std::vector<MidiMessage>& messages) {
-    std::lock_guard<std::mutex> lock(midiMutex_);
-    pendingMessages_.insert(pendingMessages_.end(), messages.begin(), messages.end());
-    hasPendingMessages_ = true;
+    for (const auto& message : messages) {
+        midiQueue_.push(MidiEvent(message));
+    }
 }
 
-void Synthesizer::updateVoice(Voice& voice, size_t numFrames) {
-    // Not used - envelope processing happens per-sample
+bool Synthesizer::isProducingAudio() const {
+    if (!midiQueue_.isEmpty()) {
+        return true;
+    }
+    for (size_t v = 0; v < MAX_VOICES; ++v) {
+        if (ampEnv_.stage[v] != EnvelopePhase::Off) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Synthesizer::handleMidiMessage(const MidiMessage& msg) {
+    if (msg.isNoteOn()) {
+        noteOn(msg.getNoteNumber(), msg.getVelocity());
+    } else if (msg.isNoteOff()) {
+        noteOff(msg.getNoteNumber());
+    } else if (msg.getType() == MidiMessageType::ControlChange) {
+        uint8_t controller = msg.getData1();
+        uint8_t value = msg.getData2();
+        
+        if (controller == 64) {
+            handleSustainPedal(value);
+        } else if (controller == 123) {
+            allNotesOff();
+        }
+    }
 }
 
 void Synthesizer::handleSustainPedal(uint8_t value) {
@@ -179,26 +240,31 @@ void Synthesizer::handleSustainPedal(uint8_t value) {
         sustainPedalDown_ = newState;
         
         if (!sustainPedalDown_) {
-            for (uint8_t note : sustainedNotes_) {
-                for (auto& voice : voices_) {
-                    if (voice.note == note && !voice.active && voice.envelope > 0.0f) {
-                        voice.envPhase = EnvelopePhase::Release;
-                        voice.envTime = 0.0f;
-                        voice.releaseStartEnvelope = voice.envelope;
+            for (uint8_t note = 0; note < 128; ++note) {
+                if (!sustainedNotes_.test(note)) {
+                    continue;
+                }
+                for (size_t v = 0; v < MAX_VOICES; ++v) {
+                    if (voices_[v].note == note && voiceAllocator_.getState(v) == VoiceAllocator::State::Held) {
+                        releaseVoice(v);
                     }
                 }
             }
-            sustainedNotes_.clear();
+            sustainedNotes_.reset();
         }
     }
 }
 
-float Synthesizer::generateWaveform(float phase, Waveform waveform) const {
+float Synthesizer::generateWaveform(float phase, float phaseIncrement, Waveform waveform) const {
     const float twoPi = 2.0f * 3.14159265f;
     
+    if (bandLimited_ && WavetableBank::hasTable(waveform)) {
+        return wavetables_->lookup(waveform, phase, phaseIncrement);
+    }
+    
     switch (waveform) {
         case Waveform::Sine:
-            return std::sin(phase * twoPi);
+            return dsp::sin(phase * twoPi);
             
         case Waveform::Square:
             return (phase < 0.5f) ? 1.0f : -1.0f;
@@ -214,77 +280,71 @@ float Synthesizer::generateWaveform(float phase, Waveform waveform) const {
             }
             
         case Waveform::Noise:
-            return noiseDist(noiseGen);
+            return 0.0f;  // Drawn from the voice's own stream in renderVoiceGroup
             
         default:
-            return std::sin(phase * twoPi);
+            return dsp::sin(phase * twoPi);
     }
 }
 
-float Synthesizer::calculateEnvelope(Voice& voice, float deltaTime) {
-    const auto& env = envelope_.ampEnvelope;
-    
-    switch (voice.envPhase) {
-        case EnvelopePhase::Attack: {
-            voice.envTime += deltaTime;
-            if (env.attack <= 0.001f) {
-                voice.envelope = 1.0f;
-                voice.envPhase = EnvelopePhase::Decay;
-                voice.envTime = 0.0f;
-            } else {
-                // Exponential attack for smoother rise
-                float progress = voice.envTime / env.attack;
-                voice.envelope = 1.0f - std::exp(-5.0f * progress);
-                if (progress >= 1.0f) {
-                    voice.envelope = 1.0f;
-                    voice.envPhase = EnvelopePhase::Decay;
-                    voice.envTime = 0.0f;
-                }
-            }
-            break;
-        }
-        case EnvelopePhase::Decay: {
-            voice.envTime += deltaTime;
-            if (env.decay <= 0.001f) {
-                voice.envelope = env.sustain;
-                voice.envPhase = EnvelopePhase::Sustain;
-            } else {
-                float progress = voice.envTime / env.decay;
-                // Exponential decay from 1.0 to sustain level
-                voice.envelope = env.sustain + (1.0f - env.sustain) * std::exp(-5.0f * progress);
-                if (progress >= 1.0f) {
-                    voice.envelope = env.sustain;
-                    voice.envPhase = EnvelopePhase::Sustain;
-                }
-            }
-            break;
-        }
-        case EnvelopePhase::Sustain:
-            voice.envelope = env.sustain;
-            break;
-            
-        case EnvelopePhase::Release: {
-            voice.envTime += deltaTime;
-            if (env.release <= 0.001f) {
-                voice.envelope = 0.0f;
-                voice.envPhase = EnvelopePhase::Off;
-            } else {
-                float progress = voice.envTime / env.release;
-                // Exponential release
-                voice.envelope = voice.releaseStartEnvelope * std::exp(-5.0f * progress);
-                if (voice.envelope < 0.0001f || progress >= 1.0f) {
-                    voice.envelope = 0.0f;
-                    voice.envPhase = EnvelopePhase::Off;
-                }
-            }
-            break;
-        }
-        case EnvelopePhase::Off:
-            voice.envelope = 0.0f;
-            break;
+Synthesizer::OscillatorLane Synthesizer::makeOscillatorLane(size_t lane, int unisonVoices) const {
+    // Without oscillators the deprecated single waveform plays at unity
+    Oscillator osc = oscillators_.empty() ? Oscillator(waveform_, 1.0f, 1.0f)
+                                          : oscillators_[lane / static_cast<size_t>(unisonVoices)];
+    int uniVoice = static_cast<int>(lane % static_cast<size_t>(unisonVoices));
+    
+    // Unison voices spread evenly across the detune range and the stereo field
+    float unisonDetune = 0.0f;
+    float unisonPan = 0.0f;
+    if (unisonVoices > 1) {
+        float voicePos = (static_cast<float>(uniVoice) / (unisonVoices - 1)) - 0.5f;  // -0.5 to 0.5
+        unisonDetune = voicePos * envelope_.unison.detune * 2.0f;
+        unisonPan = voicePos * envelope_.unison.spread * 2.0f;
+    }
+    float unisonScale = 1.0f / std::sqrt(static_cast<float>(unisonVoices));
+    
+    // Oscillator detune + unison detune in cents; oscillator pan + unison pan
+    float detuneMultiplier = std::pow(2.0f, (osc.detune + unisonDetune) / 1200.0f);
+    float totalPan = std::clamp(osc.pan + unisonPan, -1.0f, 1.0f);
+    
+    OscillatorLane result;
+    result.waveform = osc.waveform;
+    result.frequencyMultiplier = osc.frequencyMultiplier * detuneMultiplier;
+    result.gainL = osc.amplitude * unisonScale * std::cos((totalPan + 1.0f) * 0.25f * 3.14159265f);
+    result.gainR = osc.amplitude * unisonScale * std::sin((totalPan + 1.0f) * 0.25f * 3.14159265f);
+    return result;
+}
+
+size_t Synthesizer::refreshOscillatorLanes(int unisonVoices) {
+    const size_t laneCount = std::max<size_t>(oscillators_.size(), 1) * static_cast<size_t>(unisonVoices);
+    
+    // Detune and pan need pow/sin/cos, so only redo them when a setting has moved
+    const UnisonSettings& unison = envelope_.unison;
+    bool unchanged = laneCacheValid_ && oscillators_.size() == laneCacheOscillatorCount_ &&
+                     waveform_ == laneCacheWaveform_ && unison.enabled == laneCacheUnison_.enabled &&
+                     unison.voices == laneCacheUnison_.voices && unison.detune == laneCacheUnison_.detune &&
+                     unison.spread == laneCacheUnison_.spread;
+    for (size_t i = 0; unchanged && i < oscillators_.size(); ++i) {
+        const Oscillator& a = oscillators_[i];
+        const Oscillator& b = laneCacheOscillators_[i];
+        unchanged = a.waveform == b.waveform && a.frequencyMultiplier == b.frequencyMultiplier &&
+                    a.amplitude == b.amplitude && a.detune == b.detune && a.pan == b.pan;
+    }
+    if (unchanged) {
+        return laneCount;
     }
     
-    return voice.envelope;
+    for (size_t l = 0; l < laneCount && l < MAX_OSCILLATOR_LANES; ++l) {
+        laneCache_[l] = makeOscillatorLane(l, unisonVoices);
+    }
+    laneCacheOscillatorCount_ = oscillators_.size();
+    laneCacheValid_ = oscillators_.size() <= MAX_OSCILLATOR_LANES;
+    if (laneCacheValid_) {
+        std::copy(oscillators_.begin(), oscillators_.end(), laneCacheOscillators_);
+    }
+    laneCacheUnison_ = unison;
+    laneCacheWaveform_ = waveform_;
+    return laneCount;
 }
 
 float Synthesizer::calculatePitchEnvelope(Voice& voice, float deltaTime) {
@@ -316,136 +376,6 @@ float Synthesizer::calculatePitchEnvelope(Voice& voice, float deltaTime) {
     return voice.pitchEnvValue;
 }
 
-float Synthesizer::calculateFilterEnvelope(Voice& voice, float deltaTime) {
-    if (!envelope_.filter.enabled) {
-        return 0.0f;
-    }
-    
-    const auto& fEnv = envelope_.filter.envelope;
-    
-    switch (voice.filterEnvPhase) {
-        case EnvelopePhase::Attack: {
-            voice.filterEnvTime += deltaTime;
-            if (fEnv.attack <= 0.001f) {
-                voice.filterEnvelope = 1.0f;
-                voice.filterEnvPhase = EnvelopePhase::Decay;
-                voice.filterEnvTime = 0.0f;
-            } else {
-                float progress = voice.filterEnvTime / fEnv.attack;
-                voice.filterEnvelope = 1.0f - std::exp(-5.0f * progress);
-                if (progress >= 1.0f) {
-                    voice.filterEnvelope = 1.0f;
-                    voice.filterEnvPhase = EnvelopePhase::Decay;
-                    voice.filterEnvTime = 0.0f;
-                }
-            }
-            break;
-        }
-        case EnvelopePhase::Decay: {
-            voice.filterEnvTime += deltaTime;
-            if (fEnv.decay <= 0.001f) {
-                voice.filterEnvelope = fEnv.sustain;
-                voice.filterEnvPhase = EnvelopePhase::Sustain;
-            } else {
-                float progress = voice.filterEnvTime / fEnv.decay;
-                voice.filterEnvelope = fEnv.sustain + (1.0f - fEnv.sustain) * std::exp(-5.0f * progress);
-                if (progress >= 1.0f) {
-                    voice.filterEnvelope = fEnv.sustain;
-                    voice.filterEnvPhase = EnvelopePhase::Sustain;
-                }
-            }
-            break;
-        }
-        case EnvelopePhase::Sustain:
-            voice.filterEnvelope = fEnv.sustain;
-            break;
-        case EnvelopePhase::Release: {
-            voice.filterEnvTime += deltaTime;
-            if (fEnv.release <= 0.001f) {
-                voice.filterEnvelope = 0.0f;
-                voice.filterEnvPhase = EnvelopePhase::Off;
-            } else {
-                float progress = voice.filterEnvTime / fEnv.release;
-                voice.filterEnvelope = voice.filterReleaseStart * std::exp(-5.0f * progress);
-                if (voice.filterEnvelope < 0.0001f || progress >= 1.0f) {
-                    voice.filterEnvelope = 0.0f;
-                    voice.filterEnvPhase = EnvelopePhase::Off;
-                }
-            }
-            break;
-        }
-        case EnvelopePhase::Off:
-            voice.filterEnvelope = 0.0f;
-            break;
-    }
-    
-    return voice.filterEnvelope;
-}
-
-void Synthesizer::applyFilter(Voice& voice, float& sampleL, float& sampleR, float cutoffMod) {
-    if (!envelope_.filter.enabled) {
-        return;
-    }
-    
-    // Calculate effective cutoff with envelope modulation
-    float baseCutoff = envelope_.filter.cutoff;
-    float envMod = cutoffMod * envelope_.filter.envAmount;
-    float effectiveCutoff = std::clamp(baseCutoff + envMod, 0.01f, 0.99f);
-    
-    // Convert normalized cutoff to frequency (20Hz to 20kHz logarithmic)
-    float cutoffHz = 20.0f * std::pow(1000.0f, effectiveCutoff);
-    
-    // Calculate filter coefficients (state variable filter)
-    float f = 2.0f * std::sin(3.14159265f * cutoffHz / static_cast<float>(sampleRate_));
-    f = std::min(f, 1.0f);  // Stability limit
-    
-    float q = 1.0f - envelope_.filter.resonance * 0.9f;  // Q from 1.0 to 0.1
-    q = std::max(q, 0.1f);
-    
-    // Process left channel
-    float highL = sampleL - voice.filterLowL - q * voice.filterBandL;
-    voice.filterBandL += f * highL;
-    voice.filterLowL += f * voice.filterBandL;
-    
-    // Process right channel
-    float highR = sampleR - voice.filterLowR - q * voice.filterBandR;
-    voice.filterBandR += f * highR;
-    voice.filterLowR += f * voice.filterBandR;
-    
-    // Output low-pass
-    sampleL = voice.filterLowL;
-    sampleR = voice.filterLowR;
-}
-
-void Synthesizer::applySaturation(float& sampleL, float& sampleR) {
-    if (!envelope_.saturation.enabled) {
-        return;
-    }
-    
-    float drive = envelope_.saturation.drive;
-    float mix = envelope_.saturation.mix;
-    
-    // Store dry signal
-    float dryL = sampleL;
-    float dryR = sampleR;
-    
-    // Apply drive
-    float wetL = sampleL * drive;
-    float wetR = sampleR * drive;
-    
-    // Soft clipping using tanh (smooth, tube-like saturation)
-    wetL = std::tanh(wetL);
-    wetR = std::tanh(wetR);
-    
-    // Normalize output
-    wetL /= std::max(1.0f, drive * 0.5f);
-    wetR /= std::max(1.0f, drive * 0.5f);
-    
-    // Mix dry/wet
-    sampleL = dryL * (1.0f - mix) + wetL * mix;
-    sampleR = dryR * (1.0f - mix) + wetR * mix;
-}
-
 void Synthesizer::calculatePortamento(Voice& voice, float deltaTime) {
     if (!envelope_.portamento.enabled || voice.portamentoProgress >= 1.0f) {
         return;
@@ -469,10 +399,10 @@ void Synthesizer::calculatePortamento(Voice& voice, float deltaTime) {
         t = t * t * (3.0f - 2.0f * t);  // Smoothstep
         
         // Interpolate in log space for musical pitch
-        float logStart = std::log(voice.portamentoStartFreq);
-        float logEnd = std::log(voice.targetPhaseIncrement);
+        float logStart = dsp::log2(voice.portamentoStartFreq);
+        float logEnd = dsp::log2(voice.targetPhaseIncrement);
         float logCurrent = logStart + t * (logEnd - logStart);
-        voice.basePhaseIncrement = std::exp(logCurrent);
+        voice.basePhaseIncrement = dsp::exp2(logCurrent);
     }
 }
 
@@ -486,7 +416,7 @@ float Synthesizer::calculateLFO(float& phase, const LFO& lfo, float deltaTime) {
     while (phase >= 1.0f) phase -= 1.0f;
     
     // Generate sine LFO
-    float lfoValue = std::sin(phase * 2.0f * 3.14159265f);
+    float lfoValue = dsp::sin(phase * 2.0f * 3.14159265f);
     
     return lfoValue * lfo.depth;
 }
@@ -507,188 +437,519 @@ Waveform Synthesizer::getWaveform() const {
     return oscillators_[0].waveform;
 }
 
-void Synthesizer::generateAudio(AudioBuffer& buffer, size_t numFrames) {
-    // Process pending MIDI messages
-    if (hasPendingMessages_.load()) {
-        std::vector<MidiMessage> messages;
-        {
-            std::lock_guard<std::mutex> lock(midiMutex_);
-            messages.swap(pendingMessages_);
-            hasPendingMessages_ = false;
-        }
-        
-        for (const auto& msg : messages) {
-            if (msg.isNoteOn()) {
-                noteOn(msg.getNoteNumber(), msg.getVelocity());
-            } else if (msg.isNoteOff()) {
-                noteOff(msg.getNoteNumber());
-            } else if (msg.getType() == MidiMessageType::ControlChange) {
-                uint8_t controller = msg.getData1();
-                uint8_t value = msg.getData2();
-                
-                if (controller == 64) {
-                    handleSustainPedal(value);
-                }
+void Synthesizer::enterStage(EnvelopeLanes& env, size_t v, EnvelopePhase stage, const ADSREnvelope& settings) {
+    const float rate = static_cast<float>(sampleRate_);
+    
+    // Each stage covers five time constants, like the closed-form curves it replaces
+    auto approach = [&](float target, float seconds, float samples) {
+        env.target[v] = target;
+        env.coeff[v] = std::exp(-5.0f / (seconds * rate));
+        env.samplesLeft[v] = std::max<int32_t>(1, static_cast<int32_t>(std::ceil(samples)));
+    };
+    
+    env.stage[v] = stage;
+    switch (stage) {
+        case EnvelopePhase::Attack:
+            if (settings.attack <= 0.001f) {
+                env.value[v] = 1.0f;
+                enterStage(env, v, EnvelopePhase::Decay, settings);
+            } else {
+                approach(1.0f, settings.attack, settings.attack * rate);
             }
+            break;
+            
+        case EnvelopePhase::Decay:
+            if (settings.decay <= 0.001f) {
+                enterStage(env, v, EnvelopePhase::Sustain, settings);
+            } else {
+                approach(settings.sustain, settings.decay, settings.decay * rate);
+            }
+            break;
+            
+        case EnvelopePhase::Sustain:
+            env.value[v] = env.target[v] = settings.sustain;
+            env.coeff[v] = 0.0f;
+            env.samplesLeft[v] = 0;
+            break;
+            
+        case EnvelopePhase::Release: {
+            float start = env.value[v];
+            if (settings.release <= 0.001f || start < 0.0001f) {
+                enterStage(env, v, EnvelopePhase::Off, settings);
+                break;
+            }
+            // Ends after the release time or once below 0.0001, whichever is first
+            float samples = settings.release * rate;
+            samples = std::min(samples, samples * std::log(start / 0.0001f) / 5.0f);
+            approach(0.0f, settings.release, samples);
+            break;
         }
+        
+        case EnvelopePhase::Off:
+            env.value[v] = env.target[v] = env.coeff[v] = 0.0f;
+            env.samplesLeft[v] = 0;
+            break;
     }
+}
+
+void Synthesizer::finishStage(EnvelopeLanes& env, size_t v, const ADSREnvelope& settings) {
+    switch (env.stage[v]) {
+        case EnvelopePhase::Attack:
+            env.value[v] = 1.0f;
+            enterStage(env, v, EnvelopePhase::Decay, settings);
+            break;
+        case EnvelopePhase::Decay:
+            enterStage(env, v, EnvelopePhase::Sustain, settings);
+            break;
+        case EnvelopePhase::Release:
+            enterStage(env, v, EnvelopePhase::Off, settings);
+            break;
+        default:
+            break;
+    }
+}
+
+void Synthesizer::updateFilterCoefficient(size_t v, float envValue) {
+    // Calculate effective cutoff with envelope modulation
+    float envMod = envValue * envelope_.filter.envAmount;
+    float cutoff = std::clamp(envelope_.filter.cutoff + envMod, 0.01f, 0.99f);
+    if (cutoff == voiceLanes_.filterCutoff[v]) {
+        return;
+    }
+    voiceLanes_.filterCutoff[v] = cutoff;
     
-    buffer.clear();
+    // Convert normalized cutoff to frequency (20Hz to 20kHz logarithmic)
+    float cutoffHz = 20.0f * dsp::pow(1000.0f, cutoff);
+    float f = 2.0f * dsp::sin(3.14159265f * cutoffHz / static_cast<float>(sampleRate_));
+    voiceLanes_.filterF[v] = std::min(f, 1.0f);  // Stability limit
+}
+
+bool Synthesizer::hasPitchModulation() const {
+    auto lfoOnPitch = [](const LFO& lfo) {
+        return lfo.enabled && lfo.depth > 0.0f && lfo.target == LFO::Target::Pitch;
+    };
+    return envelope_.portamento.enabled || envelope_.pitchEnvelope.enabled ||
+           lfoOnPitch(envelope_.lfo1) || lfoOnPitch(envelope_.lfo2);
+}
+
+bool Synthesizer::hasPerSampleModulation() const {
+    auto lfoOnAmplitude = [](const LFO& lfo) {
+        return lfo.enabled && lfo.depth > 0.0f && lfo.target == LFO::Target::Amplitude;
+    };
+    return hasPitchModulation() || lfoOnAmplitude(envelope_.lfo1) || lfoOnAmplitude(envelope_.lfo2);
+}
+
+void Synthesizer::updateVoiceModulation(size_t v, float deltaTime) {
+    Voice& voice = voices_[v];
     
-    size_t numChannels = buffer.getNumChannels();
-    float deltaTime = 1.0f / static_cast<float>(sampleRate_);
+    // Calculate portamento (glide between notes)
+    calculatePortamento(voice, deltaTime);
     
-    // Count active voices for scaling
-    size_t activeVoiceCount = 0;
-    for (const auto& voice : voices_) {
-        if (voice.active || voice.envelope > 0.0f || voice.envPhase != EnvelopePhase::Off) {
-            activeVoiceCount++;
-        }
+    // Calculate pitch envelope (for 808-style pitch drop)
+    float pitchMod = calculatePitchEnvelope(voice, deltaTime);
+    
+    // Calculate LFO modulations
+    float lfo1Value = calculateLFO(voice.lfo1Phase, envelope_.lfo1, deltaTime);
+    float lfo2Value = calculateLFO(voice.lfo2Phase, envelope_.lfo2, deltaTime);
+    
+    // Apply LFO to pitch if configured
+    float lfoFreqMod = 1.0f;
+    if (envelope_.lfo1.enabled && envelope_.lfo1.target == LFO::Target::Pitch) {
+        lfoFreqMod *= dsp::exp2(lfo1Value / 12.0f);  // LFO depth in semitones
+    }
+    if (envelope_.lfo2.enabled && envelope_.lfo2.target == LFO::Target::Pitch) {
+        lfoFreqMod *= dsp::exp2(lfo2Value / 12.0f);
     }
     
-    float voiceScale = activeVoiceCount > 0 ? (1.0f / sqrtf(static_cast<float>(activeVoiceCount))) : 1.0f;
+    // Apply LFO to amplitude if configured
+    float lfoAmpMod = 1.0f;
+    if (envelope_.lfo1.enabled && envelope_.lfo1.target == LFO::Target::Amplitude) {
+        lfoAmpMod *= (1.0f + lfo1Value * 0.5f);  // 50% modulation depth
+    }
+    if (envelope_.lfo2.enabled && envelope_.lfo2.target == LFO::Target::Amplitude) {
+        lfoAmpMod *= (1.0f + lfo2Value * 0.5f);
+    }
     
-    for (auto& voice : voices_) {
-        if (voice.envPhase == EnvelopePhase::Off && voice.envelope <= 0.0f) {
-            continue;
-        }
-        
-        for (size_t i = 0; i < numFrames; ++i) {
-            // Calculate ADSR envelope
-            float envValue = calculateEnvelope(voice, deltaTime);
-            
-            if (envValue <= 0.0001f && voice.envPhase == EnvelopePhase::Off) {
-                break;
+    voiceLanes_.phaseIncrement[v] = voice.basePhaseIncrement * pitchMod * lfoFreqMod;
+    voiceLanes_.gain[v] = voice.amplitude * lfoAmpMod;
+}
+
+unsigned Synthesizer::selectRenderFeatures() const {
+    unsigned features = 0;
+    if (hasPerSampleModulation()) {
+        features |= RENDER_MODULATION;
+    }
+    if (hasPitchModulation()) {
+        features |= RENDER_PITCH_MODULATION;
+    }
+    if (envelope_.filter.enabled) {
+        features |= RENDER_FILTER;
+    }
+    if (envelope_.saturation.enabled) {
+        features |= RENDER_SATURATION;
+    }
+    if (std::abs(envelope_.pan) > 0.001f) {
+        features |= RENDER_PAN;
+    }
+    
+    // Without oscillators the deprecated single waveform plays
+    bool wavetablesOnly = bandLimited_ && (!oscillators_.empty() || WavetableBank::hasTable(waveform_));
+    for (const auto& osc : oscillators_) {
+        wavetablesOnly = wavetablesOnly && WavetableBank::hasTable(osc.waveform);
+    }
+    if (wavetablesOnly) {
+        features |= RENDER_WAVETABLES_ONLY;
+    }
+    return features;
+}
+
+const std::array<Synthesizer::RenderKernel, Synthesizer::NUM_RENDER_KERNELS> Synthesizer::renderKernels_ =
+    Synthesizer::makeRenderKernels(std::make_index_sequence<Synthesizer::NUM_RENDER_KERNELS>());
+
+template <unsigned Features>
+void Synthesizer::renderVoiceGroup(size_t first, AudioBuffer& buffer, size_t startFrame, size_t numFrames,
+                                   const OscillatorLane* lanes, size_t laneCount, int unisonVoices,
+                                   float outputGain) {
+    using simd::float4;
+    constexpr size_t W = VOICE_GROUP_SIZE;
+    constexpr bool modulated = (Features & RENDER_MODULATION) != 0;
+    constexpr bool pitchModulated = (Features & RENDER_PITCH_MODULATION) != 0;
+    constexpr bool filterOn = (Features & RENDER_FILTER) != 0;
+    constexpr bool saturationOn = (Features & RENDER_SATURATION) != 0;
+    constexpr bool panned = (Features & RENDER_PAN) != 0;
+    constexpr bool wavetablesOnly = (Features & RENDER_WAVETABLES_ONLY) != 0;
+    
+    const float deltaTime = 1.0f / static_cast<float>(sampleRate_);
+    const float drive = envelope_.saturation.drive;
+    const float mix = envelope_.saturation.mix;
+    const float driveNormalise = 1.0f / std::max(1.0f, drive * 0.5f);
+    const float4 q(std::max(1.0f - envelope_.filter.resonance * 0.9f, 0.1f));  // Q from 1.0 to 0.1
+    const float4 zero(0.0f);
+    const float4 voiceOutputGain(outputGain);
+    
+    // Master pan is linear, so it can go on the group's sum instead of on every voice
+    const float panL = std::cos((envelope_.pan + 1.0f) * 0.25f * 3.14159265f) * 1.414f;  // Compensate for energy loss
+    const float panR = std::sin((envelope_.pan + 1.0f) * 0.25f * 3.14159265f) * 1.414f;
+    
+    float* outL = buffer.getWritePointer(0) + startFrame;
+    float* outR = buffer.getNumChannels() >= 2 ? buffer.getWritePointer(1) + startFrame : nullptr;
+    
+    // Wavetable per oscillator lane and voice, picked for the highest increment it will play at
+    const float* tables[MAX_OSCILLATOR_LANES][W];
+    const size_t cachedLanes = std::min(laneCount, MAX_OSCILLATOR_LANES);
+    auto selectTables = [&](float4 highestIncrement) {
+        alignas(16) float increments[W];
+        highestIncrement.store(increments);
+        for (size_t l = 0; l < cachedLanes; ++l) {
+            if (!WavetableBank::hasTable(lanes[l].waveform)) {
+                continue;
             }
-            
-            // Calculate portamento (glide between notes)
-            calculatePortamento(voice, deltaTime);
-            
-            // Calculate pitch envelope (for 808-style pitch drop)
-            float pitchMod = calculatePitchEnvelope(voice, deltaTime);
-            
-            // Calculate filter envelope
-            float filterEnvValue = calculateFilterEnvelope(voice, deltaTime);
-            
-            // Calculate LFO modulations
-            float lfo1Value = calculateLFO(voice.lfo1Phase, envelope_.lfo1, deltaTime);
-            float lfo2Value = calculateLFO(voice.lfo2Phase, envelope_.lfo2, deltaTime);
-            
-            // Apply LFO to pitch if configured
-            float lfoFreqMod = 1.0f;
-            if (envelope_.lfo1.enabled && envelope_.lfo1.target == LFO::Target::Pitch) {
-                lfoFreqMod *= std::pow(2.0f, lfo1Value / 12.0f);  // LFO depth in semitones
+            for (size_t v = 0; v < W; ++v) {
+                float oscIncrement = increments[v] * lanes[l].frequencyMultiplier;
+                tables[l][v] = wavetables_->getTable(lanes[l].waveform, WavetableBank::selectLevel(oscIncrement));
             }
-            if (envelope_.lfo2.enabled && envelope_.lfo2.target == LFO::Target::Pitch) {
-                lfoFreqMod *= std::pow(2.0f, lfo2Value / 12.0f);
+        }
+    };
+    
+    size_t i = 0;
+    while (i < numFrames) {
+        // Render up to the next envelope stage change; those are the only per-lane branches
+        size_t segment = numFrames - i;
+        bool sounding = false;
+        bool filterMoving = false;
+        for (size_t k = first; k < first + W; ++k) {
+            sounding = sounding || ampEnv_.stage[k] != EnvelopePhase::Off;
+            if (ampEnv_.samplesLeft[k] > 0) {
+                segment = std::min(segment, static_cast<size_t>(ampEnv_.samplesLeft[k]));
             }
-            
-            // Apply LFO to amplitude if configured
-            float lfoAmpMod = 1.0f;
-            if (envelope_.lfo1.enabled && envelope_.lfo1.target == LFO::Target::Amplitude) {
-                lfoAmpMod *= (1.0f + lfo1Value * 0.5f);  // 50% modulation depth
+            if constexpr (filterOn) {
+                if (filterEnv_.samplesLeft[k] > 0) {
+                    segment = std::min(segment, static_cast<size_t>(filterEnv_.samplesLeft[k]));
+                }
+                filterMoving = filterMoving || filterEnv_.samplesLeft[k] > 0;
+                updateFilterCoefficient(k, filterEnv_.value[k]);
+            }
+        }
+        if (!sounding) {
+            break;
+        }
+        filterMoving = filterMoving && envelope_.filter.envAmount != 0.0f;
+        
+        float4 phase = float4::load(voiceLanes_.phase + first);
+        float4 increment = float4::load(voiceLanes_.phaseIncrement + first);
+        if ((wavetablesOnly || bandLimited_) && !pitchModulated) {
+            selectTables(increment);
+        }
+        float4 gain = float4::load(voiceLanes_.gain + first);
+        float4 ampValue = float4::load(ampEnv_.value + first);
+        const float4 ampTarget = float4::load(ampEnv_.target + first);
+        const float4 ampCoeff = float4::load(ampEnv_.coeff + first);
+        float4 filterValue = float4::load(filterEnv_.value + first);
+        const float4 filterTarget = float4::load(filterEnv_.target + first);
+        const float4 filterCoeff = float4::load(filterEnv_.coeff + first);
+        float4 f = float4::load(voiceLanes_.filterF + first);
+        float4 lowL = float4::load(voiceLanes_.filterLowL + first);
+        float4 bandL = float4::load(voiceLanes_.filterBandL + first);
+        float4 lowR = float4::load(voiceLanes_.filterLowR + first);
+        float4 bandR = float4::load(voiceLanes_.filterBandR + first);
+        
+        for (const size_t end = i + segment; i < end;) {
+            // Modulators and filter coefficients are evaluated for the end of each
+            // control block; increment, gain and coefficient ramp there linearly
+            const size_t block = std::min(controlRate_, end - i);
+            const float4 rampScale(1.0f / static_cast<float>(block));
+            float4 incrementStep(0.0f);
+            float4 gainStep(0.0f);
+            float4 fStep(0.0f);
+            if constexpr (modulated) {
+                for (size_t k = first; k < first + W; ++k) {
+                    updateVoiceModulation(k, deltaTime * static_cast<float>(block));
+                }
+                const float4 targetIncrement = float4::load(voiceLanes_.phaseIncrement + first);
+                incrementStep = (targetIncrement - increment) * rampScale;
+                gainStep = (float4::load(voiceLanes_.gain + first) - gain) * rampScale;
+                if (pitchModulated && (wavetablesOnly || bandLimited_)) {
+                    selectTables(simd::max(increment, targetIncrement));
+                }
             }
-            if (envelope_.lfo2.enabled && envelope_.lfo2.target == LFO::Target::Amplitude) {
-                lfoAmpMod *= (1.0f + lfo2Value * 0.5f);
+            if (filterMoving) {
+                alignas(16) float envValues[W];
+                filterValue.store(envValues);
+                for (size_t v = 0; v < W; ++v) {
+                    const size_t k = first + v;
+                    float decay = dsp::pow(filterEnv_.coeff[k], static_cast<float>(block));
+                    updateFilterCoefficient(k, filterEnv_.target[k] + (envValues[v] - filterEnv_.target[k]) * decay);
+                }
+                fStep = (float4::load(voiceLanes_.filterF + first) - f) * rampScale;
             }
             
-            // Update phase increment with pitch envelope and LFO
-            voice.phaseIncrement = voice.basePhaseIncrement * pitchMod * lfoFreqMod;
-            
-            // Generate sample by summing all oscillators
-            float sampleL = 0.0f;
-            float sampleR = 0.0f;
-            
-            // Handle unison - generate multiple detuned voices
-            int unisonVoices = envelope_.unison.enabled ? std::max(1, envelope_.unison.voices) : 1;
-            float unisonScale = 1.0f / std::sqrt(static_cast<float>(unisonVoices));
-            
-            for (int uniVoice = 0; uniVoice < unisonVoices; ++uniVoice) {
-                // Calculate unison detune and pan
-                float unisonDetune = 0.0f;
-                float unisonPan = 0.0f;
-                if (unisonVoices > 1) {
-                    float voicePos = (static_cast<float>(uniVoice) / (unisonVoices - 1)) - 0.5f;  // -0.5 to 0.5
-                    unisonDetune = voicePos * envelope_.unison.detune * 2.0f;  // Spread across detune range
-                    unisonPan = voicePos * envelope_.unison.spread * 2.0f;      // Spread across stereo
+            for (const size_t blockEnd = i + block; i < blockEnd; ++i) {
+                increment = increment + incrementStep;
+                gain = gain + gainStep;
+                f = f + fStep;
+                
+                ampValue = ampTarget + (ampValue - ampTarget) * ampCoeff;
+                if constexpr (filterOn) {
+                    filterValue = filterTarget + (filterValue - filterTarget) * filterCoeff;
                 }
-                float uniDetuneMultiplier = std::pow(2.0f, unisonDetune / 1200.0f);
                 
-            if (oscillators_.empty()) {
-                    float sample = generateWaveform(voice.phase * uniDetuneMultiplier, waveform_);
-                    float panL = std::cos((unisonPan + 1.0f) * 0.25f * 3.14159265f);
-                    float panR = std::sin((unisonPan + 1.0f) * 0.25f * 3.14159265f);
-                    sampleL += sample * panL * unisonScale;
-                    sampleR += sample * panR * unisonScale;
-            } else {
-                for (const auto& osc : oscillators_) {
-                        // Apply detune in cents (oscillator detune + unison detune)
-                        float totalDetune = osc.detune + unisonDetune;
-                        float detuneMultiplier = std::pow(2.0f, totalDetune / 1200.0f);
-                        
-                        // Calculate phase for this oscillator
-                        float oscPhase = voice.phase * osc.frequencyMultiplier * detuneMultiplier;
-                    while (oscPhase >= 1.0f) oscPhase -= 1.0f;
-                    while (oscPhase < 0.0f) oscPhase += 1.0f;
+                // Sum every oscillator at every unison position, one voice per lane
+                float4 left(0.0f);
+                float4 right(0.0f);
+                for (size_t l = 0; l < laneCount; ++l) {
+                    const OscillatorLane lane = l < MAX_OSCILLATOR_LANES ? lanes[l] : makeOscillatorLane(l, unisonVoices);
+                    const float4 multiplier(lane.frequencyMultiplier);
+                    const float4 oscPhase = simd::fract(phase * multiplier);
                     
-                        float sample = generateWaveform(oscPhase, osc.waveform) * osc.amplitude;
-                        
-                        // Apply stereo panning (oscillator pan + unison pan)
-                        float totalPan = std::clamp(osc.pan + unisonPan, -1.0f, 1.0f);
-                        float panL = std::cos((totalPan + 1.0f) * 0.25f * 3.14159265f);
-                        float panR = std::sin((totalPan + 1.0f) * 0.25f * 3.14159265f);
+                    float4 sample;
+                    if (wavetablesOnly || (bandLimited_ && WavetableBank::hasTable(lane.waveform))) {
+                        const float* extraTables[W];
+                        const float* const* laneTables = tables[l < cachedLanes ? l : 0];
+                        if (l >= cachedLanes) {
+                            alignas(16) float increments[W];
+                            (increment * multiplier).store(increments);
+                            for (size_t v = 0; v < W; ++v) {
+                                extraTables[v] = wavetables_->getTable(lane.waveform, WavetableBank::selectLevel(increments[v]));
+                            }
+                            laneTables = extraTables;
+                        }
                         
-                        sampleL += sample * panL * unisonScale;
-                        sampleR += sample * panR * unisonScale;
+                        // Positions and blends are lane-wise; only the table reads are per voice
+                        const float4 position = oscPhase * float4(static_cast<float>(WavetableBank::TABLE_SIZE));
+                        alignas(16) int32_t index[W];
+                        alignas(16) float below[W];
+                        alignas(16) float above[W];
+                        simd::truncate(position, index);
+                        for (size_t v = 0; v < W; ++v) {
+                            size_t n = std::min(static_cast<size_t>(index[v]), WavetableBank::TABLE_SIZE - 1);
+                            below[v] = laneTables[v][n];
+                            above[v] = laneTables[v][n + 1];
+                        }
+                        const float4 lo = float4::load(below);
+                        sample = lo + simd::fract(position) * (float4::load(above) - lo);
+                    } else if (lane.waveform == Waveform::Sawtooth) {
+                        sample = oscPhase * float4(2.0f) - float4(1.0f);
+                    } else if (lane.waveform == Waveform::Square) {
+                        sample = simd::select(oscPhase < float4(0.5f), float4(1.0f), float4(-1.0f));
+                    } else if (lane.waveform == Waveform::Triangle) {
+                        const float4 rising = oscPhase * float4(4.0f);
+                        sample = simd::select(oscPhase < float4(0.5f), rising - float4(1.0f), float4(3.0f) - rising);
+                    } else if (lane.waveform == Waveform::Noise) {
+                        alignas(16) float samples[W];
+                        for (size_t v = 0; v < W; ++v) {
+                            samples[v] = voiceNoise_[first + v].nextBipolar();
+                        }
+                        sample = float4::load(samples);
+                    } else {
+                        alignas(16) float phases[W];
+                        alignas(16) float increments[W];
+                        alignas(16) float samples[W];
+                        oscPhase.store(phases);
+                        (increment * multiplier).store(increments);
+                        for (size_t v = 0; v < W; ++v) {
+                            samples[v] = generateWaveform(phases[v], increments[v], lane.waveform);
+                        }
+                        sample = float4::load(samples);
                     }
+                    left = left + sample * float4(lane.gainL);
+                    right = right + sample * float4(lane.gainR);
                 }
+                
+                // Apply saturation/soft clipping
+                if constexpr (saturationOn) {
+                    alignas(16) float samplesL[W];
+                    alignas(16) float samplesR[W];
+                    left.store(samplesL);
+                    right.store(samplesR);
+                    for (size_t v = 0; v < W; ++v) {
+                        samplesL[v] = samplesL[v] * (1.0f - mix) + dsp::tanh(samplesL[v] * drive) * driveNormalise * mix;
+                        samplesR[v] = samplesR[v] * (1.0f - mix) + dsp::tanh(samplesR[v] * drive) * driveNormalise * mix;
+                    }
+                    left = float4::load(samplesL);
+                    right = float4::load(samplesR);
+                }
+                
+                // State variable low-pass, before the amplitude envelope
+                if constexpr (filterOn) {
+                    const float4 highL = left - lowL - q * bandL;
+                    bandL = bandL + f * highL;
+                    lowL = lowL + f * bandL;
+                    const float4 highR = right - lowR - q * bandR;
+                    bandR = bandR + f * highR;
+                    lowR = lowR + f * bandR;
+                    left = lowL;
+                    right = lowR;
+                }
+                
+                // Envelope, velocity, amplitude LFO and output gain; finished voices drop out
+                const float4 voiceGain = gain * ampValue * voiceOutputGain;
+                const simd::mask4 active = zero < ampValue;
+                float sampleL = simd::sum(simd::select(active, left * voiceGain, zero));
+                float sampleR = simd::sum(simd::select(active, right * voiceGain, zero));
+                
+                if constexpr (panned) {
+                    float mono = (sampleL + sampleR) * 0.5f;
+                    sampleL = mono * panL;
+                    sampleR = mono * panR;
+                }
+                if (outR) {
+                    outL[i] += sampleL;
+                    outR[i] += sampleR;
+                } else {
+                    outL[i] += (sampleL + sampleR) * 0.5f;
+                }
+                
+                phase = simd::fract(phase + increment);
             }
-            
-            // Apply saturation/soft clipping
-            applySaturation(sampleL, sampleR);
-            
-            // Apply filter before amplitude envelope
-            applyFilter(voice, sampleL, sampleR, filterEnvValue);
-            
-            // Apply envelope, velocity, volume, LFO amp mod, and voice scaling
-            float finalGain = voice.amplitude * volume_ * envValue * lfoAmpMod * voiceScale;
-            finalGain *= envelope_.masterVolume;  // Apply master volume
-            sampleL *= finalGain;
-            sampleR *= finalGain;
-            
-            // Apply master pan
-            if (std::abs(envelope_.pan) > 0.001f) {
-                float panL = std::cos((envelope_.pan + 1.0f) * 0.25f * 3.14159265f);
-                float panR = std::sin((envelope_.pan + 1.0f) * 0.25f * 3.14159265f);
-                float mono = (sampleL + sampleR) * 0.5f;
-                sampleL = mono * panL * 1.414f;  // Compensate for energy loss
-                sampleR = mono * panR * 1.414f;
-            }
-            
-            // Write to buffer
-            if (numChannels >= 2) {
-                buffer.getWritePointer(0)[i] += sampleL;
-                buffer.getWritePointer(1)[i] += sampleR;
-            } else if (numChannels == 1) {
-                buffer.getWritePointer(0)[i] += (sampleL + sampleR) * 0.5f;
+        }
+        
+        phase.store(voiceLanes_.phase + first);
+        ampValue.store(ampEnv_.value + first);
+        if constexpr (filterOn) {
+            filterValue.store(filterEnv_.value + first);
+            lowL.store(voiceLanes_.filterLowL + first);
+            bandL.store(voiceLanes_.filterBandL + first);
+            lowR.store(voiceLanes_.filterLowR + first);
+            bandR.store(voiceLanes_.filterBandR + first);
+        }
+        
+        // Lanes whose stage ran out move on to the next one
+        const int32_t elapsed = static_cast<int32_t>(segment);
+        for (size_t k = first; k < first + W; ++k) {
+            if (ampEnv_.samplesLeft[k] > 0 && (ampEnv_.samplesLeft[k] -= elapsed) == 0) {
+                finishStage(ampEnv_, k, envelope_.ampEnvelope);
             }
-            
-            // Update phase with modulated increment
-            voice.phase += voice.phaseIncrement;
-            while (voice.phase >= 1.0f) {
-                voice.phase -= 1.0f;
+            if (filterOn && filterEnv_.samplesLeft[k] > 0 && (filterEnv_.samplesLeft[k] -= elapsed) == 0) {
+                finishStage(filterEnv_, k, envelope_.filter.envelope);
             }
         }
     }
+}
+
+void Synthesizer::generateAudio(AudioBuffer& buffer, size_t numFrames) {
+    buffer.clear();
+    
+    size_t numChannels = buffer.getNumChannels();
+    if (numChannels == 0) {
+        return;
+    }
+    applyPendingSeed();
+    
+    // Take this block's MIDI, ordered by offset
+    size_t numEvents = midiQueue_.drainSorted(blockEvents_.data(), blockEvents_.size());
+    
+    // Idle: the cleared buffer is the whole answer
+    if (numEvents == 0 && !isProducingAudio()) {
+        return;
+    }
+    
+    // Render up to each event, apply it, carry on; late offsets land on the last frame
+    size_t rendered = 0;
+    for (size_t e = 0; e < numEvents; ++e) {
+        size_t offset = std::min<size_t>(blockEvents_[e].frameOffset, numFrames > 0 ? numFrames - 1 : 0);
+        if (offset > rendered) {
+            renderFrames(buffer, rendered, offset - rendered);
+            rendered = offset;
+        }
+        handleMidiMessage(blockEvents_[e].message);
+    }
+    if (rendered < numFrames) {
+        renderFrames(buffer, rendered, numFrames - rendered);
+    }
     
     // Soft limit to prevent clipping
     for (size_t ch = 0; ch < numChannels; ++ch) {
         float* output = buffer.getWritePointer(ch);
         for (size_t i = 0; i < numFrames; ++i) {
             // Soft tanh limiting
-            output[i] = std::tanh(output[i]);
+            output[i] = dsp::tanh(output[i]);
         }
     }
 }
 
+void Synthesizer::renderFrames(AudioBuffer& buffer, size_t startFrame, size_t numFrames) {
+    // Count active voices for scaling
+    size_t activeVoiceCount = 0;
+    for (size_t v = 0; v < MAX_VOICES; ++v) {
+        if (voices_[v].active || ampEnv_.stage[v] != EnvelopePhase::Off) {
+            activeVoiceCount++;
+        }
+    }
+    
+    float voiceScale = activeVoiceCount > 0 ? (1.0f / sqrtf(static_cast<float>(activeVoiceCount))) : 1.0f;
+    
+    const int unisonVoices = envelope_.unison.enabled ? std::max(1, envelope_.unison.voices) : 1;
+    const size_t laneCount = refreshOscillatorLanes(unisonVoices);
+    
+    // Sustain levels can be edited while notes are held
+    for (size_t v = 0; v < MAX_VOICES; ++v) {
+        if (ampEnv_.stage[v] == EnvelopePhase::Sustain) {
+            ampEnv_.value[v] = ampEnv_.target[v] = envelope_.ampEnvelope.sustain;
+        }
+        if (filterEnv_.stage[v] == EnvelopePhase::Sustain) {
+            filterEnv_.value[v] = filterEnv_.target[v] = envelope_.filter.envelope.sustain;
+        }
+    }
+    
+    // Pick the render kernel for the features this patch uses
+    const unsigned features = selectRenderFeatures();
+    if (features != renderFeatures_) {
+        renderFeatures_ = features;
+        renderKernel_ = renderKernels_[features];
+    }
+    
+    // Without per-sample modulators every voice holds its base pitch and velocity
+    if (!(features & RENDER_MODULATION)) {
+        for (size_t v = 0; v < MAX_VOICES; ++v) {
+            voiceLanes_.phaseIncrement[v] = voices_[v].basePhaseIncrement;
+            voiceLanes_.gain[v] = voices_[v].amplitude;
+        }
+    }
+    
+    const float outputGain = volume_ * voiceScale * envelope_.masterVolume;
+    for (size_t first = 0; first < MAX_VOICES; first += VOICE_GROUP_SIZE) {
+        (this->*renderKernel_)(first, buffer, startFrame, numFrames, laneCache_, laneCount, unisonVoices, outputGain);
+    }
+}
+
 } // namespace pan
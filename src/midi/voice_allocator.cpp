@@ -0,0 +1,132 @@
+#include "pan/midi/voice_allocator.h"
+#include <algorithm>
+
+namespace pan {
+
+VoiceAllocator::VoiceAllocator(size_t numVoices)
+    : numVoices_(std::min(std::max<size_t>(numVoices, 1), MAX_VOICES))
+    , polyphony_(numVoices_)
+{
+}
+
+void VoiceAllocator::setPolyphony(size_t polyphony) {
+    polyphony_ = std::min(std::max<size_t>(polyphony, 1), numVoices_);
+}
+
+VoiceAllocator::Allocation VoiceAllocator::allocate(uint8_t note) {
+    Allocation result;
+    if (getSoundingCount() >= polyphony_) {
+        result.stolen = pickVictim(note);
+        if (result.stolen != NO_VOICE) {
+            slots_[result.stolen].state = State::Stolen;
+            ++stealCount_;
+        }
+    }
+    
+    for (size_t v = 0; v < numVoices_; ++v) {
+        if (slots_[v].state == State::Free) {
+            result.voice = v;
+            break;
+        }
+    }
+    
+    // No headroom left to fade in: reuse the victim, or else the oldest fading voice
+    if (result.voice == NO_VOICE) {
+        if (result.stolen != NO_VOICE) {
+            result.voice = result.stolen;
+            result.stolen = NO_VOICE;
+        } else {
+            result.voice = 0;
+            for (size_t v = 1; v < numVoices_; ++v) {
+                bool fading = slots_[v].state == State::Stolen;
+                bool bestFading = slots_[result.voice].state == State::Stolen;
+                if ((fading && !bestFading) || (fading == bestFading && slots_[v].age < slots_[result.voice].age)) {
+                    result.voice = v;
+                }
+            }
+        }
+    }
+    
+    Slot& slot = slots_[result.voice];
+    slot.state = State::Held;
+    slot.note = note;
+    slot.age = ++clock_;
+    slot.level = 1.0f;
+    return result;
+}
+
+size_t VoiceAllocator::pickVictim(uint8_t note) const {
+    size_t oldest = NO_VOICE;
+    size_t quietest = NO_VOICE;
+    size_t sameNote = NO_VOICE;
+    size_t quietestReleased = NO_VOICE;
+    
+    for (size_t v = 0; v < numVoices_; ++v) {
+        const Slot& slot = slots_[v];
+        if (slot.state != State::Held && slot.state != State::Released) {
+            continue;
+        }
+        if (oldest == NO_VOICE || slot.age < slots_[oldest].age) {
+            oldest = v;
+        }
+        if (quietest == NO_VOICE || slot.level < slots_[quietest].level) {
+            quietest = v;
+        }
+        if (slot.note == note && (sameNote == NO_VOICE || slot.age < slots_[sameNote].age)) {
+            sameNote = v;
+        }
+        if (slot.state == State::Released &&
+            (quietestReleased == NO_VOICE || slot.level < slots_[quietestReleased].level)) {
+            quietestReleased = v;
+        }
+    }
+    
+    switch (policy_) {
+        case StealPolicy::Quietest:
+            return quietest;
+        case StealPolicy::SameNote:
+            return sameNote != NO_VOICE ? sameNote : oldest;
+        case StealPolicy::ReleaseFirst:
+            return quietestReleased != NO_VOICE ? quietestReleased : oldest;
+        case StealPolicy::Oldest:
+        default:
+            return oldest;
+    }
+}
+
+void VoiceAllocator::release(size_t voice) {
+    if (voice < numVoices_ && slots_[voice].state == State::Held) {
+        slots_[voice].state = State::Released;
+    }
+}
+
+void VoiceAllocator::finish(size_t voice) {
+    if (voice < numVoices_) {
+        slots_[voice].state = State::Free;
+        slots_[voice].level = 0.0f;
+    }
+}
+
+void VoiceAllocator::setLevel(size_t voice, float level) {
+    if (voice < numVoices_) {
+        slots_[voice].level = level;
+    }
+}
+
+void VoiceAllocator::reset() {
+    for (auto& slot : slots_) {
+        slot = Slot();
+    }
+}
+
+size_t VoiceAllocator::getSoundingCount() const {
+    size_t count = 0;
+    for (size_t v = 0; v < numVoices_; ++v) {
+        if (slots_[v].state == State::Held || slots_[v].state == State::Released) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace pan
@@ -0,0 +1,77 @@
+#include "pan/midi/wavetable.h"
+#include <cmath>
+
+namespace pan {
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+
+// Fourier series of the naive shapes Synthesizer used to generate directly
+float sineHarmonic(size_t h) {
+    return h == 1 ? 1.0f : 0.0f;
+}
+
+float squareHarmonic(size_t h) {
+    return (h % 2 == 1) ? 4.0f / (PI * static_cast<float>(h)) : 0.0f;
+}
+
+float sawtoothHarmonic(size_t h) {
+    // Rising ramp from -1 to 1
+    return -2.0f / (PI * static_cast<float>(h));
+}
+
+float triangleHarmonic(size_t h) {
+    // -1 at phase 0, +1 at phase 0.5 (cosine series)
+    return (h % 2 == 1) ? -8.0f / (PI * PI * static_cast<float>(h * h)) : 0.0f;
+}
+
+} // namespace
+
+const WavetableBank& WavetableBank::get() {
+    static const WavetableBank bank;
+    return bank;
+}
+
+WavetableBank::WavetableBank()
+    : tables_(NUM_WAVEFORMS * NUM_LEVELS)
+{
+    buildLevels(waveformIndex(Waveform::Sine), sineHarmonic, false);
+    buildLevels(waveformIndex(Waveform::Square), squareHarmonic, false);
+    buildLevels(waveformIndex(Waveform::Sawtooth), sawtoothHarmonic, false);
+    buildLevels(waveformIndex(Waveform::Triangle), triangleHarmonic, true);
+}
+
+void WavetableBank::buildLevels(size_t waveformSlot, float (*harmonicAmplitude)(size_t), bool cosine) {
+    // sin(2*pi*h*n/N) is an exact lookup into one sine period, so the whole bank
+    // needs only TABLE_SIZE calls to std::sin
+    std::array<double, TABLE_SIZE> sine;
+    for (size_t n = 0; n < TABLE_SIZE; ++n) {
+        sine[n] = std::sin(2.0 * 3.14159265358979323846 * static_cast<double>(n) / TABLE_SIZE);
+    }
+    const size_t mask = TABLE_SIZE - 1;
+    const size_t quarter = cosine ? TABLE_SIZE / 4 : 0;
+
+    // Every level's harmonics are a subset of the level below it, so add harmonics
+    // in increasing order and snapshot the sum whenever a level's limit is reached
+    std::array<double, TABLE_SIZE> sum{};
+    size_t level = NUM_LEVELS;
+    for (size_t h = 1; h <= MAX_HARMONICS && level > 0; ++h) {
+        float amplitude = harmonicAmplitude(h);
+        if (amplitude != 0.0f) {
+            for (size_t n = 0; n < TABLE_SIZE; ++n) {
+                sum[n] += amplitude * sine[(h * n + quarter) & mask];
+            }
+        }
+        while (level > 0 && h == (MAX_HARMONICS >> (level - 1))) {
+            --level;
+            Table& table = tables_[waveformSlot * NUM_LEVELS + level];
+            for (size_t n = 0; n < TABLE_SIZE; ++n) {
+                table[n] = static_cast<float>(sum[n]);
+            }
+            table[TABLE_SIZE] = table[0];
+        }
+    }
+}
+
+} // namespace pan
@@ -1,5 +1,6 @@
 #include "pan/track/audio_clip.h"
 #include <algorithm>
+#include <atomic>
 
 namespace pan {
 
@@ -19,7 +20,9 @@ void AudioClip::setGain(float gain) {
 }
 
 void AudioClip::setAudioData(std::shared_ptr<AudioBuffer> buffer) {
+    static std::atomic<uint64_t> nextContentId{1};
     audioData_ = buffer;
+    contentId_ = nextContentId.fetch_add(1, std::memory_order_relaxed);
     if (audioData_) {
         // Update end time based on audio data length
         endTime_ = startTime_ + static_cast<int64_t>(audioData_->getNumFrames());
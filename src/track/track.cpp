@@ -3,6 +3,7 @@
 #include "pan/midi/midi_clip.h"
 #include "pan/midi/synthesizer.h"
 #include "pan/audio/audio_buffer.h"
+#include "pan/audio/scratch_arena.h"
 #include <algorithm>
 #include <cmath>
 
@@ -64,7 +65,14 @@ void Track::initializeSynthesizer(double sampleRate) {
     }
 }
 
-void Track::process(AudioBuffer& buffer, size_t numFrames) {
+void Track::prepare(size_t numChannels, size_t maxFrames) {
+    if (!fallbackBuffer_ || fallbackBuffer_->getNumChannels() < numChannels ||
+        fallbackBuffer_->getCapacity() < maxFrames) {
+        fallbackBuffer_ = std::make_unique<AudioBuffer>(numChannels, maxFrames);
+    }
+}
+
+void Track::process(AudioBuffer& buffer, size_t numFrames, ScratchArena* scratch) {
     if (muted_) {
         return;
     }
@@ -97,37 +105,39 @@ void Track::process(AudioBuffer& buffer, size_t numFrames) {
     
     // Process MIDI clips
     if (type_ == Type::MIDI && !midiClips_.empty()) {
-        // Initialize synthesizer if needed (requires sample rate - will be set later)
-        // For now, we'll create a temporary buffer for MIDI synthesis
-        AudioBuffer midiBuffer(buffer.getNumChannels(), numFrames);
-        
-        // Process MIDI events from all clips
-        std::vector<pan::MidiMessage> midiMessages;
-        for (auto& midiClip : midiClips_) {
-            if (!midiClip || !midiClip->isPlaying()) {
-                continue;
-            }
-            
-            // Get events in the current time range (simplified - assumes starting from 0)
-            // TODO: Use actual timeline position
-            const auto& events = midiClip->getEvents();
-            for (const auto& event : events) {
-                midiMessages.push_back(event.message);
+        AudioBuffer* midiBuffer = scratch ? scratch->acquire(numFrames) : nullptr;
+        if (!midiBuffer || midiBuffer->getNumChannels() < buffer.getNumChannels()) {
+            midiBuffer = nullptr;
+            if (fallbackBuffer_ && fallbackBuffer_->getNumChannels() >= buffer.getNumChannels() &&
+                fallbackBuffer_->setNumFrames(numFrames)) {
+                midiBuffer = fallbackBuffer_.get();
+                midiBuffer->clear();
             }
         }
         
-        // Process all MIDI messages through synthesizer
-        if (synthesizer_ && !midiMessages.empty()) {
-            synthesizer_->processMidiMessages(midiMessages);
+        // Queue MIDI events from all clips on the synthesizer
+        if (synthesizer_) {
+            for (auto& midiClip : midiClips_) {
+                if (!midiClip || !midiClip->isPlaying()) {
+                    continue;
+                }
+                
+                // Get events in the current time range (simplified - assumes starting from 0)
+                // TODO: Use actual timeline position
+                const auto& events = midiClip->getEvents();
+                for (const auto& event : events) {
+                    synthesizer_->processMidiMessage(event.message);
+                }
+            }
         }
         
-        // Generate audio from MIDI
-        if (synthesizer_) {
-            synthesizer_->generateAudio(midiBuffer, numFrames);
+        // Generate audio from MIDI; an idle synth adds nothing
+        if (midiBuffer && synthesizer_ && synthesizer_->isProducingAudio()) {
+            synthesizer_->generateAudio(*midiBuffer, numFrames);
             
             // Mix MIDI audio into output buffer
             for (size_t ch = 0; ch < buffer.getNumChannels(); ++ch) {
-                const float* midiSamples = midiBuffer.getReadPointer(ch);
+                const float* midiSamples = midiBuffer->getReadPointer(ch);
                 float* outputSamples = buffer.getWritePointer(ch);
                 
                 for (size_t i = 0; i < numFrames; ++i) {
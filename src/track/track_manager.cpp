@@ -28,12 +28,11 @@ std::shared_ptr<Track> TrackManager::getTrack(size_t index) const {
     return tracks_[index];
 }
 
-void TrackManager::processAllTracks(AudioBuffer& buffer, size_t numFrames) {
+void TrackManager::processAllTracks(AudioBuffer& buffer, size_t numFrames, ScratchArena* scratch) {
     // Process each track and mix into the buffer
     for (auto& track : tracks_) {
         if (track && !track->isMuted()) {
-            // TODO: Create temporary buffer for track processing
-            track->process(buffer, numFrames);
+            track->process(buffer, numFrames, scratch);
         }
     }
 }
@@ -1,5 +1,9 @@
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
 #include "pan/audio/audio_buffer.h"
+#include "pan/audio/buffer_kernels.h"
 
 void testAudioBufferCreation() {
     pan::AudioBuffer buffer(2, 1024);
@@ -21,9 +25,123 @@ void testAudioBufferOperations() {
     assert(data[0] == 0.5f);
 }
 
+void testAlignedStorage() {
+    pan::AudioBuffer buffer(3, 1000);
+    assert(buffer.getChannelStride() >= 1000);
+    assert(buffer.getChannelStride() % (pan::AudioBuffer::ALIGNMENT / sizeof(float)) == 0);
+    for (size_t ch = 0; ch < 3; ++ch) {
+        auto address = reinterpret_cast<uintptr_t>(buffer.getReadPointer(ch));
+        assert(address % pan::AudioBuffer::ALIGNMENT == 0);
+    }
+    assert(buffer.getWritePointer(3) == nullptr);
+}
+
+void testViews() {
+    pan::AudioBuffer buffer(2, 100);
+    pan::AudioBuffer view = buffer.createView(10, 20);
+    assert(view.isView());
+    assert(view.getNumFrames() == 20);
+    assert(view.getReadPointer(1) == buffer.getReadPointer(1) + 10);
+
+    // Writes through the view land in the parent, and only in its range
+    view.fill(1.0f);
+    assert(buffer.getReadPointer(0)[9] == 0.0f);
+    assert(buffer.getReadPointer(0)[10] == 1.0f);
+    assert(buffer.getReadPointer(1)[29] == 1.0f);
+    assert(buffer.getReadPointer(1)[30] == 0.0f);
+
+    // Ranges are clipped to the parent
+    assert(buffer.createView(90, 50).getNumFrames() == 10);
+    assert(buffer.createView(200, 5).getNumFrames() == 0);
+
+    // Copying a view produces an owning buffer
+    pan::AudioBuffer copy = view;
+    assert(!copy.isView());
+    assert(copy.getReadPointer(0)[0] == 1.0f);
+}
+
+void testCopyAndAddMismatchedSizes() {
+    pan::AudioBuffer source(2, 64);
+    source.fill(2.0f);
+
+    // Overlapping region is copied instead of silently skipping
+    pan::AudioBuffer smaller(1, 32);
+    smaller.copyFrom(source);
+    assert(smaller.getReadPointer(0)[31] == 2.0f);
+
+    pan::AudioBuffer larger(2, 128);
+    larger.addFrom(source, 0.5f);
+    larger.addFrom(source, 0.5f);
+    assert(larger.getReadPointer(1)[63] == 2.0f);
+    assert(larger.getReadPointer(1)[64] == 0.0f);
+
+    // Ranged add between channels
+    pan::AudioBuffer mono(1, 64);
+    mono.addFrom(0, 8, source, 1, 0, 1000, 0.25f);
+    assert(mono.getReadPointer(0)[7] == 0.0f);
+    assert(mono.getReadPointer(0)[8] == 0.5f);
+    assert(mono.getReadPointer(0)[63] == 0.5f);
+}
+
+void testGainRampsAndMeters() {
+    pan::AudioBuffer buffer(1, 100);
+    buffer.fill(1.0f);
+    buffer.applyGainRamp(0.0f, 1.0f);
+    const float* data = buffer.getReadPointer(0);
+    assert(data[0] == 0.0f);
+    assert(std::abs(data[50] - 0.5f) < 1e-6f);
+    assert(data[99] < 1.0f);
+
+    pan::AudioBuffer sine(1, 4800);
+    float* s = sine.getWritePointer(0);
+    for (size_t i = 0; i < 4800; ++i) {
+        s[i] = 0.8f * std::sin(2.0f * 3.14159265f * static_cast<float>(i) / 48.0f);
+    }
+    s[1234] = -0.95f;
+    assert(sine.getPeak(0) == 0.95f);
+    assert(std::abs(sine.getRMS(0) - 0.8f / std::sqrt(2.0f)) < 1e-3f);
+    assert(sine.getPeak(0, 0, 1000) < 0.95f);
+}
+
+void testKernelsMatchReference() {
+    // Odd lengths exercise the vector bodies and scalar tails
+    for (size_t n : {1u, 3u, 7u, 8u, 15u, 16u, 33u, 511u}) {
+        std::vector<float> src(n), dst(n), ref(n);
+        for (size_t i = 0; i < n; ++i) {
+            src[i] = std::sin(static_cast<float>(i) * 0.37f);
+            dst[i] = ref[i] = std::cos(static_cast<float>(i) * 0.11f);
+        }
+        pan::kernels::add(dst.data(), src.data(), 0.3f, n);
+        for (size_t i = 0; i < n; ++i) {
+            ref[i] += src[i] * 0.3f;
+            assert(dst[i] == ref[i]);
+        }
+
+        pan::kernels::addRamp(dst.data(), src.data(), 0.2f, 0.9f, n);
+        const float step = (0.9f - 0.2f) / static_cast<float>(n);
+        for (size_t i = 0; i < n; ++i) {
+            ref[i] += src[i] * (0.2f + step * static_cast<float>(i));
+            assert(dst[i] == ref[i]);
+        }
+
+        float expectedPeak = 0.0f;
+        double expectedSum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            expectedPeak = std::max(expectedPeak, std::abs(src[i]));
+            expectedSum += static_cast<double>(src[i]) * src[i];
+        }
+        assert(pan::kernels::peak(src.data(), n) == expectedPeak);
+        assert(std::abs(pan::kernels::sumSquares(src.data(), n) - expectedSum) < 1e-9);
+    }
+}
+
 int main() {
     testAudioBufferCreation();
     testAudioBufferOperations();
+    testAlignedStorage();
+    testViews();
+    testCopyAndAddMismatchedSizes();
+    testGainRampsAndMeters();
+    testKernelsMatchReference();
     return 0;
 }
-
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/audio_recorder.h"
+#include "pan/audio/spsc_ring_buffer.h"
+#include "test_wav_fixture.h"
+
+static std::vector<uint8_t> readFile(const std::string& path) {
+    std::vector<uint8_t> bytes;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    assert(file);
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + n);
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+static uint64_t getLE64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+void testRingWraparound() {
+    pan::SpscRingBuffer<int> ring(6);
+    assert(ring.getCapacity() == 8);
+
+    int in[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    int out[8] = {};
+    size_t moved = ring.write(in, 5);
+    assert(moved == 5);
+    moved = ring.read(out, 5);
+    assert(moved == 5);
+
+    // Next write straddles the end of the storage
+    moved = ring.write(in, 8);
+    assert(moved == 8);
+    assert(ring.availableWrite() == 0);
+    moved = ring.write(in, 1);
+    assert(moved == 0);
+    moved = ring.read(out, 8);
+    assert(moved == 8);
+    (void)moved;
+    for (int i = 0; i < 8; ++i) {
+        assert(out[i] == in[i]);
+    }
+    assert(ring.availableRead() == 0);
+}
+
+void testRingConcurrent() {
+    pan::SpscRingBuffer<uint32_t> ring(256);
+    const uint32_t total = 200000;
+
+    std::thread producer([&] {
+        uint32_t next = 0;
+        uint32_t block[37];
+        while (next < total) {
+            uint32_t n = std::min<uint32_t>(37, total - next);
+            for (uint32_t i = 0; i < n; ++i) {
+                block[i] = next + i;
+            }
+            next += static_cast<uint32_t>(ring.write(block, n));
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t block[64];
+    while (expected < total) {
+        size_t n = ring.read(block, 64);
+        for (size_t i = 0; i < n; ++i, ++expected) {
+            assert(block[i] == expected);
+        }
+    }
+    producer.join();
+}
+
+static void fillRamp(pan::AudioBuffer& buffer, size_t startFrame) {
+    for (size_t ch = 0; ch < buffer.getNumChannels(); ++ch) {
+        float* data = buffer.getWritePointer(ch);
+        for (size_t i = 0; i < buffer.getNumFrames(); ++i) {
+            data[i] = static_cast<float>((startFrame + i) % 1000) / 1000.0f * (ch == 0 ? 1.0f : -1.0f);
+        }
+    }
+}
+
+void testRecorderRoundTrip(pan::WavWriter::Container container, pan::WavWriter::Format format, float tolerance) {
+    pan::AudioRecorder recorder;
+    pan::AudioRecorder::Options options;
+    options.path = tempPath(container == pan::WavWriter::Container::W64 ? "take.w64" : "take.wav");
+    options.numChannels = 2;
+    options.sampleRate = 48000.0;
+    options.format = format;
+    options.container = container;
+    options.writeChunkFrames = 4096;
+    bool ok = recorder.start(options);
+    assert(ok);
+    assert(recorder.isRecording());
+
+    pan::AudioBuffer block(2, 300);
+    const size_t numBlocks = 100;
+    for (size_t b = 0; b < numBlocks; ++b) {
+        fillRamp(block, b * 300);
+        recorder.push(block, 300);
+        // Stay within the ring like a real-time producer would
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    ok = recorder.stop();
+    assert(ok);
+    (void)ok;
+    assert(!recorder.isRecording());
+    assert(recorder.getDroppedFrames() == 0);
+    assert(recorder.getFramesRecorded() == numBlocks * 300);
+
+    // Pushes after stop() are ignored
+    recorder.push(block, 300);
+    assert(recorder.getFramesRecorded() == numBlocks * 300);
+
+    auto take = recorder.readTake();
+    assert(take);
+    assert(take->getNumChannels() == 2);
+    assert(take->getNumFrames() == numBlocks * 300);
+    pan::AudioBuffer expected(2, numBlocks * 300);
+    fillRamp(expected, 0);
+    for (size_t ch = 0; ch < 2; ++ch) {
+        for (size_t i = 0; i < numBlocks * 300; ++i) {
+            assert(std::fabs(take->getReadPointer(ch)[i] - expected.getReadPointer(ch)[i]) <= tolerance);
+        }
+    }
+    std::remove(options.path.c_str());
+}
+
+void testW64Header() {
+    pan::WavWriter writer;
+    std::string path = tempPath("header.w64");
+    bool ok = writer.open(path, 3, 44100.0, pan::WavWriter::Format::PCM24, pan::WavWriter::Container::W64);
+    assert(ok);
+    assert(writer.getDataOffset() == 104);
+    writer.preallocate(44100);
+
+    std::vector<float> samples(3 * 5, 0.25f);
+    ok = writer.writeInterleaved(samples.data(), 5);
+    assert(ok);
+    ok = writer.close();
+    assert(ok);
+    (void)ok;
+
+    std::vector<uint8_t> bytes = readFile(path);
+    const uint64_t dataBytes = 5 * 3 * 3;
+    const uint64_t padded = (dataBytes + 7) & ~uint64_t(7);
+    assert(bytes.size() == 104 + padded);
+    assert(std::memcmp(bytes.data(), "riff", 4) == 0);
+    assert(getLE64(bytes.data() + 16) == bytes.size());
+    assert(std::memcmp(bytes.data() + 24, "wave", 4) == 0);
+    assert(std::memcmp(bytes.data() + 40, "fmt ", 4) == 0);
+    assert(getLE64(bytes.data() + 56) == 40);
+    assert(bytes[66] == 3);  // Channels
+    assert(std::memcmp(bytes.data() + 80, "data", 4) == 0);
+    assert(getLE64(bytes.data() + 96) == 24 + dataBytes);
+    std::remove(path.c_str());
+}
+
+void testDroppedFrames() {
+    pan::AudioRecorder recorder;
+    pan::AudioRecorder::Options options;
+    options.path = tempPath("dropped.wav");
+    options.numChannels = 1;
+    options.ringSeconds = 0.0;       // Smallest ring: two write chunks
+    options.writeChunkFrames = 1024;
+    bool ok = recorder.start(options);
+    assert(ok);
+
+    // Far more than the ring holds in one burst; push() drops instead of waiting
+    pan::AudioBuffer block(1, 64 * 1024);
+    block.fill(0.5f);
+    recorder.push(block, block.getNumFrames());
+    assert(recorder.getDroppedFrames() > 0);
+    uint64_t dropped = recorder.getDroppedFrames();
+
+    ok = recorder.stop();
+    assert(ok);
+    (void)ok;
+    assert(recorder.getFramesRecorded() + dropped == block.getNumFrames());
+    std::remove(options.path.c_str());
+}
+
+void testEnginePushesInput() {
+    pan::AudioEngine engine;
+    pan::StreamConfig config = engine.getStreamConfig();
+    config.duplex = true;
+    bool ok = engine.setStreamConfig(config);
+    assert(ok);
+    engine.setProcessCallback([](pan::AudioBuffer&, pan::AudioBuffer& output, size_t) { output.clear(); });
+    ok = engine.start();
+    assert(ok);
+
+    pan::AudioRecorder::Options options;
+    options.path = tempPath("engine.wav");
+    options.numChannels = 2;
+    options.format = pan::WavWriter::Format::Float32;
+    ok = engine.getRecorder().start(options);
+    assert(ok);
+    (void)ok;
+
+    float deviceInput[2 * 128];
+    float deviceOutput[2 * 128];
+    for (size_t i = 0; i < 128; ++i) {
+        deviceInput[2 * i] = 0.25f;
+        deviceInput[2 * i + 1] = -0.5f;
+    }
+    for (int block = 0; block < 4; ++block) {
+        engine.processDeviceBlock(deviceInput, deviceOutput, 128);
+    }
+
+    // stop() finishes the take
+    engine.stop();
+    assert(!engine.getRecorder().isRecording());
+    auto take = engine.getRecorder().readTake();
+    assert(take && take->getNumFrames() == 4 * 128);
+    assert(take->getReadPointer(0)[100] == 0.25f);
+    assert(take->getReadPointer(1)[300] == -0.5f);
+    std::remove(options.path.c_str());
+}
+
+int main() {
+    testRingWraparound();
+    testRingConcurrent();
+    testRecorderRoundTrip(pan::WavWriter::Container::Wav, pan::WavWriter::Format::Float32, 0.0f);
+    testRecorderRoundTrip(pan::WavWriter::Container::W64, pan::WavWriter::Format::PCM16, 1.0f / 16384.0f);
+    testRecorderRoundTrip(pan::WavWriter::Container::Wav, pan::WavWriter::Format::PCM24, 1.0f / 4000000.0f);
+    testW64Header();
+    testDroppedFrames();
+    testEnginePushesInput();
+    return 0;
+}
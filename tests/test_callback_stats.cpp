@@ -0,0 +1,106 @@
+#include <cassert>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/callback_stats.h"
+
+void testRecordAndSnapshot() {
+    pan::CallbackStats stats;
+    // 512 frames at 48 kHz is a 10.67 ms budget
+    stats.record(0.002, 512, 48000.0, 0);
+    stats.record(0.004, 512, 48000.0, pan::CallbackStats::OutputUnderflow);
+    stats.record(0.020, 512, 48000.0, pan::CallbackStats::InputOverflow | pan::CallbackStats::OutputUnderflow);
+
+    pan::CallbackStatsSnapshot snap = stats.snapshot();
+    assert(snap.callbacks == 3);
+    assert(snap.framesProcessed == 3 * 512);
+    assert(snap.deadlineMisses == 1);
+    assert(snap.outputUnderflows == 2);
+    assert(snap.inputOverflows == 1);
+    assert(snap.inputUnderflows == 0 && snap.outputOverflows == 0);
+    assert(snap.getXrunCount() == 3);
+    assert(snap.maxDurationSeconds == 0.020);
+    assert(snap.lastDurationSeconds == 0.020);
+    assert(std::fabs(snap.averageDurationSeconds - 0.026 / 3.0) < 1e-6);
+    assert(std::fabs(snap.peakLoad - 0.020 / (512.0 / 48000.0)) < 1e-9);
+    assert(snap.load > 0.0 && snap.load < snap.peakLoad);
+
+    // 2000us -> [1024, 2048), 4000us -> [2048, 4096), 20000us -> [16384, 32768)
+    assert(snap.durationHistogram[10] == 1);
+    assert(snap.durationHistogram[11] == 1);
+    assert(snap.durationHistogram[14] == 1);
+    assert(pan::CallbackStatsSnapshot::getBinLowerMicros(10) == 1024.0);
+
+    // Reset applies on the next record, from the writer's side
+    stats.reset();
+    stats.record(0.0000005, 64, 48000.0, 0);
+    snap = stats.snapshot();
+    assert(snap.callbacks == 1 && snap.getXrunCount() == 0);
+    assert(snap.durationHistogram[0] == 1 && snap.durationHistogram[14] == 0);
+}
+
+void testJson() {
+    pan::CallbackStats stats;
+    stats.record(0.001, 256, 44100.0, pan::CallbackStats::OutputUnderflow, 0.012);
+    std::string json = stats.snapshot().toJson();
+    assert(json.front() == '{' && json.back() == '}');
+    assert(json.find("\"callbacks\":1") != std::string::npos);
+    assert(json.find("\"outputUnderflows\":1") != std::string::npos);
+    assert(json.find("\"outputLatencyMs\":12") != std::string::npos);
+    assert(json.find("\"durationHistogram\":[{\"fromUs\":0,") != std::string::npos);
+}
+
+void testConcurrentPolling() {
+    pan::CallbackStats stats;
+    std::thread writer([&] {
+        for (int i = 0; i < 20000; ++i) {
+            uint32_t flags = (i % 100 == 0) ? static_cast<uint32_t>(pan::CallbackStats::OutputUnderflow) : 0u;
+            stats.record(0.001, 128, 48000.0, flags);
+        }
+    });
+    uint64_t lastCount = 0;
+    while (lastCount < 20000) {
+        pan::CallbackStatsSnapshot snap = stats.snapshot();
+        assert(snap.callbacks >= lastCount);
+        lastCount = snap.callbacks;
+    }
+    writer.join();
+    assert(stats.snapshot().outputUnderflows == 200);
+}
+
+void testEngineRecordsDeviceBlocks() {
+    pan::AudioEngine engine;
+    engine.setProcessCallback([](pan::AudioBuffer&, pan::AudioBuffer& output, size_t) { output.fill(0.1f); });
+    bool started = engine.start();
+    assert(started);
+
+    std::vector<float> device(2 * 256);
+    engine.processDeviceBlock(nullptr, device.data(), 256);
+    engine.processDeviceBlock(nullptr, device.data(), 256, pan::CallbackStats::OutputUnderflow);
+
+    pan::CallbackStatsSnapshot snap = engine.getCallbackStats();
+    assert(snap.callbacks == 2);
+    assert(snap.framesProcessed == 512);
+    assert(snap.outputUnderflows == 1);
+    assert(snap.lastDurationSeconds > 0.0);
+
+    // start() resets the counters
+    engine.stop();
+    started = engine.start();
+    assert(started);
+    (void)started;
+    engine.processDeviceBlock(nullptr, device.data(), 256);
+    assert(engine.getCallbackStats().callbacks == 1);
+    engine.stop();
+}
+
+int main() {
+    testRecordAndSnapshot();
+    testJson();
+    testConcurrentPolling();
+    testEngineRecordsDeviceBlocks();
+    return 0;
+}
@@ -0,0 +1,292 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/device_io.h"
+
+static void fillRamp(pan::AudioBuffer& buffer) {
+    for (size_t ch = 0; ch < buffer.getNumChannels(); ++ch) {
+        float* data = buffer.getWritePointer(ch);
+        for (size_t i = 0; i < buffer.getNumFrames(); ++i) {
+            data[i] = (static_cast<float>(i % 200) / 100.0f - 1.0f) * (ch % 2 ? -0.5f : 0.75f);
+        }
+    }
+}
+
+void testFloatRoundTrip() {
+    // Stereo takes the vectorised path, 1/3/6 channels the generic ones; odd frame counts hit the tails
+    for (size_t channels : {1u, 2u, 3u, 6u}) {
+        pan::AudioBuffer source(channels, 37);
+        fillRamp(source);
+        std::vector<float> device(channels * 37, -9.0f);
+
+        pan::DeviceIoConverter converter;
+        converter.interleave(source, 0, device.data(), channels, 37);
+        for (size_t i = 0; i < 37; ++i) {
+            for (size_t ch = 0; ch < channels; ++ch) {
+                assert(device[i * channels + ch] == source.getReadPointer(ch)[i]);
+            }
+        }
+
+        pan::AudioBuffer dest(channels, 37);
+        converter.deinterleave(device.data(), channels, dest, 0, 37);
+        for (size_t ch = 0; ch < channels; ++ch) {
+            for (size_t i = 0; i < 37; ++i) {
+                assert(dest.getReadPointer(ch)[i] == source.getReadPointer(ch)[i]);
+            }
+        }
+    }
+}
+
+void testChannelMismatch() {
+    pan::DeviceIoConverter converter;
+
+    // Mono buffer into a 4-channel device: missing channels are silent
+    pan::AudioBuffer mono(1, 8);
+    mono.fill(0.25f);
+    std::vector<float> device(4 * 8, 1.0f);
+    converter.interleave(mono, 0, device.data(), 4, 8);
+    for (size_t i = 0; i < 8; ++i) {
+        assert(device[i * 4] == 0.25f);
+        assert(device[i * 4 + 1] == 0.0f && device[i * 4 + 3] == 0.0f);
+    }
+
+    // Frames past the end of the source are silent too
+    std::vector<float> longer(4 * 12, 1.0f);
+    converter.interleave(mono, 0, longer.data(), 4, 12);
+    for (size_t i = 8 * 4; i < longer.size(); ++i) {
+        assert(longer[i] == 0.0f);
+    }
+
+    // Stereo device into a 3-channel buffer: the extra channel is cleared
+    pan::AudioBuffer dest(3, 8);
+    dest.fill(0.9f);
+    converter.deinterleave(device.data(), 2, dest, 0, 8);
+    assert(dest.getReadPointer(0)[0] == 0.25f);
+    assert(dest.getReadPointer(2)[5] == 0.0f);
+}
+
+void testInt16() {
+    pan::DeviceIoConverter converter;
+    converter.setFormat(pan::SampleFormat::Int16);
+
+    pan::AudioBuffer source(2, 9);
+    float* left = source.getWritePointer(0);
+    float* right = source.getWritePointer(1);
+    const float values[9] = {0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 1.0f / 32768.0f, -0.25f};
+    for (size_t i = 0; i < 9; ++i) {
+        left[i] = values[i];
+        right[i] = -values[i];
+    }
+
+    int16_t device[18];
+    converter.interleave(source, 0, device, 2, 9);
+    assert(device[0] == 0);
+    assert(device[2] == 16384 && device[3] == -16384);
+    assert(device[6] == 32767);              // +1.0 clips to the largest code
+    assert(device[8] == -32768);
+    assert(device[10] == 32767 && device[11] == -32768);
+    assert(device[12] == -32768 && device[13] == 32767);
+    assert(device[14] == 1);
+
+    // Integer samples convert back exactly
+    pan::AudioBuffer dest(2, 9);
+    converter.deinterleave(device, 2, dest, 0, 9);
+    assert(dest.getReadPointer(0)[1] == 0.5f);
+    assert(dest.getReadPointer(1)[1] == -0.5f);
+    assert(dest.getReadPointer(0)[4] == -1.0f);
+    assert(dest.getReadPointer(0)[8] == -0.25f);
+
+    // The generic (3-channel) path agrees with the stereo one
+    pan::AudioBuffer wide(3, 9);
+    wide.copyFrom(source);
+    int16_t wideDevice[27];
+    converter.interleave(wide, 0, wideDevice, 3, 9);
+    for (size_t i = 0; i < 9; ++i) {
+        assert(wideDevice[i * 3] == device[i * 2]);
+        assert(wideDevice[i * 3 + 1] == device[i * 2 + 1]);
+    }
+}
+
+void testInt24AndInt32() {
+    pan::AudioBuffer source(2, 4);
+    const float values[4] = {0.5f, -1.0f, 3.0f, -0.125f};
+    for (size_t i = 0; i < 4; ++i) {
+        source.getWritePointer(0)[i] = values[i];
+        source.getWritePointer(1)[i] = -values[i];
+    }
+
+    pan::DeviceIoConverter converter;
+    converter.setFormat(pan::SampleFormat::Int24);
+    uint8_t packed[4 * 2 * 3];
+    converter.interleave(source, 0, packed, 2, 4);
+    // 0.5 -> 0x400000 little endian
+    assert(packed[0] == 0x00 && packed[1] == 0x00 && packed[2] == 0x40);
+    // 3.0 clips to 0x7FFFFF
+    assert(packed[12] == 0xFF && packed[13] == 0xFF && packed[14] == 0x7F);
+
+    pan::AudioBuffer dest(2, 4);
+    converter.deinterleave(packed, 2, dest, 0, 4);
+    assert(dest.getReadPointer(0)[0] == 0.5f);
+    assert(dest.getReadPointer(1)[0] == -0.5f);
+    assert(dest.getReadPointer(0)[1] == -1.0f);
+    assert(dest.getReadPointer(0)[3] == -0.125f);
+
+    converter.setFormat(pan::SampleFormat::Int32);
+    int32_t wide[8];
+    converter.interleave(source, 0, wide, 2, 4);
+    assert(wide[0] == 1073741824);
+    assert(wide[2] == INT32_MIN);
+    assert(wide[4] == INT32_MAX && wide[5] == INT32_MIN);
+    converter.deinterleave(wide, 2, dest, 0, 4);
+    assert(dest.getReadPointer(0)[0] == 0.5f);
+    assert(dest.getReadPointer(0)[3] == -0.125f);
+}
+
+void testDither() {
+    pan::DeviceIoConverter converter;
+    converter.setFormat(pan::SampleFormat::Int16);
+    converter.setDitherEnabled(true);
+
+    // Dither stays within +/-1 LSB and averages out to the input
+    pan::AudioBuffer source(2, 4096);
+    source.fill(100.25f / 32768.0f);
+    std::vector<int16_t> device(2 * 4096);
+    converter.interleave(source, 0, device.data(), 2, 4096);
+    double sum = 0.0;
+    bool varied = false;
+    for (int16_t sample : device) {
+        assert(sample >= 99 && sample <= 101);
+        varied = varied || sample != device[0];
+        sum += sample;
+    }
+    assert(varied);
+    assert(std::fabs(sum / static_cast<double>(device.size()) - 100.25) < 0.05);
+
+    // Float output is never dithered
+    converter.setFormat(pan::SampleFormat::Float32);
+    std::vector<float> floats(2 * 4096);
+    converter.interleave(source, 0, floats.data(), 2, 4096);
+    assert(floats[17] == source.getReadPointer(0)[0]);
+}
+
+void testEngineChunksLargeBlocks() {
+    pan::AudioEngine engine;
+    pan::StreamConfig config = engine.getStreamConfig();
+    config.bufferSize = 64;
+    config.duplex = true;  // The callback passes the input through
+    config.format = pan::SampleFormat::Int16;
+    bool ok = engine.setStreamConfig(config);
+    assert(ok);
+    ok = engine.start();
+    assert(ok);
+    (void)ok;
+    const size_t maxBlock = engine.getOutputBuffer()->getCapacity();
+    assert(maxBlock == engine.getMaxBlockSize());
+
+    std::vector<size_t> blockSizes;
+    blockSizes.reserve(8);
+    engine.setProcessCallback([&](pan::AudioBuffer& input, pan::AudioBuffer& output, size_t numFrames) {
+        blockSizes.push_back(numFrames);
+        assert(output.getNumFrames() == numFrames);
+        for (size_t ch = 0; ch < 2; ++ch) {
+            output.copyFrom(ch, 0, input, ch, 0, numFrames);
+            output.applyGain(ch, 0, numFrames, 0.5f);
+        }
+    });
+
+    // A device block larger than the staging buffers is processed in chunks, in order
+    const size_t frames = maxBlock * 2 + 10;
+    std::vector<int16_t> in(frames * 2), out(frames * 2, 7);
+    for (size_t i = 0; i < frames; ++i) {
+        in[i * 2] = static_cast<int16_t>(i % 1000) * 2;
+        in[i * 2 + 1] = -static_cast<int16_t>(i % 1000) * 2;
+    }
+    engine.processDeviceBlock(in.data(), out.data(), frames);
+
+    assert(blockSizes.size() == 3);
+    assert(blockSizes[0] == maxBlock && blockSizes[2] == 10);
+    assert(engine.getOutputBuffer()->getCapacity() == maxBlock);
+    for (size_t i = 0; i < frames * 2; ++i) {
+        assert(out[i] == in[i] / 2);
+    }
+
+    // No input: the callback sees silence
+    engine.processDeviceBlock(nullptr, out.data(), 100);
+    assert(out[0] == 0 && out[199] == 0);
+    engine.stop();
+}
+
+void testStreamConfig() {
+    pan::AudioEngine engine;
+    pan::StreamConfig config = engine.getStreamConfig();
+    assert(config.hostApi == pan::StreamConfig::HostApi::Default);
+    assert(config.sampleRate == engine.getSampleRate());
+    assert(config.dither == pan::StreamConfig().dither);  // Same default as the converter
+
+    config.hostApi = pan::StreamConfig::HostApi::Jack;
+    config.sampleRate = 48000.0;
+    config.bufferSize = 64;
+    config.suggestedLatency = 0.003;
+    config.duplex = true;
+    config.format = pan::SampleFormat::Int24;
+    bool accepted = engine.setStreamConfig(config);
+    assert(accepted);
+    assert(engine.getSampleRate() == 48000.0);
+    assert(engine.getBufferSize() == 64);
+    assert(engine.getDeviceFormat() == pan::SampleFormat::Int24);
+
+    // The individual setters and the config stay in sync
+    engine.setBufferSize(128);
+    pan::StreamConfig current = engine.getStreamConfig();
+    assert(current.bufferSize == 128);
+    assert(current.hostApi == pan::StreamConfig::HostApi::Jack);
+    assert(current.duplex && current.suggestedLatency == 0.003);
+
+    pan::StreamConfig invalid = current;
+    invalid.numChannels = 0;
+    accepted = engine.setStreamConfig(invalid);
+    assert(!accepted);
+
+    // Locked while the engine renders. An offline render holds the same lock
+    // as a running stream without needing an audio device.
+    pan::StreamConfig changed = current;
+    changed.sampleRate = 96000.0;
+    changed.format = pan::SampleFormat::Int16;
+    bool refused = false;
+    pan::OfflineRenderOptions options;
+    options.totalFrames = 1024;
+    options.sink = [&](const pan::AudioBuffer&, size_t) {
+        refused = !engine.setStreamConfig(changed) && !engine.setDeviceFormat(pan::SampleFormat::Int16);
+        engine.setSampleRate(96000.0);
+        engine.setBufferSize(256);
+        return true;
+    };
+    engine.setProcessCallback([](pan::AudioBuffer&, pan::AudioBuffer& output, size_t) { output.clear(); });
+    bool completed = engine.renderOffline(options);
+    assert(completed);
+    (void)completed;
+    assert(refused);
+    assert(engine.getSampleRate() == 48000.0 && engine.getBufferSize() == 128);
+    assert(engine.getDeviceFormat() == pan::SampleFormat::Int24);
+    assert(!engine.getStreamInfo().open);
+
+    // And free again once it's done
+    accepted = engine.setStreamConfig(changed);
+    assert(accepted);
+    (void)accepted;
+    assert(engine.getSampleRate() == 96000.0 && engine.getDeviceFormat() == pan::SampleFormat::Int16);
+}
+
+int main() {
+    testFloatRoundTrip();
+    testChannelMismatch();
+    testInt16();
+    testInt24AndInt32();
+    testDither();
+    testEngineChunksLargeBlocks();
+    testStreamConfig();
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/bit_noise_texture.h"
+#include "pan/audio/chorus.h"
+#include "pan/audio/eq8.h"
+#include "pan/audio/resonator_bank.h"
+#include "pan/audio/reverb.h"
+#include "pan/audio/wow_flutter.h"
+
+static const double SAMPLE_RATE = 48000.0;
+static const size_t BLOCK = 512;
+
+// Feed a burst, then silence for the effect's reported tail; whatever is left must be inaudible
+static float peakAfterTail(pan::Effect& effect) {
+    pan::AudioBuffer buffer(2, BLOCK);
+    for (size_t b = 0; b < 10; ++b) {
+        for (size_t ch = 0; ch < 2; ++ch) {
+            float* samples = buffer.getWritePointer(ch);
+            for (size_t i = 0; i < BLOCK; ++i) {
+                samples[i] = 0.5f * std::sin(0.05f * static_cast<float>(b * BLOCK + i));
+            }
+        }
+        effect.process(buffer, BLOCK);
+    }
+
+    double tail = effect.getTailSeconds();
+    assert(std::isfinite(tail));
+    size_t tailBlocks = static_cast<size_t>(std::ceil(tail * SAMPLE_RATE / BLOCK));
+    for (size_t b = 0; b < tailBlocks; ++b) {
+        buffer.clear();
+        effect.process(buffer, BLOCK);
+    }
+
+    float peak = 0.0f;
+    for (size_t b = 0; b < 4; ++b) {
+        buffer.clear();
+        effect.process(buffer, BLOCK);
+        peak = std::max({peak, buffer.getPeak(0, 0, BLOCK), buffer.getPeak(1, 0, BLOCK)});
+    }
+    return peak;
+}
+
+void testTailsCoverRinging() {
+    pan::Reverb reverb(SAMPLE_RATE);
+    reverb.setRoomSize(1.0f);
+    reverb.setDamping(0.0f);
+    reverb.setWetLevel(1.0f);
+    assert(reverb.getTailSeconds() > 1.0);
+    assert(peakAfterTail(reverb) < 1e-3f);
+
+    pan::ResonatorBank resonator(SAMPLE_RATE);
+    resonator.setDecay(0.99f);
+    assert(peakAfterTail(resonator) < 1e-3f);
+
+    pan::Chorus chorus(SAMPLE_RATE);
+    assert(peakAfterTail(chorus) < 1e-3f);
+
+    pan::WowFlutter wowFlutter(SAMPLE_RATE);
+    assert(peakAfterTail(wowFlutter) < 1e-3f);
+
+    pan::EQ8 eq(SAMPLE_RATE);
+    assert(peakAfterTail(eq) < 1e-3f);
+}
+
+void testNoiseNeverSleeps() {
+    pan::BitNoiseTexture texture(SAMPLE_RATE);
+    assert(std::isinf(texture.getTailSeconds()));
+    texture.setNoise(0.0f);
+    assert(texture.getTailSeconds() == 0.0);
+}
+
+int main() {
+    testTailsCoverRinging();
+    testNoiseNeverSleeps();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cmath>
+#include <initializer_list>
+#include "pan/dsp/fast_math.h"
+
+namespace approx = pan::dsp::approx;
+
+// Largest error of f against reference over n points in [lo, hi], absolute or relative
+template <typename F, typename R>
+static double maxError(F f, R reference, double lo, double hi, bool relative, int n = 200000) {
+    double worst = 0.0;
+    for (int i = 0; i <= n; ++i) {
+        float x = static_cast<float>(lo + (hi - lo) * i / n);
+        double expected = reference(static_cast<double>(x));
+        double error = std::fabs(static_cast<double>(f(x)) - expected);
+        if (relative) {
+            error /= std::fabs(expected);
+        }
+        worst = std::max(worst, error);
+    }
+    return worst;
+}
+
+void testExpLog() {
+    assert(maxError(approx::exp2, [](double x) { return std::exp2(x); }, -126.0, 126.0, true) < 3e-7);
+    assert(maxError(approx::exp2, [](double x) { return std::exp2(x); }, -1.0, 1.0, true) < 3e-7);
+    assert(maxError(approx::exp, [](double x) { return std::exp(x); }, -1.0, 1.0, true) < 3e-7 + 6e-8);
+    assert(maxError(approx::exp, [](double x) { return std::exp(x); }, -87.0, 87.0, true) < 3e-7 + 6e-8 * 87.0);
+    assert(maxError(approx::log2, [](double x) { return std::log2(x); }, 0.5, 2.0, false) < 2e-7 + 6e-8);
+    assert(maxError(approx::log2, [](double x) { return std::log2(x); }, 0.001, 4.0, false) < 2e-7 + 6e-8 * 10.0);
+    assert(maxError(approx::log2, [](double x) { return std::log2(x); }, 1e-30, 1e-20, false) < 2e-7 + 6e-8 * 100.0);
+    assert(maxError(approx::log2, [](double x) { return std::log2(x); }, 1.0, 1e30, false) < 2e-7 + 6e-8 * 100.0);
+    assert(approx::exp2(0.0f) == 1.0f);
+    assert(approx::exp2(-1000.0f) > 0.0f);
+}
+
+void testPow() {
+    // Semitone and cutoff curves, the uses in the synth
+    auto semitones = [](float s) { return approx::pow(2.0f, s / 12.0f); };
+    assert(maxError(semitones, [](double s) { return std::pow(2.0, s / 12.0); }, -48.0, 48.0, true) < 3e-7 * 5.0);
+    auto cutoff = [](float c) { return approx::pow(1000.0f, c); };
+    assert(maxError(cutoff, [](double c) { return std::pow(1000.0, c); }, 0.0, 1.0, true) < 3e-7 * 11.0);
+    assert(approx::pow(0.0f, 2.0f) == 0.0f);
+}
+
+void testSinCos() {
+    const double pi = 3.14159265358979;
+    assert(maxError(approx::sin, [](double x) { return std::sin(x); }, -2.0 * pi, 2.0 * pi, false) < 1e-6);
+    assert(maxError(approx::cos, [](double x) { return std::cos(x); }, -2.0 * pi, 2.0 * pi, false) < 1e-6);
+    assert(maxError(approx::sin, [](double x) { return std::sin(x); }, -1e4, 1e4, false, 2000000) < 1e-6);
+    assert(maxError(approx::cos, [](double x) { return std::cos(x); }, -1e4, 1e4, false, 2000000) < 1e-6);
+    assert(approx::sin(0.0f) == 0.0f);
+}
+
+void testTanh() {
+    assert(maxError(approx::tanh, [](double x) { return std::tanh(x); }, -20.0, 20.0, false) < 2e-7);
+    assert(maxError(approx::tanh, [](double x) { return std::tanh(x); }, -1e-3, 1e-3, true) < 1e-6);
+    for (float x : {0.5f, 3.0f, 9.0f, 50.0f, 1e30f}) {
+        assert(approx::tanh(-x) == -approx::tanh(x));
+        assert(std::fabs(approx::tanh(x)) <= 1.0f);
+    }
+}
+
+void testDecibels() {
+    assert(maxError(approx::dbToGain, [](double db) { return std::pow(10.0, db / 20.0); }, -144.0, 24.0, true) < 1e-6);
+    assert(maxError(approx::gainToDb, [](double g) { return 20.0 * std::log10(g); }, 1e-7, 16.0, false) < 1e-5);
+    assert(approx::dbToGain(0.0f) == 1.0f);
+}
+
+// The plain names pick the approximation, or libm in a reference build
+void testDispatch() {
+#ifdef PAN_REFERENCE_MATH
+    assert(pan::dsp::tanh(0.7f) == std::tanh(0.7f));
+    assert(pan::dsp::sin(2.5f) == std::sin(2.5f));
+#else
+    assert(pan::dsp::tanh(0.7f) == approx::tanh(0.7f));
+    assert(pan::dsp::sin(2.5f) == approx::sin(2.5f));
+#endif
+}
+
+int main() {
+    testExpLog();
+    testPow();
+    testSinCos();
+    testTanh();
+    testDecibels();
+    testDispatch();
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <cassert>
+#include <cmath>
+#include <string>
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/distortion.h"
+#include "pan/audio/eq8.h"
+#include "pan/audio/frozen_audio.h"
+#include "pan/audio/parameter_hash.h"
+#include "pan/audio/reverb.h"
+#include "pan/audio/sampler.h"
+#include "pan/midi/synthesizer.h"
+
+// Render whose frame n holds n (left) and -n (right)
+static pan::FrozenAudio makeRamp(size_t frames) {
+    pan::AudioBuffer audio(2, frames);
+    for (size_t i = 0; i < frames; ++i) {
+        audio.getWritePointer(0)[i] = static_cast<float>(i);
+        audio.getWritePointer(1)[i] = -static_cast<float>(i);
+    }
+    return pan::FrozenAudio(std::move(audio), 1234);
+}
+
+void testReadInsideRender() {
+    pan::FrozenAudio frozen = makeRamp(1000);
+    assert(frozen.getFingerprint() == 1234);
+    assert(frozen.getNumFrames() == 1000);
+
+    pan::AudioBuffer dest(2, 64);
+    frozen.read(dest, 100, 64);
+    for (size_t i = 0; i < 64; ++i) {
+        assert(dest.getReadPointer(0)[i] == static_cast<float>(100 + i));
+        assert(dest.getReadPointer(1)[i] == -static_cast<float>(100 + i));
+    }
+}
+
+void testReadAtEdges() {
+    pan::FrozenAudio frozen = makeRamp(1000);
+    pan::AudioBuffer dest(2, 64);
+
+    // Straddling the end: the overrun is silent, not stale
+    dest.fill(7.0f);
+    frozen.read(dest, 980, 64);
+    for (size_t i = 0; i < 64; ++i) {
+        float expected = i < 20 ? static_cast<float>(980 + i) : 0.0f;
+        assert(dest.getReadPointer(0)[i] == expected);
+    }
+
+    // Straddling the start
+    dest.fill(7.0f);
+    frozen.read(dest, -10, 64);
+    for (size_t i = 0; i < 64; ++i) {
+        float expected = i < 10 ? 0.0f : static_cast<float>(i - 10);
+        assert(dest.getReadPointer(0)[i] == expected);
+    }
+
+    // Entirely past the end
+    dest.fill(7.0f);
+    assert(!frozen.covers(1000, 64));
+    frozen.read(dest, 1000, 64);
+    assert(dest.getPeak(0) == 0.0f && dest.getPeak(1) == 0.0f);
+    assert(frozen.covers(999, 64));
+    assert(!frozen.covers(-64, 64));
+}
+
+void testMonoRenderFeedsBothChannels() {
+    pan::AudioBuffer mono(1, 100);
+    mono.fill(0.5f);
+    pan::FrozenAudio frozen(std::move(mono), 1);
+    pan::AudioBuffer dest(2, 32);
+    frozen.read(dest, 0, 32);
+    assert(dest.getReadPointer(0)[5] == 0.5f);
+    assert(dest.getReadPointer(1)[5] == 0.5f);
+}
+
+void testParameterHash() {
+    using pan::ParameterHash;
+    assert(ParameterHash().add(1.0f).add(2.0f).get() == ParameterHash().add(1.0f).add(2.0f).get());
+    assert(ParameterHash().add(1.0f).add(2.0f).get() != ParameterHash().add(2.0f).add(1.0f).get());
+    assert(ParameterHash().add(0.0f).get() == ParameterHash().add(-0.0f).get());
+    assert(ParameterHash().add(0.5f).get() != ParameterHash().add(0.50001f).get());
+    // Doubles keep all their bits: these two round to the same float
+    assert(ParameterHash().add(0.0).get() == ParameterHash().add(-0.0).get());
+    assert(ParameterHash().add(48000.0).get() != ParameterHash().add(48000.001).get());
+    // Strings are length-prefixed, so how values split between them matters
+    assert(ParameterHash().add(std::string("ab")).add(std::string("c")).get() !=
+           ParameterHash().add(std::string("a")).add(std::string("bc")).get());
+    assert(ParameterHash().add(true).get() != ParameterHash().add(false).get());
+}
+
+template <typename T>
+static uint64_t fingerprint(const T& object) {
+    pan::ParameterHash hash;
+    object.hashParameters(hash);
+    return hash.get();
+}
+
+void testEditsChangeFingerprints() {
+    pan::Reverb reverb(48000.0);
+    uint64_t before = fingerprint(reverb);
+    assert(fingerprint(reverb) == before);
+    reverb.setRoomSize(reverb.getRoomSize() * 0.5f);
+    assert(fingerprint(reverb) != before);
+
+    pan::Distortion distortion(48000.0);
+    before = fingerprint(distortion);
+    distortion.setType(pan::Distortion::Type::Fuzz);
+    assert(fingerprint(distortion) != before);
+
+    pan::EQ8 eq(48000.0);
+    before = fingerprint(eq);
+    eq.getBand(3).gain = 6.0f;
+    assert(fingerprint(eq) != before);
+
+    pan::Synthesizer synth(48000.0);
+    before = fingerprint(synth);
+    synth.getOscillators()[0].detune = 5.0f;
+    assert(fingerprint(synth) != before);
+    uint64_t detuned = fingerprint(synth);
+    synth.getEnvelope().filter.cutoff = 0.3f;
+    assert(fingerprint(synth) != detuned);
+
+    // Playing notes is not an edit
+    detuned = fingerprint(synth);
+    synth.noteOn(60, 100);
+    pan::AudioBuffer buffer(2, 256);
+    synth.generateAudio(buffer, 256);
+    assert(fingerprint(synth) == detuned);
+
+    pan::Sampler sampler(48000.0);
+    before = fingerprint(sampler);
+    sampler.getParams().transpose = 7;
+    assert(fingerprint(sampler) != before);
+}
+
+int main() {
+    testReadInsideRender();
+    testReadAtEdges();
+    testMonoRenderFeedsBothChannels();
+    testParameterHash();
+    testEditsChangeFingerprints();
+    return 0;
+}
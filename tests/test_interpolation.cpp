@@ -0,0 +1,231 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "pan/audio/interpolation.h"
+#include "pan/audio/sampler.h"
+#include "test_wav_fixture.h"
+
+using pan::InterpolationQuality;
+
+static const double SAMPLE_RATE = 44100.0;
+static const double PI = 3.14159265358979323846;
+
+// Read src at each position + fraction with the given quality
+static std::vector<float> readAt(InterpolationQuality quality, double increment, const std::vector<float>& src,
+                                 const std::vector<uint32_t>& positions, const std::vector<float>& fractions) {
+    std::vector<float> out(positions.size());
+    pan::interpolate(quality, increment, src.data(), nullptr, positions.data(), fractions.data(),
+                     out.data(), nullptr, positions.size());
+    return out;
+}
+
+void testLevelSelection() {
+    using pan::SincKernelBank;
+    assert(SincKernelBank::selectLevel(0.5) == 0);
+    assert(SincKernelBank::selectLevel(1.0) == 0);
+    assert(SincKernelBank::selectLevel(1.05) == 1);
+    assert(SincKernelBank::selectLevel(std::exp2(0.25)) == 1);
+    assert(SincKernelBank::selectLevel(2.0) == SincKernelBank::LEVELS_PER_OCTAVE);
+    assert(SincKernelBank::selectLevel(16.0) == SincKernelBank::NUM_LEVELS - 1);
+
+    // Each level covers its speed-up, with taps growing to match
+    for (size_t level = 0; level < SincKernelBank::NUM_LEVELS; ++level) {
+        double speedUp = SincKernelBank::getSpeedUp(level);
+        size_t taps = SincKernelBank::getTaps(level);
+        assert(SincKernelBank::selectLevel(speedUp) == level);
+        assert(taps % 4 == 0 && taps >= SincKernelBank::BASE_TAPS * speedUp - 1e-9);
+        assert(taps <= SincKernelBank::MAX_TAPS);
+    }
+
+    assert(pan::getInterpolationReach(InterpolationQuality::Linear, 4.0) == 1);
+    assert(pan::getInterpolationReach(InterpolationQuality::Cubic, 4.0) == 2);
+    assert(pan::getInterpolationReach(InterpolationQuality::Sinc, 1.0) == SincKernelBank::BASE_TAPS / 2);
+    assert(pan::getInterpolationReach(InterpolationQuality::Sinc, 4.0) == pan::MAX_INTERPOLATION_REACH);
+}
+
+void testPolynomialKernelsFollowARamp() {
+    std::vector<float> ramp(16);
+    for (size_t i = 0; i < ramp.size(); ++i) {
+        ramp[i] = 0.25f * static_cast<float>(i);
+    }
+    std::vector<uint32_t> positions = {2, 5, 7, 11};
+    std::vector<float> fractions = {0.0f, 0.25f, 0.5f, 0.9f};
+    for (InterpolationQuality quality : {InterpolationQuality::Linear, InterpolationQuality::Cubic}) {
+        std::vector<float> out = readAt(quality, 1.0, ramp, positions, fractions);
+        for (size_t k = 0; k < out.size(); ++k) {
+            assert(std::fabs(out[k] - 0.25f * (positions[k] + fractions[k])) < 1e-6f);
+        }
+    }
+}
+
+void testSincPassesBandAndDc() {
+    const size_t reach = pan::MAX_INTERPOLATION_REACH;
+    std::vector<float> dc(4 * reach, 0.5f);
+    std::vector<float> sine(4 * reach);
+    const double frequency = 0.1;  // Cycles per frame, well inside every level's passband at increment 1
+    for (size_t i = 0; i < sine.size(); ++i) {
+        sine[i] = static_cast<float>(std::sin(2.0 * PI * frequency * i));
+    }
+
+    std::vector<uint32_t> positions;
+    std::vector<float> fractions;
+    for (int i = 0; i < 64; ++i) {
+        positions.push_back(static_cast<uint32_t>(2 * reach));
+        fractions.push_back(static_cast<float>(i) / 64.0f);
+    }
+    std::vector<float> flat = readAt(InterpolationQuality::Sinc, 1.0, dc, positions, fractions);
+    std::vector<float> wave = readAt(InterpolationQuality::Sinc, 1.0, sine, positions, fractions);
+    for (size_t k = 0; k < positions.size(); ++k) {
+        assert(std::fabs(flat[k] - 0.5f) < 1e-5f);
+        double expected = std::sin(2.0 * PI * frequency * (positions[k] + fractions[k]));
+        assert(std::fabs(wave[k] - expected) < 2e-3);
+    }
+}
+
+// Four frames at a time or one by one, mono or stereo, the result is the same
+void testBlocksMatchSingleFrames() {
+    const size_t reach = pan::MAX_INTERPOLATION_REACH;
+    std::vector<float> left(4 * reach), right(4 * reach);
+    for (size_t i = 0; i < left.size(); ++i) {
+        left[i] = static_cast<float>(std::sin(0.37 * i));
+        right[i] = static_cast<float>(std::cos(0.21 * i));
+    }
+    const size_t count = 11;  // Two blocks of four and a remainder
+    std::vector<uint32_t> positions(count);
+    std::vector<float> fractions(count);
+    for (size_t k = 0; k < count; ++k) {
+        const double position = static_cast<double>(reach) + 1.7 * k;
+        positions[k] = static_cast<uint32_t>(position);
+        fractions[k] = static_cast<float>(position - std::floor(position));
+    }
+    fractions[3] = 0.99999994f;  // Reads the last kernel row
+
+    for (InterpolationQuality quality : {InterpolationQuality::Linear, InterpolationQuality::Cubic,
+                                         InterpolationQuality::Sinc}) {
+        std::vector<float> outL(count), outR(count);
+        pan::interpolate(quality, 1.7, left.data(), right.data(), positions.data(), fractions.data(),
+                         outL.data(), outR.data(), count);
+        assert(outL == readAt(quality, 1.7, left, positions, fractions));
+        for (size_t k = 0; k < count; ++k) {
+            float singleL = 0.0f, singleR = 0.0f;
+            pan::interpolate(quality, 1.7, left.data(), right.data(), &positions[k], &fractions[k],
+                             &singleL, &singleR, 1);
+            assert(outL[k] == singleL && outR[k] == singleR);
+        }
+    }
+}
+
+static std::string writeSineWav(const char* name, double cyclesPerFrame) {
+    return writeWav(name, static_cast<size_t>(SAMPLE_RATE), 1, SAMPLE_RATE, [cyclesPerFrame](size_t n, size_t) {
+        return 0.5 * std::sin(2.0 * PI * cyclesPerFrame * n);
+    });
+}
+
+// Plays the note and returns the left channel, skipping the first block
+static std::vector<float> playNote(pan::Sampler& sampler, uint8_t note, size_t frames) {
+    sampler.getParams().sustain = 1.0f;
+    sampler.noteOn(note, 127);
+    std::vector<float> outL(frames + 512), outR(frames + 512);
+    for (size_t pos = 0; pos < outL.size(); pos += 512) {
+        sampler.process(outL.data() + pos, outR.data() + pos, 512);
+    }
+    return std::vector<float>(outL.begin() + 512, outL.end());
+}
+
+static double rms(const std::vector<float>& signal) {
+    double sum = 0.0;
+    for (float v : signal) {
+        sum += static_cast<double>(v) * v;
+    }
+    return std::sqrt(sum / signal.size());
+}
+
+// A 13 kHz tone an octave up lands above Nyquist: linear folds it back down
+// almost at full level, the sinc kernels remove it
+void testSincRemovesAliasesWhenPitchedUp() {
+    std::string path = writeSineWav("interp_alias.wav", 0.3);
+    pan::Sampler linear(SAMPLE_RATE), sinc(SAMPLE_RATE);
+    bool loaded = linear.loadSample(path) && sinc.loadSample(path);
+    assert(loaded);
+    linear.getParams().interpolation = InterpolationQuality::Linear;
+    sinc.getParams().interpolation = InterpolationQuality::Sinc;
+
+    const size_t frames = 8192;
+    double aliasedLinear = rms(playNote(linear, 72, frames));
+    double aliasedSinc = rms(playNote(sinc, 72, frames));
+
+    // In band, every quality plays the tone at the same level
+    std::string lowPath = writeSineWav("interp_tone.wav", 0.01);
+    std::vector<double> levels;
+    for (InterpolationQuality quality : {InterpolationQuality::Linear, InterpolationQuality::Cubic,
+                                         InterpolationQuality::Sinc}) {
+        pan::Sampler sampler(SAMPLE_RATE);
+        loaded = sampler.loadSample(lowPath);
+        assert(loaded);
+        sampler.getParams().interpolation = quality;
+        levels.push_back(rms(playNote(sampler, 67, frames)));
+    }
+    assert(levels[0] > 0.01);
+    for (double level : levels) {
+        assert(std::fabs(level - levels[0]) < levels[0] * 0.01);
+    }
+
+    assert(aliasedLinear > levels[0] * 0.5);
+    assert(aliasedSinc < levels[0] * 0.001);
+    (void)loaded;
+
+    std::remove(path.c_str());
+    std::remove(lowPath.c_str());
+}
+
+// Offline renders can raise the quality without touching the track's setting
+void testOfflineOverride() {
+    std::string path = writeSineWav("interp_offline.wav", 0.05);
+    const size_t frames = 4096;
+
+    pan::Sampler reference(SAMPLE_RATE);
+    bool loaded = reference.loadSample(path);
+    assert(loaded);
+    reference.getParams().interpolation = InterpolationQuality::Sinc;
+    std::vector<float> expected = playNote(reference, 65, frames);
+
+    pan::Sampler live(SAMPLE_RATE);
+    loaded = live.loadSample(path);
+    assert(loaded);
+    live.getParams().interpolation = InterpolationQuality::Linear;
+    live.setOfflineInterpolation(InterpolationQuality::Sinc);
+    std::vector<float> rendered = playNote(live, 65, frames);
+    assert(rendered != expected);
+
+    pan::Sampler offline(SAMPLE_RATE);
+    loaded = offline.loadSample(path);
+    assert(loaded);
+    offline.getParams().interpolation = InterpolationQuality::Linear;
+    offline.setOfflineInterpolation(InterpolationQuality::Sinc);
+    offline.setOfflineRendering(true);
+    rendered = playNote(offline, 65, frames);
+    assert(rendered == expected);
+
+    // The track's own setting wins when it's higher
+    offline.setOfflineInterpolation(InterpolationQuality::Linear);
+    offline.getParams().interpolation = InterpolationQuality::Sinc;
+    loaded = offline.loadSample(path);  // Resets the voices
+    assert(loaded);
+    (void)loaded;
+    rendered = playNote(offline, 65, frames);
+    assert(rendered == expected);
+
+    std::remove(path.c_str());
+}
+
+int main() {
+    testLevelSelection();
+    testPolynomialKernelsFollowARamp();
+    testSincPassesBandAndDc();
+    testBlocksMatchSingleFrames();
+    testSincRemovesAliasesWhenPitchedUp();
+    testOfflineOverride();
+    return 0;
+}
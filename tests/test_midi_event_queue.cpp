@@ -0,0 +1,141 @@
+#include <cassert>
+#include <thread>
+#include <vector>
+#include "pan/midi/midi_event_queue.h"
+
+using pan::MidiEvent;
+using pan::MidiEventQueue;
+using pan::MidiMessage;
+using pan::MidiMessageType;
+
+void testCapacityRounding() {
+    assert(MidiEventQueue(0).getCapacity() == 2);
+    assert(MidiEventQueue(5).getCapacity() == 8);
+    assert(MidiEventQueue(64).getCapacity() == 64);
+    assert(MidiEventQueue().getCapacity() == MidiEventQueue::DEFAULT_CAPACITY);
+}
+
+void testOrderAndOffsets() {
+    MidiEventQueue queue(16);
+    MidiEvent event;
+    bool ok = queue.pop(event);
+    assert(!ok);
+
+    for (uint8_t n = 0; n < 10; ++n) {
+        ok = queue.push(MidiEvent(MidiMessage(MidiMessageType::NoteOn, 0, n, 100), n * 7u));
+        assert(ok);
+    }
+    for (uint8_t n = 0; n < 10; ++n) {
+        ok = queue.pop(event);
+        assert(ok);
+        assert(event.message.getNoteNumber() == n);
+        assert(event.frameOffset == n * 7u);
+    }
+    ok = queue.pop(event);
+    assert(!ok);
+    (void)ok;
+}
+
+void testOverflowIsCounted() {
+    MidiEventQueue queue(4);
+    MidiMessage message(MidiMessageType::NoteOn, 0, 60, 100);
+    bool ok = false;
+    for (int i = 0; i < 4; ++i) {
+        ok = queue.push(MidiEvent(message));
+        assert(ok);
+    }
+    ok = queue.push(MidiEvent(message));
+    assert(!ok);
+    ok = queue.push(MidiEvent(message));
+    assert(!ok);
+    assert(queue.getOverflowCount() == 2);
+
+    // Draining frees the slots again
+    MidiEvent event;
+    ok = queue.pop(event);
+    assert(ok);
+    ok = queue.push(MidiEvent(message));
+    assert(ok);
+    (void)ok;
+    assert(queue.getOverflowCount() == 2);
+}
+
+// A block's events come out by offset, ties in arrival order, and whatever
+// doesn't fit waits for the next block
+void testDrainSorted() {
+    MidiEventQueue queue(16);
+    const uint32_t offsets[] = {30, 10, 30, 0, 10, 20};
+    for (uint8_t n = 0; n < 6; ++n) {
+        const bool ok = queue.push(MidiEvent(MidiMessage(MidiMessageType::NoteOn, 0, n, 100), offsets[n]));
+        assert(ok);
+        (void)ok;
+    }
+
+    MidiEvent out[4];
+    size_t count = queue.drainSorted(out, 4);
+    assert(count == 4);
+    const uint8_t firstBlock[] = {3, 1, 0, 2};  // Offsets 0, 10, 30, 30
+    for (size_t i = 0; i < count; ++i) {
+        assert(out[i].message.getNoteNumber() == firstBlock[i]);
+    }
+
+    count = queue.drainSorted(out, 4);
+    assert(count == 2);
+    assert(out[0].message.getNoteNumber() == 4 && out[1].message.getNoteNumber() == 5);
+    count = queue.drainSorted(out, 4);
+    assert(count == 0);
+    (void)count;
+}
+
+// Several producers against one consumer: nothing lost or duplicated, and each
+// producer's events come out in the order it pushed them
+void testConcurrentProducers() {
+    const int producers = 4;
+    const int perProducer = 20000;
+    MidiEventQueue queue(256);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                MidiEvent event(MidiMessage(MidiMessageType::NoteOn, static_cast<uint8_t>(p), 60, 100),
+                                static_cast<uint32_t>(i));
+                while (!queue.push(event)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    int received = 0;
+    MidiEvent event;
+    while (received < producers * perProducer) {
+        if (!queue.pop(event)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = event.message.getChannel();
+        assert(static_cast<int>(event.frameOffset) == next[p]);
+        next[p]++;
+        received++;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const bool leftover = queue.pop(event);
+    assert(!leftover);
+    (void)leftover;
+    for (int p = 0; p < producers; ++p) {
+        assert(next[p] == perProducer);
+    }
+}
+
+int main() {
+    testCapacityRounding();
+    testOrderAndOffsets();
+    testOverflowIsCounted();
+    testDrainSorted();
+    testConcurrentProducers();
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/audio_buffer.h"
+
+// Writes a running frame counter so block boundaries can be checked
+static void installRampCallback(pan::AudioEngine& engine, size_t& counter) {
+    engine.setProcessCallback([&counter](pan::AudioBuffer&, pan::AudioBuffer& output, size_t numFrames) {
+        for (size_t i = 0; i < numFrames; ++i) {
+            float value = static_cast<float>(counter++) / 100000.0f;
+            output.getWritePointer(0)[i] = value;
+            output.getWritePointer(1)[i] = -value;
+        }
+    });
+}
+
+void testOfflineRenderToSink() {
+    pan::AudioEngine engine;
+    size_t counter = 0;
+    installRampCallback(engine, counter);
+
+    std::vector<float> rendered;
+    size_t progressCalls = 0;
+    pan::OfflineRenderOptions options;
+    options.totalFrames = 10000;
+    options.blockSize = 512;
+    options.progressIntervalFrames = 2048;
+    options.sink = [&rendered](const pan::AudioBuffer& block, size_t numFrames) {
+        assert(numFrames <= 512);
+        const float* left = block.getReadPointer(0);
+        rendered.insert(rendered.end(), left, left + numFrames);
+        return true;
+    };
+    options.progress = [&progressCalls](const pan::OfflineRenderProgress& progress) {
+        progressCalls++;
+        assert(progress.framesRendered <= progress.totalFrames);
+        return true;
+    };
+
+    pan::OfflineRenderProgress result;
+    bool completed = engine.renderOffline(options, &result);
+    assert(completed);
+    (void)completed;
+    assert(result.framesRendered == 10000);
+    assert(!result.cancelled);
+    assert(rendered.size() == 10000);
+    assert(progressCalls == 5);  // Four interval reports plus the final one
+    for (size_t i = 0; i < rendered.size(); ++i) {
+        assert(rendered[i] == static_cast<float>(i) / 100000.0f);
+    }
+    assert(!engine.isRenderingOffline());
+}
+
+void testOfflineRenderCancel() {
+    pan::AudioEngine engine;
+    size_t counter = 0;
+    installRampCallback(engine, counter);
+
+    pan::OfflineRenderOptions options;
+    options.totalFrames = 100000;
+    options.blockSize = 256;
+    options.progressIntervalFrames = 1024;
+    options.progress = [](const pan::OfflineRenderProgress&) { return false; };
+
+    pan::OfflineRenderProgress result;
+    bool completed = engine.renderOffline(options, &result);
+    assert(!completed);
+    (void)completed;
+    assert(result.cancelled);
+    assert(result.framesRendered < options.totalFrames);
+}
+
+void testOfflineRenderToWav() {
+    pan::AudioEngine engine;
+    size_t counter = 0;
+    installRampCallback(engine, counter);
+
+    const char* path = "pan_offline_render_test.wav";
+    bool written = engine.renderOfflineToFile(path, 3000, pan::WavWriter::Format::PCM16);
+    assert(written);
+    (void)written;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    assert(file.is_open());
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    assert(fileSize == 44 + 3000 * 2 * 2);
+
+    file.seekg(40);
+    uint32_t dataSize = 0;
+    file.read(reinterpret_cast<char*>(&dataSize), sizeof(dataSize));
+    assert(dataSize == 3000 * 2 * 2);
+    file.close();
+    std::remove(path);
+}
+
+int main() {
+    testOfflineRenderToSink();
+    testOfflineRenderCancel();
+    testOfflineRenderToWav();
+    return 0;
+}
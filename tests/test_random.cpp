@@ -0,0 +1,140 @@
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/bit_noise_texture.h"
+#include "pan/dsp/random.h"
+
+using pan::dsp::Random;
+
+void testSameSeedSameSequence() {
+    Random a(1234);
+    Random b(1234);
+    Random other(1235);
+    int differences = 0;
+    for (int i = 0; i < 1000; ++i) {
+        uint32_t value = a.nextUint();
+        assert(value == b.nextUint());
+        differences += value != other.nextUint() ? 1 : 0;
+    }
+    assert(differences > 990);
+
+    // Reseeding restarts the stream
+    a.setSeed(1234);
+    b.setSeed(1234);
+    b.nextUint();
+    b.setSeed(1234);
+    for (int i = 0; i < 100; ++i) {
+        assert(a.nextUint() == b.nextUint());
+    }
+}
+
+void testDerivedStreamsDiffer() {
+    // Neighbouring stream numbers and seeds must not collide or correlate
+    std::vector<uint32_t> seeds;
+    for (uint32_t seed = 0; seed < 4; ++seed) {
+        for (uint32_t stream = 0; stream < 64; ++stream) {
+            seeds.push_back(Random::derive(seed, stream));
+        }
+    }
+    for (size_t i = 0; i < seeds.size(); ++i) {
+        for (size_t j = i + 1; j < seeds.size(); ++j) {
+            assert(seeds[i] != seeds[j]);
+        }
+    }
+
+    Random first(Random::derive(7, 0));
+    Random second(Random::derive(7, 1));
+    double correlation = 0.0;
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        correlation += first.nextBipolar() * second.nextBipolar();
+    }
+    assert(std::fabs(correlation / n) < 0.02);
+}
+
+void testFillMatchesNext() {
+    Random bulk(99);
+    Random single(99);
+    float values[37];
+    for (int pass = 0; pass < 3; ++pass) {
+        bulk.fillBipolar(values, 37);
+        for (float value : values) {
+            assert(value == single.nextBipolar());
+        }
+    }
+    assert(bulk.nextUint() == single.nextUint());
+}
+
+void testDistribution() {
+    Random random(5);
+    const int n = 100000;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    int buckets[10] = {};
+    for (int i = 0; i < n; ++i) {
+        float unit = random.nextFloat();
+        assert(unit >= 0.0f && unit < 1.0f);
+        ++buckets[static_cast<int>(unit * 10.0f)];
+
+        float bipolar = random.nextBipolar();
+        assert(bipolar >= -1.0f && bipolar < 1.0f);
+        sum += bipolar;
+        sumSquares += bipolar * bipolar;
+    }
+    assert(std::fabs(sum / n) < 0.01);
+    assert(std::fabs(sumSquares / n - 1.0 / 3.0) < 0.01);  // Variance of U(-1, 1)
+    for (int count : buckets) {
+        assert(std::fabs(count - n / 10) < n / 100);
+    }
+}
+
+// Noise from an effect repeats exactly after setSeed
+static std::vector<float> renderTexture(uint32_t seed) {
+    pan::BitNoiseTexture texture(48000.0);
+    texture.setNoise(0.5f);
+    texture.setMix(1.0f);
+    texture.setSeed(seed);
+    pan::AudioBuffer buffer(2, 300);
+    std::vector<float> out;
+    for (int b = 0; b < 3; ++b) {
+        buffer.clear();
+        texture.process(buffer, 300);
+        out.insert(out.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + 300);
+    }
+    return out;
+}
+
+void testEffectSeeding() {
+    assert(renderTexture(42) == renderTexture(42));
+    assert(renderTexture(42) != renderTexture(43));
+}
+
+// A posted seed is taken once, at the owner's next block
+void testPendingSeed() {
+    pan::dsp::PendingSeed pending;
+    uint32_t seed = 0;
+    assert(!pending.take(seed));
+    
+    pending.post(0);
+    assert(pending.get() == 0);
+    assert(pending.take(seed) && seed == 0);  // Zero is a seed like any other
+    assert(!pending.take(seed));
+    
+    pending.post(7);
+    pending.post(42);
+    assert(pending.get() == 42);
+    assert(pending.take(seed) && seed == 42);  // Only the latest lands
+    assert(!pending.take(seed));
+    assert(pending.get() == 42);
+}
+
+int main() {
+    testSameSeedSameSequence();
+    testDerivedStreamsDiffer();
+    testFillMatchesNext();
+    testDistribution();
+    testEffectSeeding();
+    testPendingSeed();
+    return 0;
+}
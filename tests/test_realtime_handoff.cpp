@@ -0,0 +1,96 @@
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "pan/audio/realtime_handoff.h"
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/audio_buffer.h"
+
+struct Payload {
+    static constexpr int MAGIC = 0x5A5A;
+    explicit Payload(int v) : value(v) { liveCount++; }
+    ~Payload() { magic = 0; liveCount--; }
+    int magic = MAGIC;
+    int value;
+    static std::atomic<int> liveCount;
+};
+std::atomic<int> Payload::liveCount{0};
+
+void testPublishAndCollect() {
+    {
+        pan::RealtimeHandoff<Payload> handoff;
+        assert(!handoff.read());
+
+        handoff.publish(std::make_unique<Payload>(1));
+        {
+            auto scope = handoff.read();
+            assert(scope && scope->value == 1);
+
+            // Retired while a reader is active - must survive collection
+            handoff.publish(std::make_unique<Payload>(2));
+            size_t freed = handoff.collectGarbage();
+            assert(freed == 0);
+            (void)freed;
+            assert(scope->magic == Payload::MAGIC);
+            assert(handoff.getRetiredCount() == 1);
+        }
+        size_t freed = handoff.collectGarbage();
+        assert(freed == 1);
+        (void)freed;
+        assert(handoff.read()->value == 2);
+        assert(Payload::liveCount == 1);
+    }
+    assert(Payload::liveCount == 0);
+}
+
+void testConcurrentSwap() {
+    pan::RealtimeHandoff<Payload> handoff;
+    handoff.publish(std::make_unique<Payload>(0));
+
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        int last = 0;
+        while (!done) {
+            auto scope = handoff.read();
+            assert(scope->magic == Payload::MAGIC);
+            assert(scope->value >= last);  // Values only move forward
+            last = scope->value;
+        }
+    });
+
+    for (int i = 1; i <= 20000; ++i) {
+        handoff.publish(std::make_unique<Payload>(i));
+        handoff.collectGarbage();
+    }
+    done = true;
+    reader.join();
+    handoff.collectGarbage();
+    assert(handoff.getRetiredCount() == 0);
+    assert(Payload::liveCount == 1);
+}
+
+void testEngineCallbackSwap() {
+    pan::AudioEngine engine;
+    assert(!engine.hasProcessCallback());
+
+    int which = 0;
+    engine.setProcessCallback([&which](pan::AudioBuffer&, pan::AudioBuffer&, size_t) { which = 1; });
+    assert(engine.hasProcessCallback());
+    engine.setProcessCallback([&which](pan::AudioBuffer&, pan::AudioBuffer&, size_t) { which = 2; });
+
+    pan::AudioBuffer input(2, 64);
+    pan::AudioBuffer output(2, 64);
+    engine.processAudioCallback(input, output, 64);
+    assert(which == 2);
+    engine.collectGarbage();
+
+    engine.setProcessCallback(nullptr);
+    assert(!engine.hasProcessCallback());
+}
+
+int main() {
+    testPublishAndCollect();
+    testConcurrentSwap();
+    testEngineCallbackSwap();
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cerrno>
+#include <string>
+#include <thread>
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/realtime_thread.h"
+#include "pan/audio/render_pool.h"
+
+static float multiplyTiny(float scale) {
+    volatile float tiny = 1e-38f;  // Normal, but the product below is denormal
+    volatile float s = scale;
+    return tiny * s;
+}
+
+void testDenormalFlushing() {
+#if defined(__SSE__) || defined(__aarch64__) || defined(_M_X64)
+    std::thread([] {
+        assert(multiplyTiny(1e-3f) != 0.0f);
+        {
+            pan::realtime::ScopedDenormalFlush flush;
+            assert(pan::realtime::isDenormalFlushingEnabled());
+            assert(multiplyTiny(1e-3f) == 0.0f);
+        }
+        // Previous mode restored
+        assert(!pan::realtime::isDenormalFlushingEnabled());
+        assert(multiplyTiny(1e-3f) != 0.0f);
+
+        assert(pan::realtime::enableDenormalFlushing());
+        assert(multiplyTiny(1e-3f) == 0.0f);
+    }).join();
+#endif
+}
+
+void testPriorityReport() {
+    // Whether SCHED_FIFO is allowed depends on the machine; either way the report says what happened
+    std::thread([] {
+        pan::RealtimeThreadPolicy policy;
+        policy.priority = 10;
+        policy.cpu = 0;
+        pan::RealtimeThreadReport report = pan::realtime::applyToCurrentThread(policy);
+        assert(report.applied);
+        assert(report.realtimePriority ? report.priority > 0 : report.priorityError != 0);
+        assert(report.affinitySet || report.affinityError != 0);
+    }).join();
+}
+
+void testWorkersApplyPolicy() {
+    pan::RenderPool pool;
+    pool.setNumThreads(2);
+    pan::RealtimeThreadPolicy policy;
+    policy.elevatePriority = false;
+    pool.setRealtimePolicy(policy);
+
+    // Workers configure themselves before their next job; tasks then run with denormals flushed
+    std::atomic<int> flushed{0};
+    auto task = [&](size_t) {
+        if (pan::realtime::isDenormalFlushingEnabled()) {
+            flushed.fetch_add(1);
+        }
+        // Long enough that the caller can't drain every range before the workers wake
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    };
+    for (int block = 0; block < 10; ++block) {
+        pool.run(64, task, 0.0);
+    }
+    assert(flushed.load() > 0);
+    assert(pool.getRealtimeWorkerCount() == 0);
+}
+
+void testEngineDiagnostics() {
+    pan::AudioEngine engine;
+    pan::RealtimeThreadPolicy policy;
+    policy.elevatePriority = false;
+    bool accepted = engine.setRealtimePolicy(policy);
+    assert(accepted);
+    assert(!engine.getRealtimeDiagnostics().audioThread.applied);
+
+    engine.setProcessCallback([](pan::AudioBuffer&, pan::AudioBuffer& output, size_t) { output.fill(0.1f); });
+    bool started = engine.start();
+    assert(started);
+    (void)started;
+    accepted = engine.setRealtimePolicy(policy);
+    assert(!accepted);
+    (void)accepted;
+
+    pan::RealtimeDiagnostics before = engine.getRealtimeDiagnostics();
+    assert(before.memoryLocked ? before.lockedBytes > 0 : before.memoryLockError != 0);
+
+    std::thread([&] {
+        float device[2 * 64];
+        engine.processDeviceBlock(nullptr, device, 64);
+    }).join();
+
+    pan::RealtimeDiagnostics after = engine.getRealtimeDiagnostics();
+    assert(after.audioThread.applied);
+    assert(!after.audioThread.realtimePriority && after.audioThread.priorityError == 0);
+#if defined(__SSE__) || defined(__aarch64__) || defined(_M_X64)
+    assert(after.audioThread.denormalsFlushed);
+#endif
+    assert(after.describe().find("Audio thread") != std::string::npos);
+    engine.stop();
+
+    // More tracks reallocate the scratch arena; the restart locks the new buffers
+    accepted = engine.setMaxTrackCount(engine.getMaxTrackCount() * 2);
+    assert(accepted);
+    started = engine.start();
+    assert(started);
+    pan::RealtimeDiagnostics grown = engine.getRealtimeDiagnostics();
+    assert(grown.memoryLocked == before.memoryLocked);
+    assert(!grown.memoryLocked || grown.lockedBytes > before.lockedBytes);
+    engine.stop();
+}
+
+int main() {
+    testDenormalFlushing();
+    testPriorityReport();
+    testWorkersApplyPolicy();
+    testEngineDiagnostics();
+    return 0;
+}
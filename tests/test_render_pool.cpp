@@ -0,0 +1,118 @@
+#include <cassert>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <set>
+#include <thread>
+#include <vector>
+#include "pan/audio/render_pool.h"
+
+void testEveryTaskRunsOnce() {
+    pan::RenderPool pool;
+    pool.setNumThreads(3);
+
+    const size_t numTasks = 37;
+    std::vector<std::atomic<int>> counts(numTasks);
+    for (int block = 0; block < 500; ++block) {
+        for (auto& count : counts) {
+            count = 0;
+        }
+        auto task = [&counts](size_t i) { counts[i].fetch_add(1); };
+        pool.run(numTasks, task, 0.0);
+        for (auto& count : counts) {
+            assert(count.load() == 1);
+        }
+    }
+    assert(pool.getStats().parallelBlocks == 500);
+}
+
+void testParallelMatchesSerial() {
+    const size_t numTasks = 24;
+    const size_t numFrames = 256;
+
+    auto render = [&](pan::RenderPool& pool) {
+        std::vector<std::vector<float>> buffers(numTasks, std::vector<float>(numFrames));
+        auto task = [&buffers](size_t t) {
+            for (size_t i = 0; i < buffers[t].size(); ++i) {
+                buffers[t][i] = std::sin(0.01f * static_cast<float>(i * (t + 1))) * 0.3f;
+            }
+        };
+        pool.run(numTasks, task, 0.0);
+
+        // Deterministic summing stage
+        std::vector<float> mix(numFrames, 0.0f);
+        for (size_t t = 0; t < numTasks; ++t) {
+            for (size_t i = 0; i < numFrames; ++i) {
+                mix[i] += buffers[t][i];
+            }
+        }
+        return mix;
+    };
+
+    pan::RenderPool serialPool;
+    serialPool.setNumThreads(0);
+    pan::RenderPool parallelPool;
+    parallelPool.setNumThreads(4);
+
+    std::vector<float> serial = render(serialPool);
+    std::vector<float> parallel = render(parallelPool);
+    assert(serial == parallel);
+    assert(serialPool.getStats().serialBlocks == 1);
+}
+
+// Workers idle past their spin budget park, and the next block wakes them.
+// Tasks run under the pool's allocation guard, so each records its thread in
+// a preallocated slot and the caller counts them afterwards.
+void testParkedWorkersWake() {
+    pan::RenderPool pool;
+    pool.setNumThreads(2);
+
+    constexpr size_t numTasks = 64;
+    std::array<std::atomic<std::thread::id>, numTasks> ranOn;
+    auto task = [&ranOn](size_t i) {
+        ranOn[i].store(std::this_thread::get_id(), std::memory_order_relaxed);
+        // Long enough that the caller can't drain every range before the workers wake
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    };
+    for (int block = 0; block < 3; ++block) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(pan::RenderPool::MAX_SPIN_SECONDS * 3));
+        for (auto& id : ranOn) {
+            id.store(std::thread::id(), std::memory_order_relaxed);
+        }
+        pool.run(numTasks, task, 0.0);
+        std::set<std::thread::id> threads;
+        for (const auto& id : ranOn) {
+            threads.insert(id.load(std::memory_order_relaxed));
+        }
+        assert(threads.size() > 1);
+    }
+}
+
+void testDeadlineFallback() {
+    pan::RenderPool pool;
+    pool.setNumThreads(2);
+
+    auto task = [](size_t) {};
+    // An impossible deadline: every parallel block counts as a miss
+    for (int i = 0; i < pan::RenderPool::MAX_CONSECUTIVE_MISSES; ++i) {
+        assert(!pool.isSerialFallbackActive());
+        bool ranParallel = pool.run(8, task, 1e-12);
+        assert(ranParallel);
+        (void)ranParallel;
+    }
+    assert(pool.isSerialFallbackActive());
+    assert(pool.getStats().deadlineMisses == static_cast<uint64_t>(pan::RenderPool::MAX_CONSECUTIVE_MISSES));
+    bool ranParallel = pool.run(8, task, 1e-12);
+    assert(!ranParallel);
+    (void)ranParallel;
+    assert(pool.getStats().serialBlocks == 1);
+}
+
+int main() {
+    testEveryTaskRunsOnce();
+    testParallelMatchesSerial();
+    testParkedWorkersWake();
+    testDeadlineFallback();
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/resample_cache.h"
+#include "pan/audio/sample_loader.h"
+#include "pan/audio/sample_pool.h"
+#include "pan/audio/sampler.h"
+#include "test_wav_fixture.h"
+
+namespace fs = std::filesystem;
+
+static const double SOURCE_RATE = 44100.0;
+static const double ENGINE_RATE = 48000.0;
+static const double TONE_HZ = 882.0;
+static const double PI = 3.14159265358979323846;
+
+// One second of a 882 Hz tone at 44.1 kHz; the right channel is inverted
+static std::string writeToneWav(const char* name, bool stereo) {
+    return writeWav(name, static_cast<size_t>(SOURCE_RATE), stereo ? 2 : 1, SOURCE_RATE, [](size_t n, size_t c) {
+        float value = static_cast<float>(0.5 * std::sin(2.0 * PI * TONE_HZ * n / SOURCE_RATE));
+        return c == 0 ? value : -value;
+    });
+}
+
+static std::string cachePathFor(const std::string& path, double rate) {
+    uintmax_t size = fs::file_size(path);
+    int64_t modified = static_cast<int64_t>(fs::last_write_time(path).time_since_epoch().count());
+    return pan::ResampleCache::get().getCachePath(path, size, modified, rate);
+}
+
+// Plays the note and returns the left channel, skipping the attack in the first block
+static std::vector<float> playNote(pan::Sampler& sampler, uint8_t note, size_t frames) {
+    sampler.getParams().sustain = 1.0f;
+    sampler.noteOn(note, 127);
+    std::vector<float> outL(frames + 512), outR(frames + 512);
+    for (size_t pos = 0; pos < outL.size(); pos += 512) {
+        sampler.process(outL.data() + pos, outR.data() + pos, 512);
+    }
+    return std::vector<float>(outL.begin() + 512, outL.end());
+}
+
+void testLoadConvertsToEngineRate() {
+    std::string path = writeToneWav("resample_tone.wav", true);
+    pan::Sampler sampler(ENGINE_RATE);
+    const bool loaded = sampler.loadSample(path);
+    assert(loaded);
+    (void)loaded;
+
+    const pan::Sample* sample = sampler.getSample();
+    assert(sample->sampleRate == ENGINE_RATE);
+    assert(sample->getNumFrames() == static_cast<size_t>(ENGINE_RATE));
+    assert(sample->stereo && sample->filePath == path && sample->name == "pan_test_resample_tone");
+    assert(fs::exists(cachePathFor(path, ENGINE_RATE)));
+
+    // The same tone, sampled at the new rate; the edges ring against the silence around the file
+    for (size_t n = 1000; n + 1000 < sample->getNumFrames(); ++n) {
+        double expected = 0.5 * std::sin(2.0 * PI * TONE_HZ * n / ENGINE_RATE);
+        assert(std::fabs(sample->dataL[n] - expected) < 1e-4);
+        assert(std::fabs(sample->dataR[n] + expected) < 1e-4);
+    }
+
+    std::remove(path.c_str());
+}
+
+// At the root note there's nothing left to interpolate, whatever the quality
+void testRootNoteIsAStraightCopy() {
+    std::string path = writeToneWav("resample_root.wav", false);
+    for (pan::InterpolationQuality quality : {pan::InterpolationQuality::Linear, pan::InterpolationQuality::Cubic,
+                                              pan::InterpolationQuality::Sinc}) {
+        pan::Sampler sampler(ENGINE_RATE);
+        const bool loaded = sampler.loadSample(path);
+        assert(loaded);
+        (void)loaded;
+        sampler.getParams().interpolation = quality;
+        const std::vector<float>& data = sampler.getSample()->dataL;
+
+        std::vector<float> out = playNote(sampler, static_cast<uint8_t>(sampler.getRootNote()), 4096);
+        const size_t peak = 512 + static_cast<size_t>(ENGINE_RATE / TONE_HZ / 4);  // A crest of the tone
+        const double gain = out[peak - 512] / data[peak];
+        assert(gain > 0.0);
+        for (size_t k = 0; k < out.size(); ++k) {
+            assert(std::fabs(out[k] - data[512 + k] * gain) < 1e-6);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+void testConversionIsReused() {
+    std::string path = writeToneWav("resample_reuse.wav", false);
+    pan::SamplePool& pool = pan::SamplePool::get();
+    auto first = pool.load(path, pan::Sampler::DEFAULT_STREAMING_THRESHOLD,
+                           pan::Sampler::DEFAULT_STREAMING_PRELOAD_SECONDS, ENGINE_RATE);
+    assert(first);
+    std::vector<float> converted = first->dataL;
+    const std::string cachePath = cachePathFor(path, ENGINE_RATE);
+    const auto written = fs::last_write_time(cachePath);
+
+    // Dropped from memory, the conversion is read back from disk rather than redone
+    first.reset();
+    pool.purgeUnused();
+    auto second = pool.load(path, pan::Sampler::DEFAULT_STREAMING_THRESHOLD,
+                            pan::Sampler::DEFAULT_STREAMING_PRELOAD_SECONDS, ENGINE_RATE);
+    assert(second && second->dataL == converted && second->sampleRate == ENGINE_RATE);
+    assert(fs::last_write_time(cachePath) == written);
+
+    // Large conversions stream from the cache like any other big WAV
+    auto streamed = pool.load(path, 0, 0.01, ENGINE_RATE);
+    assert(streamed && streamed->stream && streamed->getNumFrames() == converted.size());
+    std::vector<float> tail(1000);
+    std::vector<uint8_t> scratch;
+    const size_t framesRead = streamed->stream->read(40000, tail.size(), tail.data(), nullptr, scratch);
+    assert(framesRead == tail.size());
+    (void)framesRead;
+    assert(std::equal(tail.begin(), tail.end(), converted.begin() + 40000));
+
+    // At its own rate the file isn't converted, and an edited file gets a fresh conversion
+    auto native = pool.load(path, pan::Sampler::DEFAULT_STREAMING_THRESHOLD,
+                            pan::Sampler::DEFAULT_STREAMING_PRELOAD_SECONDS, SOURCE_RATE);
+    assert(native && native->sampleRate == SOURCE_RATE && !fs::exists(cachePathFor(path, SOURCE_RATE)));
+    uintmax_t size = fs::file_size(path);
+    assert(pan::ResampleCache::get().getCachePath(path, size, 1, ENGINE_RATE) !=
+           pan::ResampleCache::get().getCachePath(path, size, 2, ENGINE_RATE));
+
+    std::remove(path.c_str());
+}
+
+// Wired up as MainWindow does it: a new engine rate retunes the sampler and reconverts its sample
+void testEngineRateChangeReconverts() {
+    std::string path = writeToneWav("resample_engine.wav", false);
+    pan::AudioEngine engine;
+    engine.setSampleRate(ENGINE_RATE);
+    auto sampler = std::make_shared<pan::Sampler>(engine.getSampleRate());
+    pan::SampleLoader loader;
+    loader.load(sampler, path);
+    loader.waitUntilIdle();
+    assert(sampler->getSample()->sampleRate == ENGINE_RATE);
+
+    std::vector<double> changes;
+    engine.setSampleRateListener([&](double rate) {
+        changes.push_back(rate);
+        sampler->setEngineSampleRate(rate);
+        loader.load(sampler, sampler->getSample()->filePath);
+    });
+    engine.setSampleRate(ENGINE_RATE);  // Unchanged: no call
+    assert(changes.empty());
+
+    pan::StreamConfig config = engine.getStreamConfig();
+    config.sampleRate = 96000.0;
+    const bool configured = engine.setStreamConfig(config);
+    assert(configured);
+    (void)configured;
+    assert(changes.size() == 1 && changes[0] == 96000.0);
+    loader.waitUntilIdle();
+    assert(sampler->getEngineSampleRate() == 96000.0);
+    assert(sampler->getSample()->sampleRate == 96000.0);
+    assert(sampler->getSample()->getNumFrames() == 96000);
+    assert(fs::exists(cachePathFor(path, 96000.0)));
+
+    std::remove(path.c_str());
+}
+
+// Past the size cap the oldest conversions go, never the one just written
+void testCacheIsCapped() {
+    pan::ResampleCache& cache = pan::ResampleCache::get();
+    pan::SamplePool& pool = pan::SamplePool::get();
+    const char* names[] = {"resample_cap_a.wav", "resample_cap_b.wav", "resample_cap_c.wav"};
+    std::vector<std::string> paths, cachePaths;
+    for (const char* name : names) {
+        paths.push_back(writeToneWav(name, false));
+        cachePaths.push_back(cachePathFor(paths.back(), ENGINE_RATE));
+    }
+
+    // Room for two conversions
+    auto load = [&](const std::string& path) {
+        auto sample = pool.load(path, pan::Sampler::DEFAULT_STREAMING_THRESHOLD,
+                                pan::Sampler::DEFAULT_STREAMING_PRELOAD_SECONDS, ENGINE_RATE);
+        assert(sample);
+        pool.purgeUnused();
+    };
+    load(paths[0]);
+    cache.setMaxBytes(fs::file_size(cachePaths[0]) * 5 / 2);
+    load(paths[1]);
+    assert(fs::exists(cachePaths[0]) && fs::exists(cachePaths[1]));
+    load(paths[2]);
+    assert(!fs::exists(cachePaths[0]) && fs::exists(cachePaths[1]) && fs::exists(cachePaths[2]));
+
+    // Even a cap too small for one conversion keeps the newest
+    cache.setMaxBytes(1);
+    cache.prune(cachePaths[2]);
+    assert(!fs::exists(cachePaths[1]) && fs::exists(cachePaths[2]));
+
+    cache.setMaxBytes(pan::ResampleCache::DEFAULT_MAX_BYTES);
+    for (const std::string& path : paths) {
+        std::remove(path.c_str());
+    }
+}
+
+int main() {
+    const std::string cacheDir = tempPath("resample_cache");
+    fs::remove_all(cacheDir);
+    pan::ResampleCache::get().setDirectory(cacheDir);
+
+    testLoadConvertsToEngineRate();
+    testRootNoteIsAStraightCopy();
+    testConversionIsReused();
+    testEngineRateChangeReconverts();
+    testCacheIsCapped();
+
+    fs::remove_all(cacheDir);
+    return 0;
+}
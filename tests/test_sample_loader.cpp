@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pan/audio/sample_loader.h"
+#include "pan/audio/sample_pool.h"
+#include "pan/audio/sampler.h"
+#include "test_wav_fixture.h"
+
+static const double SAMPLE_RATE = 44100.0;
+
+static std::string writeTestWav(const char* name, size_t frames, float value) {
+    return writeWav(name, frames, 1, SAMPLE_RATE, [value](size_t, size_t) { return value; });
+}
+
+static float peak(pan::Sampler& sampler, size_t frames) {
+    std::vector<float> outL(frames), outR(frames);
+    sampler.process(outL.data(), outR.data(), frames);
+    float result = 0.0f;
+    for (float v : outL) {
+        result = std::max(result, std::abs(v));
+    }
+    return result;
+}
+
+void testLoadInstallsOnPoll() {
+    std::string path = writeTestWav("loader_basic.wav", 200000, 0.5f);
+    pan::SamplePool::get().purgeUnused();
+    auto sampler = std::make_shared<pan::Sampler>(SAMPLE_RATE);
+    pan::SampleLoader loader;
+
+    int done = 0;
+    bool loaded = false;
+    float lastProgress = 0.0f;
+    loader.load(sampler, path,
+                [&](bool ok) { ++done; loaded = ok; },
+                [&](float fraction) { assert(fraction >= lastProgress); lastProgress = fraction; });
+    assert(!loader.isIdle());
+
+    // Nothing reaches the sampler or the callbacks outside poll()
+    loader.waitUntilIdle();
+    assert(loader.isIdle());
+    assert(done == 1 && loaded);
+    assert(sampler->getSample() && sampler->getSample()->dataL.size() == 200000);
+
+    sampler->noteOn(60, 127);
+    assert(peak(*sampler, 512) > 0.0f);
+
+    std::remove(path.c_str());
+}
+
+void testNewerLoadSupersedesOlder() {
+    std::string pathA = writeTestWav("loader_a.wav", 1000, 0.25f);
+    std::string pathB = writeTestWav("loader_b.wav", 1000, 0.75f);
+    auto sampler = std::make_shared<pan::Sampler>(SAMPLE_RATE);
+    pan::SampleLoader loader(1);
+
+    std::vector<bool> results;
+    loader.load(sampler, pathA, [&](bool ok) { results.push_back(ok); });
+    loader.load(sampler, pathB, [&](bool ok) { results.push_back(ok); });
+    loader.waitUntilIdle();
+    assert(results.size() == 2);
+    assert(!results[0] && results[1]);
+    assert(sampler->getSample()->dataL[0] == 0.75f);
+
+    // Failures and samplers deleted meanwhile report false and change nothing
+    bool missing = true;
+    loader.load(sampler, tempPath("loader_missing.wav"), [&](bool ok) { missing = ok; });
+    loader.waitUntilIdle();
+    assert(!missing);
+    assert(sampler->getSample()->dataL[0] == 0.75f);
+
+    auto orphan = std::make_shared<pan::Sampler>(SAMPLE_RATE);
+    bool orphaned = true;
+    loader.load(orphan, pathA, [&](bool ok) { orphaned = ok; });
+    orphan.reset();
+    loader.waitUntilIdle();
+    assert(!orphaned);
+
+    std::remove(pathA.c_str());
+    std::remove(pathB.c_str());
+}
+
+// The swap lands at a block boundary and the replaced sample is freed by poll(), not process()
+void testSwapWhilePlaying() {
+    std::string pathA = writeTestWav("loader_swap_a.wav", 100000, 0.5f);
+    std::string pathB = writeTestWav("loader_swap_b.wav", 100000, 0.25f);
+    auto sampler = std::make_shared<pan::Sampler>(SAMPLE_RATE);
+    sampler->getParams().sustain = 1.0f;
+    pan::SampleLoader loader;
+
+    loader.load(sampler, pathA);
+    loader.waitUntilIdle();
+    std::weak_ptr<const pan::Sample> old = sampler->getSharedSample();
+    sampler->noteOn(60, 127);
+    assert(peak(*sampler, 512) > 0.0f);
+    assert(sampler->isProducingAudio());
+
+    loader.load(sampler, pathB);
+    loader.waitUntilIdle();
+    assert(sampler->getSample()->dataL[0] == 0.25f);
+
+    // The next block drops the old sample's voices and plays nothing until a new note
+    assert(peak(*sampler, 512) == 0.0f);
+    assert(!sampler->isProducingAudio());
+    sampler->noteOn(60, 127);
+    assert(peak(*sampler, 512) > 0.0f);
+
+    // Nothing but the pool still holds the old sample
+    loader.poll();
+    pan::SamplePool::get().purgeUnused();
+    assert(old.expired());
+
+    std::remove(pathA.c_str());
+    std::remove(pathB.c_str());
+}
+
+int main() {
+    testLoadInstallsOnPoll();
+    testNewerLoadSupersedesOlder();
+    testSwapWhilePlaying();
+    return 0;
+}
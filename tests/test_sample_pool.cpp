@@ -0,0 +1,106 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "pan/audio/sample_pool.h"
+#include "pan/audio/sampler.h"
+#include "test_wav_fixture.h"
+
+static std::string writeTestWav(const char* name, size_t frames, float value) {
+    return writeWav(name, frames, 1, 44100.0, [value](size_t, size_t) { return value; });
+}
+
+void testSamePathIsShared() {
+    pan::SamplePool& pool = pan::SamplePool::get();
+    pool.purgeUnused();
+    std::string path = writeTestWav("pool_shared.wav", 1000, 0.25f);
+
+    auto first = pool.load(path);
+    auto second = pool.load(path);
+    assert(first && first == second);
+    assert(pool.getNumEntries() == 1);
+    assert(pool.getMemoryUsage() == pan::SamplePool::getMemorySize(*first));
+
+    // Samplers share the pooled data but keep their own root note
+    pan::Sampler a(44100.0), b(44100.0);
+    const bool loadedA = a.loadSample(path);
+    const bool loadedB = b.loadSample(path);
+    assert(loadedA && loadedB);
+    (void)loadedA;
+    (void)loadedB;
+    assert(a.getSample() == first.get() && b.getSample() == first.get());
+    a.setRootNote(48);
+    assert(a.getRootNote() == 48 && b.getRootNote() == 60);
+
+    // Different streaming settings decode separately
+    auto streamed = pool.load(path, 0, 0.001);
+    assert(streamed && streamed != first && streamed->stream);
+    assert(pool.getNumEntries() == 2);
+
+    std::remove(path.c_str());
+}
+
+void testChangedFileIsReloaded() {
+    pan::SamplePool& pool = pan::SamplePool::get();
+    std::string path = writeTestWav("pool_changed.wav", 1000, 0.25f);
+    auto before = pool.load(path);
+    assert(before && before->dataL[0] == 0.25f);
+
+    writeTestWav("pool_changed.wav", 2000, 0.5f);
+    auto after = pool.load(path);
+    assert(after && after != before);
+    assert(after->dataL.size() == 2000 && after->dataL[0] == 0.5f);
+    // The old holder still has the old audio
+    assert(before->dataL.size() == 1000 && before->dataL[0] == 0.25f);
+
+    std::remove(path.c_str());
+    auto missing = pool.load(path);
+    assert(!missing);
+}
+
+void testUnusedEntriesEvictedOldestFirst() {
+    pan::SamplePool& pool = pan::SamplePool::get();
+    pool.purgeUnused();
+    assert(pool.getNumEntries() == 0 && pool.getMemoryUsage() == 0);
+
+    std::string pathA = writeTestWav("pool_a.wav", 10000, 0.1f);
+    std::string pathB = writeTestWav("pool_b.wav", 10000, 0.2f);
+    std::string pathC = writeTestWav("pool_c.wav", 10000, 0.3f);
+    const pan::Sample* a = pool.load(pathA).get();
+    auto held = pool.load(pathB);
+    pool.load(pathC);
+    pool.load(pathA);  // Now C is the least recently used unused entry
+    assert(pool.getNumEntries() == 3);
+
+    size_t entryBytes = pan::SamplePool::getMemorySize(*held);
+    pool.setMemoryBudget(entryBytes * 2);
+    assert(pool.getNumEntries() == 2);
+    auto reloaded = pool.load(pathA);
+    assert(reloaded.get() == a);  // Still cached
+    reloaded.reset();
+
+    // Entries in use are never evicted, even over budget
+    pool.setMemoryBudget(0);
+    assert(pool.getNumEntries() == 1);
+    reloaded = pool.load(pathB);
+    assert(reloaded == held);
+    reloaded.reset();
+    assert(pool.getMemoryUsage() == entryBytes);
+
+    held.reset();
+    pool.purgeUnused();
+    assert(pool.getNumEntries() == 0);
+    pool.setMemoryBudget(pan::SamplePool::DEFAULT_MEMORY_BUDGET);
+
+    std::remove(pathA.c_str());
+    std::remove(pathB.c_str());
+    std::remove(pathC.c_str());
+}
+
+int main() {
+    testSamePathIsShared();
+    testChangedFileIsReloaded();
+    testUnusedEntriesEvictedOldestFirst();
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pan/audio/sample_stream.h"
+#include "pan/audio/sampler.h"
+#include "test_wav_fixture.h"
+
+static const double SAMPLE_RATE = 44100.0;
+
+// Frame n: left sin(0.01n) * 0.5, right cos(0.013n) * 0.5
+static float testValue(size_t frame, size_t channel) {
+    return channel == 0 ? 0.5f * std::sin(0.01f * frame) : 0.5f * std::cos(0.013f * frame);
+}
+
+static std::string writeTestWav(const char* name, size_t frames, size_t channels, pan::WavWriter::Format format) {
+    return writeWav(name, frames, channels, SAMPLE_RATE, testValue, format);
+}
+
+void testSampleFileReadsFrames() {
+    std::string path = writeTestWav("stream_read.wav", 10000, 2, pan::WavWriter::Format::Float32);
+    auto file = pan::SampleFile::open(path);
+    assert(file);
+    assert(file->getNumFrames() == 10000);
+    assert(file->getNumChannels() == 2);
+    assert(file->getSampleRate() == SAMPLE_RATE);
+
+    std::vector<float> left(100), right(100);
+    std::vector<uint8_t> scratch;
+    size_t framesRead = file->read(5000, 100, left.data(), right.data(), scratch);
+    assert(framesRead == 100);
+    for (size_t i = 0; i < 100; ++i) {
+        assert(left[i] == testValue(5000 + i, 0));
+        assert(right[i] == testValue(5000 + i, 1));
+    }
+
+    // Short at the end of the file
+    framesRead = file->read(9950, 100, left.data(), right.data(), scratch);
+    assert(framesRead == 50);
+    framesRead = file->read(10000, 100, left.data(), right.data(), scratch);
+    assert(framesRead == 0);
+    (void)framesRead;
+
+    assert(!pan::SampleFile::open(tempPath("does_not_exist.wav")));
+    std::remove(path.c_str());
+}
+
+static void render(pan::Sampler& sampler, std::vector<float>& outL, std::vector<float>& outR, size_t blockSize) {
+    for (size_t pos = 0; pos < outL.size(); pos += blockSize) {
+        size_t n = std::min(blockSize, outL.size() - pos);
+        sampler.process(outL.data() + pos, outR.data() + pos, n);
+    }
+}
+
+// Offline, a streamed sample must play exactly as the same file loaded whole
+void testStreamedMatchesInMemory(pan::WavWriter::Format format, size_t channels, bool loop, int note) {
+    std::string path = writeTestWav("stream_match.wav", static_cast<size_t>(SAMPLE_RATE), channels, format);
+
+    pan::Sampler memory(SAMPLE_RATE);
+    pan::Sampler streamed(SAMPLE_RATE);
+    streamed.setStreamingThreshold(0);
+    streamed.setStreamingPreload(0.05);
+    streamed.setOfflineRendering(true);
+    bool loaded = memory.loadSample(path);
+    assert(loaded);
+    loaded = streamed.loadSample(path);
+    assert(loaded);
+    (void)loaded;
+    assert(!memory.isStreaming());
+    assert(streamed.isStreaming());
+    assert(streamed.getSampleFrames() == memory.getSampleFrames());
+    assert(streamed.getSample()->dataL.size() < streamed.getSampleFrames());
+    assert(streamed.getSample()->waveformDisplay.size() == memory.getSample()->waveformDisplay.size());
+
+    for (pan::Sampler* sampler : {&memory, &streamed}) {
+        sampler->getParams().loopEnabled = loop;
+        sampler->getParams().loopStart = 0.6f;
+        sampler->noteOn(static_cast<uint8_t>(note), 100);
+    }
+
+    // Long enough to wrap the loop several times
+    const size_t frames = static_cast<size_t>(SAMPLE_RATE * 3.0);
+    std::vector<float> memL(frames), memR(frames), strL(frames), strR(frames);
+    render(memory, memL, memR, 512);
+    render(streamed, strL, strR, 512);
+
+    assert(streamed.getStreamUnderruns() == 0);
+    float peak = 0.0f;
+    for (size_t i = 0; i < frames; ++i) {
+        assert(strL[i] == memL[i]);
+        assert(strR[i] == memR[i]);
+        peak = std::max(peak, std::abs(memL[i]));
+    }
+    assert(peak > 0.01f);
+    std::remove(path.c_str());
+}
+
+// A voice that outruns the disk plays silence, counts it, and carries on
+void testUnderrunIsCountedNotWaitedFor() {
+    std::string path = writeTestWav("stream_underrun.wav", static_cast<size_t>(SAMPLE_RATE * 2.0), 1,
+                                    pan::WavWriter::Format::PCM16);
+    pan::Sampler sampler(SAMPLE_RATE);
+    sampler.setStreamingThreshold(0);
+    sampler.setStreamingPreload(0.01);
+    bool loaded = sampler.loadSample(path);
+    assert(loaded);
+    (void)loaded;
+    sampler.getParams().sustain = 1.0f;
+    sampler.noteOn(60, 127);
+
+    // One huge block: the stream is only requested inside it, so everything
+    // past the resident 10 ms is missing
+    const size_t frames = static_cast<size_t>(SAMPLE_RATE * 1.0);
+    std::vector<float> outL(frames), outR(frames);
+    sampler.process(outL.data(), outR.data(), frames);
+    assert(sampler.getStreamUnderruns() > 0);
+    assert(outL[100] != 0.0f);
+    assert(outL[frames - 1] == 0.0f);
+
+    // Given a moment, the streamer catches up with the play head
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    uint64_t underruns = sampler.getStreamUnderruns();
+    std::vector<float> blockL(512), blockR(512);
+    sampler.process(blockL.data(), blockR.data(), 512);
+    assert(sampler.getStreamUnderruns() == underruns);
+    float peak = 0.0f;
+    for (float v : blockL) {
+        peak = std::max(peak, std::abs(v));
+    }
+    assert(peak > 0.0f);
+    std::remove(path.c_str());
+}
+
+void testSmallFilesStayResident() {
+    std::string path = writeTestWav("stream_small.wav", 1000, 2, pan::WavWriter::Format::PCM24);
+    pan::Sampler sampler(SAMPLE_RATE);
+    bool loaded = sampler.loadSample(path);
+    assert(loaded);
+    (void)loaded;
+    assert(!sampler.isStreaming());
+    assert(sampler.getSample()->dataL.size() == 1000);
+    assert(std::abs(sampler.getSample()->dataR[500] - testValue(500, 1)) < 1e-6f);
+    std::remove(path.c_str());
+}
+
+// Streams created and destroyed mid-pass are skipped or waited for, and
+// never disturb the others
+void testStreamsComeAndGoWhileFilling() {
+    const size_t frames = 20000;
+    std::string path = writeTestWav("stream_churn.wav", frames, 1, pan::WavWriter::Format::Float32);
+    auto file = pan::SampleFile::open(path);
+    assert(file);
+
+    pan::VoiceStream kept(file, false);
+    kept.start(0, frames, 0, true, 0);
+    uint64_t played = 0;
+    for (int i = 0; i < 200; ++i) {
+        {
+            pan::VoiceStream passing(file, false);
+            passing.start(0, frames, 0, true, 0);
+            if (i % 2 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+        const uint64_t available = kept.available();
+        for (; played < available; ++played) {
+            assert(kept.left(played) == testValue(played % frames, 0));
+        }
+        kept.consume(played);
+    }
+    assert(played > 0);
+    kept.stop();
+    std::remove(path.c_str());
+}
+
+int main() {
+    testSampleFileReadsFrames();
+    testStreamedMatchesInMemory(pan::WavWriter::Format::Float32, 2, false, 60);
+    testStreamedMatchesInMemory(pan::WavWriter::Format::Float32, 2, true, 67);
+    testStreamedMatchesInMemory(pan::WavWriter::Format::PCM16, 1, true, 48);
+    testUnderrunIsCountedNotWaitedFor();
+    testSmallFilesStayResident();
+    testStreamsComeAndGoWhileFilling();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include "pan/audio/audio_engine.h"
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/scratch_arena.h"
+#include "pan/audio/rt_alloc_check.h"
+#include "pan/midi/midi_clip.h"
+#include "pan/track/track.h"
+
+void testAcquireAndReset() {
+    pan::ScratchArena arena;
+    bool prepared = arena.prepare(2, 1024, 3);
+    assert(prepared);
+    (void)prepared;
+    assert(arena.getNumBuffers() == 3);
+
+    pan::AudioBuffer* a = arena.acquire(256);
+    pan::AudioBuffer* b = arena.acquire(1024);
+    pan::AudioBuffer* c = arena.acquire(64);
+    assert(a && b && c);
+    assert(a != b && b != c && a != c);
+    assert(a->getNumFrames() == 256);
+    assert(a->getCapacity() == 1024);
+    assert(a->getNumChannels() == 2);
+
+    // Exhausted, and oversized requests fail without allocating
+    assert(arena.acquire(16) == nullptr);
+    assert(arena.getExhaustedCount() == 1);
+    arena.reset();
+    assert(arena.acquire(2048) == nullptr);
+    assert(arena.getExhaustedCount() == 2);
+    assert(arena.getHighWaterMark() == 3);
+
+    // Borrowed buffers come back cleared
+    arena.reset();
+    pan::AudioBuffer* again = arena.acquire(128);
+    assert(again == a);
+    again->fill(0.5f);
+    arena.reset();
+    again = arena.acquire(128);
+    for (size_t i = 0; i < 128; ++i) {
+        assert(again->getReadPointer(0)[i] == 0.0f);
+        assert(again->getReadPointer(1)[i] == 0.0f);
+    }
+}
+
+void testLogicalLength() {
+    pan::AudioBuffer buffer(1, 100);
+    buffer.fill(1.0f);
+    bool resized = buffer.setNumFrames(40);
+    assert(resized);
+    resized = buffer.setNumFrames(101);
+    assert(!resized);
+    (void)resized;
+    buffer.clear();
+    // Only the logical length is touched
+    assert(buffer.getReadPointer(0)[39] == 0.0f);
+    assert(buffer.getReadPointer(0)[40] == 1.0f);
+}
+
+void testCallbackRunsWithArena() {
+    pan::AudioEngine engine;
+    bool sawGuard = false;
+    bool borrowed = true;
+    engine.setProcessCallback([&](pan::AudioBuffer&, pan::AudioBuffer&, size_t numFrames) {
+        sawGuard = pan::RealtimeAllocationGuard::isActive();
+        // Every track can borrow its buffers each block
+        for (size_t i = 0; i < engine.getMaxTrackCount() * pan::AudioEngine::SCRATCH_BUFFERS_PER_TRACK; ++i) {
+            borrowed = borrowed && engine.getScratchArena().acquire(numFrames) != nullptr;
+        }
+    });
+
+    pan::OfflineRenderOptions options;
+    options.totalFrames = 2048;
+    options.blockSize = 512;
+    bool completed = engine.renderOffline(options);
+    assert(completed);
+    (void)completed;
+    assert(sawGuard);
+    assert(borrowed);
+    assert(!pan::RealtimeAllocationGuard::isActive());
+    assert(engine.getScratchArena().getExhaustedCount() == 0);
+}
+
+// Without an arena a track renders into the buffer from prepare(), never a fresh one
+void testTrackFallbackBuffer() {
+    pan::Track track("Synth", pan::Track::Type::MIDI);
+    track.initializeSynthesizer(48000.0);
+    auto clip = std::make_shared<pan::MidiClip>("Notes");
+    clip->addEvent(0, pan::MidiMessage(pan::MidiMessageType::NoteOn, 0, 60, 100));
+    clip->setPlaying(true);
+    track.addMidiClip(clip);
+
+    auto peak = [](const pan::AudioBuffer& buffer) {
+        float value = 0.0f;
+        for (size_t i = 0; i < buffer.getNumFrames(); ++i) {
+            value = std::max(value, std::abs(buffer.getReadPointer(0)[i]));
+        }
+        return value;
+    };
+
+    // Unprepared: the block is skipped rather than allocated for
+    pan::AudioBuffer output(2, 256);
+    track.process(output, 256);
+    assert(peak(output) == 0.0f);
+
+    track.prepare(2, 512);
+    track.process(output, 256);
+    assert(peak(output) > 0.0f);
+
+    // Larger than prepared: skipped again
+    pan::AudioBuffer large(2, 1024);
+    track.process(large, 1024);
+    assert(peak(large) == 0.0f);
+}
+
+int main() {
+    testAcquireAndReset();
+    testLogicalLength();
+    testTrackFallbackBuffer();
+    testCallbackRunsWithArena();
+    return 0;
+}
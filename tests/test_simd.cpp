@@ -0,0 +1,76 @@
+#include <cassert>
+#include <cmath>
+#include "pan/dsp/simd.h"
+
+using pan::simd::float4;
+
+static float4 make(float a, float b, float c, float d) {
+    alignas(16) float values[4] = {a, b, c, d};
+    return float4::load(values);
+}
+
+static void unpack(float4 x, float* out) {
+    alignas(16) float values[4];
+    x.store(values);
+    for (int i = 0; i < 4; ++i) {
+        out[i] = values[i];
+    }
+}
+
+void testArithmetic() {
+    float out[4];
+    unpack(make(1, 2, 3, 4) * make(2, 2, 2, 2) - make(1, 1, 1, 1) + float4(0.5f), out);
+    assert(out[0] == 1.5f && out[1] == 3.5f && out[2] == 5.5f && out[3] == 7.5f);
+
+    unpack(pan::simd::min(make(1, 5, 3, 7), float4(4.0f)), out);
+    assert(out[0] == 1.0f && out[1] == 4.0f && out[2] == 3.0f && out[3] == 4.0f);
+    unpack(pan::simd::max(make(1, 5, 3, 7), float4(4.0f)), out);
+    assert(out[0] == 4.0f && out[1] == 5.0f && out[2] == 4.0f && out[3] == 7.0f);
+
+    assert(pan::simd::sum(make(1, 2, 3, 4)) == 10.0f);
+
+    unpack(pan::simd::sum4(make(1, 2, 3, 4), float4(1.0f), make(-1, 1, -1, 1), make(0.5f, 0, 0, 0)), out);
+    assert(out[0] == 10.0f && out[1] == 4.0f && out[2] == 0.0f && out[3] == 0.5f);
+
+    alignas(16) float values[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    unpack(float4::loadUnaligned(values + 3), out);
+    assert(out[0] == 3.0f && out[1] == 4.0f && out[2] == 5.0f && out[3] == 6.0f);
+    float4(9, 8, 7, 6).storeUnaligned(values + 1);
+    assert(values[0] == 0.0f && values[1] == 9.0f && values[4] == 6.0f && values[5] == 5.0f);
+}
+
+void testMasks() {
+    auto mask = make(0, 1, 2, 3) < float4(1.5f);
+    assert(mask.bits() == 0x3);
+    assert((make(0, 1, 2, 3) >= float4(1.0f)).bits() == 0xE);
+
+    float out[4];
+    unpack(pan::simd::select(mask, float4(1.0f), float4(-1.0f)), out);
+    assert(out[0] == 1.0f && out[1] == 1.0f && out[2] == -1.0f && out[3] == -1.0f);
+}
+
+void testFract() {
+    float out[4];
+    unpack(pan::simd::fract(make(0.25f, 1.75f, -0.25f, 3.0f)), out);
+    assert(out[0] == 0.25f && out[1] == 0.75f && out[2] == 0.75f && out[3] == 0.0f);
+
+    // Wrapped phases stay in [0, 1)
+    for (float x = -8.0f; x < 8.0f; x += 0.013f) {
+        unpack(pan::simd::fract(float4(x)), out);
+        assert(out[0] >= 0.0f && out[0] < 1.0f);
+        assert(std::fabs(out[0] - (x - std::floor(x))) < 1e-5f);
+    }
+
+    alignas(16) int32_t index[4];
+    pan::simd::truncate(make(0.5f, 1.9f, 2047.99f, -1.5f), index);
+    assert(index[0] == 0 && index[1] == 1 && index[2] == 2047 && index[3] == -1);
+    unpack(pan::simd::truncate(make(0.5f, 1.9f, 2047.99f, -1.5f)), out);
+    assert(out[0] == 0.0f && out[1] == 1.0f && out[2] == 2047.0f && out[3] == -1.0f);
+}
+
+int main() {
+    testArithmetic();
+    testMasks();
+    testFract();
+    return 0;
+}
@@ -0,0 +1,332 @@
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include "pan/audio/audio_buffer.h"
+#include "pan/audio/noise_seeds.h"
+#include "pan/midi/synthesizer.h"
+
+static const size_t BLOCK = 256;
+static const size_t BLOCKS = 200;
+
+// Pad with every control-rate modulator switched on
+static void configureModulatedPatch(pan::Synthesizer& synth) {
+    synth.setOscillators({pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 0.6f),
+                          pan::Oscillator(pan::Waveform::Square, 0.5f, 0.4f)});
+    synth.setADSR(0.05f, 0.2f, 0.6f, 0.3f);
+    auto& env = synth.getEnvelope();
+    env.unison.enabled = true;
+    env.unison.voices = 3;
+    env.unison.detune = 15.0f;
+    env.filter.enabled = true;
+    env.filter.cutoff = 0.4f;
+    env.filter.resonance = 0.5f;
+    env.filter.envAmount = 0.4f;
+    env.filter.envelope = pan::ADSREnvelope(0.02f, 0.3f, 0.3f, 0.2f);
+    env.lfo1 = pan::LFO(5.0f, 0.3f, pan::LFO::Target::Pitch);
+    env.lfo2 = pan::LFO(2.0f, 0.5f, pan::LFO::Target::Amplitude);
+    env.pitchEnvelope = pan::PitchEnvelope(2.0f, 0.05f);
+    env.portamento.enabled = true;
+    env.portamento.time = 0.08f;
+}
+
+static std::vector<float> render(size_t controlRate) {
+    pan::Synthesizer synth(48000.0);
+    synth.setControlRate(controlRate);
+    configureModulatedPatch(synth);
+
+    std::vector<float> out;
+    pan::AudioBuffer buffer(2, BLOCK);
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        if (b == 0) {
+            for (int n = 0; n < 6; ++n) {
+                synth.noteOn(static_cast<uint8_t>(48 + n * 4), 100);
+            }
+        }
+        if (b == 120) {
+            synth.allNotesOff();
+        }
+        synth.generateAudio(buffer, BLOCK);
+        for (size_t ch = 0; ch < 2; ++ch) {
+            out.insert(out.end(), buffer.getReadPointer(ch), buffer.getReadPointer(ch) + BLOCK);
+        }
+    }
+    return out;
+}
+
+static double rms(const float* samples, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return std::sqrt(sum / static_cast<double>(n));
+}
+
+void testControlRateMatchesPerSample() {
+    std::vector<float> reference = render(1);
+    std::vector<float> controlRate = render(32);
+    assert(reference.size() == controlRate.size());
+
+    // Difference stays under 1% of the signal, and every block's level within 0.05 dB
+    std::vector<float> difference(reference.size());
+    for (size_t i = 0; i < reference.size(); ++i) {
+        difference[i] = reference[i] - controlRate[i];
+    }
+    double signal = rms(reference.data(), reference.size());
+    assert(signal > 0.05);
+    assert(rms(difference.data(), difference.size()) < 0.01 * signal);
+
+    for (size_t b = 0; b < BLOCKS; ++b) {
+        double a = rms(reference.data() + b * 2 * BLOCK, 2 * BLOCK);
+        double c = rms(controlRate.data() + b * 2 * BLOCK, 2 * BLOCK);
+        if (a > 0.01) {
+            assert(std::fabs(20.0 * std::log10(c / a)) < 0.05);
+        }
+    }
+}
+
+void testControlRateRange() {
+    pan::Synthesizer synth(48000.0);
+    assert(synth.getControlRate() == pan::Synthesizer::DEFAULT_CONTROL_RATE);
+    synth.setControlRate(0);
+    assert(synth.getControlRate() == 1);
+    synth.setControlRate(100000);
+    assert(synth.getControlRate() == pan::Synthesizer::MAX_CONTROL_RATE);
+}
+
+void testOscillatorEditsTakeEffect() {
+    // Cached oscillator lanes must notice edits made through the mutable accessor
+    pan::Synthesizer synth(48000.0);
+    synth.setADSR(0.001f, 0.001f, 1.0f, 0.1f);
+    synth.noteOn(60, 127);
+    pan::AudioBuffer buffer(2, BLOCK);
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) > 0.01);
+
+    synth.getOscillators()[0].amplitude = 0.0f;
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) < 1e-6);
+
+    synth.getOscillators()[0].amplitude = 1.0f;
+    synth.getOscillators()[0].pan = -1.0f;
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) > 0.01);
+    assert(rms(buffer.getReadPointer(1), BLOCK) < 1e-6);
+}
+
+void testFeatureChangesSwitchKernel() {
+    // Each block renders with the kernel for the patch as it is now
+    pan::Synthesizer synth(48000.0);
+    synth.setOscillators({pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 1.0f)});
+    synth.setADSR(0.001f, 0.001f, 1.0f, 0.1f);
+    synth.noteOn(60, 127);
+    pan::AudioBuffer buffer(2, BLOCK);
+    synth.generateAudio(buffer, BLOCK);
+    synth.generateAudio(buffer, BLOCK);
+    double open = rms(buffer.getReadPointer(0), BLOCK);
+
+    auto& env = synth.getEnvelope();
+    env.filter.enabled = true;
+    env.filter.cutoff = 0.05f;
+    synth.generateAudio(buffer, BLOCK);
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) < 0.5 * open);
+
+    env.filter.enabled = false;
+    env.pan = 1.0f;
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) < 1e-6);
+    assert(rms(buffer.getReadPointer(1), BLOCK) > 0.01);
+
+    // Noise has no table, so this leaves the wavetable-only kernel
+    env.pan = 0.0f;
+    synth.getOscillators()[0].waveform = pan::Waveform::Noise;
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) > 0.01);
+}
+
+void testMidiOffsetsAreSampleAccurate() {
+    pan::Synthesizer synth(48000.0);
+    synth.setOscillators({pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 1.0f)});
+    synth.setADSR(0.001f, 0.001f, 1.0f, 0.01f);
+    pan::AudioBuffer buffer(2, BLOCK);
+
+    // Queued out of order; the note still starts exactly at its offset
+    synth.processMidiMessage(pan::MidiMessage(pan::MidiMessageType::NoteOff, 0, 60, 0), 200);
+    synth.processMidiMessage(pan::MidiMessage(pan::MidiMessageType::NoteOn, 0, 60, 100), 100);
+    synth.generateAudio(buffer, BLOCK);
+    const float* left = buffer.getReadPointer(0);
+    assert(rms(left, 100) == 0.0);
+    assert(rms(left + 100, 100) > 0.01);
+
+    // Released at 200; a 10 ms release has finished two blocks later
+    synth.generateAudio(buffer, BLOCK);
+    synth.generateAudio(buffer, BLOCK);
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) < 1e-4);
+
+    // Offsets past the block land on its last frame
+    synth.processMidiMessage(pan::MidiMessage(pan::MidiMessageType::NoteOn, 0, 60, 100), 10 * BLOCK);
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK - 1) == 0.0);
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) > 0.01);
+    assert(synth.getDroppedMidiEvents() == 0);
+}
+
+// A note released before it has rendered a frame must still end
+void testNoteReleasedBeforeFirstFrameStops() {
+    for (bool queued : {false, true}) {
+        pan::Synthesizer synth(48000.0);
+        synth.setOscillators({pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 1.0f)});
+        synth.setADSR(0.05f, 0.1f, 0.8f, 0.2f);
+        if (queued) {
+            // A zero-length clip note or a fast tap: both events at one offset
+            synth.processMidiMessage(pan::MidiMessage(pan::MidiMessageType::NoteOn, 0, 60, 100), 64);
+            synth.processMidiMessage(pan::MidiMessage(pan::MidiMessageType::NoteOff, 0, 60, 0), 64);
+        } else {
+            synth.noteOn(60, 100);
+            synth.noteOff(60);
+        }
+        pan::AudioBuffer buffer(2, BLOCK);
+        for (int b = 0; b < 4; ++b) {
+            synth.generateAudio(buffer, BLOCK);
+        }
+        assert(rms(buffer.getReadPointer(0), BLOCK) == 0.0);
+        assert(!synth.isProducingAudio());
+    }
+}
+
+void testStolenVoiceFadesOut() {
+    // One-voice polyphony: the second note steals the first, which fades rather than cuts
+    auto render = [](bool firstNote, std::vector<float>& out) {
+        pan::Synthesizer synth(48000.0);
+        synth.setPolyphony(1);
+        synth.setOscillators({pan::Oscillator(pan::Waveform::Sine, 1.0f, 1.0f)});
+        synth.setADSR(0.001f, 0.001f, 1.0f, 0.5f);
+        pan::AudioBuffer buffer(2, BLOCK);
+        for (size_t b = 0; b < 6; ++b) {
+            if (b == 0 && firstNote) {
+                synth.noteOn(60, 100);
+            }
+            if (b == 2) {
+                synth.noteOn(72, 100);
+            }
+            synth.generateAudio(buffer, BLOCK);
+            out.insert(out.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + BLOCK);
+        }
+        assert(synth.getPolyphony() == 1);
+    };
+    std::vector<float> stolen, alone;
+    render(true, stolen);
+    render(false, alone);
+
+    // Both notes overlap briefly after the steal...
+    double overlap = 0.0;
+    for (size_t i = 2 * BLOCK; i < 2 * BLOCK + 64; ++i) {
+        overlap += std::fabs(stolen[i] - alone[i]);
+    }
+    assert(overlap > 0.1);
+
+    // ...and once the fade is over only the new note is left
+    for (size_t i = 4 * BLOCK; i < 6 * BLOCK; ++i) {
+        assert(std::fabs(stolen[i] - alone[i]) < 1e-4f);
+    }
+}
+
+void testIdleDetection() {
+    pan::Synthesizer synth(48000.0);
+    synth.setADSR(0.001f, 0.001f, 1.0f, 0.01f);
+    pan::AudioBuffer buffer(2, BLOCK);
+    assert(!synth.isProducingAudio());
+
+    // Queued MIDI wakes it before any rendering happens
+    synth.processMidiMessage(pan::MidiMessage(pan::MidiMessageType::NoteOn, 0, 60, 100));
+    assert(synth.isProducingAudio());
+    synth.generateAudio(buffer, BLOCK);
+    assert(synth.isProducingAudio());
+
+    // Still sounding through the release, idle after it
+    synth.noteOff(60);
+    synth.generateAudio(buffer, BLOCK);
+    assert(synth.isProducingAudio());
+    for (int b = 0; b < 4; ++b) {
+        synth.generateAudio(buffer, BLOCK);
+    }
+    assert(!synth.isProducingAudio());
+    synth.generateAudio(buffer, BLOCK);
+    assert(rms(buffer.getReadPointer(0), BLOCK) == 0.0);
+}
+
+static std::vector<float> playNoise(pan::Synthesizer& synth) {
+    synth.setOscillators({pan::Oscillator(pan::Waveform::Noise, 1.0f, 1.0f)});
+    synth.setADSR(0.001f, 0.001f, 1.0f, 0.05f);
+    synth.noteOn(60, 100);
+    synth.noteOn(64, 100);
+    pan::AudioBuffer buffer(2, BLOCK);
+    std::vector<float> out;
+    for (int b = 0; b < 4; ++b) {
+        synth.generateAudio(buffer, BLOCK);
+        out.insert(out.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + BLOCK);
+    }
+    return out;
+}
+
+// Noise comes from per-voice streams derived from the seed: same seed and
+// notes, same output, whichever instance renders it
+static std::vector<float> renderNoise(uint32_t seed) {
+    pan::Synthesizer synth(48000.0);
+    synth.setSeed(seed);
+    return playNoise(synth);
+}
+
+void testNoiseIsReproducible() {
+    std::vector<float> first = renderNoise(11);
+    assert(rms(first.data(), first.size()) > 0.05);
+    assert(first == renderNoise(11));
+    assert(first != renderNoise(12));
+}
+
+// Two tracks added with the same noise patch, seeded as MainWindow seeds them:
+// when they are created, not only before a bounce
+void testFreshTracksPlayDifferentNoise() {
+    const uint32_t projectSeed = 0x5EED;
+    pan::Synthesizer first(48000.0), second(48000.0);
+    assert(playNoise(first) == playNoise(second));  // Unseeded, both play the same noise
+
+    pan::Synthesizer a(48000.0), b(48000.0);
+    bool reseeded = pan::NoiseSeeds::assign(a, pan::NoiseSeeds::forSlot(projectSeed, 0, pan::NoiseSeeds::INSTRUMENT_SLOT), false);
+    assert(reseeded);
+    reseeded = pan::NoiseSeeds::assign(b, pan::NoiseSeeds::forSlot(projectSeed, 1, pan::NoiseSeeds::INSTRUMENT_SLOT), false);
+    assert(reseeded);
+    std::vector<float> outA = playNoise(a);
+    std::vector<float> outB = playNoise(b);
+    double cross = 0.0, powerA = 0.0, powerB = 0.0;
+    for (size_t i = 0; i < outA.size(); ++i) {
+        cross += static_cast<double>(outA[i]) * outB[i];
+        powerA += static_cast<double>(outA[i]) * outA[i];
+        powerB += static_cast<double>(outB[i]) * outB[i];
+    }
+    assert(powerA > 0.0 && powerB > 0.0);
+    assert(std::fabs(cross / std::sqrt(powerA * powerB)) < 0.05);
+
+    // The next live pass leaves them alone, so running noise isn't restarted
+    reseeded = pan::NoiseSeeds::assign(a, pan::NoiseSeeds::forSlot(projectSeed, 0, pan::NoiseSeeds::INSTRUMENT_SLOT), false);
+    assert(!reseeded);
+    reseeded = pan::NoiseSeeds::assign(a, pan::NoiseSeeds::forSlot(projectSeed, 0, pan::NoiseSeeds::INSTRUMENT_SLOT), true);
+    assert(reseeded);
+    (void)reseeded;
+}
+
+int main() {
+    testControlRateMatchesPerSample();
+    testControlRateRange();
+    testOscillatorEditsTakeEffect();
+    testFeatureChangesSwitchKernel();
+    testMidiOffsetsAreSampleAccurate();
+    testNoteReleasedBeforeFirstFrameStops();
+    testStolenVoiceFadesOut();
+    testIdleDetection();
+    testNoiseIsReproducible();
+    testFreshTracksPlayDifferentNoise();
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <cassert>
+#include "pan/midi/voice_allocator.h"
+
+using pan::StealPolicy;
+using pan::VoiceAllocator;
+
+void testFreeSlotsFirst() {
+    VoiceAllocator allocator(4);
+    for (uint8_t n = 0; n < 4; ++n) {
+        auto allocation = allocator.allocate(60 + n);
+        assert(allocation.voice == n);
+        assert(allocation.stolen == VoiceAllocator::NO_VOICE);
+    }
+    assert(allocator.getSoundingCount() == 4);
+
+    allocator.finish(2);
+    assert(allocator.allocate(70).voice == 2);
+    assert(allocator.getStealCount() == 0);
+}
+
+void testPolyphonyLeavesFadeHeadroom() {
+    VoiceAllocator allocator(6);
+    allocator.setPolyphony(4);
+    for (uint8_t n = 0; n < 4; ++n) {
+        allocator.allocate(60 + n);
+    }
+
+    // The oldest voice fades in its own slot while the new note takes a spare one
+    auto allocation = allocator.allocate(70);
+    assert(allocation.stolen == 0);
+    assert(allocation.voice == 4);
+    assert(allocator.getState(0) == VoiceAllocator::State::Stolen);
+    assert(allocator.getSoundingCount() == 4);
+
+    allocation = allocator.allocate(71);
+    assert(allocation.stolen == 1 && allocation.voice == 5);
+
+    // Out of headroom: the victim's slot is reused directly
+    allocation = allocator.allocate(72);
+    assert(allocation.stolen == VoiceAllocator::NO_VOICE);
+    assert(allocation.voice == 2);
+    assert(allocator.getStealCount() == 3);
+
+    allocator.setPolyphony(0);
+    assert(allocator.getPolyphony() == 1);
+    allocator.setPolyphony(100);
+    assert(allocator.getPolyphony() == 6);
+}
+
+void testStealPolicies() {
+    auto fill = [](VoiceAllocator& allocator) {
+        allocator.setPolyphony(4);
+        for (uint8_t n = 0; n < 4; ++n) {
+            allocator.allocate(60 + n);
+        }
+        allocator.setLevel(0, 0.9f);
+        allocator.setLevel(1, 0.5f);
+        allocator.setLevel(2, 0.1f);
+        allocator.setLevel(3, 0.7f);
+        allocator.release(3);
+    };
+
+    VoiceAllocator oldest(8);
+    fill(oldest);
+    assert(oldest.allocate(80).stolen == 0);
+
+    VoiceAllocator quietest(8);
+    quietest.setStealPolicy(StealPolicy::Quietest);
+    fill(quietest);
+    assert(quietest.allocate(80).stolen == 2);
+
+    VoiceAllocator sameNote(8);
+    sameNote.setStealPolicy(StealPolicy::SameNote);
+    fill(sameNote);
+    assert(sameNote.allocate(61).stolen == 1);
+    assert(sameNote.allocate(90).stolen == 0);  // No match: oldest
+
+    VoiceAllocator releaseFirst(8);
+    releaseFirst.setStealPolicy(StealPolicy::ReleaseFirst);
+    fill(releaseFirst);
+    assert(releaseFirst.allocate(80).stolen == 3);
+    assert(releaseFirst.allocate(81).stolen == 0);  // Nothing released left: oldest
+}
+
+void testReset() {
+    VoiceAllocator allocator(2);
+    allocator.allocate(60);
+    allocator.allocate(61);
+    allocator.reset();
+    assert(allocator.getSoundingCount() == 0);
+    assert(allocator.allocate(62).voice == 0);
+}
+
+int main() {
+    testFreeSlotsFirst();
+    testPolyphonyLeavesFadeHeadroom();
+    testStealPolicies();
+    testReset();
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "pan/audio/wav_writer.h"
+
+// Scratch files for tests that read samples from disk. Each test removes
+// the files it writes.
+
+inline std::string tempPath(const char* name) {
+    return std::string("/tmp/pan_test_") + name;
+}
+
+// Writes frames x channels at sampleRate to tempPath(name); frame n of
+// channel c is value(n, c). Returns the path.
+template <typename Value>
+std::string writeWav(const char* name, size_t frames, size_t channels, double sampleRate, Value value,
+                     pan::WavWriter::Format format = pan::WavWriter::Format::Float32) {
+    std::string path = tempPath(name);
+    std::vector<float> samples(frames * channels);
+    for (size_t n = 0; n < frames; ++n) {
+        for (size_t c = 0; c < channels; ++c) {
+            samples[n * channels + c] = static_cast<float>(value(n, c));
+        }
+    }
+    pan::WavWriter writer;
+    // Kept out of assert() so the file is still written under NDEBUG
+    const bool opened = writer.open(path, channels, sampleRate, format);
+    const bool written = opened && writer.writeInterleaved(samples.data(), frames);
+    const bool closed = writer.close();
+    assert(opened && written && closed);
+    (void)written;
+    (void)closed;
+    return path;
+}
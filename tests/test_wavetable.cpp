@@ -0,0 +1,104 @@
+#include <cassert>
+#include <cmath>
+#include "pan/audio/audio_buffer.h"
+#include "pan/midi/synthesizer.h"
+#include "pan/midi/wavetable.h"
+
+static const float PI = 3.14159265358979f;
+
+void testLevelSelection() {
+    using pan::WavetableBank;
+    assert(WavetableBank::selectLevel(0.0f) == 0);
+    assert(WavetableBank::selectLevel(0.5f / WavetableBank::MAX_HARMONICS) == 0);
+
+    // The chosen level's top harmonic is always at or below Nyquist, and the level below would alias
+    for (float increment = 0.0011f; increment < 0.5f; increment *= 1.07f) {
+        size_t level = WavetableBank::selectLevel(increment);
+        size_t harmonics = WavetableBank::MAX_HARMONICS >> level;
+        assert(harmonics * increment <= 0.5f);
+        assert(level == 0 || 2 * harmonics * increment > 0.5f);
+    }
+    assert(WavetableBank::selectLevel(0.9f) == WavetableBank::NUM_LEVELS - 1);
+}
+
+void testSineTable() {
+    const auto& bank = pan::WavetableBank::get();
+    for (int i = 0; i < 1000; ++i) {
+        float phase = static_cast<float>(i) / 1000.0f;
+        float expected = std::sin(2.0f * PI * phase);
+        assert(std::fabs(bank.lookup(pan::Waveform::Sine, phase, 0.01f) - expected) < 1e-5f);
+    }
+}
+
+void testBandLimitedShapes() {
+    const auto& bank = pan::WavetableBank::get();
+
+    // Level 0 follows the naive shapes away from their discontinuities
+    for (int i = 1; i < 20; ++i) {
+        float phase = 0.05f * static_cast<float>(i);
+        if (std::fabs(phase - 0.5f) < 0.01f) {
+            continue;
+        }
+        float saw = bank.lookup(pan::Waveform::Sawtooth, phase, 0.0001f);
+        float square = bank.lookup(pan::Waveform::Square, phase, 0.0001f);
+        float triangle = bank.lookup(pan::Waveform::Triangle, phase, 0.0001f);
+        assert(std::fabs(saw - (2.0f * phase - 1.0f)) < 0.02f);
+        assert(std::fabs(square - (phase < 0.5f ? 1.0f : -1.0f)) < 0.02f);
+        float expectedTriangle = phase < 0.5f ? 4.0f * phase - 1.0f : 3.0f - 4.0f * phase;
+        assert(std::fabs(triangle - expectedTriangle) < 0.01f);
+    }
+
+    // The top level holds just the fundamental
+    const float* top = bank.getTable(pan::Waveform::Sawtooth, pan::WavetableBank::NUM_LEVELS - 1);
+    for (size_t n = 0; n <= pan::WavetableBank::TABLE_SIZE; n += 64) {
+        float phase = static_cast<float>(n) / pan::WavetableBank::TABLE_SIZE;
+        assert(std::fabs(top[n] + 2.0f / PI * std::sin(2.0f * PI * phase)) < 1e-5f);
+    }
+}
+
+// Energy left after removing the fundamental; aliasing shows up as inharmonic content
+static double renderResidual(bool bandLimited) {
+    const double sampleRate = 48000.0;
+    pan::Synthesizer synth(sampleRate);
+    synth.setBandLimited(bandLimited);
+    synth.setOscillators({pan::Oscillator(pan::Waveform::Sawtooth, 1.0f, 1.0f)});
+    synth.setADSR(0.001f, 0.001f, 1.0f, 0.1f);
+    synth.noteOn(108, 127);  // C8, ~4186 Hz: harmonics above the 5th fold back
+
+    pan::AudioBuffer buffer(2, 4800);
+    synth.generateAudio(buffer, 4800);  // Skip the attack
+    synth.generateAudio(buffer, 4800);
+
+    // Project out every true harmonic below Nyquist; what is left is aliasing
+    const float* samples = buffer.getReadPointer(0);
+    const double f0 = 440.0 * std::pow(2.0, (108 - 69) / 12.0);
+    double total = 0.0;
+    for (size_t i = 0; i < 4800; ++i) {
+        total += samples[i] * samples[i];
+    }
+    double harmonic = 0.0;
+    for (int h = 1; h * f0 < sampleRate / 2; ++h) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < 4800; ++i) {
+            double w = 2.0 * M_PI * h * f0 * static_cast<double>(i) / sampleRate;
+            re += samples[i] * std::cos(w);
+            im += samples[i] * std::sin(w);
+        }
+        harmonic += 2.0 * (re * re + im * im) / 4800.0;
+    }
+    return (total - harmonic) / total;
+}
+
+void testLessAliasing() {
+    double naive = renderResidual(false);
+    double bandLimited = renderResidual(true);
+    assert(bandLimited < naive * 0.1);
+}
+
+int main() {
+    testLevelSelection();
+    testSineTable();
+    testBandLimitedShapes();
+    testLessAliasing();
+    return 0;
+}